@@ -0,0 +1,47 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Beacon timing and boss-side pairing limits. Kept free of Arduino and radio
+// headers so host benches simulate with the values the firmware uses.
+
+// Configurable beacon timing
+constexpr unsigned long MIN_BEACON_INTERVAL_MS = 1000; // 1 Second
+constexpr unsigned long MAX_BEACON_INTERVAL_MS = 1000*10; //10 Seconds
+constexpr unsigned long BEACON_INTERVAL_MS = MAX_BEACON_INTERVAL_MS;  // Default
+constexpr unsigned long BEACON_TIMEOUT = MAX_BEACON_INTERVAL_MS*10;     // Pairing window
+
+// Boss-side pairing capacity and persistence
+constexpr size_t PAIRING_TABLE_SIZE = 128;
+constexpr size_t BEACON_QUEUE_SIZE = 32;                  // Absorbs a burst between loop() calls
+constexpr unsigned long PEER_SAVE_QUIET_MS = 2000;        // Flush once admissions go quiet
+constexpr unsigned long PEER_SAVE_MAX_DELAY_MS = 10000;   // ...or at most this long after the first
+constexpr unsigned long KEY_OFFER_RETRY_MS = 500;         // PairAccept / KeyRotate resend interval until KeyConfirm
+constexpr uint8_t KEY_OFFER_ATTEMPTS = 8;                 // ...then the old LMK stays and the offer is dropped
+constexpr unsigned long KEY_OFFER_BACKOFF_MS = 30000;     // Retry delay after a dropped offer
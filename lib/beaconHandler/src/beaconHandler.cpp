@@ -27,33 +27,75 @@
 #include "ringBuffer.hpp"
 #include "espNowCoPilot.hpp"
 #include "platformCompat.hpp"
-#include <mbedtls/md.h>
+#include <textCodec.hpp>
+#include <heapStats.hpp>
+#include <packetTrace.hpp>
 #include <Arduino.h>
 
 beaconHandler* beaconHandler::instance = nullptr;
-extern espNowCoPilot<deviceDataPacket> radio;
+
+static const uint8_t broadcastMac[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+// Beacon HMAC input: mac, sequenceId + channel, nonce. Covering the sequence keeps a captured
+// beacon from being replayed under a bumped sequence to provoke a fresh PairAccept.
+static_assert(offsetof(beaconPacket, channel) == offsetof(beaconPacket, sequenceId) + 1,
+              "sequenceId and channel are MACed as one span");
+static hmacVerifyJob beaconMacJob(const beaconPacket& pkt) {
+    return {{{pkt.mac, sizeof(pkt.mac)}, {&pkt.sequenceId, 2}, {pkt.nonce, sizeof(pkt.nonce)}}, 3, pkt.hmac, false};
+}
 
 beaconHandler::beaconHandler() {}
 
-void beaconHandler::begin(configManager2* cfg, uint8_t channel) {
+beaconHandler::~beaconHandler() {
+    if (config) {
+        for (int id : configSubs) config->unsubscribe(id);
+    }
+}
+
+void beaconHandler::bindConfig(configManager2* cfg) {
+    if (config) {
+        for (int& id : configSubs) config->unsubscribe(id);
+    }
     config = cfg;
+    cfgSecret = config->handle("security", "secret");
+    cfgEncrypt = config->handle("security", "encrypt");
+
+    // Both deliver the current value immediately, then again whenever the web UI changes it
+    configSubs[0] = config->subscribe("security", "encrypt", onConfigChange, this);
+    configSubs[1] = config->subscribe("espnow", "beaconInterval", onConfigChange, this);
+    configSubs[2] = config->subscribe("security", "keyRotateMin", onConfigChange, this);
+}
+
+void beaconHandler::onConfigChange(const String&, const String& key, const String& value, void* context) {
+    beaconHandler* self = static_cast<beaconHandler*>(context);
+    if (key == "encrypt") {
+        self->secureMode = self->config->getBool(self->cfgEncrypt);
+    } else if (key == "beaconInterval") {
+        long userInterval = value.toInt();
+        if (userInterval >= (long)MIN_BEACON_INTERVAL_MS && userInterval <= (long)MAX_BEACON_INTERVAL_MS) {
+            self->beaconIntervalMs = static_cast<unsigned long>(userInterval);
+        }
+    } else if (key == "keyRotateMin") {
+        long minutes = value.toInt();
+        self->keyRotateMs = minutes > 0 ? static_cast<unsigned long>(minutes) * 60000UL : 0;
+    }
+}
+
+void beaconHandler::begin(configManager2* cfg, uint8_t channel) {
+    heapScope heap(HEAP_TAG_BEACON);
+    bindConfig(cfg);
     wifiChannel = channel;
-    paired = false;
     broadcasting = true;
     isBoss = false;
-
-    int userInterval = config->getValue("espnow", "beaconInterval").toInt();
-    if (userInterval >= MIN_BEACON_INTERVAL_MS && userInterval <= MAX_BEACON_INTERVAL_MS) {
-        beaconIntervalMs = static_cast<unsigned long>(userInterval);
-    }
+    fillSessionNonce(sessionNonce);
 
     setWiFiChannel(wifiChannel);
 }
 
 void beaconHandler::beginPairing(configManager2* cfg) {
-    config = cfg;
+    heapScope heap(HEAP_TAG_BEACON);
+    bindConfig(cfg);
     isBoss = true;
-    paired = false;
     broadcasting = false;
 
     instance = this;
@@ -62,12 +104,20 @@ void beaconHandler::beginPairing(configManager2* cfg) {
     esp_wifi_set_promiscuous_filter(nullptr);
     esp_wifi_set_promiscuous_rx_cb(sniffCallback);
 
+    // PairAccept goes out over broadcast: the worker has no key for us yet
+    if (radio) radio->addPeer(broadcastMac, wifiChannel, nullptr);
+    else Serial.println("⚠️ [PAIR] No radio set: workers cannot be admitted");
+
     Serial.println("[PAIR] Boss is listening for beacons...");
 }
 
 void beaconHandler::loop(unsigned long) {
+    heapScope heap(HEAP_TAG_BEACON);
     if (isBoss) {
-        if (!paired) processQueue();
+        processQueue();
+        unsigned long now = millis();
+        retryKeyOffers(now);
+        rotateDueKeys(now);
     } else {
         if (!broadcasting || millis() - lastBeaconTime < beaconIntervalMs) return;
         lastBeaconTime = millis();
@@ -83,9 +133,10 @@ void beaconHandler::sendBeacon(bool verbose) {
     pkt.channel = wifiChannel;
 
     WiFi.macAddress(pkt.mac);
+    memcpy(pkt.nonce, sessionNonce, sizeof(pkt.nonce));
 
-    String secret = config->getValue("security", "secret");
-    bool encrypt = config->getValue("security", "encrypt") == "true";
+    String secret = config->getString(cfgSecret);
+    bool encrypt = secureMode;
     pkt.unencrypted = !encrypt;
 
     if (encrypt && !secret.isEmpty()) {
@@ -95,7 +146,8 @@ void beaconHandler::sendBeacon(bool verbose) {
         memcpy(pkt.sharedSecret, secret.c_str(), sizeof(pkt.sharedSecret));
     }
 
-    esp_now_send(nullptr, reinterpret_cast<uint8_t*>(&pkt), sizeof(pkt));
+    bool sent = esp_now_send(nullptr, reinterpret_cast<uint8_t*>(&pkt), sizeof(pkt)) == ESP_OK;
+    packetTraceRecord(sent ? PACKET_TX : PACKET_TX_ERROR, nullptr, reinterpret_cast<const uint8_t*>(&pkt), sizeof(pkt));
     lastSentPacket = pkt;
 
     if (verbose) {
@@ -105,25 +157,12 @@ void beaconHandler::sendBeacon(bool verbose) {
 }
 
 void beaconHandler::signBeacon(beaconPacket& packet, const uint8_t* key, size_t len) {
-    const mbedtls_md_info_t* md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
-    if (!md) return;
-
-    mbedtls_md_context_t ctx;
-    mbedtls_md_init(&ctx);
-
-    if (mbedtls_md_setup(&ctx, md, 1) != 0) {
-        mbedtls_md_free(&ctx);
-        return;
-    }
-
-    mbedtls_md_hmac_starts(&ctx, key, len);
-    mbedtls_md_hmac_update(&ctx, packet.mac, sizeof(packet.mac));
-    mbedtls_md_hmac_finish(&ctx, packet.hmac);
-    mbedtls_md_free(&ctx);
+    hmacVerifyJob job = beaconMacJob(packet);
+    defaultCrypto().hmacSha256(key, len, job.parts, job.partCount, packet.hmac);
 }
 
 void beaconHandler::sniffCallback(void* buf, wifi_promiscuous_pkt_type_t type) {
-    if (!instance || instance->paired || type != WIFI_PKT_MGMT) return;
+    if (!instance || type != WIFI_PKT_MGMT) return;
 
     const wifi_promiscuous_pkt_t* pkt =
         reinterpret_cast<const wifi_promiscuous_pkt_t*>(buf);
@@ -132,19 +171,15 @@ void beaconHandler::sniffCallback(void* buf, wifi_promiscuous_pkt_type_t type) {
     beaconPacket candidate;
     memcpy(&candidate, pkt->payload, sizeof(beaconPacket));
 
-    Serial.printf("* [RX] MAC: %02X:%02X:%02X:%02X:%02X:%02X | Seq: %u | Mode: %s\n",
-                  candidate.mac[0], candidate.mac[1], candidate.mac[2],
-                  candidate.mac[3], candidate.mac[4], candidate.mac[5],
-                  candidate.sequenceId,
+    char macStr[MAC_TEXT_LEN + 1];
+    formatMac(candidate.mac, macStr);
+    Serial.printf("* [RX] MAC: %s | Seq: %u | Mode: %s\n", macStr, candidate.sequenceId,
                   candidate.unencrypted ? "CLEAR" : "SECURE");
 
-    String encryptFlag = instance->config->getValue("security", "encrypt");
-    bool expectSecure = (encryptFlag == "true");
+    bool expectSecure = instance->secureMode;
 
-    if (expectSecure && !instance->validateHMAC(candidate)) {
-        Serial.println("[REJECT] Invalid HMAC");
-        return;
-    } else if (!expectSecure && !candidate.unencrypted) {
+    // HMACs are checked in bulk by processQueue(), off the WiFi task
+    if (!expectSecure && !candidate.unencrypted) {
         Serial.println("[REJECT] Encrypted beacon but secure mode is disabled");
         return;
     }
@@ -153,84 +188,367 @@ void beaconHandler::sniffCallback(void* buf, wifi_promiscuous_pkt_type_t type) {
 }
 
 bool beaconHandler::validateHMAC(const beaconPacket& pkt) {
-    String secret = config->getValue("security", "secret");
+    String secret = config->getString(cfgSecret);
     if (secret.isEmpty()) return false;
 
-    uint8_t expected[32];
-    const mbedtls_md_info_t* md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
-    if (!md) return false;
+    hmacVerifyJob job = beaconMacJob(pkt);
+    return defaultCrypto().verifyHmacBatch(reinterpret_cast<const uint8_t*>(secret.c_str()),
+                                           secret.length(), &job, 1) == 1;
+}
+
+void beaconHandler::queueCandidate(const beaconPacket& pkt) {
+    beaconBuffer.push(const_cast<beaconPacket&>(pkt));
+}
+
+void beaconHandler::processQueue() {
+    unsigned long now = millis();
+    String secret = config->getString(cfgSecret);
+
+    // Drain the whole queue: every worker in a burst gets its own table entry
+    beaconPacket* batch = beaconBatch;
+    hmacVerifyJob* jobs = beaconJobs;
+    size_t count = 0;
+    size_t secure = 0;
+    while (count < BEACON_QUEUE_SIZE && beaconBuffer.pop(batch[count])) {
+        const beaconPacket& pkt = batch[count++];
+        if (pkt.unencrypted) continue;
+        jobs[secure++] = beaconMacJob(pkt);
+    }
+
+    // One key, many tags: the backend reuses the keyed HMAC state across the batch
+    if (secure > 0 && !secret.isEmpty()) {
+        defaultCrypto().verifyHmacBatch(reinterpret_cast<const uint8_t*>(secret.c_str()),
+                                        secret.length(), jobs, secure);
+    }
+
+    for (size_t i = 0, job = 0; i < count; ++i) {
+        const beaconPacket& pkt = batch[i];
+        bool hmacOk = !pkt.unencrypted && jobs[job++].valid;
+        bool authentic = secret.length() >= sizeof(pkt.sharedSecret) &&
+                         (pkt.unencrypted
+                              ? memcmp(pkt.sharedSecret, secret.c_str(), sizeof(pkt.sharedSecret)) == 0
+                              : hmacOk);
+        if (!authentic) {
+            // Forged beacons never take a table slot, and never demote an admitted peer
+            Serial.println("[REJECT] Beacon failed authentication");
+            pairingCandidate* known = peers.find(pkt.mac);
+            if (known && known->state != candidateState::admitted) known->state = candidateState::rejected;
+            continue;
+        }
+
+        pairingCandidate* entry = peers.findOrInsert(pkt.mac, now);
+        if (!entry) {
+            Serial.println("[PAIR] Pairing table full, dropping beacon");
+            continue;
+        }
+
+        bool admitted = entry->state == candidateState::admitted;
+        bool repeat = admitted && pkt.sequenceId == entry->lastSequence;
+        if (repeat) continue;  // Same frame sniffed twice
 
-    mbedtls_md_context_t ctx;
-    mbedtls_md_init(&ctx);
+        entry->lastSeen = now;
+        entry->lastSequence = pkt.sequenceId;
 
-    if (mbedtls_md_setup(&ctx, md, 1) != 0) {
-        mbedtls_md_free(&ctx);
+        if (!admitted) {
+            admitCandidate(*entry, pkt, secret);
+            continue;
+        }
+
+        if (memcmp(pkt.nonce, entry->workerNonce, sizeof(entry->workerNonce)) == 0) {
+            // Same session still beaconing: our PairAccept (or its KeyConfirm) was lost.
+            // Once confirmed this can only be a replay or a beacon that crossed the confirmation.
+            if (!entry->keyConfirmed && !entry->offerPending)
+                startKeyOffer(*entry, CommandCode::PairAccept, entry->keyEpoch, entry->workerNonce, entry->bossNonce);
+            continue;
+        }
+
+        // New worker nonce: it restarted. With no confirmed key there is nothing to keep.
+        if (!entry->keyConfirmed) {
+            admitCandidate(*entry, pkt, secret);
+            continue;
+        }
+        if (entry->offerPending && entry->offerCommand == static_cast<uint8_t>(CommandCode::PairAccept) &&
+            memcmp(pkt.nonce, entry->offerWorkerNonce, sizeof(entry->offerWorkerNonce)) == 0)
+            continue;  // Already offered; retryKeyOffers() resends it
+
+        // Offer the new session, but keep the confirmed LMK until the worker confirms it
+        uint8_t bossNonce[SESSION_NONCE_LEN];
+        fillSessionNonce(bossNonce);
+        startKeyOffer(*entry, CommandCode::PairAccept, 0, pkt.nonce, bossNonce);
+    }
+
+    peers.expire(now, BEACON_TIMEOUT);
+    flushPeers();
+}
+
+bool beaconHandler::admitCandidate(pairingCandidate& entry, const beaconPacket& pkt, const String& secret) {
+    bool reoffer = entry.state == candidateState::admitted;
+    uint8_t bossMac[6];
+    uint8_t bossNonce[SESSION_NONCE_LEN];
+    uint8_t lmk[SESSION_KEY_LEN];
+
+    WiFi.macAddress(bossMac);
+    fillSessionNonce(bossNonce);
+
+    if (!deriveSessionKey(reinterpret_cast<const uint8_t*>(secret.c_str()), secret.length(),
+                          pkt.nonce, bossNonce, pkt.mac, bossMac, 0, lmk)) {
+        Serial.println("[REJECT] Session key derivation failed");
+        if (!reoffer) entry.state = candidateState::rejected;
         return false;
     }
 
-    mbedtls_md_hmac_starts(&ctx,
-        reinterpret_cast<const uint8_t*>(secret.c_str()), secret.length());
-    mbedtls_md_hmac_update(&ctx, pkt.mac, sizeof(pkt.mac));
-    mbedtls_md_hmac_finish(&ctx, expected);
-    mbedtls_md_free(&ctx);
+    // No confirmed key to protect yet, so ours goes in straight away
+    entry.channel = pkt.channel;
+    if (radio) radio->forgetPeer(entry.mac);  // A new worker nonce: it restarted its counter too
+    installPeerKey(entry, lmk);
+    memset(lmk, 0, sizeof(lmk));
+    memcpy(entry.workerNonce, pkt.nonce, sizeof(entry.workerNonce));
+    memcpy(entry.bossNonce, bossNonce, sizeof(entry.bossNonce));
+    entry.keyEpoch = 0;
+    entry.rotateEpoch = 0;
+    entry.keyConfirmed = false;
+    entry.keyInstalledAt = millis();
+    startKeyOffer(entry, CommandCode::PairAccept, 0, entry.workerNonce, entry.bossNonce);
+    if (reoffer) return entry.radioRegistered;
+
+    entry.state = candidateState::admitted;
+    entry.persisted = false;
+    entry.admittedAt = millis();
+
+    // Flash writes are batched; see flushPeers()
+    peerSaveTimer.markDirty(entry.admittedAt);
+
+    char macStr[MAC_TEXT_LEN + 1];
+    formatMac(pkt.mac, macStr);
+    Serial.printf("[PAIRED] %s on channel %u (%u peers%s)\n", macStr, pkt.channel, (unsigned)peerCount(),
+                  entry.radioRegistered ? "" : ", radio peer list full");
+    return entry.radioRegistered;
+}
+
+bool beaconHandler::installPeerKey(pairingCandidate& entry, const uint8_t* lmk) {
+    if (!radio) return false;
+    if (!entry.appCrypto && radio->addPeer(entry.mac, entry.channel, lmk)) {
+        entry.radioRegistered = true;
+        return true;
+    }
 
-    return memcmp(pkt.hmac, expected, sizeof(expected)) == 0;
+    // Encrypted peer slots exhausted: unencrypted slot plus application-layer AEAD
+    packetCipher* cipher = radio->getCipher();
+    if (!cipher || !cipher->setPeerKey(entry.mac, lmk)) {
+        entry.radioRegistered = false;
+        return false;
+    }
+    entry.appCrypto = true;
+    entry.radioRegistered = radio->addPeer(entry.mac, entry.channel, nullptr);
+    return true;
 }
 
-void beaconHandler::queueCandidate(const beaconPacket& pkt) {
-    beaconBuffer.push(const_cast<beaconPacket&>(pkt));
+bool beaconHandler::sendSessionOffer(const uint8_t* dest, const pairingCandidate& entry, CommandCode cmd,
+                                     uint8_t epoch, const uint8_t* bossNonce, const uint8_t* lmk) {
+    deviceDataPacket msg = {};
+    msg.version = 1;
+    msg.command = static_cast<uint8_t>(cmd);
+    msg.flags = (entry.channel & PKT_OFFER_CHANNEL_MASK) | (entry.appCrypto ? PKT_OFFER_APP_CRYPTO : 0);
+    msg.seqId = epoch;
+
+    // Boss nonce rides in values[] + nonce[]; tag[] carries key confirmation
+    memcpy(msg.values, bossNonce, sizeof(msg.values));
+    memcpy(msg.nonce, bossNonce + sizeof(msg.values), sizeof(msg.nonce));
+    computeSessionConfirm(lmk, entry.mac, epoch, msg.tag);
+    WiFi.macAddress(msg.senderMac);
+
+    return radio && radio->sendEspNow(dest, msg);
 }
 
-void beaconHandler::processQueue() {
-    beaconPacket pkt;
-    while (beaconBuffer.pop(pkt)) {
-        String secret = config->getValue("security", "secret");
-        if (secret.length() < sizeof(pkt.sharedSecret)) continue;
+bool beaconHandler::rotateSessionKey(const uint8_t* mac) {
+    pairingCandidate* entry = peers.find(mac);
+    if (!config || !entry || entry->state != candidateState::admitted ||
+        !entry->keyConfirmed || entry->offerPending)
+        return false;
 
-        if (!pkt.unencrypted && !validateHMAC(pkt)) continue;
+    uint8_t bossNonce[SESSION_NONCE_LEN];
+    fillSessionNonce(bossNonce);
+    ++entry->rotateEpoch;  // Past any abandoned offer the worker may already have installed
+    return startKeyOffer(*entry, CommandCode::KeyRotate, entry->rotateEpoch, entry->workerNonce, bossNonce);
+}
 
-        if (pkt.unencrypted &&
-            memcmp(pkt.sharedSecret, secret.c_str(), sizeof(pkt.sharedSecret)) != 0) {
-            Serial.println("[REJECT] Shared secret mismatch");
-            continue;
+bool beaconHandler::startKeyOffer(pairingCandidate& entry, CommandCode cmd, uint8_t epoch,
+                                  const uint8_t* workerNonce, const uint8_t* bossNonce) {
+    memmove(entry.offerWorkerNonce, workerNonce, sizeof(entry.offerWorkerNonce));
+    memmove(entry.offerNonce, bossNonce, sizeof(entry.offerNonce));
+    entry.offerCommand = static_cast<uint8_t>(cmd);
+    entry.offerEpoch = epoch;
+    entry.offerAttempts = 0;
+    entry.offerPending = true;
+    return sendKeyOffer(entry);
+}
+
+bool beaconHandler::sendKeyOffer(pairingCandidate& entry) {
+    String secret = config->getString(cfgSecret);
+    uint8_t bossMac[6];
+    uint8_t lmk[SESSION_KEY_LEN];
+
+    entry.offerSentAt = millis();
+    ++entry.offerAttempts;
+    WiFi.macAddress(bossMac);
+    if (!deriveSessionKey(reinterpret_cast<const uint8_t*>(secret.c_str()), secret.length(),
+                          entry.offerWorkerNonce, entry.offerNonce, entry.mac, bossMac, entry.offerEpoch, lmk))
+        return false;
+
+    // Broadcast and authenticated by its own tag, so it reaches the worker whichever LMK it holds.
+    // A confirmed LMK stays installed until handlePacket() sees the KeyConfirm.
+    bool sent = sendSessionOffer(broadcastMac, entry, static_cast<CommandCode>(entry.offerCommand),
+                                 entry.offerEpoch, entry.offerNonce, lmk);
+    memset(lmk, 0, sizeof(lmk));
+    return sent;
+}
+
+void beaconHandler::retryKeyOffers(unsigned long now) {
+    peers.forEach([&](pairingCandidate& c) {
+        if (!c.offerPending || now - c.offerSentAt < KEY_OFFER_RETRY_MS) return;
+        if (c.offerAttempts < KEY_OFFER_ATTEMPTS) {
+            sendKeyOffer(c);
+            return;
         }
 
-        char macStr[18];
-        sprintf(macStr, "%02X:%02X:%02X:%02X:%02X:%02X",
-                pkt.mac[0], pkt.mac[1], pkt.mac[2],
-                pkt.mac[3], pkt.mac[4], pkt.mac[5]);
+        // Worker gone, or only its confirmations were lost. An abandoned KeyRotate is offered
+        // again by rotateDueKeys(); a worker that still needs a PairAccept keeps beaconing for one.
+        c.offerPending = false;
+        memset(c.offerNonce, 0, sizeof(c.offerNonce));
+        char macStr[MAC_TEXT_LEN + 1];
+        formatMac(c.mac, macStr);
+        Serial.printf("[KEY] No KeyConfirm from %s, staying on epoch %u%s\n", macStr, c.keyEpoch,
+                      c.keyConfirmed ? "" : " (unconfirmed)");
+    });
+}
 
-        config->setValue("espnow", "remotemac", String(macStr));
-        config->setValue("espnow", "channel", String(pkt.channel));
-        config->saveToJson("/config.json", config->getConfig());
+void beaconHandler::rotateDueKeys(unsigned long now) {
+    if (!config) return;
+
+    // One new offer per pass keeps HKDF work and broadcast bursts off a single loop()
+    pairingCandidate* due = nullptr;
+    peers.forEach([&](pairingCandidate& c) {
+        if (due || c.state != candidateState::admitted || !c.keyConfirmed || c.offerPending) return;
+        // An abandoned rotation may be live on the worker; keep offering until one is confirmed
+        bool abandoned = c.rotateEpoch != c.keyEpoch;
+        if (abandoned ? now - c.offerSentAt >= KEY_OFFER_BACKOFF_MS
+                      : keyRotateMs && now - c.keyInstalledAt >= keyRotateMs)
+            due = &c;
+    });
+    if (due) rotateSessionKey(due->mac);
+}
 
-        uint8_t lmk[16] = {0};  // placeholder
-        radio.addPeer(pkt.mac, pkt.channel, lmk);
+bool beaconHandler::handlePacket(const deviceDataPacket& pkt) {
+    if (pkt.command != static_cast<uint8_t>(CommandCode::KeyConfirm)) return false;
+    if (!isBoss || !config) return true;
+
+    pairingCandidate* entry = peers.find(pkt.senderMac);
+    if (!entry || entry->state != candidateState::admitted || !entry->offerPending ||
+        pkt.seqId != entry->offerEpoch)
+        return true;  // Duplicate, or an answer to an offer we no longer hold
+
+    uint8_t offered[SESSION_NONCE_LEN];
+    memcpy(offered, pkt.values, sizeof(pkt.values));
+    memcpy(offered + sizeof(pkt.values), pkt.nonce, sizeof(pkt.nonce));
+    if (memcmp(offered, entry->offerNonce, sizeof(offered)) != 0) return true;
+
+    String secret = config->getString(cfgSecret);
+    uint8_t bossMac[6];
+    uint8_t lmk[SESSION_KEY_LEN];
+    uint8_t expected[SESSION_CONFIRM_LEN];
+    WiFi.macAddress(bossMac);
+    bool ok = deriveSessionKey(reinterpret_cast<const uint8_t*>(secret.c_str()), secret.length(),
+                               entry->offerWorkerNonce, entry->offerNonce, entry->mac, bossMac,
+                               entry->offerEpoch, lmk);
+    if (ok) {
+        // The worker binds its tag to our MAC, so a replayed offer cannot pose as a confirmation
+        computeSessionConfirm(lmk, bossMac, entry->offerEpoch, expected);
+        ok = memcmp(expected, pkt.tag, sizeof(expected)) == 0;
+    }
+    bool rotation = entry->offerCommand == static_cast<uint8_t>(CommandCode::KeyRotate);
+    if (ok) {
+        // A new session for a confirmed worker: it restarted, so its counter did too
+        if (!rotation && radio) radio->forgetPeer(entry->mac);
+        ok = installPeerKey(*entry, lmk);
+    }
+    memset(lmk, 0, sizeof(lmk));
+    if (!ok) {
+        Serial.println("[REJECT] KeyConfirm failed verification");
+        return true;  // Offer stays pending; the next resend gets a fresh confirmation
+    }
 
-        paired = true;
-        broadcasting = false;
+    memcpy(entry->workerNonce, entry->offerWorkerNonce, sizeof(entry->workerNonce));
+    memcpy(entry->bossNonce, entry->offerNonce, sizeof(entry->bossNonce));
+    entry->keyEpoch = entry->offerEpoch;
+    if (!rotation) entry->rotateEpoch = entry->keyEpoch;
+    entry->keyConfirmed = true;
+    entry->keyInstalledAt = millis();
+    entry->offerPending = false;
+    memset(entry->offerNonce, 0, sizeof(entry->offerNonce));
+    char macStr[MAC_TEXT_LEN + 1];
+    formatMac(entry->mac, macStr);
+    Serial.printf("[KEY] %s confirmed %s epoch %u\n", macStr, rotation ? "rotation to" : "session at",
+                  entry->keyEpoch);
+    return true;
+}
 
-        Serial.printf("[PAIRED] Registered peer on channel %u\n", pkt.channel);
-        break;
+void beaconHandler::flushPeers(bool force) {
+    if (!config || !peerSaveTimer.isDirty()) return;
+    if (!force && !peerSaveTimer.due(millis())) return;
+
+    size_t pending = 0;
+    const pairingCandidate* newest = nullptr;
+    peers.forEach([&](pairingCandidate& c) {
+        if (c.state != candidateState::admitted || c.persisted) return;
+
+        char macStr[MAC_TEXT_LEN + 1];
+        formatMac(c.mac, macStr);
+        config->setValue("peers", String(macStr), String(c.channel));
+        if (!newest || c.admittedAt >= newest->admittedAt) newest = &c;
+        ++pending;
+    });
+
+    if (newest) {
+        // Legacy single-peer keys track the most recent admission
+        char macStr[MAC_TEXT_LEN + 1];
+        formatMac(newest->mac, macStr);
+        config->setValue("espnow", "remotemac", String(macStr));
+        config->setValue("espnow", "channel", String(newest->channel));
     }
+
+    if (pending && !config->save()) {
+        peerSaveTimer.markDirty(millis());  // Back off and retry
+        return;
+    }
+
+    peers.forEach([](pairingCandidate& c) {
+        if (c.state == candidateState::admitted) c.persisted = true;
+    });
+    peerSaveTimer.clear();
+
+    Serial.printf("[PAIR] Persisted %u new peer(s) in one write\n", (unsigned)pending);
 }
 
 void beaconHandler::debugDump() {
     Serial.println(F("===== BeaconHandler DEBUG DUMP ====="));
-    Serial.printf("Paired: %s\n", paired ? "YES" : "NO");
+    Serial.printf("Peers: %u admitted, %u pending, %u rejected, %u unsaved\n",
+                  (unsigned)peers.count(candidateState::admitted),
+                  (unsigned)peers.count(candidateState::seen),
+                  (unsigned)peers.count(candidateState::rejected),
+                  (unsigned)peers.unpersistedCount());
+    Serial.printf("Rejected frames: %u AEAD, %u tag\n",
+                  radio && radio->getCipher() ? (unsigned)radio->getCipher()->rejectCount() : 0u,
+                  radio && radio->getTagger() ? (unsigned)radio->getTagger()->rejectCount() : 0u);
     Serial.printf("Broadcasting: %s\n", broadcasting ? "YES" : "NO");
     Serial.printf("Sequence ID: %u\n", sequenceId);
 
-    char macStr[18];
-    sprintf(macStr, "%02X:%02X:%02X:%02X:%02X:%02X",
-            lastSentPacket.mac[0], lastSentPacket.mac[1], lastSentPacket.mac[2],
-            lastSentPacket.mac[3], lastSentPacket.mac[4], lastSentPacket.mac[5]);
+    char macStr[MAC_TEXT_LEN + 1];
+    formatMac(lastSentPacket.mac, macStr);
 
     Serial.printf("Last Beacon MAC: %s\n", macStr);
-    Serial.printf("Last Shared Secret (hex): ");
-    for (size_t i = 0; i < sizeof(lastSentPacket.sharedSecret); ++i)
-        Serial.printf("%02X ", lastSentPacket.sharedSecret[i]);
-    Serial.println();
+    char secretHex[sizeof(lastSentPacket.sharedSecret) * 3];
+    formatHex(lastSentPacket.sharedSecret, sizeof(lastSentPacket.sharedSecret), secretHex, sizeof(secretHex), ' ');
+    Serial.printf("Last Shared Secret (hex): %s\n", secretHex);
 
     if (config) {
         Serial.printf("Config Secret: %s\n", config->getValue("security", "secret").c_str());
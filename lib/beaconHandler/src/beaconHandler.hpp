@@ -28,7 +28,6 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <Arduino.h>
-#include <mbedtls/md.h>
 #include <globalConstants.h>
 
 #if defined(ESP8266)
@@ -46,7 +45,15 @@ extern "C" {
 #endif
 
 #include "ringBuffer.hpp"
+#include "pairingTable.hpp"
+#include "beaconConstants.hpp"
+#include <debounceTimer.hpp>
+#include <sessionKey.hpp>
+#include <cryptoBackend.hpp>
+#include <configManager2.h>
+#include <deviceDataPacket.h>
 class configManager2;
+template <typename T> class espNowCoPilot;
 
 #if defined(ESP32)
 #define MY_IRAM_ATTR IRAM_ATTR
@@ -55,7 +62,7 @@ class configManager2;
 #endif
 
 struct beaconPacket {
-    uint8_t version = 1;
+    uint8_t version = 2;
     uint8_t deviceType = 1;
     uint8_t mac[6];
     uint8_t sequenceId;
@@ -63,21 +70,18 @@ struct beaconPacket {
     uint8_t hmac[32];
     bool unencrypted = true;
     uint8_t sharedSecret[8];  // Direct comparison in unencrypted mode
+    uint8_t nonce[SESSION_NONCE_LEN];  // Worker half of the session key salt
 };
 
-// Configurable beacon timing
-constexpr unsigned long MIN_BEACON_INTERVAL_MS = 1000; // 1 Second
-constexpr unsigned long MAX_BEACON_INTERVAL_MS = 1000*10; //10 Seconds
-constexpr unsigned long BEACON_INTERVAL_MS = MAX_BEACON_INTERVAL_MS;  // Default
-constexpr unsigned long BEACON_TIMEOUT = MAX_BEACON_INTERVAL_MS*10;     // Pairing window
-
 class beaconHandler {
 public:
     static beaconHandler* instance;
 
     beaconHandler();
-    ~beaconHandler() = default;
+    ~beaconHandler();
 
+    // Needed before beginPairing(): admissions install keys and send offers through it
+    void setRadio(espNowCoPilot<deviceDataPacket>* r) { radio = r; }
     void begin(configManager2* cfg, uint8_t channel = 6);
     void loop(unsigned long);
 
@@ -87,13 +91,24 @@ public:
     void sendBeacon(bool verbose = false);
     void debugDump();
 
+    // Worker half of the session key salt, fixed for this pairing attempt
+    const uint8_t* getSessionNonce() const { return sessionNonce; }
+    void stopBroadcasting() { broadcasting = false; }
+
     // Static sniff callback (used in boss mode)
     static void MY_IRAM_ATTR sniffCallback(void* buf, wifi_promiscuous_pkt_type_t type);
 
+    // Boss-side pairing status
+    size_t peerCount() const { return peers.count(candidateState::admitted); }
+    bool isPaired() const { return peerCount() > 0; }
+    void flushPeers(bool force = false);
+    bool rotateSessionKey(const uint8_t* mac);
+    // Consumes KeyConfirm frames; false for anything else
+    bool handlePacket(const deviceDataPacket& pkt);
+
 private:
     // Role state
     bool isBoss = false;
-    bool paired = false;
     bool broadcasting = false;
 
     // Wi-Fi & timing
@@ -104,14 +119,36 @@ private:
 
     // Config and memory
     configManager2* config = nullptr;
+    espNowCoPilot<deviceDataPacket>* radio = nullptr; // Provided by setRadio(), not owned
+    configHandle cfgSecret;     // Resolved once in bindConfig(); read on every beacon
+    configHandle cfgEncrypt;
+    int configSubs[3] = {-1, -1, -1};
+    unsigned long keyRotateMs = 0;     // security.keyRotateMin; 0 disables rotation
+    volatile bool secureMode = false;  // Mirrors security.encrypt so the sniffer never touches config
+    void bindConfig(configManager2* cfg);
+    static void onConfigChange(const String& section, const String& key, const String& value, void* context);
     beaconPacket lastSentPacket{};
+    uint8_t sessionNonce[SESSION_NONCE_LEN] = {0};
 
     // Packet authentication
     void signBeacon(beaconPacket& packet, const uint8_t* key, size_t len);
     bool validateHMAC(const beaconPacket& pkt);
 
     // Boss-only pairing
-    ringBuffer<beaconPacket, DEVICE_MSG_BUFFER_SIZE> beaconBuffer;
+    ringBuffer<beaconPacket, BEACON_QUEUE_SIZE> beaconBuffer;
+    beaconPacket beaconBatch[BEACON_QUEUE_SIZE];    // processQueue() scratch, kept off the stack
+    hmacVerifyJob beaconJobs[BEACON_QUEUE_SIZE];
+    pairingTable<PAIRING_TABLE_SIZE> peers;
+    debounceTimer peerSaveTimer{PEER_SAVE_QUIET_MS, PEER_SAVE_MAX_DELAY_MS};
     void queueCandidate(const beaconPacket& pkt);
     void processQueue();
+    bool admitCandidate(pairingCandidate& entry, const beaconPacket& pkt, const String& secret);
+    bool sendSessionOffer(const uint8_t* dest, const pairingCandidate& entry, CommandCode cmd,
+                          uint8_t epoch, const uint8_t* bossNonce, const uint8_t* lmk);
+    bool startKeyOffer(pairingCandidate& entry, CommandCode cmd, uint8_t epoch,
+                       const uint8_t* workerNonce, const uint8_t* bossNonce);
+    bool sendKeyOffer(pairingCandidate& entry);
+    void retryKeyOffers(unsigned long now);
+    void rotateDueKeys(unsigned long now);
+    bool installPeerKey(pairingCandidate& entry, const uint8_t* lmk);
 };
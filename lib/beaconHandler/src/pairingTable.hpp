@@ -0,0 +1,140 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @brief Per-worker pairing state tracked by the boss.
+ *
+ * seen      - beacon received, not yet checked against the shared secret
+ * admitted  - authenticated and registered with the radio
+ * rejected  - failed authentication; ignored until it ages out
+ */
+enum class candidateState : uint8_t {
+    empty, seen, admitted, rejected
+};
+
+struct pairingCandidate {
+    uint8_t mac[6] = {0};
+    uint8_t channel = 0;
+    uint8_t lastSequence = 0;
+    candidateState state = candidateState::empty;
+    bool persisted = false;        // Written to flash
+    bool radioRegistered = false;  // esp_now_add_peer() succeeded
+    bool appCrypto = false;        // Keyed in packetCipher instead of the ESP-NOW LMK
+    unsigned long firstSeen = 0;
+    unsigned long lastSeen = 0;
+    unsigned long admittedAt = 0;
+
+    // Session key state (see sessionKey.hpp)
+    uint8_t workerNonce[8] = {0};
+    uint8_t bossNonce[8] = {0};
+    uint8_t keyEpoch = 0;          // Epoch of the installed LMK
+    bool keyConfirmed = false;     // Worker sent KeyConfirm for the installed LMK
+    uint8_t rotateEpoch = 0;       // Last KeyRotate epoch offered; never reused, even if abandoned
+    unsigned long keyInstalledAt = 0;
+
+    // Outstanding PairAccept / KeyRotate, resent until the worker confirms it
+    bool offerPending = false;
+    uint8_t offerCommand = 0;
+    uint8_t offerEpoch = 0;
+    uint8_t offerWorkerNonce[8] = {0};
+    uint8_t offerNonce[8] = {0};
+    uint8_t offerAttempts = 0;
+    unsigned long offerSentAt = 0;
+};
+
+/**
+ * @brief Fixed-size table of pairing candidates, keyed by MAC.
+ *
+ * No heap use; lookups are linear which is fine for the ~100 entries a boss
+ * handles. When full, the oldest non-admitted entry is recycled.
+ */
+template <size_t N>
+class pairingTable {
+public:
+    pairingCandidate* find(const uint8_t* mac) {
+        for (auto& c : entries) {
+            if (c.state != candidateState::empty && memcmp(c.mac, mac, 6) == 0) return &c;
+        }
+        return nullptr;
+    }
+
+    pairingCandidate* findOrInsert(const uint8_t* mac, unsigned long now) {
+        if (pairingCandidate* c = find(mac)) return c;
+
+        pairingCandidate* slot = nullptr;
+        for (auto& c : entries) {
+            if (c.state == candidateState::empty) { slot = &c; break; }
+            if (c.state != candidateState::admitted &&
+                (!slot || c.lastSeen < slot->lastSeen)) slot = &c;
+        }
+        if (!slot) return nullptr;  // Table full of admitted peers
+
+        *slot = pairingCandidate{};
+        memcpy(slot->mac, mac, 6);
+        slot->state = candidateState::seen;
+        slot->firstSeen = now;
+        slot->lastSeen = now;
+        return slot;
+    }
+
+    // Drop candidates that stopped beaconing without being admitted
+    void expire(unsigned long now, unsigned long timeoutMs) {
+        for (auto& c : entries) {
+            if ((c.state == candidateState::seen || c.state == candidateState::rejected) &&
+                now - c.lastSeen > timeoutMs) {
+                c = pairingCandidate{};
+            }
+        }
+    }
+
+    size_t count(candidateState s) const {
+        size_t n = 0;
+        for (const auto& c : entries) if (c.state == s) ++n;
+        return n;
+    }
+
+    size_t unpersistedCount() const {
+        size_t n = 0;
+        for (const auto& c : entries)
+            if (c.state == candidateState::admitted && !c.persisted) ++n;
+        return n;
+    }
+
+    template <typename Fn>
+    void forEach(Fn fn) {
+        for (auto& c : entries) if (c.state != candidateState::empty) fn(c);
+    }
+
+    static constexpr size_t capacity() { return N; }
+
+private:
+    pairingCandidate entries[N];
+};
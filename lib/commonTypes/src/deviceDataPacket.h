@@ -22,8 +22,9 @@
  * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #pragma once
+#if defined(ARDUINO)
 #include <Arduino.h>
-#pragma once
+#endif
 #include <stdint.h>
 
 #pragma pack(push, 1)
@@ -48,3 +49,13 @@ struct deviceDataPacket {
 };
 
 #pragma pack(pop)
+
+// deviceDataPacket::flags bits
+constexpr uint8_t PKT_FLAG_ACK_REQUIRED = 0x01;
+constexpr uint8_t PKT_FLAG_ENCRYPTED    = 0x02;  // values[] sealed with AES-CCM, tag[] holds the MIC
+constexpr uint8_t PKT_FLAG_BROADCAST    = 0x04;  // Sealed with the group key rather than a peer key
+constexpr uint8_t PKT_FLAG_TAGGED       = 0x08;  // Cleartext values[], tag[] holds a SipHash short tag
+
+// PairAccept / KeyRotate reuse flags: channel in the low nibble, plus
+constexpr uint8_t PKT_OFFER_CHANNEL_MASK = 0x0F;
+constexpr uint8_t PKT_OFFER_APP_CRYPTO   = 0x80;  // Key goes to packetCipher, not the ESP-NOW LMK
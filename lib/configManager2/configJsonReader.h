@@ -0,0 +1,326 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <map>
+
+// Scratch limits for the streaming loader; everything else goes straight into the map
+constexpr size_t CONFIG_JSON_CHUNK = 128;
+constexpr size_t CONFIG_JSON_KEY_MAX = 64;
+constexpr size_t CONFIG_JSON_VALUE_MAX = 512;
+
+using configStore = std::map<String, std::map<String, String>>;
+
+// Wraps a NUL-terminated string so it can be fed through configJsonReader
+class configMemorySource
+{
+public:
+    configMemorySource(const char *text, size_t len) : p(text), remaining(len) {}
+    size_t read(uint8_t *buf, size_t len)
+    {
+        size_t n = len < remaining ? len : remaining;
+        memcpy(buf, p, n);
+        p += n;
+        remaining -= n;
+        return n;
+    }
+
+private:
+    const char *p;
+    size_t remaining;
+};
+
+/**
+ * @brief Streaming parser for the two-level section → key → value config JSON.
+ *
+ * Reads Source (anything with size_t read(uint8_t*, size_t), e.g. an Arduino
+ * File) in CONFIG_JSON_CHUNK pieces and inserts each value as soon as it is
+ * complete, so peak memory is the finished map plus a fixed scratch area
+ * rather than file text + JSON document + map.
+ *
+ * Values that are numbers, booleans, null or nested JSON are kept as their
+ * literal text, matching what JsonVariant::as<String>() produced before.
+ */
+template <typename Source>
+class configJsonReader
+{
+public:
+    explicit configJsonReader(Source &src) : source(src) {}
+
+    bool parse(configStore &out)
+    {
+        skipSpace();
+        if (next() != '{')
+            return fail("root is not an object");
+        skipSpace();
+        if (peek() == '}')
+            return true;
+
+        while (true)
+        {
+            char section[CONFIG_JSON_KEY_MAX];
+            skipSpace();
+            if (!readString(section, sizeof(section)) || !expectColon())
+                return false;
+
+            std::map<String, String> &fields = out[String(section)];
+            skipSpace();
+            if (peek() == '{')
+            {
+                if (!parseSection(fields))
+                    return false;
+            }
+            else
+            {
+                char ignored[CONFIG_JSON_VALUE_MAX];
+                if (!readValue(ignored, sizeof(ignored)))
+                    return false; // Non-object at the top level: section stays empty
+            }
+
+            skipSpace();
+            int c = next();
+            if (c == '}')
+                return true;
+            if (c != ',')
+                return fail("expected ',' or '}' between sections");
+        }
+    }
+
+    // A single flat object, {"key": value, ...}, as one section's fields
+    bool parseFields(std::map<String, String> &out)
+    {
+        skipSpace();
+        if (peek() != '{')
+            return fail("root is not an object");
+        return parseSection(out);
+    }
+
+    const char *error() const { return err; }
+    size_t bytesRead() const { return consumed; }
+
+private:
+    Source &source;
+    uint8_t buf[CONFIG_JSON_CHUNK];
+    size_t len = 0;
+    size_t pos = 0;
+    size_t consumed = 0;
+    const char *err = nullptr;
+
+    int peek()
+    {
+        if (pos == len)
+        {
+            len = source.read(buf, sizeof(buf));
+            pos = 0;
+            if (len == 0)
+                return -1;
+        }
+        return buf[pos];
+    }
+
+    int next()
+    {
+        int c = peek();
+        if (c >= 0)
+        {
+            ++pos;
+            ++consumed;
+        }
+        return c;
+    }
+
+    void skipSpace()
+    {
+        for (int c = peek(); c == ' ' || c == '\n' || c == '\r' || c == '\t'; c = peek())
+            next();
+    }
+
+    bool fail(const char *why)
+    {
+        if (!err)
+            err = why;
+        return false;
+    }
+
+    bool expectColon()
+    {
+        skipSpace();
+        return next() == ':' || fail("expected ':'");
+    }
+
+    bool parseSection(std::map<String, String> &fields)
+    {
+        next(); // '{'
+        skipSpace();
+        if (peek() == '}')
+        {
+            next();
+            return true;
+        }
+
+        char key[CONFIG_JSON_KEY_MAX];
+        char value[CONFIG_JSON_VALUE_MAX];
+        while (true)
+        {
+            skipSpace();
+            if (!readString(key, sizeof(key)) || !expectColon())
+                return false;
+            skipSpace();
+            if (!readValue(value, sizeof(value)))
+                return false;
+            fields[String(key)] = String(value);
+
+            skipSpace();
+            int c = next();
+            if (c == '}')
+                return true;
+            if (c != ',')
+                return fail("expected ',' or '}' in section");
+        }
+    }
+
+    static size_t putUtf8(char *out, uint32_t cp)
+    {
+        if (cp < 0x80)
+        {
+            out[0] = static_cast<char>(cp);
+            return 1;
+        }
+        if (cp < 0x800)
+        {
+            out[0] = static_cast<char>(0xC0 | (cp >> 6));
+            out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+            return 2;
+        }
+        out[0] = static_cast<char>(0xE0 | (cp >> 12));
+        out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 3;
+    }
+
+    // Quoted string into out (NUL-terminated); escapes decoded
+    bool readString(char *out, size_t cap)
+    {
+        if (next() != '"')
+            return fail("expected string");
+        size_t n = 0;
+        while (true)
+        {
+            int c = next();
+            if (c < 0)
+                return fail("unterminated string");
+            if (c == '"')
+                break;
+            char tmp[3];
+            size_t add = 1;
+            tmp[0] = static_cast<char>(c);
+            if (c == '\\')
+            {
+                int e = next();
+                switch (e)
+                {
+                case 'n': tmp[0] = '\n'; break;
+                case 't': tmp[0] = '\t'; break;
+                case 'r': tmp[0] = '\r'; break;
+                case 'b': tmp[0] = '\b'; break;
+                case 'f': tmp[0] = '\f'; break;
+                case '"': case '\\': case '/': tmp[0] = static_cast<char>(e); break;
+                case 'u':
+                {
+                    uint32_t cp = 0;
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        int h = next();
+                        int v = (h >= '0' && h <= '9') ? h - '0'
+                              : (h >= 'a' && h <= 'f') ? h - 'a' + 10
+                              : (h >= 'A' && h <= 'F') ? h - 'A' + 10
+                                                       : -1;
+                        if (v < 0)
+                            return fail("bad \\u escape");
+                        cp = (cp << 4) | v;
+                    }
+                    if (cp == 0)
+                        return fail("NUL in string");
+                    add = putUtf8(tmp, cp);
+                    break;
+                }
+                default:
+                    return fail("bad escape");
+                }
+            }
+            if (n + add >= cap)
+                return fail("string exceeds scratch buffer");
+            memcpy(out + n, tmp, add);
+            n += add;
+        }
+        out[n] = '\0';
+        return true;
+    }
+
+    // Scalar or nested value as text
+    bool readValue(char *out, size_t cap)
+    {
+        int c = peek();
+        if (c == '"')
+            return readString(out, cap);
+
+        size_t n = 0;
+        int depth = 0;
+        bool inString = false;
+        while (true)
+        {
+            c = peek();
+            if (c < 0)
+                return fail("unexpected end of input");
+            if (!inString && depth == 0 && (c == ',' || c == '}' || c == ']' ||
+                                            c == ' ' || c == '\n' || c == '\r' || c == '\t'))
+                break;
+            next();
+            if (inString)
+            {
+                if (c == '\\')
+                {
+                    if (n + 1 >= cap)
+                        return fail("value exceeds scratch buffer");
+                    out[n++] = static_cast<char>(c);
+                    c = next();
+                }
+                else if (c == '"')
+                    inString = false;
+            }
+            else if (c == '"')
+                inString = true;
+            else if (c == '{' || c == '[')
+                ++depth;
+            else if (c == '}' || c == ']')
+                --depth;
+            if (n + 1 >= cap)
+                return fail("value exceeds scratch buffer");
+            out[n++] = static_cast<char>(c);
+        }
+        out[n] = '\0';
+        return n > 0 || fail("missing value");
+    }
+};
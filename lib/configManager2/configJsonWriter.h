@@ -0,0 +1,210 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <map>
+#include "configJsonReader.h"
+
+#if defined(ESP32)
+#include <esp_rom_crc.h>
+#endif
+
+// CRC-32 (IEEE 802.3). Boot hashes config.json with this, so it uses the ROM
+// routine on the ESP32 and a byte table (1 KB, built once) elsewhere.
+inline uint32_t configCrc32(uint32_t crc, const uint8_t *data, size_t len)
+{
+#if defined(ESP32)
+    return esp_rom_crc32_le(crc, data, len);
+#else
+    struct byteTable
+    {
+        uint32_t entry[256];
+        byteTable()
+        {
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k)
+                    c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+                entry[i] = c;
+            }
+        }
+    };
+    static const byteTable table;
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i)
+        crc = table.entry[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+#endif
+}
+
+// Sinks for configJsonWriter: anything with size_t write(const uint8_t*, size_t)
+class configNullSink
+{
+public:
+    size_t write(const uint8_t *, size_t len) { return len; }
+};
+
+class configStringSink
+{
+public:
+    explicit configStringSink(String &out) : out(out) {}
+    size_t write(const uint8_t *buf, size_t len)
+    {
+        out.concat(reinterpret_cast<const char *>(buf), len);
+        return len;
+    }
+
+private:
+    String &out;
+};
+
+/**
+ * @brief Writes a section → key → value store as pretty JSON, in the same
+ * layout serializeJsonPretty() produced, without building a document first.
+ *
+ * Output is buffered in CONFIG_JSON_CHUNK pieces. A CRC-32 of everything
+ * written is kept so callers can compare against the last save or verify a
+ * read-back.
+ */
+template <typename Sink>
+class configJsonWriter
+{
+public:
+    explicit configJsonWriter(Sink &sink) : sink(sink) {}
+
+    bool write(const std::map<String, std::map<String, String>> &store)
+    {
+        openDocument();
+        bool firstSection = true;
+        for (const auto &section : store)
+        {
+            writeSection(section.first, section.second, firstSection);
+            firstSection = false;
+        }
+        closeDocument(firstSection);
+        return finish();
+    }
+
+    // write() in pieces, for callers that emit the document a section at a time:
+    // "{", then writeSection() for each (first = true for the first one), then closeDocument()
+    void openDocument() { put("{"); }
+    void writeSection(const String &name, const std::map<String, String> &fields, bool first)
+    {
+        put(first ? "\n  " : ",\n  ");
+        putString(name);
+        put(": ");
+        writeFields(fields);
+    }
+    void closeDocument(bool empty) { put(empty ? "}" : "\n}"); }
+
+    // One section's fields as an object, indented as inside the document
+    void writeFields(const std::map<String, String> &fields)
+    {
+        put("{");
+        bool firstField = true;
+        for (const auto &field : fields)
+        {
+            put(firstField ? "\n    " : ",\n    ");
+            firstField = false;
+            putString(field.first);
+            put(": ");
+            putString(field.second);
+        }
+        put(firstField ? "}" : "\n  }");
+    }
+
+    // Pushes out what is buffered; false if the sink came up short at any point
+    bool finish()
+    {
+        flush();
+        return ok;
+    }
+
+    uint32_t crc() const { return crcValue; }
+    size_t bytesWritten() const { return total; }
+
+private:
+    Sink &sink;
+    uint8_t buf[CONFIG_JSON_CHUNK];
+    size_t len = 0;
+    size_t total = 0;
+    uint32_t crcValue = 0;
+    bool ok = true;
+
+    void putByte(uint8_t c)
+    {
+        if (len == sizeof(buf))
+            flush();
+        buf[len++] = c;
+    }
+
+    void put(const char *s)
+    {
+        while (*s)
+            putByte(static_cast<uint8_t>(*s++));
+    }
+
+    void putString(const String &s)
+    {
+        static const char hex[] = "0123456789abcdef";
+        putByte('"');
+        for (const char *p = s.c_str(); *p; ++p)
+        {
+            uint8_t c = static_cast<uint8_t>(*p);
+            switch (c)
+            {
+            case '"': put("\\\""); break;
+            case '\\': put("\\\\"); break;
+            case '\n': put("\\n"); break;
+            case '\r': put("\\r"); break;
+            case '\t': put("\\t"); break;
+            case '\b': put("\\b"); break;
+            case '\f': put("\\f"); break;
+            default:
+                if (c < 0x20)
+                {
+                    put("\\u00");
+                    putByte(hex[c >> 4]);
+                    putByte(hex[c & 0x0F]);
+                }
+                else
+                    putByte(c);
+            }
+        }
+        putByte('"');
+    }
+
+    void flush()
+    {
+        if (len == 0)
+            return;
+        crcValue = configCrc32(crcValue, buf, len);
+        if (sink.write(buf, len) != len)
+            ok = false;
+        total += len;
+        len = 0;
+    }
+};
@@ -24,59 +24,217 @@
 
 #include <configManager2.h>
 #include <TRACE.h>
+#include <textCodec.hpp>
+#include <heapStats.hpp>
 
-configManager2::configManager2() {};
+configManager2::configManager2()
+{
+#if defined(ESP32)
+    _lock = xSemaphoreCreateRecursiveMutexStatic(&_lockBuffer);
+#endif
+}
+
+void configManager2::lock() const
+{
+#if defined(ESP32)
+    xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
+#else
+    _lock.lock();
+#endif
+}
+
+void configManager2::unlock() const
+{
+#if defined(ESP32)
+    xSemaphoreGiveRecursive(_lock);
+#else
+    _lock.unlock();
+#endif
+}
 
 bool configManager2::begin(const String filename, bool verbose)
 {
-    String jsonString;
-    _config.clear(); // Always start clean
+    heapScope heap(HEAP_TAG_CONFIG);
+    configLockGuard guard(*this);
+    unsigned long started = millis();
+    bool loaded = false;
+    _fromSnapshot = false;
+    _snapshotPending = false;
+    _path = filename;
+
+    configStore before; // Kept to tell subscribers what a re-begin() changed
+    before.swap(_config);
 
     if (!SPIFFS.begin(true))
     {
         if (verbose)
             Serial.println("❌ SPIFFS Mount Failed. Loading defaults...");
-        jsonString = loadDefaults();
     }
     else
     {
         if (verbose)
             Serial.println("✅ SPIFFS mounted");
 
-        if (!loadConfigString(filename.c_str(), &jsonString, verbose))
-        {
-            if (verbose)
-                Serial.println("⚠️ Failed to read config file. Loading defaults...");
-            jsonString = loadDefaults();
-        }
+        // Stays mounted: saves and the web UI use it later
+        recoverInterruptedSave(filename);
+        _fromSnapshot = _snapshotEnabled && loadFromSnapshot(filename, verbose);
+        loaded = _fromSnapshot || loadFromFile(filename, verbose);
+    }
+
+    _dirty.clear();
+    _saveTimer.clear();
 
-        SPIFFS.end();
+    if (!loaded || _config.empty())
+    {
+        if (verbose)
+            Serial.println("⚠️ Failed to read config file. Loading defaults...");
+        _config = jsonStringToMap(loadDefaults(), verbose);
+        for (const auto &section : _config)
+            _dirty.insert(section.first); // Nothing usable on flash yet
+        _savedCrc = 0;
+        _savedLen = 0;
     }
 
-    if (verbose && !jsonString.isEmpty())
+    _schema.compile(_config);
+    loadVersion();
+    refreshHandles();
+    notifyReload(before);
+
+    if (verbose)
     {
-        Serial.println("📄 Raw config string:");
-        Serial.println(jsonString);
+        Serial.printf("✅ Loaded %u config sections in %lu ms%s\n",
+                      (unsigned)_config.size(), millis() - started, _fromSnapshot ? " (snapshot)" : "");
+        printConfigToSerial();
     }
 
-    // Deserialize
-    _config = jsonStringToMap(jsonString, verbose);
+    return !_config.empty();
+}
+
+bool configManager2::loadFromFile(const String &filename, bool verbose)
+{
+    heapScope heap(HEAP_TAG_CONFIG);
+    configLockGuard guard(*this);
+    File file = SPIFFS.open(filename, "r");
+    if (!file)
+    {
+        if (verbose)
+            Serial.println("❌ Failed to open config file.");
+        return false;
+    }
 
-    if (_config.empty())
+    // Parse straight from the file into a fresh store; _config is only replaced on success.
+    // The file is hashed on the way through so a fresh snapshot can be tied to it.
+    configStore parsed;
+    configCrcSource<File> source(file);
+    configJsonReader<configCrcSource<File>> reader(source);
+    bool ok = reader.parse(parsed);
+    uint8_t rest[CONFIG_JSON_CHUNK];
+    while (ok && source.read(rest, sizeof(rest)) > 0)
+        ; // Trailing whitespace still counts towards the hash
+    file.close();
+
+    if (!ok || parsed.empty())
     {
         if (verbose)
-            Serial.println("⚠️ JSON parsing failed or produced empty config.");
-        jsonString = loadDefaults();
-        _config = jsonStringToMap(jsonString);
+            Serial.printf("❌ Config parse failed after %u bytes: %s\n",
+                          (unsigned)reader.bytesRead(), reader.error() ? reader.error() : "empty");
+        return false;
     }
 
+    _config.swap(parsed);
     if (verbose)
+        Serial.printf("✅ Config file loaded (%u bytes streamed)\n", (unsigned)reader.bytesRead());
+    if (filename == _path)
     {
-        Serial.printf("✅ Loaded %zu config sections\n", _config.size());
-        printConfigToSerial();
+        // Hand-formatted JSON never matches our serialisation, so the first save rewrites it
+        _savedLen = source.length();
+        _savedCrc = source.crc();
+        _snapshotPending = _snapshotEnabled;
     }
+    return true;
+}
 
-    return !_config.empty();
+String configManager2::snapshotPath(const String &path) const
+{
+    if (path.endsWith(".json"))
+        return path.substring(0, path.length() - 5) + ".snap";
+    return path + ".snap";
+}
+
+// Uses the snapshot only if config.json still has the size and mtime it was built from.
+// Only the directory entry is looked at; the JSON itself is never read on this path.
+bool configManager2::loadFromSnapshot(const String &filename, bool verbose)
+{
+    File snap = SPIFFS.open(snapshotPath(filename), "r");
+    if (!snap)
+        return false;
+    configSnapshotReader<File> reader(snap);
+    configSnapshotHeader header;
+    if (!reader.readHeader(header))
+    {
+        snap.close();
+        return false;
+    }
+
+    File json = SPIFFS.open(filename, "r");
+    bool fresh = json && json.size() == header.sourceLen &&
+                 static_cast<uint32_t>(json.getLastWrite()) == header.sourceTime;
+    json.close();
+    if (!fresh)
+    {
+        snap.close();
+        if (verbose)
+            Serial.println("ℹ️ Config snapshot is stale, parsing JSON");
+        return false;
+    }
+
+    configStore loaded;
+    bool ok = reader.readPayload(loaded);
+    snap.close();
+    if (!ok || loaded.empty())
+    {
+        if (verbose)
+            Serial.println("⚠️ Config snapshot damaged, parsing JSON");
+        return false;
+    }
+
+    _config.swap(loaded);
+    _savedLen = header.sourceLen;
+    _savedCrc = header.sourceCrc;
+    if (verbose)
+        Serial.printf("✅ Config loaded from snapshot (%u payload bytes)\n", (unsigned)header.payloadLen);
+    return true;
+}
+
+// Not atomic on purpose: a torn snapshot fails its payload CRC and boot falls back to JSON
+bool configManager2::writeSnapshot(const String &path)
+{
+    // Stamp it with the file the store was loaded from or last saved to; anything else is not ours
+    File json = SPIFFS.open(path, "r");
+    uint32_t sourceTime = json ? static_cast<uint32_t>(json.getLastWrite()) : 0;
+    bool ours = json && json.size() == _savedLen;
+    json.close();
+    if (!ours)
+        return false;
+
+    String snapPath = snapshotPath(path);
+    File file = SPIFFS.open(snapPath, "w");
+    if (!file)
+        return false;
+    configSnapshotWriter<File> writer(file);
+    bool ok = writer.write(_config, _savedLen, _savedCrc, sourceTime);
+    file.close();
+    _saveStats.bytesWritten += writer.bytesWritten();
+    if (!ok)
+        SPIFFS.remove(snapPath);
+    return ok;
+}
+
+void configManager2::invalidateSnapshot()
+{
+    String snapPath = snapshotPath(_path);
+    if (SPIFFS.exists(snapPath))
+        SPIFFS.remove(snapPath);
 }
 
 configManager2::~configManager2() {}
@@ -188,97 +346,217 @@ bool configManager2::loadConfigString(const char *filename, String *jsonString,
 
 bool configManager2::jsonStringToConfig(const String &jsonString, bool verbose)
 {
+    heapScope heap(HEAP_TAG_CONFIG);
+    configLockGuard guard(*this);
+    configStore before;
+    before.swap(_config);
     _config = jsonStringToMap(jsonString, verbose);
+    _schema.compile(_config);
+    loadVersion();
+    refreshHandles();
+    notifyReload(before);
     return true;
 }
 
 std::map<String, std::map<String, String>> configManager2::jsonStringToMap(const String &jsonString, bool verbose)
 {
-    std::map<String, std::map<String, String>> configMap = {};
+    configStore parsed;
+    configMemorySource source(jsonString.c_str(), jsonString.length());
+    configJsonReader<configMemorySource> reader(source);
 
-    //    JsonDocument doc;
-    StaticJsonDocument<6144> doc; // size tuned to your config
-    if (doc.capacity() < doc.memoryUsage())
+    if (!reader.parse(parsed))
     {
-        Serial.println("[WARN] JSON exceeded capacity");
+        Serial.printf("❌ Failed to parse JSON: %s\n", reader.error());
         return {};
     }
-    Serial.printf("⚠️ JSON string length: %u\n", jsonString.length());
-    Serial.println("📄 JSON preview:");
-    Serial.println(jsonString);
 
-    DeserializationError error = deserializeJson(doc, jsonString);
-    if (!doc.is<JsonObject>()) {
-    Serial.println("⚠️ Root element is not an object!");
-    return {};
+    if (verbose)
+        Serial.printf("✅ Loaded %u config sections\n", (unsigned)parsed.size());
+    return parsed;
+}
+
+uint32_t configManager2::storeCrc(const std::map<String, std::map<String, String>> &store) const
+{
+    configNullSink sink;
+    configJsonWriter<configNullSink> writer(sink);
+    writer.write(store);
+    return writer.crc();
 }
-    if (error)
+
+// A save that died between removing the old file and renaming the new one
+// leaves only the (already verified) temp file behind; anything else is debris.
+void configManager2::recoverInterruptedSave(const String &path)
+{
+    String tmp = path + ".tmp";
+    if (!SPIFFS.exists(tmp))
+        return;
+    if (!SPIFFS.exists(path) && SPIFFS.rename(tmp, path))
     {
-        Serial.println("❌ Failed to parse JSON");
-        Serial.print(F("deserializeJson() failed: "));
-        Serial.println(error.c_str());
-        return configMap;
+        Serial.println("♻️ Recovered config from interrupted save");
+        return;
     }
+    SPIFFS.remove(tmp);
+}
+
+bool configManager2::writeAtomic(const String &path, const std::map<String, std::map<String, String>> &store, uint32_t crc)
+{
+    String tmp = path + ".tmp";
+    if (SPIFFS.exists(tmp))
+        SPIFFS.remove(tmp);
 
-    JsonObjectConst root = doc.as<JsonObject>();
-    if (root.isNull())
+    File file = SPIFFS.open(tmp, "w");
+    if (!file)
     {
-        Serial.println("⚠️ Root is not a JSON object");
-        return configMap;
+        Serial.println("❌ Failed to open file for writing: " + tmp);
+        return false;
     }
+    configJsonWriter<File> writer(file);
+    bool ok = writer.write(store);
+    file.close();
+    _saveStats.bytesWritten += writer.bytesWritten();
 
-    for (const auto &section : root)
+    // Read back before the old file is touched
+    if (ok)
     {
-        const char *sectionName = section.key().c_str();
-        JsonObjectConst sectionObj = section.value().as<JsonObjectConst>();
-
-        std::map<String, String> sectionData;
-        for (const auto &kv : sectionObj)
+        file = SPIFFS.open(tmp, "r");
+        uint8_t buf[CONFIG_JSON_CHUNK];
+        uint32_t readCrc = 0;
+        size_t readLen = 0;
+        size_t n;
+        while (file && (n = file.read(buf, sizeof(buf))) > 0)
         {
-            sectionData[String(kv.key().c_str())] = kv.value().as<String>();
+            readCrc = configCrc32(readCrc, buf, n);
+            readLen += n;
         }
+        file.close();
+        ok = readCrc == crc && readLen == writer.bytesWritten();
+    }
+    if (!ok)
+    {
+        Serial.println("❌ Config write verification failed: " + tmp);
+        SPIFFS.remove(tmp);
+        return false;
+    }
 
-        configMap[sectionName] = sectionData;
+    // SPIFFS cannot rename over an existing file; recoverInterruptedSave() covers the gap
+    if (SPIFFS.exists(path) && !SPIFFS.remove(path))
+        return false;
+    if (!SPIFFS.rename(tmp, path))
+    {
+        Serial.println("❌ Failed to move " + tmp + " into place");
+        return false;
     }
 
-    Serial.printf("✅ Loaded %zu config sections\n", configMap.size());
-    return configMap;
+    Serial.printf("✅ Config saved to %s (%u bytes, crc %08X)\n",
+                  path.c_str(), (unsigned)writer.bytesWritten(), (unsigned)crc);
+    if (&store == &_config)
+        _savedLen = writer.bytesWritten();
+    return true;
 }
 
 bool configManager2::saveToJson(const String &path, const std::map<String, std::map<String, String>> &configMap)
 {
-    String jsonOutput = mapToJsonString(configMap);
+    configLockGuard guard(*this);
+    bool isOwnStore = &configMap == &_config && path == _path;
+    uint32_t crc = storeCrc(configMap);
+    if (isOwnStore && crc == _savedCrc)
+    {
+        ++_saveStats.skipped;
+        _dirty.clear();
+        _saveTimer.clear();
+        return true;
+    }
 
-    SPIFFS.begin(true); // Ensure SPIFFS is mounted
-    File file = SPIFFS.open(path, "w");
-    if (!file)
+    if (!SPIFFS.begin(true))
     {
-        Serial.println("❌ Failed to open file for writing: " + path);
-        SPIFFS.end(); // Unmount SPIFFS
+        ++_saveStats.failures;
         return false;
     }
-
-    size_t written = file.print(jsonOutput);
-    file.close();
-    SPIFFS.end(); // Unmount SPIFFS
-
-    if (written == 0)
+    if (!writeAtomic(path, configMap, crc))
     {
-        Serial.println("⚠️ Nothing was written to " + path);
+        ++_saveStats.failures;
         return false;
     }
 
-    Serial.printf("✅ Config saved to %s (%u bytes)\n", path.c_str(), written);
+    ++_saveStats.saves;
+    if (isOwnStore)
+    {
+        // A snapshot already on flash is stale now (a same-size save within the same
+        // mtime second would still match its stamp); a pending one will pick this up
+        invalidateSnapshot();
+        _savedCrc = crc;
+        _dirty.clear();
+        _saveTimer.clear();
+    }
     return true;
 }
 
+bool configManager2::isDirty() const
+{
+    configLockGuard guard(*this);
+    return !_dirty.empty();
+}
+
+bool configManager2::isSectionDirty(const String &section) const
+{
+    configLockGuard guard(*this);
+    return _dirty.count(section) > 0;
+}
+
+configSaveStats configManager2::getSaveStats() const
+{
+    configLockGuard guard(*this);
+    return _saveStats;
+}
+
+void configManager2::markDirty(const String &section)
+{
+    configLockGuard guard(*this);
+    _dirty.insert(section);
+    _saveTimer.markDirty(millis());
+}
+
+void configManager2::scheduleSave()
+{
+    configLockGuard guard(*this);
+    if (isDirty())
+        _saveTimer.markDirty(millis());
+}
+
+bool configManager2::save(bool force)
+{
+    heapScope heap(HEAP_TAG_CONFIG);
+    configLockGuard guard(*this);
+    if (!force && !isDirty())
+        return true;
+    return saveToJson(_path, _config);
+}
+
+bool configManager2::loop(unsigned long now)
+{
+    configLockGuard guard(*this);
+    if (_snapshotPending && !isDirty())
+    {
+        _snapshotPending = false;
+        writeSnapshot(_path);
+    }
+    if (!_saveTimer.due(now))
+        return false;
+    if (save())
+        return true;
+    _saveTimer.markDirty(now); // Retry after another quiet period
+    return false;
+}
+
 bool configManager2::saveConfigFile(const char *filename)
 {
+    configLockGuard guard(*this);
     return saveToJson(filename, _config);
 }
 
 String configManager2::getValue(const String &section, const String &key) const
 {
+    configLockGuard guard(*this);
     if (_config.count(section) && _config.at(section).count(key))
     {
         return _config.at(section).at(key);
@@ -286,9 +564,538 @@ String configManager2::getValue(const String &section, const String &key) const
     return "[NOT FOUND]";
 }
 
-void configManager2::setValue(const String &section, const String &key, const String &value)
+bool configManager2::setValue(const String &section, const String &key, const String &value)
+{
+    heapScope heap(HEAP_TAG_CONFIG);
+    configLockGuard guard(*this);
+    return storeValue(section, key, value, nullptr);
+}
+
+bool configManager2::storeValue(const String &section, const String &key, const String &value, const char **why)
+{
+    // Typed fields are checked and stored in canonical form
+    const configFieldSpec *spec = _schema.field(section, key);
+    String canonical;
+    const char *reason = nullptr;
+    if (spec && !configSchema::normalize(*spec, value, canonical, &reason))
+    {
+        Serial.printf("⚠️ Rejected [%s][%s] = '%s': %s\n", section.c_str(), key.c_str(), value.c_str(), reason);
+        if (why)
+            *why = reason;
+        return false;
+    }
+    const String &stored = spec ? canonical : value;
+
+    String &slot = _config[section][key];
+    if (slot == stored && !slot.isEmpty())
+        return true;
+    slot = stored;
+    markDirty(section);
+    recordChange(section, key);
+    touchSection(section);
+    if (key == "format.use" || section.endsWith(".format"))
+    {
+        _schema.compile(_config);
+        touchAll(); // Other sections may render through this format
+    }
+    for (auto &entry : _handles)
+    {
+        if (entry.key == key && entry.section == section)
+            refreshHandle(entry);
+    }
+    notifyChange(section, key);
+    return true;
+}
+
+size_t configManager2::applyUpdates(const std::map<String, std::map<String, String>> &updates,
+                                    std::map<String, String> *rejected)
+{
+    heapScope heap(HEAP_TAG_CONFIG);
+    configLockGuard guard(*this);
+    size_t applied = 0;
+    beginBatch();
+    for (const auto &section : updates)
+    {
+        for (const auto &field : section.second)
+        {
+            // Read-only fields are shown on the form but are not the user's to change
+            const configFieldSpec *spec = _schema.field(section.first, field.first);
+            if (spec && spec->readOnly)
+                continue;
+            const char *why = nullptr;
+            if (storeValue(section.first, field.first, field.second, &why))
+                ++applied;
+            else if (rejected)
+                (*rejected)[section.first + "." + field.first] = why;
+        }
+    }
+    endBatch();
+    return applied;
+}
+
+bool configManager2::patchValues(const std::map<String, std::map<String, String>> &patch,
+                                 std::map<String, String> *rejected)
+{
+    heapScope heap(HEAP_TAG_CONFIG);
+    configLockGuard guard(*this);
+    bool valid = true;
+    for (const auto &section : patch)
+    {
+        auto known = _config.find(section.first);
+        for (const auto &field : section.second)
+        {
+            const char *why = nullptr;
+            const configFieldSpec *spec = _schema.field(section.first, field.first);
+            String canonical;
+            if (known == _config.end() || !known->second.count(field.first))
+                why = "unknown key";
+            else if (spec && spec->readOnly)
+                why = "read-only";
+            else if (spec && !configSchema::normalize(*spec, field.second, canonical, &why) && !why)
+                why = "invalid value";
+            if (!why)
+                continue;
+            valid = false;
+            if (rejected)
+                (*rejected)[section.first + "." + field.first] = why;
+        }
+    }
+    if (!valid)
+        return false;
+
+    applyUpdates(patch);
+    return true;
+}
+
+void configManager2::trackVersions(const std::set<String> &sections)
+{
+    configLockGuard guard(*this);
+    _versioned = sections;
+    _versioned.erase(CONFIG_FLEET_SECTION); // The version must not version itself
+}
+
+uint32_t configManager2::getVersion() const
+{
+    configLockGuard guard(*this);
+    return _version;
+}
+
+void configManager2::storeVersion(uint32_t version)
+{
+    _version = version;
+    _config[CONFIG_FLEET_SECTION][CONFIG_FLEET_VERSION_KEY] = String(version);
+    markDirty(CONFIG_FLEET_SECTION);
+    touchSection(CONFIG_FLEET_SECTION);
+}
+
+void configManager2::loadVersion()
+{
+    _journal.clear(); // History does not survive a reload; older receivers get a full delta
+    auto sec = _config.find(CONFIG_FLEET_SECTION);
+    if (sec == _config.end() || !sec->second.count(CONFIG_FLEET_VERSION_KEY))
+    {
+        _version = 0;
+        return;
+    }
+    const String &text = sec->second.at(CONFIG_FLEET_VERSION_KEY);
+    int32_t version = 0;
+    parseInt(text.c_str(), text.length(), version);
+    _version = version < 0 ? 0 : (uint32_t)version;
+}
+
+void configManager2::recordChange(const String &section, const String &key)
+{
+    if (_applyingDelta || !_versioned.count(section))
+        return;
+    storeVersion(_version + 1);
+    if (_journal.size() >= CONFIG_JOURNAL_MAX)
+        _journal.erase(_journal.begin());
+    _journal.push_back({_version, section, key});
+}
+
+configDelta configManager2::diffSince(uint32_t version) const
+{
+    configLockGuard guard(*this);
+    configDelta delta;
+    delta.fromVersion = version;
+    delta.toVersion = _version;
+    if (version == _version)
+        return delta;
+
+    // Entries are one version apart, so the journal covers anything from just before its first entry
+    uint32_t oldest = _journal.empty() ? _version : _journal.front().version - 1;
+    delta.full = version > _version || version < oldest;
+    if (delta.full)
+    {
+        for (const auto &section : _versioned)
+        {
+            auto sec = _config.find(section);
+            if (sec == _config.end())
+                continue;
+            for (const auto &field : sec->second)
+                delta.changes.push_back({section, field.first, field.second});
+        }
+        return delta;
+    }
+
+    for (const auto &entry : _journal)
+    {
+        if (entry.version <= version)
+            continue;
+        bool seen = false;
+        for (const auto &change : delta.changes)
+        {
+            if (change.key == entry.key && change.section == entry.section)
+            {
+                seen = true;
+                break;
+            }
+        }
+        if (!seen)
+            delta.changes.push_back({entry.section, entry.key, _config.at(entry.section).at(entry.key)});
+    }
+    return delta;
+}
+
+bool configManager2::applyDelta(const configDelta &delta, std::map<String, String> *rejected)
+{
+    heapScope heap(HEAP_TAG_CONFIG);
+    configLockGuard guard(*this);
+    if (delta.fromVersion != _version)
+    {
+        Serial.printf("⚠️ Delta %u→%u does not apply to version %u\n",
+                      (unsigned)delta.fromVersion, (unsigned)delta.toVersion, (unsigned)_version);
+        return false;
+    }
+
+    // What each change overwrote, so one rejected value rolls the whole delta back
+    struct previous
+    {
+        const configChange *change;
+        bool existed;
+        String value;
+    };
+    std::vector<previous> undo;
+    undo.reserve(delta.changes.size());
+    size_t queued = _batchChanges.size();
+    bool ok = true;
+
+    _applyingDelta = true;
+    beginBatch();
+    for (const auto &change : delta.changes)
+    {
+        previous entry{&change, false, String()};
+        auto sec = _config.find(change.section);
+        if (sec != _config.end())
+        {
+            auto field = sec->second.find(change.key);
+            if (field != sec->second.end())
+            {
+                entry.existed = true;
+                entry.value = field->second;
+            }
+        }
+        const char *why = nullptr;
+        if (!storeValue(change.section, change.key, change.value, &why))
+        {
+            if (rejected)
+                (*rejected)[change.section + "." + change.key] = why;
+            ok = false;
+            break;
+        }
+        undo.push_back(entry);
+    }
+
+    if (ok)
+    {
+        storeVersion(delta.toVersion);
+        _journal.clear(); // Versions now follow the sender's numbering
+    }
+    else
+    {
+        for (auto it = undo.rbegin(); it != undo.rend(); ++it)
+        {
+            auto &fields = _config[it->change->section];
+            if (it->existed)
+                fields[it->change->key] = it->value;
+            else
+                fields.erase(it->change->key);
+            if (fields.empty())
+                _config.erase(it->change->section);
+        }
+        _batchChanges.resize(queued); // Nobody hears about values that never stuck
+        _schema.compile(_config);
+        refreshHandles();
+    }
+    endBatch();
+    _applyingDelta = false;
+    return ok;
+}
+
+int configManager2::subscribe(const String &section, const String &key, configChangeCallback callback, void *context)
+{
+    configLockGuard guard(*this);
+    if (!callback)
+        return -1;
+    subscriber entry;
+    entry.section = section;
+    entry.key = key;
+    entry.callback = callback;
+    entry.context = context;
+    _subscribers.push_back(entry);
+    int id = _subscribers.size() - 1;
+
+    auto sec = _config.find(section);
+    if (sec != _config.end())
+    {
+        if (key.isEmpty())
+        {
+            for (const auto &field : sec->second)
+                callback(section, field.first, field.second, context);
+        }
+        else
+        {
+            auto field = sec->second.find(key);
+            if (field != sec->second.end())
+                callback(section, key, field->second, context);
+        }
+    }
+    return id;
+}
+
+void configManager2::unsubscribe(int id)
+{
+    configLockGuard guard(*this);
+    // Slots are never reused, so ids held elsewhere stay unambiguous
+    if (id >= 0 && id < (int)_subscribers.size())
+        _subscribers[id].callback = nullptr;
+}
+
+// A batch holds the lock until it ends, so another task's edits cannot land in it
+void configManager2::beginBatch()
+{
+    lock();
+    ++_batchDepth;
+}
+
+void configManager2::endBatch()
+{
+    if (_batchDepth == 0)
+        return;
+    if (--_batchDepth == 0)
+    {
+        std::vector<std::pair<String, String>> changes;
+        changes.swap(_batchChanges);
+        for (const auto &change : changes)
+            dispatch(change.first, change.second);
+    }
+    unlock();
+}
+
+void configManager2::notifyChange(const String &section, const String &key)
 {
-    _config[section][key] = value;
+    if (_subscribers.empty())
+        return;
+    if (_batchDepth == 0)
+    {
+        dispatch(section, key);
+        return;
+    }
+    for (const auto &change : _batchChanges)
+    {
+        if (change.first == section && change.second == key)
+            return;
+    }
+    _batchChanges.emplace_back(section, key);
+}
+
+// Compares only what someone is watching, so a reload with no subscribers costs nothing
+void configManager2::notifyReload(const configStore &before)
+{
+    if (_subscribers.empty())
+        return;
+    static const std::map<String, String> none;
+    auto fieldsOf = [](const configStore &store, const String &section) -> const std::map<String, String> &
+    {
+        auto it = store.find(section);
+        return it == store.end() ? none : it->second;
+    };
+    auto valueOf = [](const std::map<String, String> &fields, const String &key) -> const String *
+    {
+        auto it = fields.find(key);
+        return it == fields.end() ? nullptr : &it->second;
+    };
+
+    beginBatch();
+    for (size_t i = 0; i < _subscribers.size(); ++i)
+    {
+        const String section = _subscribers[i].section;
+        const String key = _subscribers[i].key;
+        if (!_subscribers[i].callback)
+            continue;
+        const std::map<String, String> &oldFields = fieldsOf(before, section);
+        const std::map<String, String> &newFields = fieldsOf(_config, section);
+        auto check = [&](const String &k)
+        {
+            const String *was = valueOf(oldFields, k);
+            const String *now = valueOf(newFields, k);
+            if (!was != !now || (was && *was != *now))
+                notifyChange(section, k);
+        };
+        if (!key.isEmpty())
+        {
+            check(key);
+            continue;
+        }
+        for (const auto &field : oldFields)
+            check(field.first);
+        for (const auto &field : newFields)
+        {
+            if (!valueOf(oldFields, field.first))
+                check(field.first);
+        }
+    }
+    endBatch();
+}
+
+void configManager2::dispatch(const String &section, const String &key)
+{
+    static const String empty;
+    const String *value = &empty;
+    auto sec = _config.find(section);
+    if (sec != _config.end())
+    {
+        auto field = sec->second.find(key);
+        if (field != sec->second.end())
+            value = &field->second;
+    }
+
+    // By index: a callback may subscribe (and grow the vector) while we iterate
+    for (size_t i = 0; i < _subscribers.size(); ++i)
+    {
+        configChangeCallback callback = _subscribers[i].callback;
+        if (!callback || _subscribers[i].section != section)
+            continue;
+        if (!_subscribers[i].key.isEmpty() && _subscribers[i].key != key)
+            continue;
+        callback(section, key, *value, _subscribers[i].context);
+    }
+}
+
+configHandle configManager2::handle(const String &section, const String &key)
+{
+    configLockGuard guard(*this);
+    configHandle h;
+    for (size_t i = 0; i < _handles.size(); ++i)
+    {
+        if (_handles[i].section == section && _handles[i].key == key)
+        {
+            h.index = i;
+            return h;
+        }
+    }
+    if (_handles.size() >= 0xFFFF)
+        return h;
+
+    cachedValue entry;
+    entry.section = section;
+    entry.key = key;
+    refreshHandle(entry);
+    _handles.push_back(entry);
+    h.index = _handles.size() - 1;
+    return h;
+}
+
+void configManager2::refreshHandle(cachedValue &entry)
+{
+    entry.present = false;
+    entry.text = String();
+    entry.intValue = 0;
+    entry.boolValue = false;
+    entry.bytesLen = 0;
+
+    auto sec = _config.find(entry.section);
+    if (sec == _config.end())
+        return;
+    auto field = sec->second.find(entry.key);
+    if (field == sec->second.end())
+        return;
+
+    const String &v = field->second;
+    entry.present = true;
+    entry.text = v;
+    int32_t number = 0;
+    parseInt(v.c_str(), v.length(), number);
+    entry.intValue = number;
+    entry.boolValue = v == "true" || v == "1" || v == "on";
+    entry.bytesLen = parseHex(v.c_str(), v.length(), entry.bytes, sizeof(entry.bytes));
+}
+
+void configManager2::refreshHandles()
+{
+    configLockGuard guard(*this);
+    for (auto &entry : _handles)
+        refreshHandle(entry);
+    touchAll(); // Called after reloads and direct writes: anything may have changed
+}
+
+void configManager2::touchSection(const String &section)
+{
+    _sectionRevisions[section] = ++_revision;
+}
+
+void configManager2::touchAll()
+{
+    _allRevision = ++_revision;
+    _sectionRevisions.clear(); // All older than _allRevision now
+}
+
+uint32_t configManager2::getRevision() const
+{
+    configLockGuard guard(*this);
+    return _revision;
+}
+
+uint32_t configManager2::getSectionRevision(const String &section) const
+{
+    configLockGuard guard(*this);
+    auto found = _sectionRevisions.find(section);
+    return found != _sectionRevisions.end() ? found->second : _allRevision;
+}
+
+bool configManager2::has(configHandle h) const
+{
+    configLockGuard guard(*this);
+    return h.index < _handles.size() && _handles[h.index].present;
+}
+
+String configManager2::getString(configHandle h) const
+{
+    configLockGuard guard(*this);
+    return has(h) ? _handles[h.index].text : String();
+}
+
+long configManager2::getInt(configHandle h, long fallback) const
+{
+    configLockGuard guard(*this);
+    return has(h) ? _handles[h.index].intValue : fallback;
+}
+
+bool configManager2::getBool(configHandle h) const
+{
+    configLockGuard guard(*this);
+    return has(h) && _handles[h.index].boolValue;
+}
+
+size_t configManager2::getBytes(configHandle h, uint8_t *out, size_t outLen) const
+{
+    configLockGuard guard(*this);
+    if (!has(h))
+        return 0;
+    const cachedValue &entry = _handles[h.index];
+    size_t n = entry.bytesLen < outLen ? entry.bytesLen : outLen;
+    memcpy(out, entry.bytes, n);
+    return n;
 }
 
 const std::map<String, std::map<String, String>> &configManager2::getConfig() const
@@ -308,6 +1115,7 @@ String configManager2::getPassword() const
 
 void configManager2::printConfigToSerial() const
 {
+    configLockGuard guard(*this);
     Serial.println("\n===== Configuration Map =====");
     for (const auto &section : _config)
     {
@@ -322,23 +1130,10 @@ void configManager2::printConfigToSerial() const
 
 String configManager2::mapToJsonString(const std::map<String, std::map<String, String>> &configMap)
 {
-    //    JsonDocument doc;
-    StaticJsonDocument<6144> doc; // size tuned to your config
-
-    for (const auto &sectionPair : configMap)
-    {
-        const String &sectionName = sectionPair.first;
-        const auto &sectionData = sectionPair.second;
-
-        JsonObject sectionObj = doc[sectionName].to<JsonObject>();
-        for (const auto &kv : sectionData)
-        {
-            sectionObj[kv.first] = kv.second;
-        }
-    }
-
     String output;
-    serializeJsonPretty(doc, output);
+    configStringSink sink(output);
+    configJsonWriter<configStringSink> writer(sink);
+    writer.write(configMap);
     return output;
 }
 
@@ -349,26 +1144,5 @@ std::map<String, String> &configManager2::getSection(const String &sectionName)
 
 bool configManager2::parseHexStringToBytes(const String &hexInput, uint8_t *out, size_t outLen)
 {
-    String hex = hexInput;
-    hex.replace(" ", "");
-    hex.toUpperCase();
-
-    if (hex.startsWith("0X"))
-    {
-        hex = hex.substring(2);
-    }
-
-    if (hex.length() != outLen * 2)
-        return false;
-
-    for (size_t i = 0; i < outLen; ++i)
-    {
-        char byteStr[3] = {hex[2 * i], hex[2 * i + 1], '\0'};
-        char *end = nullptr;
-        out[i] = static_cast<uint8_t>(strtol(byteStr, &end, 16));
-        if (*end != '\0')
-            return false;
-    }
-
-    return true;
-}
\ No newline at end of file
+    return parseHex(hexInput.c_str(), hexInput.length(), out, outLen) == outLen;
+}
@@ -25,31 +25,247 @@
 #pragma once
 #include <Arduino.h>
 #include <map>
+#include <set>
 #include <vector>
 #include <SPIFFS.h>
-#include <ArduinoJson.h>
 #include <WString.h> // Ensure String class is available
+#include "configJsonReader.h"
+#include "configJsonWriter.h"
+#include "configSnapshot.h"
+#include "configSchema.h"
+#include <debounceTimer.hpp>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#else
+#include <mutex>
+#endif
+
+// Bytes kept per handle for getBytes(): enough for a MAC, an LMK or a 256-bit key
+constexpr size_t CONFIG_HANDLE_BYTES_MAX = 32;
+
+// Changes are written once things have been quiet this long, but never later than the max delay
+constexpr unsigned long CONFIG_SAVE_QUIET_MS = 2000;
+constexpr unsigned long CONFIG_SAVE_MAX_DELAY_MS = 15000;
+
+struct configSaveStats
+{
+    uint32_t saves = 0;        // Files actually written
+    uint32_t skipped = 0;      // Save requests that found nothing new to write
+    uint32_t failures = 0;
+    uint32_t bytesWritten = 0; // Flash bytes written by saves, including read-back verification failures
+};
+
+// Fleet sync: the version of the tracked sections lives in the store, next to them
+constexpr const char *CONFIG_FLEET_SECTION = "fleet";
+constexpr const char *CONFIG_FLEET_VERSION_KEY = "version";
+constexpr size_t CONFIG_JOURNAL_MAX = 32; // Changes remembered for diffSince(); older receivers get a full delta
+
+struct configChange
+{
+    String section;
+    String key;
+    String value;
+};
+
+// Tracked keys that changed after fromVersion, with their values as of toVersion
+struct configDelta
+{
+    uint32_t fromVersion = 0;
+    uint32_t toVersion = 0;
+    bool full = false; // Every tracked key: the journal no longer reaches back to fromVersion
+    std::vector<configChange> changes;
+};
+
+// Change notification; value is empty when the key disappeared on a reload
+using configChangeCallback = void (*)(const String &section, const String &key, const String &value, void *context);
+
+// Index of a pre-resolved section/key pair; obtain once with configManager2::handle()
+struct configHandle
+{
+    uint16_t index = 0xFFFF;
+    bool isValid() const { return index != 0xFFFF; }
+};
 
 class configManager2
 {
 private:
     std::map<String, std::map<String, String>> _config; // section → field → value
 
+    // Typed values for one handle, re-derived whenever its string changes
+    struct cachedValue
+    {
+        String section;
+        String key;
+        bool present = false;
+        String text; // A copy: readers get it under the lock, never a node another task may change
+        long intValue = 0;
+        bool boolValue = false;
+        uint8_t bytes[CONFIG_HANDLE_BYTES_MAX] = {0};
+        uint8_t bytesLen = 0;
+    };
+    std::vector<cachedValue> _handles;
+    configSchema _schema; // Compiled from the *.format sections on every load
+
+    void refreshHandle(cachedValue &entry);
+    bool storeValue(const String &section, const String &key, const String &value, const char **why);
+
+    // Key-level change subscriptions; an empty key matches the whole section
+    struct subscriber
+    {
+        String section;
+        String key;
+        configChangeCallback callback = nullptr; // nullptr once unsubscribed
+        void *context = nullptr;
+    };
+    std::vector<subscriber> _subscribers;
+    int _batchDepth = 0;
+    std::vector<std::pair<String, String>> _batchChanges; // Delivered when the outermost batch ends
+
+    void notifyChange(const String &section, const String &key);
+    void notifyReload(const configStore &before);
+    void dispatch(const String &section, const String &key);
+
+    // Versioning of the sections a boss pushes to its workers (see diffSince())
+    struct journalEntry
+    {
+        uint32_t version;
+        String section;
+        String key;
+    };
+    std::set<String> _versioned;
+    uint32_t _version = 0;
+    std::vector<journalEntry> _journal; // Oldest first, at most CONFIG_JOURNAL_MAX
+    bool _applyingDelta = false;
+
+    void recordChange(const String &section, const String &key);
+    void storeVersion(uint32_t version);
+    void loadVersion();
+
+    // Revisions for render caches (see getSectionRevision())
+    uint32_t _revision = 0;
+    uint32_t _allRevision = 0; // Last reload or schema change; every section is at least this new
+    std::map<String, uint32_t> _sectionRevisions;
+    void touchSection(const String &section);
+    void touchAll();
+
+    // Persistence: per-section dirty set, debounced write-behind, atomic replace
+    String _path = "/config.json";
+    std::set<String> _dirty;
+    debounceTimer _saveTimer{CONFIG_SAVE_QUIET_MS, CONFIG_SAVE_MAX_DELAY_MS};
+    uint32_t _savedCrc = 0; // CRC of config.json as loaded or last written
+    uint32_t _savedLen = 0;
+    configSaveStats _saveStats;
+
+    uint32_t storeCrc(const std::map<String, std::map<String, String>> &store) const;
+    bool writeAtomic(const String &path, const std::map<String, std::map<String, String>> &store, uint32_t crc);
+    void recoverInterruptedSave(const String &path);
+
+    // Binary snapshot next to the JSON (see configSnapshot.h). Rebuilt from loop()
+    // at most once per boot, after a boot that had to parse the JSON.
+    bool _snapshotEnabled = true;
+    bool _fromSnapshot = false;
+    bool _snapshotPending = false;
+    String snapshotPath(const String &path) const;
+    bool loadFromSnapshot(const String &filename, bool verbose);
+    bool writeSnapshot(const String &path);
+
+    // Web handlers edit the store on async_tcp while loop() saves it on the loop task
+#if defined(ESP32)
+    StaticSemaphore_t _lockBuffer;
+    SemaphoreHandle_t _lock;
+#else
+    mutable std::recursive_mutex _lock;
+#endif
+
 public:
     configManager2();
     ~configManager2();
 
+    // One recursive lock over the store. Every public method takes it; callers also
+    // hold it (configLockGuard) while reading through getConfig(), getSection() or
+    // getSchema(), or when a check and the edit it guards must not be split.
+    // Subscribers run with it held.
+    void lock() const;
+    void unlock() const;
+
     bool begin( String filename, bool = true);
+    bool loadFromFile(const String &filename, bool verbose = true); // Streams into the store; SPIFFS must be mounted
+    void setSnapshotEnabled(bool enabled) { _snapshotEnabled = enabled; }
+    bool loadedFromSnapshot() const { return _fromSnapshot; }
+    void invalidateSnapshot(); // For writers of config.json other than this class
+    const String &getPath() const { return _path; }
     bool loadConfigString(const char *filename, String *jsonString, bool verbose = true);
     std::map<String, std::map<String, String>> jsonStringToMap(const String &jsonString, bool = false);
     bool jsonStringToConfig(const String &jsonString, bool = false);
     String mapToJsonString(const std::map<String, std::map<String, String>> &configMap);
-    bool saveToJson(const String &path, const std::map<String, std::map<String, String>> &configMap);
+    bool saveToJson(const String &path, const std::map<String, std::map<String, String>> &configMap); // Atomic; skips unchanged
     bool saveConfigFile(const char *filename);
     String loadDefaults();
 
     String getValue(const String &section, const String &key) const;
-    void setValue(const String &section, const String &key, const String &value);
+    // Fields with a format are validated and stored canonically; false when rejected
+    bool setValue(const String &section, const String &key, const String &value);
+    // One batch, e.g. a form post: read-only fields are skipped, rejects are reported as "section.key" → reason
+    size_t applyUpdates(const std::map<String, std::map<String, String>> &updates,
+                        std::map<String, String> *rejected = nullptr);
+    // All-or-nothing edit of existing keys, e.g. a REST PATCH: every field is
+    // checked first (unknown keys, read-only fields and schema rejects all count),
+    // and nothing is stored unless all of them pass. Only the sections it touches
+    // are marked dirty.
+    bool patchValues(const std::map<String, std::map<String, String>> &patch,
+                     std::map<String, String> *rejected = nullptr);
+    const configSchema &getSchema() const { return _schema; }
+
+    // Config versioning for fleet sync. Each accepted change to a tracked section
+    // bumps the version, which is saved in fleet.version. diffSince() returns the
+    // tracked keys changed after a given version (or all of them when the journal
+    // has been trimmed past it); applyDelta() installs such a delta all-or-nothing,
+    // only on top of the version it was made from.
+    void trackVersions(const std::set<String> &sections);
+    uint32_t getVersion() const;
+    configDelta diffSince(uint32_t version) const;
+    bool applyDelta(const configDelta &delta, std::map<String, String> *rejected = nullptr);
+
+    // Change subscriptions. Callbacks run after the store and handles are updated,
+    // once per changed key: from setValue() (only when the value really changes),
+    // at the end of a batch, or when a reload changes a watched key. subscribe()
+    // also delivers the current value(s) straight away so consumers can build
+    // their derived state in one place. Pass an empty key to watch a whole section.
+    int subscribe(const String &section, const String &key, configChangeCallback callback, void *context = nullptr);
+    void unsubscribe(int id);
+    void beginBatch();
+    void endBatch();
+
+    // Write-behind persistence. setValue() marks its section dirty when the value
+    // actually changes and arms the debounce timer; loop() writes once it is due.
+    void markDirty(const String &section);
+    bool isDirty() const;
+    bool isSectionDirty(const String &section) const;
+    void scheduleSave();
+    bool save(bool force = false); // Write now if dirty (or always, when forced)
+    bool loop(unsigned long now);  // Returns true when a save happened; also refreshes the snapshot
+    configSaveStats getSaveStats() const;
+
+    // Change counters for caches of derived output (e.g. rendered pages). The
+    // revision goes up with every stored change; a section's revision is the
+    // value it had when that section last changed. Reloads, format changes and
+    // refreshHandles() count as changes to every section.
+    uint32_t getRevision() const;
+    uint32_t getSectionRevision(const String &section) const;
+
+    // Hot-path accessors: resolve once, then read in O(1). Only getString()
+    // copies, so the text stays valid whatever another task does to the store.
+    // Values track setValue() and reloads; call refreshHandles() after writing
+    // through getSection() directly.
+    configHandle handle(const String &section, const String &key);
+    void refreshHandles();
+    bool has(configHandle h) const;
+    String getString(configHandle h) const;              // Empty when absent
+    long getInt(configHandle h, long fallback = 0) const;
+    bool getBool(configHandle h) const;                  // "true" / "1" / "on"
+    size_t getBytes(configHandle h, uint8_t *out, size_t outLen) const; // Hex or MAC text; 0 if unparsable
 
     const std::map<String, std::map<String, String>> &getConfig() const;
 
@@ -60,4 +276,17 @@ public:
     void printConfigToSerial() const;
     std::map<String, String> &getSection(const String &sectionName);
     bool parseHexStringToBytes(const String &hexInput, uint8_t *out, size_t outLen) ;
-};
\ No newline at end of file
+};
+
+// Holds a configManager2's lock for a scope, e.g. while rendering through getConfig()
+class configLockGuard
+{
+public:
+    explicit configLockGuard(const configManager2 &config) : _config(config) { _config.lock(); }
+    ~configLockGuard() { _config.unlock(); }
+    configLockGuard(const configLockGuard &) = delete;
+    configLockGuard &operator=(const configLockGuard &) = delete;
+
+private:
+    const configManager2 &_config;
+};
@@ -0,0 +1,181 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "configSchema.h"
+#include <textCodec.hpp>
+
+void configSchema::compile(const configStore &store)
+{
+    _formats.clear();
+    _sectionFormat.clear();
+
+    for (const auto &section : store)
+    {
+        if (!section.first.endsWith(".format"))
+            continue;
+        fieldMap &fields = _formats[section.first];
+        for (const auto &entry : section.second)
+        {
+            const String &key = entry.first;
+            if (key.endsWith(".tooltip"))
+                fields[key.substring(0, key.length() - 8)].tooltip = entry.second;
+        }
+        for (const auto &entry : section.second)
+        {
+            const String &key = entry.first;
+            if (key.endsWith(".tooltip"))
+                continue;
+            String name = key.endsWith(".format") ? key.substring(0, key.length() - 7) : key;
+            configFieldSpec &spec = fields[name];
+            String tooltip = spec.tooltip;
+            spec = parseType(entry.second);
+            spec.tooltip = tooltip;
+        }
+    }
+
+    for (const auto &section : store)
+    {
+        auto use = section.second.find("format.use");
+        if (use == section.second.end())
+            continue;
+        auto format = _formats.find(use->second);
+        if (format != _formats.end())
+            _sectionFormat[section.first] = &format->second;
+    }
+}
+
+const configFieldSpec *configSchema::field(const String &section, const String &key) const
+{
+    auto format = _sectionFormat.find(section);
+    if (format == _sectionFormat.end())
+        return nullptr;
+    auto spec = format->second->find(key);
+    return spec == format->second->end() ? nullptr : &spec->second;
+}
+
+configFieldSpec configSchema::parseType(const String &text)
+{
+    configFieldSpec spec;
+    String base = text;
+    int dot = text.indexOf('.');
+    if (dot != -1)
+    {
+        base = text.substring(0, dot);
+        String suffix = text.substring(dot + 1);
+        spec.readOnly = suffix == "readonly";
+        if (suffix == "password")
+            spec.type = configFieldType::password;
+    }
+    base.toLowerCase(); // data/config.json has "String" as well as "string"
+
+    if (base == "integer")
+        spec.type = configFieldType::integer;
+    else if (base == "checkbox")
+        spec.type = configFieldType::checkbox;
+    else if (base == "macaddress")
+        spec.type = configFieldType::macaddress;
+    else if (base == "ipaddress")
+        spec.type = configFieldType::ipaddress;
+    else if (base == "password")
+        spec.type = configFieldType::password;
+    return spec;
+}
+
+const char *configSchema::typeName(configFieldType type)
+{
+    switch (type)
+    {
+    case configFieldType::integer: return "integer";
+    case configFieldType::checkbox: return "checkbox";
+    case configFieldType::macaddress: return "macaddress";
+    case configFieldType::ipaddress: return "ipaddress";
+    case configFieldType::password: return "password";
+    default: return "string";
+    }
+}
+
+bool configSchema::normalize(const configFieldSpec &spec, const String &value, String &out, const char **why)
+{
+    const char *reason = nullptr;
+    const char *p = value.c_str();
+    size_t len = value.length();
+
+    if (len >= CONFIG_JSON_VALUE_MAX)
+        reason = "too long";
+    else if (spec.type == configFieldType::checkbox)
+    {
+        // Browsers post "on"; older code wrote "1"
+        if (value == "true" || value == "1" || value == "on")
+            out = "true";
+        else if (value.isEmpty() || value == "false" || value == "0" || value == "off")
+            out = "false";
+        else
+            reason = "expected true or false";
+    }
+    else if (len == 0)
+        out = value; // Every other type may be left blank
+    else if (spec.type == configFieldType::integer)
+    {
+        int32_t number;
+        char text[INT_TEXT_MAX + 1];
+        if (!parseInt(p, len, number))
+            reason = "expected a number";
+        else
+        {
+            formatInt(number, text);
+            out = text;
+        }
+    }
+    else if (spec.type == configFieldType::macaddress)
+    {
+        // AA:BB:CC:DD:EE:FF, AA-BB-..., or 12 bare hex digits; stored colon-separated
+        uint8_t mac[6];
+        char text[MAC_TEXT_LEN + 1];
+        if (!parseMac(p, len, mac))
+            reason = "expected a MAC address";
+        else
+        {
+            formatMac(mac, text);
+            out = text;
+        }
+    }
+    else if (spec.type == configFieldType::ipaddress)
+    {
+        uint8_t ip[4];
+        char text[IPV4_TEXT_MAX + 1];
+        if (!parseIPv4(p, len, ip))
+            reason = "expected an IPv4 address";
+        else
+        {
+            formatIPv4(ip, text);
+            out = text;
+        }
+    }
+    else
+        out = value;
+
+    if (why)
+        *why = reason;
+    return reason == nullptr;
+}
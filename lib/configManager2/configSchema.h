@@ -0,0 +1,77 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <map>
+#include "configJsonReader.h"
+
+enum class configFieldType : uint8_t
+{
+    string,
+    integer,
+    checkbox,
+    macaddress,
+    ipaddress,
+    password
+};
+
+// One field of a *.format section, compiled from text such as "integer.readonly"
+struct configFieldSpec
+{
+    configFieldType type = configFieldType::string;
+    bool readOnly = false;
+    String tooltip;
+};
+
+/**
+ * @brief Typed view of the *.format sections.
+ *
+ * A format section lists field types ("channel": "integer.readonly"), the
+ * older "<field>.format" spelling ("password.format": "password") and
+ * optional "<field>.tooltip" text. Sections point at a format through their
+ * "format.use" key. compile() resolves all of that once, so rendering and
+ * validation look up a configFieldSpec instead of re-parsing type strings.
+ */
+class configSchema
+{
+public:
+    void compile(const configStore &store);
+
+    // Spec for a field of a data section; nullptr when the section has no format or the format omits the key
+    const configFieldSpec *field(const String &section, const String &key) const;
+    bool hasFormat(const String &section) const { return _sectionFormat.count(section) > 0; }
+
+    static configFieldSpec parseType(const String &text);
+    static const char *typeName(configFieldType type);
+
+    // Checks value against spec. On success out holds the canonical text
+    // (e.g. "true"/"false", upper-case colon MAC); on failure why says what is wrong.
+    static bool normalize(const configFieldSpec &spec, const String &value, String &out, const char **why = nullptr);
+
+private:
+    using fieldMap = std::map<String, configFieldSpec>;
+    std::map<String, fieldMap> _formats;                // "net.format" → fields
+    std::map<String, const fieldMap *> _sectionFormat;  // "wifiAP" → its format's fields
+};
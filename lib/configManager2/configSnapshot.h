@@ -0,0 +1,335 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <map>
+#include "configJsonReader.h"
+#include "configJsonWriter.h"
+
+/**
+ * Binary snapshot of the config store, written next to config.json so boot
+ * can skip JSON tokenising. JSON stays the source of truth: the header carries
+ * the size and SPIFFS mtime of the config.json it was built from (plus its
+ * CRC-32, as recorded at save time), and a snapshot whose source no longer
+ * has that size and mtime is ignored and rebuilt. Checking the stamp costs an
+ * open, not a read of the JSON. configManager2 deletes the snapshot whenever
+ * it rewrites config.json, and other writers (the web UI upload) call
+ * invalidateSnapshot(); the stamp catches anything else.
+ *
+ * Layout (little-endian):
+ *   header  magic "CFGS", version, 3 reserved, sourceLen, sourceCrc, sourceTime,
+ *           payloadLen, payloadCrc
+ *   payload u16 sections, then per section: u8 len + name, u16 fields,
+ *           then per field: u8 len + key, u16 len + value
+ *
+ * Sections and keys are stored in map order, so loading appends with an end
+ * hint instead of searching the tree for every insert.
+ */
+constexpr uint32_t CONFIG_SNAPSHOT_MAGIC = 0x53474643; // "CFGS"
+constexpr uint8_t CONFIG_SNAPSHOT_VERSION = 2;
+constexpr size_t CONFIG_SNAPSHOT_HEADER = 28;
+
+// Passes a Source through while measuring it, so config.json is hashed as it is parsed
+template <typename Source>
+class configCrcSource
+{
+public:
+    explicit configCrcSource(Source &src) : source(src) {}
+    size_t read(uint8_t *buf, size_t len)
+    {
+        size_t n = source.read(buf, len);
+        crcValue = configCrc32(crcValue, buf, n);
+        total += n;
+        return n;
+    }
+    uint32_t crc() const { return crcValue; }
+    uint32_t length() const { return total; }
+
+private:
+    Source &source;
+    uint32_t crcValue = 0;
+    uint32_t total = 0;
+};
+
+struct configSnapshotHeader
+{
+    uint32_t sourceLen = 0;
+    uint32_t sourceCrc = 0;
+    uint32_t sourceTime = 0; // getLastWrite() of config.json; 0 where SPIFFS keeps no mtime
+    uint32_t payloadLen = 0;
+    uint32_t payloadCrc = 0;
+};
+
+// Streams a store into Sink as snapshot payload, buffering CONFIG_JSON_CHUNK bytes at a time
+template <typename Sink>
+class configSnapshotWriter
+{
+public:
+    explicit configSnapshotWriter(Sink &sink) : sink(sink) {}
+
+    bool write(const std::map<String, std::map<String, String>> &store, uint32_t sourceLen, uint32_t sourceCrc,
+               uint32_t sourceTime)
+    {
+        // Header goes out first with the payload fields unknown; measure the payload in a dry run
+        configSnapshotWriter<configNullSink> dry(nullSink);
+        dry.writePayload(store);
+        if (!dry.ok)
+            return false;
+
+        put32(CONFIG_SNAPSHOT_MAGIC);
+        putByte(CONFIG_SNAPSHOT_VERSION);
+        putByte(0);
+        putByte(0);
+        putByte(0);
+        put32(sourceLen);
+        put32(sourceCrc);
+        put32(sourceTime);
+        put32(static_cast<uint32_t>(dry.total));
+        put32(dry.crcValue);
+        flush();
+        writePayload(store);
+        return ok;
+    }
+
+    size_t bytesWritten() const { return total; }
+
+private:
+    template <typename> friend class configSnapshotWriter;
+
+    Sink &sink;
+    configNullSink nullSink;
+    uint8_t buf[CONFIG_JSON_CHUNK];
+    size_t len = 0;
+    size_t total = 0;
+    uint32_t crcValue = 0;
+    bool ok = true;
+
+    void writePayload(const std::map<String, std::map<String, String>> &store)
+    {
+        crcValue = 0; // Payload CRC only; the header was flushed before this
+        put16(store.size());
+        for (const auto &section : store)
+        {
+            putText(section.first, 0xFF);
+            put16(section.second.size());
+            for (const auto &field : section.second)
+            {
+                putText(field.first, 0xFF);
+                putText(field.second, 0xFFFF);
+            }
+        }
+        flush();
+    }
+
+    void putText(const String &s, size_t max)
+    {
+        size_t n = s.length();
+        if (n > max)
+        {
+            ok = false;
+            n = max;
+        }
+        if (max == 0xFF)
+            putByte(static_cast<uint8_t>(n));
+        else
+            put16(n);
+        const char *p = s.c_str();
+        for (size_t i = 0; i < n; ++i)
+            putByte(static_cast<uint8_t>(p[i]));
+    }
+
+    void put16(size_t v)
+    {
+        if (v > 0xFFFF)
+            ok = false;
+        putByte(v & 0xFF);
+        putByte((v >> 8) & 0xFF);
+    }
+
+    void put32(uint32_t v)
+    {
+        for (int i = 0; i < 4; ++i)
+            putByte((v >> (8 * i)) & 0xFF);
+    }
+
+    void putByte(uint8_t c)
+    {
+        if (len == sizeof(buf))
+            flush();
+        buf[len++] = c;
+    }
+
+    void flush()
+    {
+        if (len == 0)
+            return;
+        crcValue = configCrc32(crcValue, buf, len);
+        if (sink.write(buf, len) != len)
+            ok = false;
+        total += len;
+        len = 0;
+    }
+};
+
+/**
+ * @brief Reads a snapshot from Source (anything with size_t read(uint8_t*, size_t)).
+ *
+ * readHeader() is cheap and lets the caller compare sourceLen/sourceTime
+ * against config.json before committing to the payload. readPayload() only
+ * reports success once the whole payload matched its CRC, so a torn
+ * snapshot never leaks into the live store.
+ */
+template <typename Source>
+class configSnapshotReader
+{
+public:
+    explicit configSnapshotReader(Source &src) : source(src) {}
+
+    bool readHeader(configSnapshotHeader &header)
+    {
+        uint8_t raw[CONFIG_SNAPSHOT_HEADER];
+        if (!take(raw, sizeof(raw)))
+            return false;
+        if (get32(raw) != CONFIG_SNAPSHOT_MAGIC || raw[4] != CONFIG_SNAPSHOT_VERSION)
+            return false;
+        header.sourceLen = get32(raw + 8);
+        header.sourceCrc = get32(raw + 12);
+        header.sourceTime = get32(raw + 16);
+        header.payloadLen = get32(raw + 20);
+        header.payloadCrc = get32(raw + 24);
+        expected = header;
+        // From here on every byte fetched is payload; hash what is already buffered
+        crcValue = configCrc32(0, buf + pos, len - pos);
+        payloadRead = len - pos;
+        hashing = true;
+        return true;
+    }
+
+    bool readPayload(configStore &out)
+    {
+        uint16_t sectionCount;
+        if (!take16(sectionCount))
+            return false;
+        for (uint16_t s = 0; s < sectionCount; ++s)
+        {
+            String name;
+            uint16_t fieldCount;
+            if (!takeText(name, false) || !take16(fieldCount))
+                return false;
+            std::map<String, String> &fields = out.emplace_hint(out.end(), std::move(name), std::map<String, String>())->second;
+            for (uint16_t f = 0; f < fieldCount; ++f)
+            {
+                String key, value;
+                if (!takeText(key, false) || !takeText(value, true))
+                    return false;
+                fields.emplace_hint(fields.end(), std::move(key), std::move(value));
+            }
+        }
+        // Drain to EOF so trailing bytes also count against payloadLen and the CRC
+        pos = len;
+        while (fill())
+            pos = len;
+        return payloadRead == expected.payloadLen && crcValue == expected.payloadCrc;
+    }
+
+private:
+    Source &source;
+    configSnapshotHeader expected;
+    uint8_t buf[CONFIG_JSON_CHUNK];
+    size_t len = 0;
+    size_t pos = 0;
+    size_t payloadRead = 0;
+    uint32_t crcValue = 0;
+    bool hashing = false;
+
+    static uint32_t get32(const uint8_t *p)
+    {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    bool fill()
+    {
+        if (pos < len)
+            return true;
+        len = source.read(buf, sizeof(buf));
+        pos = 0;
+        if (hashing)
+        {
+            crcValue = configCrc32(crcValue, buf, len);
+            payloadRead += len;
+        }
+        return len > 0;
+    }
+
+    // Hands out the next n bytes of the chunk buffer to use(), refilling as needed
+    template <typename Use>
+    bool consume(size_t n, Use use)
+    {
+        while (n > 0)
+        {
+            if (!fill())
+                return false;
+            size_t step = len - pos < n ? len - pos : n;
+            use(buf + pos, step);
+            pos += step;
+            n -= step;
+        }
+        return true;
+    }
+
+    bool take(uint8_t *out, size_t n)
+    {
+        return consume(n, [&out](const uint8_t *p, size_t step) { memcpy(out, p, step); out += step; });
+    }
+
+    bool take16(uint16_t &v)
+    {
+        uint8_t raw[2];
+        if (!take(raw, 2))
+            return false;
+        v = raw[0] | (raw[1] << 8);
+        return true;
+    }
+
+    // Appends straight from the chunk buffer; no intermediate copy or length limit beyond the prefix
+    bool takeText(String &out, bool wide)
+    {
+        uint16_t n;
+        if (wide)
+        {
+            if (!take16(n))
+                return false;
+        }
+        else
+        {
+            uint8_t n8;
+            if (!take(&n8, 1))
+                return false;
+            n = n8;
+        }
+        out.reserve(n);
+        return consume(n, [&out](const uint8_t *p, size_t step) { out.concat(reinterpret_cast<const char *>(p), step); });
+    }
+};
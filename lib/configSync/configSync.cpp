@@ -0,0 +1,448 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "configSync.hpp"
+#include <cryptoBackend.hpp>
+#include <textCodec.hpp>
+#include <heapStats.hpp>
+#include <string.h>
+
+bool configSync::begin(configManager2* cfg, const uint8_t* selfMac, bool boss,
+                       configSyncSend send, void* context) {
+    if (!cfg || !send) return false;
+    config = cfg;
+    memcpy(self, selfMac, sizeof(self));
+    isBoss = boss;
+    sendFn = send;
+    sendContext = context;
+
+    if (!isBoss) {
+        Serial.printf("[SYNC] Worker at config v%u\n", (unsigned)config->getVersion());
+        return true;
+    }
+
+    String list = config->getValue(CONFIG_FLEET_SECTION, "sections");
+    if (list == "[NOT FOUND]") list = "mqtt,updates";
+    std::set<String> sections;
+    int start = 0;
+    while (start <= (int)list.length()) {
+        int comma = list.indexOf(',', start);
+        if (comma < 0) comma = list.length();
+        String name = list.substring(start, comma);
+        name.trim();
+        if (!name.isEmpty()) sections.insert(name);
+        start = comma + 1;
+    }
+    config->trackVersions(sections);
+
+    // Every admitted worker lands in the peers section; that is our fleet list
+    if (peersSub < 0) peersSub = config->subscribe("peers", "", onPeerChange, this);
+
+    Serial.printf("[SYNC] Boss at config v%u, pushing %s to %u workers\n",
+                  (unsigned)config->getVersion(), list.c_str(), (unsigned)peerCount());
+    return true;
+}
+
+void configSync::setKey(const uint8_t* k) {
+    memcpy(key, k, sizeof(key));
+    keyed = true;
+}
+
+void configSync::onPeerChange(const String&, const String& mac, const String& value, void* context) {
+    uint8_t raw[6];
+    if (!value.isEmpty() && parseMac(mac.c_str(), mac.length(), raw)) static_cast<configSync*>(context)->addPeer(raw);
+}
+
+bool configSync::addPeer(const uint8_t* mac) {
+    if (findPeer(mac)) return true;
+    for (auto& peer : peers) {
+        if (peer.used) continue;
+        peer = peerState{};
+        memcpy(peer.mac, mac, sizeof(peer.mac));
+        peer.used = true;
+        return true;
+    }
+    return false;
+}
+
+configSync::peerState* configSync::findPeer(const uint8_t* mac) {
+    for (auto& peer : peers) {
+        if (peer.used && memcmp(peer.mac, mac, 6) == 0) return &peer;
+    }
+    return nullptr;
+}
+
+const configSync::peerState* configSync::findPeer(const uint8_t* mac) const {
+    return const_cast<configSync*>(this)->findPeer(mac);
+}
+
+size_t configSync::peerCount() const {
+    size_t n = 0;
+    for (const auto& peer : peers) if (peer.used) ++n;
+    return n;
+}
+
+size_t configSync::syncedCount() const {
+    size_t n = 0;
+    uint32_t version = config ? config->getVersion() : 0;
+    for (const auto& peer : peers) {
+        if (peer.used && peer.known && peer.version == version) ++n;
+    }
+    return n;
+}
+
+uint32_t configSync::peerVersion(const uint8_t* mac) const {
+    const peerState* peer = findPeer(mac);
+    return peer ? peer->version : 0;
+}
+
+bool configSync::encodeDelta(const configDelta& delta, std::vector<uint8_t>& out) {
+    out.clear();
+    for (const auto& change : delta.changes) {
+        size_t sectionLen = change.section.length();
+        size_t keyLen = change.key.length();
+        size_t valueLen = change.value.length();
+        if (sectionLen > 0xFF || keyLen > 0xFF || valueLen > 0xFFFF) return false;
+
+        out.push_back(static_cast<uint8_t>(sectionLen));
+        out.insert(out.end(), change.section.c_str(), change.section.c_str() + sectionLen);
+        out.push_back(static_cast<uint8_t>(keyLen));
+        out.insert(out.end(), change.key.c_str(), change.key.c_str() + keyLen);
+        out.push_back(static_cast<uint8_t>(valueLen));
+        out.push_back(static_cast<uint8_t>(valueLen >> 8));
+        out.insert(out.end(), change.value.c_str(), change.value.c_str() + valueLen);
+    }
+    return true;
+}
+
+bool configSync::decodeDelta(const uint8_t* data, size_t len, configDelta& out) {
+    out.changes.clear();
+    size_t pos = 0;
+    auto take = [&](size_t n, String& field) {
+        if (len - pos < n) return false;
+        field = String();
+        field.concat(reinterpret_cast<const char*>(data + pos), n);
+        pos += n;
+        return true;
+    };
+    while (pos < len) {
+        configChange change;
+        if (!take(data[pos++], change.section) || pos >= len) return false;
+        if (!take(data[pos++], change.key) || len - pos < 2) return false;
+        size_t valueLen = data[pos] | (data[pos + 1] << 8);
+        pos += 2;
+        if (!take(valueLen, change.value)) return false;
+        if (change.section.isEmpty() || change.key.isEmpty()) return false;
+        out.changes.push_back(change);
+    }
+    return true;
+}
+
+void configSync::computeTag(const uint8_t* data, size_t len, const uint8_t* receiver, uint8_t* tagOut) const {
+    cryptoSpan parts[2] = {{data, len}, {receiver, 6}};
+    uint8_t full[32];
+    defaultCrypto().hmacSha256(key, sizeof(key), parts, 2, full);
+    memcpy(tagOut, full, CONFIG_SYNC_TAG_LEN);
+}
+
+bool configSync::sendFrame(const uint8_t* mac, configSyncType type, uint8_t flags, uint8_t fragment,
+                           uint8_t fragments, uint32_t fromVersion, uint32_t toVersion,
+                           const uint8_t* payload, size_t len) {
+    if (!keyed || len > CONFIG_SYNC_CHUNK) return false;
+
+    uint8_t frame[CONFIG_SYNC_FRAME_MAX];
+    configSyncHeader hdr = {CONFIG_SYNC_MAGIC, static_cast<uint8_t>(type), flags, fragment, fragments,
+                            fromVersion, toVersion};
+    memcpy(frame, &hdr, sizeof(hdr));
+    if (len) memcpy(frame + sizeof(hdr), payload, len);
+    size_t body = sizeof(hdr) + len;
+    computeTag(frame, body, mac, frame + body);
+
+    size_t total = body + CONFIG_SYNC_TAG_LEN;
+    if (!sendFn(mac, frame, total, sendContext)) return false;
+    ++stats.framesSent;
+    stats.bytesSent += total;
+    return true;
+}
+
+bool configSync::onFrame(const uint8_t* mac, const uint8_t* data, int len) {
+    if (len < (int)(sizeof(configSyncHeader) + CONFIG_SYNC_TAG_LEN) || len > (int)CONFIG_SYNC_FRAME_MAX ||
+        data[0] != CONFIG_SYNC_MAGIC) {
+        return false;
+    }
+
+    uint8_t next = (inboxHead + 1) % CONFIG_SYNC_INBOX_SIZE;
+    if (next == inboxTail) {
+        ++stats.dropped;  // The sender retries the whole transfer
+        return true;
+    }
+    inboxFrame& slot = inbox[inboxHead];
+    memcpy(slot.mac, mac, sizeof(slot.mac));
+    slot.len = static_cast<uint8_t>(len);
+    memcpy(slot.data, data, len);
+    inboxHead = next;
+    return true;
+}
+
+bool configSync::verifyFrame(const uint8_t* data, size_t len) {
+    if (!keyed) return false;
+    size_t body = len - CONFIG_SYNC_TAG_LEN;
+    uint8_t expected[CONFIG_SYNC_TAG_LEN];
+    computeTag(data, body, self, expected);
+
+    uint8_t diff = 0;
+    for (size_t i = 0; i < CONFIG_SYNC_TAG_LEN; ++i) diff |= expected[i] ^ data[body + i];
+    return diff == 0;
+}
+
+void configSync::loop(unsigned long now) {
+    if (!config) return;
+    heapScope heap(HEAP_TAG_SYNC);
+
+    while (inboxTail != inboxHead) {
+        handleFrame(inbox[inboxTail]);
+        inboxTail = (inboxTail + 1) % CONFIG_SYNC_INBOX_SIZE;
+    }
+    if (!isBoss) {
+        retryHeldAck(now);
+        return;
+    }
+
+    size_t inFlight = 0;
+    for (auto& peer : peers) {
+        if (!peer.used || !peer.awaiting) continue;
+        if (now - peer.sentAt < CONFIG_SYNC_ACK_TIMEOUT_MS + peer.fragments * CONFIG_SYNC_FRAGMENT_MS) {
+            ++inFlight;
+            continue;
+        }
+        if (peer.attempts >= CONFIG_SYNC_ATTEMPTS) {
+            char macStr[MAC_TEXT_LEN + 1];
+            formatMac(peer.mac, macStr);
+            Serial.printf("[SYNC] %s not answering; retrying in %lus\n", macStr, CONFIG_SYNC_BACKOFF_MS / 1000);
+            peer.awaiting = false;
+            peer.held = true;
+            peer.holdUntil = now + CONFIG_SYNC_BACKOFF_MS;
+            continue;
+        }
+        ++stats.retries;
+        startTransfer(peer, now);
+        ++inFlight;
+    }
+
+    // Start new transfers round-robin so one slow worker cannot starve the rest
+    for (size_t n = 0; n < CONFIG_SYNC_PEERS && inFlight < CONFIG_SYNC_WINDOW; ++n) {
+        size_t index = (cursor + n) % CONFIG_SYNC_PEERS;
+        peerState& peer = peers[index];
+        if (!needsSync(peer, now)) continue;
+        peer.attempts = 0;
+        peer.held = false;
+        startTransfer(peer, now);
+        if (peer.awaiting) ++inFlight;
+        cursor = index + 1;
+    }
+}
+
+bool configSync::needsSync(const peerState& peer, unsigned long now) const {
+    if (!peer.used || peer.awaiting) return false;
+    if (peer.held && (long)(now - peer.holdUntil) < 0) return false;
+    if (!peer.known) return true;
+
+    uint32_t version = config->getVersion();
+    if (peer.version == version) return false;
+    return !(peer.refused && peer.refusedVersion == version);
+}
+
+void configSync::startTransfer(peerState& peer, unsigned long now) {
+    ++peer.attempts;
+    peer.sentAt = now;
+    peer.fragments = 1;
+    if (!peer.known) {
+        peer.awaiting = sendFrame(peer.mac, configSyncType::Probe, 0, 0, 1, 0, config->getVersion(), nullptr, 0);
+        return;
+    }
+    peer.awaiting = sendDelta(peer);
+}
+
+bool configSync::sendDelta(peerState& peer) {
+    configDelta delta = config->diffSince(peer.version);
+    std::vector<uint8_t> payload;
+    if (!encodeDelta(delta, payload) || payload.size() > CONFIG_SYNC_MAX_FRAGMENTS * CONFIG_SYNC_CHUNK) {
+        Serial.printf("[SYNC] v%u delta does not fit one transfer (%u bytes)\n",
+                      (unsigned)delta.toVersion, (unsigned)payload.size());
+        peer.refused = true;
+        peer.refusedVersion = delta.toVersion;
+        return false;
+    }
+
+    uint8_t flags = delta.full ? CONFIG_SYNC_FLAG_FULL : 0;
+    size_t fragments = payload.empty() ? 1 : (payload.size() + CONFIG_SYNC_CHUNK - 1) / CONFIG_SYNC_CHUNK;
+    peer.fragments = fragments;
+    for (size_t i = 0; i < fragments; ++i) {
+        size_t offset = i * CONFIG_SYNC_CHUNK;
+        size_t len = payload.size() - offset < CONFIG_SYNC_CHUNK ? payload.size() - offset : CONFIG_SYNC_CHUNK;
+        if (!sendFrame(peer.mac, configSyncType::Delta, flags, i, fragments, delta.fromVersion,
+                       delta.toVersion, payload.data() + offset, len)) {
+            return false;
+        }
+    }
+    ++stats.deltasSent;
+    if (delta.full) ++stats.fullSyncs;
+    return true;
+}
+
+void configSync::handleFrame(const inboxFrame& frame) {
+    if (!verifyFrame(frame.data, frame.len)) {
+        ++stats.rejected;
+        return;
+    }
+    ++stats.framesReceived;
+
+    configSyncHeader hdr;
+    memcpy(&hdr, frame.data, sizeof(hdr));
+    const uint8_t* payload = frame.data + sizeof(hdr);
+    size_t len = frame.len - sizeof(hdr) - CONFIG_SYNC_TAG_LEN;
+    if (isBoss) handleBossFrame(frame.mac, hdr);
+    else handleWorkerFrame(frame.mac, hdr, payload, len);
+}
+
+void configSync::handleBossFrame(const uint8_t* mac, const configSyncHeader& hdr) {
+    peerState* peer = findPeer(mac);
+    if (!peer) return;
+
+    configSyncType type = static_cast<configSyncType>(hdr.type);
+    if (type == configSyncType::Ack) {
+        peer->version = hdr.toVersion;
+        peer->refused = false;
+    } else if (type == configSyncType::Nack) {
+        char macStr[MAC_TEXT_LEN + 1];
+        formatMac(mac, macStr);
+        Serial.printf("[SYNC] %s refused v%u, stays at v%u\n", macStr, (unsigned)hdr.toVersion,
+                      (unsigned)hdr.fromVersion);
+        peer->version = hdr.fromVersion;
+        peer->refused = true;
+        peer->refusedVersion = hdr.toVersion;
+    } else {
+        return;
+    }
+    peer->known = true;
+    peer->awaiting = false;
+    peer->held = false;
+    peer->attempts = 0;
+}
+
+void configSync::handleWorkerFrame(const uint8_t* mac, const configSyncHeader& hdr,
+                                   const uint8_t* payload, size_t len) {
+    uint32_t current = config->getVersion();
+    configSyncType type = static_cast<configSyncType>(hdr.type);
+    // RAM is ahead of flash. Stay quiet rather than nack: a Nack parks the version on
+    // the boss, while its retries and backoff find us again once the save lands.
+    if (held.active) return;
+    if (type == configSyncType::Probe) {
+        sendFrame(mac, configSyncType::Ack, 0, 0, 1, current, current, nullptr, 0);
+        return;
+    }
+    if (type != configSyncType::Delta) return;
+
+    // Made from another version (or already applied): tell the boss where we are instead
+    if (hdr.fromVersion != current) {
+        sendFrame(mac, configSyncType::Ack, 0, 0, 1, current, current, nullptr, 0);
+        return;
+    }
+    if (hdr.fragments == 0 || hdr.fragments > CONFIG_SYNC_MAX_FRAGMENTS || hdr.fragment >= hdr.fragments ||
+        (hdr.fragment + 1 < hdr.fragments && len != CONFIG_SYNC_CHUNK)) {
+        ++stats.rejected;
+        return;
+    }
+
+    if (!rx.active || rx.fromVersion != hdr.fromVersion || rx.toVersion != hdr.toVersion ||
+        rx.fragments != hdr.fragments) {
+        rx.active = true;
+        rx.fromVersion = hdr.fromVersion;
+        rx.toVersion = hdr.toVersion;
+        rx.fragments = hdr.fragments;
+        rx.flags = hdr.flags;
+        rx.received = 0;
+        rx.length = 0;
+        rx.buffer.assign(hdr.fragments * CONFIG_SYNC_CHUNK, 0);
+    }
+
+    memcpy(rx.buffer.data() + hdr.fragment * CONFIG_SYNC_CHUNK, payload, len);
+    rx.received |= 1u << hdr.fragment;
+    if (hdr.fragment + 1 == hdr.fragments) rx.length = hdr.fragment * CONFIG_SYNC_CHUNK + len;
+    if (rx.received == (1u << rx.fragments) - 1) applyTransfer(mac);
+}
+
+void configSync::applyTransfer(const uint8_t* mac) {
+    configDelta delta;
+    std::map<String, String> rejected;
+    bool ok = decodeDelta(rx.buffer.data(), rx.length, delta);
+    delta.fromVersion = rx.fromVersion;
+    delta.toVersion = rx.toVersion;
+    delta.full = rx.flags & CONFIG_SYNC_FLAG_FULL;
+    if (ok) ok = config->applyDelta(delta, &rejected);
+
+    rx.active = false;
+    std::vector<uint8_t>().swap(rx.buffer);
+
+    if (!ok) {
+        for (const auto& reject : rejected) {
+            Serial.printf("[SYNC] Rejected %s: %s\n", reject.first.c_str(), reject.second.c_str());
+        }
+        uint32_t current = config->getVersion();
+        sendFrame(mac, configSyncType::Nack, 0, 0, 1, current, delta.toVersion, nullptr, 0);
+        return;
+    }
+
+    // Persist before acking so the boss never counts a version we could lose
+    Serial.printf("[SYNC] Applied %u change(s)%s, now at v%u\n", (unsigned)delta.changes.size(),
+                  delta.full ? " (full)" : "", (unsigned)delta.toVersion);
+    held.active = true;
+    memcpy(held.mac, mac, sizeof(held.mac));
+    held.toVersion = delta.toVersion;
+    held.triedAt = millis();
+    if (config->save()) {
+        retryHeldAck(held.triedAt);
+        return;
+    }
+    ++stats.saveFailures;
+    Serial.println("[SYNC] ⚠️ Save failed; holding the ack until a retry succeeds");
+}
+
+void configSync::retryHeldAck(unsigned long now) {
+    if (!held.active) return;
+
+    // configManager2::loop() retries too; either way the store is clean once it is on flash
+    if (config->isDirty()) {
+        if (now - held.triedAt < CONFIG_SYNC_SAVE_RETRY_MS) return;
+        held.triedAt = now;
+        if (!config->save()) {
+            ++stats.saveFailures;
+            return;
+        }
+    }
+    held.active = false;
+    ++stats.applied;
+    sendFrame(held.mac, configSyncType::Ack, 0, 0, 1, held.toVersion, held.toVersion, nullptr, 0);
+}
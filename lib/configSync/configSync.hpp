@@ -0,0 +1,211 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <configManager2.h>
+#include <sessionKey.hpp>
+
+/**
+ * @brief Boss → worker config push over ESP-NOW.
+ *
+ * The boss versions a set of sections (fleet.sections, default "mqtt,updates";
+ * see configManager2::trackVersions()) and keeps every worker listed in the
+ * peers section at that version. A worker whose version is unknown is probed;
+ * one that is behind gets configManager2::diffSince(its version), which is
+ * just the changed keys unless the boss journal has moved past it. The worker
+ * applies the delta all-or-nothing, saves, and acks with its new version; if
+ * the save fails it answers nothing until a retry gets the version to flash.
+ *
+ * Frames are variable length, so they bypass the deviceDataPacket queue via
+ * espNowCoPilot::setFrameHook():
+ *
+ *   magic | type | flags | fragment | fragments | fromVersion | toVersion | payload | tag[8]
+ *
+ * tag = trunc64(HMAC-SHA256(deriveConfigKey(secret), header || payload || receiverMac)).
+ * A worker only applies a delta made from the version it holds, so a replayed
+ * frame cannot roll it back. A full delta overwrites the tracked keys; it
+ * does not remove keys the boss no longer has. Payloads are authenticated,
+ * not encrypted: keep secrets out of the synced sections unless every worker
+ * has an LMK peer slot.
+ */
+
+constexpr uint8_t CONFIG_SYNC_MAGIC = 0xC5;            // Never a deviceDataPacket::version
+constexpr size_t CONFIG_SYNC_FRAME_MAX = 250;          // ESP_NOW_MAX_DATA_LEN
+constexpr size_t CONFIG_SYNC_TAG_LEN = 8;
+constexpr size_t CONFIG_SYNC_MAX_FRAGMENTS = 16;       // ~3.6 KB of delta per transfer
+constexpr size_t CONFIG_SYNC_PEERS = 128;              // PAIRING_TABLE_SIZE
+constexpr size_t CONFIG_SYNC_WINDOW = 4;               // Workers with a transfer in flight at once
+constexpr unsigned long CONFIG_SYNC_ACK_TIMEOUT_MS = 200;  // Covers the worker's flash save...
+constexpr unsigned long CONFIG_SYNC_FRAGMENT_MS = 10;      // ...plus this per fragment on a busy channel
+constexpr uint8_t CONFIG_SYNC_ATTEMPTS = 4;
+constexpr unsigned long CONFIG_SYNC_BACKOFF_MS = 30000;    // After a worker stops answering
+constexpr unsigned long CONFIG_SYNC_SAVE_RETRY_MS = 1000;  // Worker: retry a failed save this often before acking
+
+enum class configSyncType : uint8_t {
+    Probe = 1,  // Boss → worker: report your version
+    Delta = 2,  // Boss → worker: one fragment of an encoded configDelta
+    Ack = 3,    // Worker → boss: toVersion is what I hold now
+    Nack = 4    // Worker → boss: could not apply toVersion; fromVersion is what I hold
+};
+
+constexpr uint8_t CONFIG_SYNC_FLAG_FULL = 0x01;
+
+#pragma pack(push, 1)
+struct configSyncHeader {
+    uint8_t magic;
+    uint8_t type;
+    uint8_t flags;
+    uint8_t fragment;
+    uint8_t fragments;
+    uint32_t fromVersion;
+    uint32_t toVersion;
+};
+#pragma pack(pop)
+
+constexpr size_t CONFIG_SYNC_CHUNK = CONFIG_SYNC_FRAME_MAX - sizeof(configSyncHeader) - CONFIG_SYNC_TAG_LEN;
+constexpr size_t CONFIG_SYNC_INBOX_SIZE = CONFIG_SYNC_MAX_FRAGMENTS + 1;  // One whole transfer between loop() calls; one slot stays empty
+
+struct configSyncStats {
+    uint32_t framesSent = 0;
+    uint32_t bytesSent = 0;
+    uint32_t framesReceived = 0;
+    uint32_t rejected = 0;     // Bad tag or malformed (loop() only)
+    uint32_t dropped = 0;      // Inbox full (onFrame() only, so each counter has one writer)
+    uint32_t deltasSent = 0;   // Transfers started, retries included
+    uint32_t fullSyncs = 0;
+    uint32_t retries = 0;
+    uint32_t applied = 0;      // Worker: deltas installed and saved
+    uint32_t saveFailures = 0; // Worker: saves that failed after an apply (the ack waits for a retry)
+};
+
+// Hands one frame to the radio; the template wires this to esp_now_send()
+using configSyncSend = bool (*)(const uint8_t* mac, const uint8_t* data, size_t len, void* context);
+
+class configSync {
+public:
+    bool begin(configManager2* cfg, const uint8_t* selfMac, bool boss,
+               configSyncSend send, void* context = nullptr);
+    void setKey(const uint8_t* key);  // From deriveConfigKey()
+
+    // Radio receive callback (WiFi task): queues frames that look like ours, returns true if it took one
+    bool onFrame(const uint8_t* mac, const uint8_t* data, int len);
+    void loop(unsigned long now);
+
+    // Boss: workers to keep in sync; also fed from the peers section
+    bool addPeer(const uint8_t* mac);
+    size_t peerCount() const;
+    size_t syncedCount() const;  // Workers confirmed at the current version
+    uint32_t peerVersion(const uint8_t* mac) const;
+
+    const configSyncStats& getStats() const { return stats; }
+
+    // Wire encoding of a delta payload: per change, u8 section length, section,
+    // u8 key length, key, u16 value length (little endian), value
+    static bool encodeDelta(const configDelta& delta, std::vector<uint8_t>& out);
+    static bool decodeDelta(const uint8_t* data, size_t len, configDelta& out);
+
+private:
+    struct peerState {
+        uint8_t mac[6] = {0};
+        bool used = false;
+        bool known = false;          // version was reported by the worker itself
+        uint32_t version = 0;
+        bool awaiting = false;
+        uint8_t attempts = 0;
+        uint8_t fragments = 0;       // Of the transfer in flight
+        unsigned long sentAt = 0;
+        unsigned long holdUntil = 0; // Backoff after a timeout or a rejected delta
+        bool held = false;
+        bool refused = false;        // Nacked refusedVersion; not retried until the config moves on
+        uint32_t refusedVersion = 0;
+    };
+
+    struct inboxFrame {
+        uint8_t mac[6];
+        uint8_t len;
+        uint8_t data[CONFIG_SYNC_FRAME_MAX];
+    };
+
+    configManager2* config = nullptr;
+    configSyncSend sendFn = nullptr;
+    void* sendContext = nullptr;
+    uint8_t self[6] = {0};
+    uint8_t key[SESSION_KEY_LEN] = {0};
+    bool keyed = false;
+    bool isBoss = false;
+    int peersSub = -1;
+    configSyncStats stats;
+
+    // Single producer (WiFi task), single consumer (loop)
+    inboxFrame inbox[CONFIG_SYNC_INBOX_SIZE];
+    volatile uint8_t inboxHead = 0;
+    volatile uint8_t inboxTail = 0;
+
+    // Boss
+    peerState peers[CONFIG_SYNC_PEERS];
+    size_t cursor = 0;  // Round-robin start for new transfers
+
+    // Worker: the transfer being reassembled
+    struct {
+        bool active = false;
+        uint32_t fromVersion = 0;
+        uint32_t toVersion = 0;
+        uint8_t fragments = 0;
+        uint8_t flags = 0;
+        uint32_t received = 0;  // Bit per fragment
+        size_t length = 0;
+        std::vector<uint8_t> buffer;
+    } rx;
+
+    // Worker: a delta applied in RAM whose save failed; no Ack until toVersion is on flash
+    struct {
+        bool active = false;
+        uint8_t mac[6] = {0};
+        uint32_t toVersion = 0;
+        unsigned long triedAt = 0;
+    } held;
+
+    peerState* findPeer(const uint8_t* mac);
+    const peerState* findPeer(const uint8_t* mac) const;
+    bool needsSync(const peerState& peer, unsigned long now) const;
+    void startTransfer(peerState& peer, unsigned long now);
+    bool sendDelta(peerState& peer);
+    bool sendFrame(const uint8_t* mac, configSyncType type, uint8_t flags, uint8_t fragment, uint8_t fragments,
+                   uint32_t fromVersion, uint32_t toVersion, const uint8_t* payload, size_t len);
+    bool verifyFrame(const uint8_t* data, size_t len);
+    void handleFrame(const inboxFrame& frame);
+    void handleBossFrame(const uint8_t* mac, const configSyncHeader& hdr);
+    void handleWorkerFrame(const uint8_t* mac, const configSyncHeader& hdr, const uint8_t* payload, size_t len);
+    void applyTransfer(const uint8_t* mac);
+    void retryHeldAck(unsigned long now);
+    void computeTag(const uint8_t* data, size_t len, const uint8_t* receiver, uint8_t* tagOut) const;
+
+    static void onPeerChange(const String& section, const String& key, const String& value, void* context);
+};
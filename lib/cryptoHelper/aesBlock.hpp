@@ -0,0 +1,35 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "cryptoBackend.hpp"
+
+// Single-block AES-128 encryption used by the application-layer AEAD.
+// The work is done by defaultCrypto(): the ESP32 AES peripheral on targets,
+// the portable software AES on hosts or with -DAPP_CRYPTO_SOFTWARE.
+class aesBlock {
+public:
+    explicit aesBlock(cryptoBackend& backend = defaultCrypto()) : crypto(backend) {}
+    ~aesBlock() { memset(&schedule, 0, sizeof(schedule)); }
+    aesBlock(const aesBlock&) = delete;
+    aesBlock& operator=(const aesBlock&) = delete;
+
+    // Re-keying is skipped when the same 16 bytes are already loaded
+    bool setKey(const uint8_t* key) {
+        if (keyed && memcmp(key, schedule.key, sizeof(schedule.key)) == 0) return true;
+        crypto.aesExpandKey(key, schedule);
+        keyed = true;
+        return true;
+    }
+
+    void encrypt(const uint8_t* in, uint8_t* out) {
+        crypto.aesEncrypt(schedule, in, out);
+    }
+
+    const char* backendName() const { return crypto.name(); }
+
+private:
+    cryptoBackend& crypto;
+    aesKeySchedule schedule = {};
+    bool keyed = false;
+};
@@ -0,0 +1,230 @@
+#include "cryptoBackend.hpp"
+#include <string.h>
+#include <mbedtls/version.h>
+
+#if defined(ESP32) && !defined(APP_CRYPTO_SOFTWARE)
+#include <sdkconfig.h>
+#if CONFIG_IDF_TARGET_ESP32
+#include "sha/sha_parallel_engine.h"
+#else
+#include "sha/sha_dma.h"
+#endif
+#define APP_CRYPTO_HW 1
+#endif
+
+// ---------------------------------------------------------------------------
+// Shared HMAC construction
+// ---------------------------------------------------------------------------
+
+bool cryptoBackend::tagsEqual(const uint8_t* a, const uint8_t* b, size_t len) {
+    uint8_t diff = 0;
+    for (size_t i = 0; i < len; ++i) diff |= a[i] ^ b[i];
+    return diff == 0;
+}
+
+bool cryptoBackend::hmacSha256(const uint8_t* key, size_t keyLen,
+                               const cryptoSpan* parts, size_t count, uint8_t* out) {
+    if (count > MAX_PARTS) return false;
+
+    uint8_t k[64] = {0};
+    if (keyLen > sizeof(k)) {
+        cryptoSpan keySpan = {key, keyLen};
+        sha256(&keySpan, 1, k);
+    } else {
+        memcpy(k, key, keyLen);
+    }
+
+    uint8_t pad[64];
+    uint8_t inner[32];
+    cryptoSpan spans[MAX_PARTS + 1];
+
+    for (size_t i = 0; i < sizeof(pad); ++i) pad[i] = k[i] ^ 0x36;
+    spans[0] = {pad, sizeof(pad)};
+    for (size_t i = 0; i < count; ++i) spans[i + 1] = parts[i];
+    sha256(spans, count + 1, inner);
+
+    for (size_t i = 0; i < sizeof(pad); ++i) pad[i] = k[i] ^ 0x5c;
+    spans[1] = {inner, sizeof(inner)};
+    sha256(spans, 2, out);
+
+    memset(k, 0, sizeof(k));
+    memset(pad, 0, sizeof(pad));
+    return true;
+}
+
+size_t cryptoBackend::verifyHmacBatch(const uint8_t* key, size_t keyLen,
+                                      hmacVerifyJob* jobs, size_t count, size_t tagLen) {
+    size_t matched = 0;
+    uint8_t mac[32];
+    for (size_t i = 0; i < count; ++i) {
+        jobs[i].valid = hmacSha256(key, keyLen, jobs[i].parts, jobs[i].partCount, mac) &&
+                        tagsEqual(mac, jobs[i].expected, tagLen);
+        matched += jobs[i].valid;
+    }
+    return matched;
+}
+
+// ---------------------------------------------------------------------------
+// Portable software backend (mbedtls)
+// ---------------------------------------------------------------------------
+
+namespace {
+
+class softwareBackend : public cryptoBackend {
+public:
+    const char* name() const override { return "mbedtls"; }
+
+    void sha256(const cryptoSpan* parts, size_t count, uint8_t* out) override {
+        sha256Stream st;
+        for (size_t i = 0; i < count; ++i) st.update(parts[i].data, parts[i].len);
+        st.finish(out);
+    }
+
+    void aesExpandKey(const uint8_t* key, aesKeySchedule& ks) override {
+        memcpy(ks.key, key, 16);
+        mbedtls_aes_init(&ks.sw);
+        mbedtls_aes_setkey_enc(&ks.sw, key, 128);
+    }
+
+    // mbedtls takes a non-const context, but ECB encryption only reads the round keys
+    void aesEncrypt(const aesKeySchedule& ks, const uint8_t* in, uint8_t* out) override {
+        mbedtls_aes_crypt_ecb(const_cast<mbedtls_aes_context*>(&ks.sw), MBEDTLS_AES_ENCRYPT, in, out);
+    }
+
+    // Key pads are hashed once and the midstates reused for every message
+    size_t verifyHmacBatch(const uint8_t* key, size_t keyLen,
+                           hmacVerifyJob* jobs, size_t count, size_t tagLen) override {
+        uint8_t k[64] = {0};
+        if (keyLen > sizeof(k)) {
+            cryptoSpan keySpan = {key, keyLen};
+            sha256(&keySpan, 1, k);
+        } else {
+            memcpy(k, key, keyLen);
+        }
+
+        uint8_t pad[64];
+        sha256Stream innerBase, outerBase;
+        for (size_t i = 0; i < sizeof(pad); ++i) pad[i] = k[i] ^ 0x36;
+        innerBase.update(pad, sizeof(pad));
+        for (size_t i = 0; i < sizeof(pad); ++i) pad[i] = k[i] ^ 0x5c;
+        outerBase.update(pad, sizeof(pad));
+        memset(k, 0, sizeof(k));
+        memset(pad, 0, sizeof(pad));
+
+        size_t matched = 0;
+        sha256Stream st;
+        for (size_t j = 0; j < count; ++j) {
+            uint8_t digest[32];
+            st = innerBase;
+            for (size_t i = 0; i < jobs[j].partCount; ++i)
+                st.update(jobs[j].parts[i].data, jobs[j].parts[i].len);
+            st.finish(digest);
+
+            st = outerBase;
+            st.update(digest, sizeof(digest));
+            st.finish(digest);
+
+            jobs[j].valid = tagsEqual(digest, jobs[j].expected, tagLen);
+            matched += jobs[j].valid;
+        }
+        return matched;
+    }
+};
+
+#if defined(APP_CRYPTO_HW)
+class hardwareBackend : public cryptoBackend {
+public:
+    const char* name() const override { return "esp32-hw"; }
+
+    // esp_sha() is one-shot, so parts are gathered into a stack buffer first.
+    // Inputs larger than that (never the case for beacons/HKDF) use software.
+    void sha256(const cryptoSpan* parts, size_t count, uint8_t* out) override {
+        uint8_t buf[256];
+        size_t len = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (len + parts[i].len > sizeof(buf)) {
+                softwareCrypto().sha256(parts, count, out);
+                return;
+            }
+            memcpy(buf + len, parts[i].data, parts[i].len);
+            len += parts[i].len;
+        }
+        esp_sha(SHA2_256, buf, len, out);
+    }
+
+    // The peripheral expands the key itself; the context only has to be set up once per key
+    void aesExpandKey(const uint8_t* key, aesKeySchedule& ks) override {
+        memcpy(ks.key, key, 16);
+        esp_aes_init(&ks.hw);
+        esp_aes_setkey(&ks.hw, key, 128);
+    }
+
+    // esp_aes_crypt_ecb() takes a non-const context but only reads the key from it
+    void aesEncrypt(const aesKeySchedule& ks, const uint8_t* in, uint8_t* out) override {
+        esp_aes_crypt_ecb(const_cast<esp_aes_context*>(&ks.hw), ESP_AES_ENCRYPT, in, out);
+    }
+
+    // esp_sha() is one-shot and cannot resume from the ipad/opad midstates, so the base-class
+    // loop would cost four peripheral calls per tag. mbedtls' streaming context can, and
+    // ESP-IDF runs its blocks on this same peripheral: two compressions per tag.
+    size_t verifyHmacBatch(const uint8_t* key, size_t keyLen,
+                           hmacVerifyJob* jobs, size_t count, size_t tagLen) override {
+        return softwareCrypto().verifyHmacBatch(key, keyLen, jobs, count, tagLen);
+    }
+};
+#endif
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Incremental SHA-256
+// ---------------------------------------------------------------------------
+
+sha256Stream::sha256Stream() {
+    mbedtls_sha256_init(&_ctx);
+    reset();
+}
+
+sha256Stream::sha256Stream(const sha256Stream& other) {
+    mbedtls_sha256_init(&_ctx);
+    mbedtls_sha256_clone(&_ctx, &other._ctx);
+}
+
+sha256Stream& sha256Stream::operator=(const sha256Stream& other) {
+    if (this != &other) mbedtls_sha256_clone(&_ctx, &other._ctx);
+    return *this;
+}
+
+sha256Stream::~sha256Stream() {
+    mbedtls_sha256_free(&_ctx);  // Also releases the SHA peripheral if this context held it
+}
+
+// mbedtls 3 dropped the _ret suffix (and the void variants) from the streaming calls
+#if MBEDTLS_VERSION_NUMBER < 0x03000000
+void sha256Stream::reset() { mbedtls_sha256_starts_ret(&_ctx, 0); }
+void sha256Stream::update(const uint8_t* data, size_t len) { mbedtls_sha256_update_ret(&_ctx, data, len); }
+void sha256Stream::finish(uint8_t* out) { mbedtls_sha256_finish_ret(&_ctx, out); }
+#else
+void sha256Stream::reset() { mbedtls_sha256_starts(&_ctx, 0); }
+void sha256Stream::update(const uint8_t* data, size_t len) { mbedtls_sha256_update(&_ctx, data, len); }
+void sha256Stream::finish(uint8_t* out) { mbedtls_sha256_finish(&_ctx, out); }
+#endif
+
+cryptoBackend& softwareCrypto() {
+    static softwareBackend backend;
+    return backend;
+}
+
+cryptoBackend* hardwareCrypto() {
+#if defined(APP_CRYPTO_HW)
+    static hardwareBackend backend;
+    return &backend;
+#else
+    return nullptr;
+#endif
+}
+
+cryptoBackend& defaultCrypto() {
+    cryptoBackend* hw = hardwareCrypto();
+    return hw ? *hw : softwareCrypto();
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <mbedtls/aes.h>
+#include <mbedtls/sha256.h>
+#if defined(ESP32) && !defined(APP_CRYPTO_SOFTWARE)
+#include "aes/esp_aes.h"
+#endif
+
+struct cryptoSpan {
+    const uint8_t* data;
+    size_t len;
+};
+
+// Expanded in place by aesExpandKey(); not copyable (mbedtls 2.x points into its own context)
+struct aesKeySchedule {
+    uint8_t key[16];
+    mbedtls_aes_context sw;  // Filled by the software backend only
+#if defined(ESP32) && !defined(APP_CRYPTO_SOFTWARE)
+    esp_aes_context hw;      // Keyed once by the hardware backend, reused for every block
+#endif
+};
+
+struct hmacVerifyJob {
+    cryptoSpan parts[3];
+    size_t partCount;
+    const uint8_t* expected;  // Tag received on the wire
+    bool valid;               // Set by verifyHmacBatch()
+};
+
+/**
+ * @brief Primitive crypto operations behind one interface.
+ *
+ * softwareCrypto() wraps mbedtls and builds anywhere; on ESP-IDF its SHA-256
+ * may itself land on the peripheral. hardwareCrypto() drives the ESP32 SHA and
+ * AES peripherals directly and is nullptr on hosts. defaultCrypto() picks hardware when present unless
+ * the build defines APP_CRYPTO_SOFTWARE.
+ */
+class cryptoBackend {
+public:
+    static constexpr size_t MAX_PARTS = 7;
+
+    virtual ~cryptoBackend() = default;
+    virtual const char* name() const = 0;
+
+    virtual void sha256(const cryptoSpan* parts, size_t count, uint8_t* out) = 0;
+    virtual void aesExpandKey(const uint8_t* key, aesKeySchedule& ks) = 0;
+    virtual void aesEncrypt(const aesKeySchedule& ks, const uint8_t* in, uint8_t* out) = 0;
+
+    // HMAC-SHA256 over up to MAX_PARTS message parts
+    virtual bool hmacSha256(const uint8_t* key, size_t keyLen,
+                            const cryptoSpan* parts, size_t count, uint8_t* out);
+
+    // Checks many tags under one key (e.g. queued beacons); returns how many matched.
+    // Only the first tagLen bytes of each tag are compared.
+    virtual size_t verifyHmacBatch(const uint8_t* key, size_t keyLen,
+                                   hmacVerifyJob* jobs, size_t count, size_t tagLen = 32);
+
+protected:
+    static bool tagsEqual(const uint8_t* a, const uint8_t* b, size_t len);
+};
+
+/**
+ * @brief SHA-256 over input that arrives in pieces (an OTA image as it is
+ * received). Backed by mbedtls' streaming context, which ESP-IDF runs on the
+ * SHA peripheral whenever the peripheral is free. Copies clone the midstate.
+ */
+class sha256Stream {
+public:
+    static constexpr size_t DIGEST_LEN = 32;
+
+    sha256Stream();
+    sha256Stream(const sha256Stream& other);
+    sha256Stream& operator=(const sha256Stream& other);
+    ~sha256Stream();
+
+    void reset();
+    void update(const uint8_t* data, size_t len);
+    void finish(uint8_t* out);  // DIGEST_LEN bytes; reset() before hashing again
+
+private:
+    mbedtls_sha256_context _ctx;
+};
+
+cryptoBackend& softwareCrypto();
+cryptoBackend* hardwareCrypto();
+cryptoBackend& defaultCrypto();
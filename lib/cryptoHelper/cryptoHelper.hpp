@@ -1,23 +1,47 @@
-#include <mbedtls/md.h>
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "cryptoBackend.hpp"
 
-bool computeHmacSHA256(const uint8_t* key, size_t keyLen,
-                       const uint8_t* data, size_t dataLen,
-                       uint8_t* outHmac, size_t outLen = 32)
+inline bool computeHmacSHA256(const uint8_t* key, size_t keyLen,
+                              const uint8_t* data, size_t dataLen,
+                              uint8_t* outHmac, size_t outLen = 32)
 {
-    const mbedtls_md_info_t* md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
-    if (!md || outLen < 32) return false;
+    if (outLen < 32) return false;
+    cryptoSpan part = {data, dataLen};
+    return defaultCrypto().hmacSha256(key, keyLen, &part, 1, outHmac);
+}
 
-    mbedtls_md_context_t ctx;
-    mbedtls_md_init(&ctx);
+// RFC 5869 HKDF-SHA256. Written on top of the HMAC primitive because
+// MBEDTLS_HKDF_C is not enabled in the default ESP32 Arduino build.
+inline bool computeHkdfSHA256(const uint8_t* salt, size_t saltLen,
+                              const uint8_t* ikm, size_t ikmLen,
+                              const uint8_t* info, size_t infoLen,
+                              uint8_t* out, size_t outLen)
+{
+    if (outLen > 255 * 32) return false;
+
+    uint8_t prk[32];
+    static const uint8_t zeroSalt[32] = {0};
+    if (!salt || saltLen == 0) { salt = zeroSalt; saltLen = sizeof(zeroSalt); }
+    if (!computeHmacSHA256(salt, saltLen, ikm, ikmLen, prk)) return false;
+
+    cryptoBackend& crypto = defaultCrypto();
+    uint8_t block[32];
+    size_t done = 0;
+    for (uint8_t counter = 1; done < outLen; ++counter) {
+        cryptoSpan parts[3] = {{block, counter > 1 ? sizeof(block) : 0},
+                               {info, infoLen},
+                               {&counter, 1}};
+        if (!crypto.hmacSha256(prk, sizeof(prk), parts, 3, block)) return false;
 
-    if (mbedtls_md_setup(&ctx, md, 1) != 0) {
-        mbedtls_md_free(&ctx);
-        return false;
+        size_t n = (outLen - done < sizeof(block)) ? outLen - done : sizeof(block);
+        memcpy(out + done, block, n);
+        done += n;
     }
 
-    mbedtls_md_hmac_starts(&ctx, key, keyLen);
-    mbedtls_md_hmac_update(&ctx, data, dataLen);
-    mbedtls_md_hmac_finish(&ctx, outHmac);
-    mbedtls_md_free(&ctx);
+    memset(prk, 0, sizeof(prk));
+    memset(block, 0, sizeof(block));
     return true;
-}
\ No newline at end of file
+}
@@ -0,0 +1,190 @@
+#include "packetCipher.hpp"
+#include "sessionKey.hpp"
+#include <string.h>
+
+namespace {
+constexpr size_t CCM_NONCE_LEN = 10;            // senderMac + 32-bit counter
+constexpr size_t CCM_L = 15 - CCM_NONCE_LEN;    // Length field width
+constexpr size_t CCM_AAD_LEN = 4 + 6;
+constexpr size_t CCM_MSG_LEN = sizeof(deviceDataPacket::values);
+constexpr size_t CCM_MIC_LEN = sizeof(deviceDataPacket::tag);
+
+const uint8_t broadcastAddr[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+bool constantTimeEqual(const uint8_t* a, const uint8_t* b, size_t len) {
+    uint8_t diff = 0;
+    for (size_t i = 0; i < len; ++i) diff |= a[i] ^ b[i];
+    return diff == 0;
+}
+}
+
+void packetCipher::begin(const uint8_t* selfMac) {
+    memcpy(self, selfMac, sizeof(self));
+    // Random start so a reboot does not replay the previous run's nonces
+    window.begin();
+}
+
+void packetCipher::setGroupKey(const uint8_t* key) {
+    memcpy(groupKey, key, sizeof(groupKey));
+    hasGroupKey = true;
+}
+
+bool packetCipher::setPeerKey(const uint8_t* mac, const uint8_t* key) {
+    peerKey* slot = nullptr;
+    for (auto& p : peers) {
+        if (p.used && memcmp(p.mac, mac, 6) == 0) { slot = &p; break; }
+        if (!p.used && !slot) slot = &p;
+    }
+    if (!slot) return false;
+
+    memcpy(slot->mac, mac, 6);
+    memcpy(slot->key, key, AEAD_KEY_LEN);
+    slot->used = true;
+    return true;
+}
+
+void packetCipher::removePeerKey(const uint8_t* mac) {
+    for (auto& p : peers) {
+        if (p.used && memcmp(p.mac, mac, 6) == 0) {
+            p.used = false;
+            memset(p.key, 0, sizeof(p.key));
+        }
+    }
+}
+
+bool packetCipher::hasPeerKey(const uint8_t* mac) const {
+    return peerKeyFor(mac) != nullptr;
+}
+
+const uint8_t* packetCipher::peerKeyFor(const uint8_t* mac) const {
+    for (const auto& p : peers) {
+        if (p.used && memcmp(p.mac, mac, 6) == 0) return p.key;
+    }
+    return nullptr;
+}
+
+void packetCipher::buildNonceAad(const deviceDataPacket& pkt, uint8_t* nonce, uint8_t* aad) {
+    memcpy(nonce, pkt.senderMac, 6);
+    memcpy(nonce + 6, pkt.nonce, 4);
+
+    aad[0] = pkt.version;
+    aad[1] = pkt.command;
+    aad[2] = pkt.flags;
+    aad[3] = pkt.seqId;
+    memcpy(aad + 4, pkt.senderMac, 6);
+}
+
+// CBC-MAC part of CCM (RFC 3610) for our fixed sizes: B0, one AAD block, one message block
+void packetCipher::ccmMic(aesBlock& aes, const uint8_t* nonce, const uint8_t* aad,
+                          const uint8_t* msg, uint8_t* mic) {
+    uint8_t x[16];
+    uint8_t b[16] = {0};
+
+    b[0] = 0x40 | (((CCM_MIC_LEN - 2) / 2) << 3) | (CCM_L - 1);
+    memcpy(b + 1, nonce, CCM_NONCE_LEN);
+    b[15] = CCM_MSG_LEN;
+    aes.encrypt(b, x);
+
+    memset(b, 0, sizeof(b));
+    b[1] = CCM_AAD_LEN;
+    memcpy(b + 2, aad, CCM_AAD_LEN);
+    for (size_t i = 0; i < 16; ++i) b[i] ^= x[i];
+    aes.encrypt(b, x);
+
+    memset(b, 0, sizeof(b));
+    memcpy(b, msg, CCM_MSG_LEN);
+    for (size_t i = 0; i < 16; ++i) b[i] ^= x[i];
+    aes.encrypt(b, x);
+
+    memcpy(mic, x, CCM_MIC_LEN);
+}
+
+void packetCipher::ccmCtr(aesBlock& aes, const uint8_t* nonce, uint32_t counter, uint8_t* block) {
+    uint8_t a[16] = {0};
+    a[0] = CCM_L - 1;
+    memcpy(a + 1, nonce, CCM_NONCE_LEN);
+    a[15] = static_cast<uint8_t>(counter);
+    aes.encrypt(a, block);
+}
+
+bool packetCipher::seal(deviceDataPacket& pkt, const uint8_t* destMac) {
+    if (isExempt(pkt)) return true;
+
+    bool group = !destMac || memcmp(destMac, broadcastAddr, 6) == 0;
+    const uint8_t* key = group ? nullptr : peerKeyFor(destMac);
+    if (!key) {
+        if (!hasGroupKey) return false;
+        key = groupKey;
+        group = true;
+    }
+    if (!txAes.setKey(key)) return false;
+
+    uint32_t ctr = window.next();
+    pkt.nonce[0] = ctr >> 24;
+    pkt.nonce[1] = ctr >> 16;
+    pkt.nonce[2] = ctr >> 8;
+    pkt.nonce[3] = ctr;
+    memcpy(pkt.senderMac, self, sizeof(self));
+    pkt.flags |= PKT_FLAG_ENCRYPTED;
+    if (group) pkt.flags |= PKT_FLAG_BROADCAST;
+    else pkt.flags &= ~PKT_FLAG_BROADCAST;
+
+    uint8_t nonce[CCM_NONCE_LEN];
+    uint8_t aad[CCM_AAD_LEN];
+    uint8_t mic[CCM_MIC_LEN];
+    uint8_t s[16];
+    buildNonceAad(pkt, nonce, aad);
+
+    ccmMic(txAes, nonce, aad, pkt.values, mic);
+    ccmCtr(txAes, nonce, 0, s);
+    for (size_t i = 0; i < CCM_MIC_LEN; ++i) pkt.tag[i] = mic[i] ^ s[i];
+    ccmCtr(txAes, nonce, 1, s);
+    for (size_t i = 0; i < CCM_MSG_LEN; ++i) pkt.values[i] ^= s[i];
+    return true;
+}
+
+bool packetCipher::open(deviceDataPacket& pkt, const uint8_t* fromMac) {
+    if (isExempt(pkt)) return true;
+    if (!(pkt.flags & PKT_FLAG_ENCRYPTED)) {
+        bool required = requireSealed && ((fromMac && peerKeyFor(fromMac)) || peerKeyFor(pkt.senderMac));
+        if (required) ++rejects;
+        return !required;
+    }
+
+    const uint8_t* key = (pkt.flags & PKT_FLAG_BROADCAST)
+                             ? (hasGroupKey ? groupKey : nullptr)
+                             : peerKeyFor(pkt.senderMac);
+    if (!key || !rxAes.setKey(key)) {
+        ++rejects;
+        return false;
+    }
+
+    uint8_t nonce[CCM_NONCE_LEN];
+    uint8_t aad[CCM_AAD_LEN];
+    uint8_t plain[CCM_MSG_LEN];
+    uint8_t mic[CCM_MIC_LEN];
+    uint8_t s[16];
+    buildNonceAad(pkt, nonce, aad);
+
+    ccmCtr(rxAes, nonce, 1, s);
+    for (size_t i = 0; i < CCM_MSG_LEN; ++i) plain[i] = pkt.values[i] ^ s[i];
+    ccmMic(rxAes, nonce, aad, plain, mic);
+    ccmCtr(rxAes, nonce, 0, s);
+    for (size_t i = 0; i < CCM_MIC_LEN; ++i) mic[i] ^= s[i];
+
+    if (!constantTimeEqual(mic, pkt.tag, CCM_MIC_LEN)) {
+        ++rejects;
+        return false;
+    }
+
+    // Only an authentic frame may move the sender's window
+    uint32_t ctr = (uint32_t)pkt.nonce[0] << 24 | (uint32_t)pkt.nonce[1] << 16 |
+                   (uint32_t)pkt.nonce[2] << 8 | pkt.nonce[3];
+    if (!window.accept(pkt.senderMac, ctr)) {
+        ++rejects;
+        return false;
+    }
+
+    memcpy(pkt.values, plain, sizeof(plain));
+    return true;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <deviceDataPacket.h>
+#include <globalConstants.h>
+#include "aesBlock.hpp"
+#include "replayWindow.hpp"
+
+constexpr size_t AEAD_KEY_LEN = 16;
+constexpr size_t AEAD_PEER_KEY_SLOTS = 128;  // Matches the boss pairing table
+
+/**
+ * @brief Application-layer AES-CCM for deviceDataPacket.
+ *
+ * Used where ESP-NOW hardware encryption is unavailable: broadcast frames and
+ * peers beyond the encrypted-peer limit. The packet layout is unchanged:
+ *
+ *   CCM nonce = senderMac || nonce[4]  (nonce[] is a per-sender counter)
+ *   AAD       = version, command, flags, seqId, senderMac
+ *   plaintext = values[4]  ->  ciphertext in place
+ *   MIC       = tag[4]
+ *
+ * A 4-byte MIC is what the existing tag[] field allows; treat it as 2^-32
+ * per-forgery protection, not a long-term signature.
+ * open() also refuses a counter the sender has already used (replayWindow).
+ */
+class packetCipher {
+public:
+    void begin(const uint8_t* selfMac);
+    void setGroupKey(const uint8_t* key);
+    bool setPeerKey(const uint8_t* mac, const uint8_t* key);
+    void removePeerKey(const uint8_t* mac);
+    bool hasPeerKey(const uint8_t* mac) const;
+
+    // When set, open() rejects packets without PKT_FLAG_ENCRYPTED from a sender it holds a
+    // peer key for (by fromMac or senderMac): once that key is installed the sender seals
+    // everything it sends us.
+    // Senders without a peer key (hardware-encrypted peers, group broadcasts) are unaffected.
+    void setRequireSealed(bool on) { requireSealed = on; }
+
+    // destMac == nullptr (or broadcast) seals with the group key
+    bool seal(deviceDataPacket& pkt, const uint8_t* destMac);
+    bool open(deviceDataPacket& pkt, const uint8_t* fromMac = nullptr);  // fromMac: the radio's source address
+
+    uint32_t rejectCount() const { return rejects; }
+    const char* backendName() const { return txAes.backendName(); }
+
+    // Sender counters and replay state; the radio forgets a peer here when it re-pairs
+    replayWindow& replay() { return window; }
+
+    // Pairing offers and their confirmations carry their own key confirmation in tag[] and are never sealed
+    static bool isExempt(const deviceDataPacket& pkt) {
+        return pkt.command == static_cast<uint8_t>(CommandCode::PairAccept) ||
+               pkt.command == static_cast<uint8_t>(CommandCode::KeyRotate) ||
+               pkt.command == static_cast<uint8_t>(CommandCode::KeyConfirm);
+    }
+
+private:
+    struct peerKey {
+        uint8_t mac[6];
+        uint8_t key[AEAD_KEY_LEN];
+        bool used;
+    };
+
+    uint8_t self[6] = {0};
+    uint8_t groupKey[AEAD_KEY_LEN] = {0};
+    bool hasGroupKey = false;
+    bool requireSealed = false;
+    volatile uint32_t rejects = 0;
+    replayWindow window;
+    peerKey peers[AEAD_PEER_KEY_SLOTS] = {};
+
+    // Separate contexts: seal() runs in the loop task, open() in the Wi-Fi task
+    aesBlock txAes;
+    aesBlock rxAes;
+
+    const uint8_t* peerKeyFor(const uint8_t* mac) const;
+    static void buildNonceAad(const deviceDataPacket& pkt, uint8_t* nonce, uint8_t* aad);
+    static void ccmMic(aesBlock& aes, const uint8_t* nonce, const uint8_t* aad,
+                       const uint8_t* msg, uint8_t* mic);
+    static void ccmCtr(aesBlock& aes, const uint8_t* nonce, uint32_t counter, uint8_t* block);
+};
+
+// Dispatch helpers so espNowCoPilot<T> can stay generic over its payload type
+template <typename U> inline bool aeadSeal(packetCipher&, U&, const uint8_t*) { return false; }
+template <typename U> inline bool aeadOpen(packetCipher&, U&, const uint8_t*) { return true; }
+inline bool aeadSeal(packetCipher& c, deviceDataPacket& pkt, const uint8_t* dest) { return c.seal(pkt, dest); }
+inline bool aeadOpen(packetCipher& c, deviceDataPacket& pkt, const uint8_t* from) { return c.open(pkt, from); }
+template <typename U> inline bool aeadFlagged(const U&) { return false; }
+inline bool aeadFlagged(const deviceDataPacket& pkt) { return pkt.flags & PKT_FLAG_ENCRYPTED; }
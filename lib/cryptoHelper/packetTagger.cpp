@@ -0,0 +1,76 @@
+#include "packetTagger.hpp"
+#include "sessionKey.hpp"
+#include "sipHash.hpp"
+#include <string.h>
+
+namespace {
+constexpr size_t TAG_HEAD_LEN = offsetof(deviceDataPacket, tag);
+constexpr size_t TAG_INPUT_LEN = TAG_HEAD_LEN + sizeof(deviceDataPacket::senderMac);
+static_assert(offsetof(deviceDataPacket, senderMac) == TAG_HEAD_LEN + sizeof(deviceDataPacket::tag),
+              "tag[] must sit between nonce[] and senderMac[]");
+}
+
+void packetTagger::begin(const uint8_t* selfMac) {
+    memcpy(self, selfMac, sizeof(self));
+    window->begin();
+}
+
+void packetTagger::setKey(const uint8_t* k) {
+    memcpy(key, k, sizeof(key));
+    keyed = true;
+}
+
+uint32_t packetTagger::computeTag(const uint8_t* key, const deviceDataPacket& pkt) {
+    const uint8_t* raw = reinterpret_cast<const uint8_t*>(&pkt);
+    uint8_t input[TAG_INPUT_LEN];
+    memcpy(input, raw, TAG_HEAD_LEN);
+    memcpy(input + TAG_HEAD_LEN, pkt.senderMac, sizeof(pkt.senderMac));
+    return static_cast<uint32_t>(sipHash24(key, input, sizeof(input)));
+}
+
+bool packetTagger::sign(deviceDataPacket& pkt) {
+    if (passesThrough(pkt)) return true;
+    if (!keyed) return false;
+
+    uint32_t ctr = window->next();
+    pkt.nonce[0] = ctr >> 24;
+    pkt.nonce[1] = ctr >> 16;
+    pkt.nonce[2] = ctr >> 8;
+    pkt.nonce[3] = ctr;
+    memcpy(pkt.senderMac, self, sizeof(self));
+    pkt.flags |= PKT_FLAG_TAGGED;
+
+    uint32_t tag = computeTag(key, pkt);
+    memcpy(pkt.tag, &tag, sizeof(pkt.tag));
+    return true;
+}
+
+bool packetTagger::verify(const deviceDataPacket& pkt) {
+    if (passesThrough(pkt)) return true;
+    if (pkt.flags & PKT_FLAG_ENCRYPTED) {
+        // Claims to be sealed, but nothing here could have opened it
+        ++rejects;
+        return false;
+    }
+    if (!(pkt.flags & PKT_FLAG_TAGGED)) {
+        if (requireTag) ++rejects;
+        return !requireTag;
+    }
+
+    uint32_t expected = keyed ? computeTag(key, pkt) : 0;
+    uint32_t received;
+    memcpy(&received, pkt.tag, sizeof(received));
+    if (!keyed || (expected ^ received) != 0) {
+        ++rejects;
+        return false;
+    }
+
+    // Only an authentic frame may move the sender's window
+    uint32_t ctr = (uint32_t)pkt.nonce[0] << 24 | (uint32_t)pkt.nonce[1] << 16 |
+                   (uint32_t)pkt.nonce[2] << 8 | pkt.nonce[3];
+    if (!window->accept(pkt.senderMac, ctr)) {
+        ++rejects;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <deviceDataPacket.h>
+#include "packetCipher.hpp"
+
+constexpr size_t TAG_KEY_LEN = 16;
+
+/**
+ * @brief 32-bit SipHash-2-4 integrity tag for cleartext deviceDataPacket frames.
+ *
+ * Covers every byte except tag[] itself:
+ *
+ *   tag = trunc32(SipHash-2-4(key, version..nonce[4] || senderMac))
+ *
+ * nonce[] is a per-sender counter, so retransmits of identical payloads still
+ * produce distinct tags. Frames sealed by packetCipher already carry a CCM MIC
+ * in tag[] and pass through untouched, as do pairing offers. A frame flagged
+ * PKT_FLAG_ENCRYPTED passes only when a cipher is set, and the caller must
+ * have opened it with that cipher first (espNowCoPilot does); without one,
+ * the flag alone would skip the tag check.
+ *
+ * Like the AEAD MIC, 32 bits is per-forgery protection against on-air
+ * tampering, not a long-term signature.
+ *
+ * verify() refuses a counter the sender has already used. With AEAD on as
+ * well, share packetCipher's replayWindow: a sender numbers sealed and tagged
+ * frames from one counter, so the receiver must track them in one window.
+ */
+class packetTagger {
+public:
+    void begin(const uint8_t* selfMac);
+    void setKey(const uint8_t* key);
+
+    // When set, verify() rejects cleartext frames that arrive without a tag
+    void setRequireTag(bool on) { requireTag = on; }
+
+    // The cipher that opens sealed frames before verify(); nullptr rejects every sealed frame
+    void setCipher(const packetCipher* c) { cipher = c; }
+
+    bool sign(deviceDataPacket& pkt);
+    bool verify(const deviceDataPacket& pkt);
+
+    uint32_t rejectCount() const { return rejects; }
+
+    // Call before begin(); e.g. shareReplayWindow(cipher.replay())
+    void shareReplayWindow(replayWindow& shared) { window = &shared; }
+    replayWindow& replay() { return *window; }
+
+    static uint32_t computeTag(const uint8_t* key, const deviceDataPacket& pkt);
+
+private:
+    uint8_t self[6] = {0};
+    uint8_t key[TAG_KEY_LEN] = {0};
+    bool keyed = false;
+    bool requireTag = false;
+    const packetCipher* cipher = nullptr;
+    volatile uint32_t rejects = 0;
+    replayWindow ownWindow;
+    replayWindow* window = &ownWindow;
+
+    bool passesThrough(const deviceDataPacket& pkt) const {
+        return packetCipher::isExempt(pkt) || (cipher && (pkt.flags & PKT_FLAG_ENCRYPTED));
+    }
+};
+
+// Dispatch helpers so espNowCoPilot<T> can stay generic over its payload type
+template <typename U> inline bool tagSign(packetTagger&, U&) { return true; }
+template <typename U> inline bool tagVerify(packetTagger&, const U&) { return true; }
+inline bool tagSign(packetTagger& t, deviceDataPacket& pkt) { return t.sign(pkt); }
+inline bool tagVerify(packetTagger& t, const deviceDataPacket& pkt) { return t.verify(pkt); }
@@ -0,0 +1,121 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "sessionKey.hpp"
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#else
+#include <atomic>
+#endif
+
+constexpr size_t REPLAY_SENDERS = 128;  // Matches the boss pairing table
+constexpr uint32_t REPLAY_SLACK = 32;   // Frames a sender's counter may arrive out of order by
+
+/**
+ * @brief Frame counter for outgoing packets and replay window for incoming ones.
+ *
+ * next() numbers the frames this device sends (nonce[] in deviceDataPacket).
+ * accept() keeps, per sender, the highest counter seen plus a bitmap of the
+ * REPLAY_SLACK before it, and refuses anything older or already seen. Call it
+ * only after the frame authenticated, so forgeries cannot move the window.
+ *
+ * Counters start at a random value each boot (CCM nonces must never repeat
+ * under the group key), so a rebooted sender may restart below its old
+ * window; forget() it when the peer re-pairs. When the table is full, slots
+ * are reused round-robin and the evicted sender starts afresh.
+ */
+class replayWindow {
+public:
+    // Random start, from setup(); later calls keep the running counter, so a shared window can be begun twice
+    void begin() {
+        if (seeded) return;
+        fillSessionNonce(reinterpret_cast<uint8_t*>(&txCounter), sizeof(txCounter));
+        seeded = true;
+    }
+
+    uint32_t next() {
+        lock();
+        uint32_t ctr = ++txCounter;
+        unlock();
+        return ctr;
+    }
+
+    bool accept(const uint8_t* mac, uint32_t counter) {
+        lock();
+        sender* s = find(mac);
+        if (!s) {
+            for (auto& slot : senders) {
+                if (!slot.used) { s = &slot; break; }
+            }
+            if (!s) {
+                s = &senders[victim];
+                victim = (victim + 1) % REPLAY_SENDERS;
+            }
+            memcpy(s->mac, mac, 6);
+            s->used = true;
+            s->highest = counter;
+            s->seen = 1;
+            unlock();
+            return true;
+        }
+
+        // Serial-number arithmetic, so a counter wrapping past 2^32 still moves forward
+        int32_t ahead = static_cast<int32_t>(counter - s->highest);
+        bool fresh;
+        if (ahead > 0) {
+            s->seen = static_cast<uint32_t>(ahead) < REPLAY_SLACK ? (s->seen << ahead) | 1 : 1;
+            s->highest = counter;
+            fresh = true;
+        } else {
+            uint32_t behind = static_cast<uint32_t>(-static_cast<int64_t>(ahead));
+            fresh = behind < REPLAY_SLACK && !(s->seen & (1u << behind));
+            if (fresh) s->seen |= 1u << behind;
+            else ++replays;
+        }
+        unlock();
+        return fresh;
+    }
+
+    void forget(const uint8_t* mac) {
+        lock();
+        sender* s = find(mac);
+        if (s) s->used = false;
+        unlock();
+    }
+
+    uint32_t replayCount() const { return replays; }
+
+private:
+    struct sender {
+        uint8_t mac[6];
+        bool used;
+        uint32_t highest;
+        uint32_t seen;  // Bit n: highest - n already accepted
+    };
+
+    sender senders[REPLAY_SENDERS] = {};
+    size_t victim = 0;
+    uint32_t txCounter = 0;
+    bool seeded = false;
+    volatile uint32_t replays = 0;
+
+    // accept() runs in the Wi-Fi task, next() and forget() in the loop task
+#if defined(ESP32)
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    void lock() { portENTER_CRITICAL(&mux); }
+    void unlock() { portEXIT_CRITICAL(&mux); }
+#else
+    std::atomic_flag flag = ATOMIC_FLAG_INIT;
+    void lock() { while (flag.test_and_set(std::memory_order_acquire)) {} }
+    void unlock() { flag.clear(std::memory_order_release); }
+#endif
+
+    sender* find(const uint8_t* mac) {
+        for (auto& s : senders) {
+            if (s.used && memcmp(s.mac, mac, 6) == 0) return &s;
+        }
+        return nullptr;
+    }
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "cryptoHelper.hpp"
+
+#if defined(ESP32)
+#include <esp_system.h>
+#else
+#include <random>
+#endif
+
+constexpr size_t SESSION_NONCE_LEN = 8;
+constexpr size_t SESSION_KEY_LEN = 16;   // ESP_NOW_KEY_LEN
+constexpr size_t SESSION_CONFIRM_LEN = 4;
+
+inline void fillSessionNonce(uint8_t* out, size_t len = SESSION_NONCE_LEN)
+{
+#if defined(ESP32)
+    esp_fill_random(out, len);
+#else
+    static std::random_device rd;
+    for (size_t i = 0; i < len; ++i) out[i] = static_cast<uint8_t>(rd());
+#endif
+}
+
+/**
+ * @brief Derive the per-peer ESP-NOW LMK for one key epoch.
+ *
+ * LMK = HKDF-SHA256(salt = workerNonce || bossNonce,
+ *                   ikm  = shared secret,
+ *                   info = "espnow-lmk" || workerMac || bossMac || epoch)
+ *
+ * Both sides contribute a fresh nonce, so every pairing (and every rotation,
+ * which draws a new boss nonce) yields an unrelated key.
+ */
+inline bool deriveSessionKey(const uint8_t* secret, size_t secretLen,
+                             const uint8_t* workerNonce, const uint8_t* bossNonce,
+                             const uint8_t* workerMac, const uint8_t* bossMac,
+                             uint8_t epoch, uint8_t* lmkOut)
+{
+    if (!secret || secretLen == 0) return false;
+
+    uint8_t salt[2 * SESSION_NONCE_LEN];
+    memcpy(salt, workerNonce, SESSION_NONCE_LEN);
+    memcpy(salt + SESSION_NONCE_LEN, bossNonce, SESSION_NONCE_LEN);
+
+    static const char label[] = "espnow-lmk";
+    uint8_t info[sizeof(label) - 1 + 6 + 6 + 1];
+    memcpy(info, label, sizeof(label) - 1);
+    memcpy(info + sizeof(label) - 1, workerMac, 6);
+    memcpy(info + sizeof(label) - 1 + 6, bossMac, 6);
+    info[sizeof(info) - 1] = epoch;
+
+    return computeHkdfSHA256(salt, sizeof(salt), secret, secretLen,
+                             info, sizeof(info), lmkOut, SESSION_KEY_LEN);
+}
+
+/**
+ * @brief Short key-confirmation tag sent with PairAccept / KeyRotate.
+ *
+ * Proves the boss holds the same derived key and addresses the message to a
+ * single worker, since the accept itself travels over broadcast.
+ */
+inline bool computeSessionConfirm(const uint8_t* lmk, const uint8_t* workerMac,
+                                  uint8_t epoch, uint8_t* tagOut)
+{
+    uint8_t msg[6 + 1];
+    memcpy(msg, workerMac, 6);
+    msg[6] = epoch;
+
+    uint8_t full[32];
+    if (!computeHmacSHA256(lmk, SESSION_KEY_LEN, msg, sizeof(msg), full)) return false;
+    memcpy(tagOut, full, SESSION_CONFIRM_LEN);
+    return true;
+}
+
+// Group key for application-layer AEAD on broadcast frames (see packetCipher.hpp)
+inline bool deriveGroupKey(const uint8_t* secret, size_t secretLen, uint8_t* keyOut)
+{
+    static const char label[] = "espnow-group";
+    return secretLen > 0 &&
+           computeHkdfSHA256(nullptr, 0, secret, secretLen,
+                             reinterpret_cast<const uint8_t*>(label), sizeof(label) - 1,
+                             keyOut, SESSION_KEY_LEN);
+}
+
+// Fleet key for the SipHash short tags on cleartext frames (see packetTagger.hpp)
+inline bool deriveTagKey(const uint8_t* secret, size_t secretLen, uint8_t* keyOut)
+{
+    static const char label[] = "espnow-tag";
+    return secretLen > 0 &&
+           computeHkdfSHA256(nullptr, 0, secret, secretLen,
+                             reinterpret_cast<const uint8_t*>(label), sizeof(label) - 1,
+                             keyOut, SESSION_KEY_LEN);
+}
+
+// Fleet key for the HMAC on config sync frames (see configSync.hpp)
+inline bool deriveConfigKey(const uint8_t* secret, size_t secretLen, uint8_t* keyOut)
+{
+    static const char label[] = "espnow-config";
+    return secretLen > 0 &&
+           computeHkdfSHA256(nullptr, 0, secret, secretLen,
+                             reinterpret_cast<const uint8_t*>(label), sizeof(label) - 1,
+                             keyOut, SESSION_KEY_LEN);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// SipHash-2-4 (Aumasson & Bernstein): a keyed 64-bit PRF built for short
+// inputs. A 22-byte packet is three compressions of add/rotate/xor, with no
+// tables and no peripheral round trips.
+namespace sipHashDetail {
+
+inline uint64_t rotl(uint64_t x, unsigned b) { return (x << b) | (x >> (64 - b)); }
+
+inline uint64_t load64le(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+inline void round(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+    v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+    v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+}
+
+}  // namespace sipHashDetail
+
+inline uint64_t sipHash24(const uint8_t* key, const uint8_t* data, size_t len) {
+    using namespace sipHashDetail;
+    uint64_t k0 = load64le(key), k1 = load64le(key + 8);
+    uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ k1;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+    uint64_t v3 = 0x7465646279746573ULL ^ k1;
+
+    const uint8_t* end = data + (len & ~size_t(7));
+    for (; data != end; data += 8) {
+        uint64_t m = load64le(data);
+        v3 ^= m;
+        round(v0, v1, v2, v3);
+        round(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+
+    uint64_t b = uint64_t(len) << 56;
+    for (size_t i = 0; i < (len & 7); ++i) b |= uint64_t(data[i]) << (8 * i);
+    v3 ^= b;
+    round(v0, v1, v2, v3);
+    round(v0, v1, v2, v3);
+    v0 ^= b;
+
+    v2 ^= 0xff;
+    for (int i = 0; i < 4; ++i) round(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
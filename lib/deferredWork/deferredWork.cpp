@@ -0,0 +1,410 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "deferredWork.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+static portMUX_TYPE statsLock = portMUX_INITIALIZER_UNLOCKED;
+#define STATS_LOCK() portENTER_CRITICAL(&statsLock)
+#define STATS_UNLOCK() portEXIT_CRITICAL(&statsLock)
+#else
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+static std::atomic_flag statsLock = ATOMIC_FLAG_INIT;
+#define STATS_LOCK() while (statsLock.test_and_set(std::memory_order_acquire)) {}
+#define STATS_UNLOCK() statsLock.clear(std::memory_order_release)
+#endif
+
+namespace {
+
+struct job {
+    const char* name;
+    deferredJob run;
+    void* context;
+};
+
+deferredWorkStats stats;
+uint32_t depth = 0;
+
+void runJob(const job& j) {
+    uint32_t start = micros();
+    j.run(j.context);
+    uint32_t us = micros() - start;
+    STATS_LOCK();
+    ++stats.completed;
+    if (us > stats.longestUs) {
+        stats.longestUs = us;
+        stats.longestName = j.name;
+    }
+    STATS_UNLOCK();
+}
+
+// Counted before the job is visible to the worker, so depth never goes below zero
+void countQueued() {
+    STATS_LOCK();
+    ++stats.queued;
+    if (++depth > stats.peakDepth) stats.peakDepth = depth;
+    STATS_UNLOCK();
+}
+
+void countRefused(bool wasQueued) {
+    STATS_LOCK();
+    if (wasQueued) {
+        --stats.queued;
+        --depth;
+    }
+    ++stats.refused;
+    STATS_UNLOCK();
+}
+
+void countStarted() {
+    STATS_LOCK();
+    --depth;
+    STATS_UNLOCK();
+}
+
+void countWriterWait(uint32_t us) {
+    STATS_LOCK();
+    ++stats.writerWaits;
+    stats.writerWaitUs += us;
+    STATS_UNLOCK();
+}
+
+#if defined(ESP32)
+
+QueueHandle_t queue = nullptr;
+TaskHandle_t worker = nullptr;
+
+void workerTask(void*) {
+    job j;
+    for (;;) {
+        if (xQueueReceive(queue, &j, portMAX_DELAY) != pdTRUE) continue;
+        countStarted();
+        runJob(j);
+    }
+}
+
+#else
+
+// Same bounded ring the FreeRTOS queue gives; joined at exit so benches end cleanly
+struct hostWorker {
+    job slots[DEFERRED_WORK_SLOTS];
+    size_t head = 0, count = 0;
+    bool stopping = false;
+    std::mutex lock;
+    std::condition_variable ready;
+    std::thread thread;
+
+    void run() {
+        std::unique_lock<std::mutex> guard(lock);
+        for (;;) {
+            ready.wait(guard, [this] { return count || stopping; });
+            if (!count) return;
+            job j = slots[head];
+            head = (head + 1) % DEFERRED_WORK_SLOTS;
+            --count;
+            guard.unlock();
+            countStarted();
+            runJob(j);
+            guard.lock();
+        }
+    }
+    ~hostWorker() {
+        if (!thread.joinable()) return;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        ready.notify_one();
+        thread.join();
+    }
+};
+
+hostWorker host;
+
+#endif
+
+} // namespace
+
+bool deferredWorkBegin() {
+#if defined(ESP32)
+    if (worker) return true;
+    queue = xQueueCreate(DEFERRED_WORK_SLOTS, sizeof(job));
+    if (!queue) return false;
+    if (xTaskCreate(workerTask, "deferredWork", DEFERRED_WORK_STACK, nullptr, DEFERRED_WORK_PRIORITY, &worker) !=
+        pdPASS) {
+        vQueueDelete(queue);
+        queue = nullptr;
+        worker = nullptr;
+        return false;
+    }
+#else
+    if (!host.thread.joinable()) host.thread = std::thread([] { host.run(); });
+#endif
+    return true;
+}
+
+bool deferredWorkRunning() {
+#if defined(ESP32)
+    return worker != nullptr;
+#else
+    return host.thread.joinable();
+#endif
+}
+
+bool deferWork(const char* name, deferredJob run, void* context) {
+    job j = {name, run, context};
+#if defined(ESP32)
+    if (!queue) {
+        countRefused(false);
+        return false;
+    }
+    countQueued();
+    if (xQueueSend(queue, &j, 0) != pdTRUE) {
+        countRefused(true);
+        return false;
+    }
+#else
+    {
+        std::lock_guard<std::mutex> guard(host.lock);
+        if (!host.thread.joinable() || host.count == DEFERRED_WORK_SLOTS) {
+            countRefused(false);
+            return false;
+        }
+        countQueued();
+        host.slots[(host.head + host.count++) % DEFERRED_WORK_SLOTS] = j;
+    }
+    host.ready.notify_one();
+#endif
+    return true;
+}
+
+deferredWorkStats deferredWorkGetStats() {
+    STATS_LOCK();
+    deferredWorkStats copy = stats;
+    STATS_UNLOCK();
+    return copy;
+}
+
+uint32_t deferredWorkDepth() {
+    STATS_LOCK();
+    uint32_t n = depth;
+    STATS_UNLOCK();
+    return n;
+}
+
+void deferredWorkYield() {
+#if defined(ESP32)
+    vTaskDelay(1); // The worker is below async_tcp: it only runs if we block
+#else
+    std::this_thread::yield();
+#endif
+}
+
+size_t deferredWorkStatsToJson(char* out, size_t cap) {
+    deferredWorkStats s = deferredWorkGetStats();
+    int n = snprintf(out, cap,
+                     "{\"running\":%s,\"depth\":%u,\"slots\":%u,\"queued\":%u,\"completed\":%u,\"refused\":%u,"
+                     "\"peakDepth\":%u,\"longestUs\":%u,\"longestJob\":\"%s\",\"writerWaits\":%u,\"writerWaitUs\":%u}",
+                     deferredWorkRunning() ? "true" : "false", unsigned(deferredWorkDepth()),
+                     unsigned(DEFERRED_WORK_SLOTS), unsigned(s.queued), unsigned(s.completed), unsigned(s.refused),
+                     unsigned(s.peakDepth), unsigned(s.longestUs), s.longestName, unsigned(s.writerWaits),
+                     unsigned(s.writerWaitUs));
+    return n > 0 && size_t(n) < cap ? size_t(n) : 0;
+}
+
+// deferredWriter
+
+bool deferredWriter::begin() {
+    end();
+    _blocks = static_cast<uint8_t*>(malloc(DEFERRED_WRITER_BLOCKS * _blockSize));
+    _fillBlock = 0;
+    _fill = 0;
+    _head = 0;
+    _queued = 0;
+    _closing = false;
+    _cancelled = false;
+    _then = nullptr;
+    _waits = 0;
+    _failed = false;
+    return _blocks != nullptr;
+}
+
+void deferredWriter::end() {
+    lockState();
+    _cancelled = true;
+    unlockState();
+    while (_jobsOut) awaitExit(); // At most the block the worker is on, then it lets go
+    free(_blocks);
+    _blocks = nullptr;
+    _fill = 0;
+}
+
+size_t deferredWriter::room() const {
+    if (!_blocks || _failed) return 0;
+    lockState();
+    size_t free = DEFERRED_WRITER_BLOCKS - _queued;
+    unlockState();
+    return free * _blockSize - _fill; // The block being filled is one of the free ones
+}
+
+bool deferredWriter::blockFree() const {
+    lockState();
+    bool free = _queued < DEFERRED_WRITER_BLOCKS;
+    unlockState();
+    return free;
+}
+
+// Only reached by a caller that wrote past room()
+void deferredWriter::waitForBlock() {
+    uint32_t start = micros();
+    while (!blockFree()) deferredWorkYield();
+    ++_waits;
+    countWriterWait(micros() - start);
+}
+
+bool deferredWriter::write(const uint8_t* data, size_t len) {
+    if (!_blocks) return false;
+    while (len && !_failed) {
+        if (_fill == 0 && !blockFree()) waitForBlock();
+        size_t n = _blockSize - _fill < len ? _blockSize - _fill : len;
+        memcpy(_blocks + _fillBlock * _blockSize + _fill, data, n);
+        _fill += n;
+        data += n;
+        len -= n;
+        if (_fill == _blockSize) handOver(_blockSize, nullptr, false);
+    }
+    return !_failed;
+}
+
+bool deferredWriter::finish(deferredJob then) {
+    if (!_blocks) return false;
+    handOver(_fill, then, true);
+    return true;
+}
+
+// len == 0 queues nothing, only the completion
+void deferredWriter::handOver(size_t len, deferredJob then, bool closing) {
+    size_t block = _fillBlock;
+    if (len) {
+        _fillBlock = (_fillBlock + 1) % DEFERRED_WRITER_BLOCKS;
+        _fill = 0;
+    }
+    lockState();
+    if (len) {
+        _lengths[block] = len;
+        ++_queued;
+    }
+    if (closing) {
+        _then = then;
+        _closing = true;
+    }
+    bool start = !_draining;
+    _draining = true;
+    unlockState();
+    if (!start) return; // The running drain job picks it up
+
+    reapExits();
+    ++_jobsOut;
+    if (!deferWork(_name, drain, this)) {
+        --_jobsOut;
+        drainBlocks(); // Inline, as before there was a worker
+    }
+}
+
+// Writes queued blocks until there are none, then runs the completion if finish() asked for one
+void deferredWriter::drainBlocks() {
+    for (;;) {
+        lockState();
+        if (_cancelled) {
+            _queued = 0;
+            _closing = false;
+        }
+        if (_queued == 0) {
+            deferredJob then = _closing ? _then : nullptr;
+            _closing = false;
+            if (!then) {
+                _draining = false;
+                unlockState();
+                return;
+            }
+            unlockState();
+            then(_context);
+            continue;
+        }
+        size_t block = _head;
+        size_t len = _lengths[block];
+        unlockState();
+
+        if (!_failed && !_sink(_context, _blocks + block * _blockSize, len)) _failed = true;
+
+        lockState();
+        _head = (block + 1) % DEFERRED_WRITER_BLOCKS;
+        --_queued;
+        unlockState();
+    }
+}
+
+void deferredWriter::drain(void* self) {
+    deferredWriter* w = static_cast<deferredWriter*>(self);
+    w->drainBlocks();
+    // Last touch: the owner may free us once it has taken this
+#if defined(ESP32)
+    xSemaphoreGive(w->_exited);
+#else
+    std::lock_guard<std::mutex> guard(w->_exitLock);
+    ++w->_exits;
+    w->_exitSignal.notify_one(); // Under the lock, so end() cannot return before we are done with w
+#endif
+}
+
+// Exits already signalled; keeps the count of outstanding ones small without waiting
+void deferredWriter::reapExits() {
+#if defined(ESP32)
+    while (_jobsOut && xSemaphoreTake(_exited, 0) == pdTRUE) --_jobsOut;
+#else
+    std::lock_guard<std::mutex> guard(_exitLock);
+    _jobsOut -= _exits;
+    _exits = 0;
+#endif
+}
+
+void deferredWriter::awaitExit() {
+#if defined(ESP32)
+    xSemaphoreTake(_exited, portMAX_DELAY);
+#else
+    std::unique_lock<std::mutex> guard(_exitLock);
+    _exitSignal.wait(guard, [this] { return _exits > 0; });
+    --_exits;
+#endif
+    --_jobsOut;
+}
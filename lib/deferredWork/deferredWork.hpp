@@ -0,0 +1,182 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+/**
+ * @brief Slow work that web handlers must not do themselves, flash writes
+ * above all: every connection is served by the one async_tcp task, so a
+ * callback that waits on flash stalls them all. Handlers queue a job and
+ * return; one worker task runs the jobs in order, below the network tasks.
+ *
+ * The queue holds DEFERRED_WORK_SLOTS jobs and never grows. deferWork()
+ * returns false when it is full or the worker is not running, and the caller
+ * decides: do it inline as before, or answer 503. Jobs are a function and a
+ * context pointer, so queueing does not allocate.
+ *
+ * ESP32: a FreeRTOS queue and task. Host: a thread, so benches see the same
+ * concurrency.
+ */
+
+#ifndef DEFERRED_WORK_SLOTS
+#define DEFERRED_WORK_SLOTS 8
+#endif
+
+#ifndef DEFERRED_WORK_STACK
+#define DEFERRED_WORK_STACK 6144 // Update.write() and SPIFFS writes run on it
+#endif
+
+#ifndef DEFERRED_WORK_PRIORITY
+#define DEFERRED_WORK_PRIORITY 1 // loop() runs at 1, async_tcp at 3, the WiFi task above that
+#endif
+
+typedef void (*deferredJob)(void* context);
+
+struct deferredWorkStats {
+    uint32_t queued = 0;
+    uint32_t completed = 0;
+    uint32_t refused = 0;    // Queue full or worker not running
+    uint32_t peakDepth = 0;
+    uint32_t longestUs = 0;  // Longest single job
+    const char* longestName = "";
+    uint32_t writerWaits = 0;  // deferredWriter::write() calls that went past room() and waited
+    uint32_t writerWaitUs = 0; // Time they spent waiting
+};
+
+bool deferredWorkBegin(); // Starts the worker once; true while it runs
+bool deferredWorkRunning();
+bool deferWork(const char* name, deferredJob job, void* context); // name must outlive the job
+deferredWorkStats deferredWorkGetStats();
+uint32_t deferredWorkDepth(); // Queued and not started yet
+void deferredWorkYield();     // Let the worker run while waiting on it
+size_t deferredWorkStatsToJson(char* out, size_t cap); // 0 when it does not fit
+
+#ifndef DEFERRED_WRITER_BLOCKS
+#define DEFERRED_WRITER_BLOCKS 4 // Per writer: one block filling, the others queued for the worker
+#endif
+
+/**
+ * @brief Buffered writes to a slow sink through the worker, without waiting on it.
+ *
+ * write() copies into a ring of DEFERRED_WRITER_BLOCKS blocks; each full block
+ * is queued for the worker while the next one fills. finish() queues the
+ * partial last block together with a completion job, so neither call waits on
+ * the sink. room() is what write() takes without waiting: a caller fed faster
+ * than the sink drains (an upload over a fast network) has to hold the sender
+ * off, e.g. by delaying TCP acks, until room() comes back. Writing past room()
+ * waits for the worker rather than lose data, and is counted in the stats.
+ * Without a worker (or with the queue full) blocks are written inline, as
+ * before. Sink errors show up on a later write() and in failed(). The sink is
+ * only ever called from one task at a time; end() before touching what it
+ * writes to.
+ */
+class deferredWriter {
+public:
+    typedef bool (*sinkFn)(void* context, const uint8_t* data, size_t len);
+
+    // name shows up in the worker's longest-job stats
+    deferredWriter(const char* name, size_t blockSize, sinkFn sink, void* context)
+        : _name(name), _blockSize(blockSize), _sink(sink), _context(context) {
+#if defined(ESP32)
+        _exited = xSemaphoreCreateCountingStatic(DEFERRED_WRITER_BLOCKS, 0, &_exitedBuffer);
+#endif
+    }
+    ~deferredWriter() { end(); }
+
+    bool begin();                                // Allocates the ring
+    void end();                                  // Drops queued blocks, waits for the worker to let go, frees the ring
+    bool write(const uint8_t* data, size_t len); // false once any block failed
+    bool finish(deferredJob then);               // Queues the rest; then(context) runs once it is written, on the worker
+    size_t room() const;                         // Bytes write() takes without waiting
+    bool failed() const { return _failed.load(); }
+    uint32_t waits() const { return _waits; }    // Writes that went past room() and waited
+
+private:
+    deferredWriter(const deferredWriter&) = delete;
+    deferredWriter& operator=(const deferredWriter&) = delete;
+
+    static void drain(void* self);
+    void drainBlocks();
+    void handOver(size_t len, deferredJob then, bool closing);
+    bool blockFree() const;
+    void waitForBlock();
+    void reapExits();
+    void awaitExit();
+
+    const char* _name;
+    size_t _blockSize;
+    sinkFn _sink;
+    void* _context;
+    uint8_t* _blocks = nullptr;
+    std::atomic<bool> _failed{false};
+    uint32_t _waits = 0;
+
+    // Owner side only
+    size_t _fillBlock = 0; // Block being filled
+    size_t _fill = 0;
+    uint32_t _jobsOut = 0; // Drain jobs started whose exit has not been taken yet
+
+    // Shared with the worker, under the state lock
+    size_t _lengths[DEFERRED_WRITER_BLOCKS] = {};
+    size_t _head = 0;   // Next block for the sink
+    size_t _queued = 0; // Full blocks, including the one being written
+    bool _draining = false;
+    bool _closing = false;
+    bool _cancelled = false;
+    deferredJob _then = nullptr;
+
+#if defined(ESP32)
+    mutable portMUX_TYPE _state = portMUX_INITIALIZER_UNLOCKED;
+    void lockState() const { portENTER_CRITICAL(&_state); }
+    void unlockState() const { portEXIT_CRITICAL(&_state); }
+#else
+    mutable std::atomic_flag _state = ATOMIC_FLAG_INIT;
+    void lockState() const { while (_state.test_and_set(std::memory_order_acquire)) {} }
+    void unlockState() const { _state.clear(std::memory_order_release); }
+#endif
+
+    // Given once by every drain job as its last touch; end() takes them all before freeing
+#if defined(ESP32)
+    StaticSemaphore_t _exitedBuffer;
+    SemaphoreHandle_t _exited;
+#else
+    std::mutex _exitLock;
+    std::condition_variable _exitSignal;
+    uint32_t _exits = 0;
+#endif
+};
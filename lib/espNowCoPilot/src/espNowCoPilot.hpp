@@ -16,6 +16,9 @@
 #include <pairingManager.hpp>
 #include <radioInterface.hpp>
 #include <globalConstants.h>
+#include <packetCipher.hpp>
+#include <packetTagger.hpp>
+#include <packetTrace.hpp>
 
 template <typename T>
 class espNowCoPilot : public radioInterface {
@@ -37,6 +40,9 @@ class espNowCoPilot : public radioInterface {
 
     static uint8_t _channel;
 public:
+    // Sees every received frame first (e.g. configSync); returns true when it took the frame
+    using FrameHook = bool (*)(const uint8_t* mac, const uint8_t* data, int len, void* context);
+
     espNowCoPilot(pairingManager* pairing,
                   ringBuffer<T, DEVICE_MSG_BUFFER_SIZE>* rx = nullptr,
                   ringBuffer<T, DEVICE_MSG_BUFFER_SIZE>* tx = nullptr);
@@ -49,10 +55,23 @@ public:
 
         // 🔗 Implement interface method
     bool addPeer(const uint8_t* mac, uint8_t channel, const uint8_t* lmk = nullptr) override;
+    void forgetPeer(const uint8_t* mac) override;
+    bool sendFrame(const uint8_t* mac, const uint8_t* data, size_t len) override;
 
     ringBuffer<T, DEVICE_MSG_BUFFER_SIZE>* getRXQueue();
     ringBuffer<T, DEVICE_MSG_BUFFER_SIZE>* getTXQueue();
 
+    // Application-layer AEAD for broadcast and peers without hardware encryption
+    void setCipher(packetCipher* c);
+    packetCipher* getCipher() const { return cipher; }
+
+    // SipHash short tag on frames that go out in cleartext
+    void setTagger(packetTagger* t);
+    packetTagger* getTagger() const { return tagger; }
+
+    // Variable-length frames that are not a T; runs in the WiFi task, so keep it short
+    void setFrameHook(FrameHook hook, void* context = nullptr) { frameHook = hook; frameHookContext = context; }
+
     static espNowCoPilot<T>* instance;
 
 private:
@@ -61,6 +80,12 @@ private:
     bool ownsQueues = false;
 
     pairingManager* pairingRef = nullptr;
+    packetCipher* cipher = nullptr;
+    packetTagger* tagger = nullptr;
+    FrameHook frameHook = nullptr;
+    void* frameHookContext = nullptr;
+
+    bool needsAppCrypto(const uint8_t* mac) const;
 
     static void onReceive(const uint8_t* mac, const uint8_t* data, int len);
     static void onSend(const uint8_t* mac, esp_now_send_status_t status);
@@ -3,6 +3,8 @@
 template <typename T>
 espNowCoPilot<T>* espNowCoPilot<T>::instance = nullptr;
 
+static const uint8_t espNowBroadcastAddr[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
 template <typename T>
 espNowCoPilot<T>::espNowCoPilot(pairingManager* pairing,
                                 ringBuffer<T, DEVICE_MSG_BUFFER_SIZE>* rx,
@@ -44,16 +46,34 @@ bool espNowCoPilot<T>::begin(uint8_t channel, wifi_mode_t mode, bool verbose) {
 
 template <typename T>
 void espNowCoPilot<T>::onReceive(const uint8_t* mac, const uint8_t* data, int len) {
-    if (!instance || !instance->rxQueue || len != sizeof(T)) return;
+    if (!instance) return;
+    if (instance->frameHook && instance->frameHook(mac, data, len, instance->frameHookContext)) {
+        packetTraceRecord(PACKET_RX_FRAME, mac, data, len);
+        return;
+    }
+    if (!instance->rxQueue || len != sizeof(T)) {
+        packetTraceRecord(PACKET_RX_REJECTED, mac, data, len);
+        return;
+    }
 
     T pkt;
     memcpy(&pkt, data, sizeof(T));
     // memcpy(pkt.senderMac, mac, 6);  // Optional if T has sender MAC
-    instance->rxQueue->push(pkt);
+    // Both checks run before queueing; failures are counted in rejectCount().
+    // Without a cipher nothing can open a sealed frame, so the flag alone is grounds to drop it.
+    if ((instance->cipher ? !aeadOpen(*instance->cipher, pkt, mac) : aeadFlagged(pkt)) ||
+        (instance->tagger && !tagVerify(*instance->tagger, pkt))) {
+        packetTraceRecord(PACKET_RX_REJECTED, mac, data, len);
+        return;
+    }
+    bool queued = instance->rxQueue->push(pkt);
+    packetTraceQueued(PACKET_QUEUE_RX, queued);
+    packetTraceRecord(queued ? PACKET_RX : PACKET_RX_DROPPED, mac, data, len);
 }
 
 template <typename T>
 void espNowCoPilot<T>::onSend(const uint8_t* mac, esp_now_send_status_t status) {
+    packetTraceRecord(status == ESP_NOW_SEND_SUCCESS ? PACKET_TX_ACKED : PACKET_TX_FAILED, mac, nullptr, 0);
     if (status != ESP_NOW_SEND_SUCCESS) {
         Serial.println("⚠️ ESP-NOW send failed");
     }
@@ -65,6 +85,7 @@ void espNowCoPilot<T>::loop() {
 
     T pkt;
     if (txQueue && txQueue->pop(pkt)) {
+        packetTraceDequeued(PACKET_QUEUE_TX);
         const uint8_t* mac = pairingRef->getPeerMac();
         sendEspNow(mac, pkt);
     }
@@ -72,7 +93,59 @@ void espNowCoPilot<T>::loop() {
 
 template <typename T>
 bool espNowCoPilot<T>::sendEspNow(const uint8_t* mac, const T& pkt) {
-    return esp_now_send(mac, reinterpret_cast<const uint8_t*>(&pkt), sizeof(T)) == ESP_OK;
+    bool sent = false;
+    if (cipher && needsAppCrypto(mac)) {
+        T sealed = pkt;
+        if (aeadSeal(*cipher, sealed, mac)) {
+            // Peers that did not fit in the ESP-NOW peer list are reached via broadcast;
+            // only the holder of the peer key can open the frame
+            const uint8_t* dest = (mac && !esp_now_is_peer_exist(mac)) ? espNowBroadcastAddr : mac;
+            sent = esp_now_send(dest, reinterpret_cast<const uint8_t*>(&sealed), sizeof(T)) == ESP_OK;
+        }
+    } else if (tagger) {
+        T tagged = pkt;
+        sent = tagSign(*tagger, tagged) &&
+               esp_now_send(mac, reinterpret_cast<const uint8_t*>(&tagged), sizeof(T)) == ESP_OK;
+    } else {
+        sent = esp_now_send(mac, reinterpret_cast<const uint8_t*>(&pkt), sizeof(T)) == ESP_OK;
+    }
+    packetTraceRecord(sent ? PACKET_TX : PACKET_TX_ERROR, mac, reinterpret_cast<const uint8_t*>(&pkt), sizeof(T));
+    return sent;
+}
+
+template <typename T>
+bool espNowCoPilot<T>::sendFrame(const uint8_t* mac, const uint8_t* data, size_t len) {
+    if (memcmp(mac, espNowBroadcastAddr, 6) == 0 && !esp_now_is_peer_exist(espNowBroadcastAddr)) {
+        addPeer(espNowBroadcastAddr, 0, nullptr);
+    }
+    bool sent = esp_now_send(mac, data, len) == ESP_OK;
+    packetTraceRecord(sent ? PACKET_TX : PACKET_TX_ERROR, mac, data, len);
+    return sent;
+}
+
+template <typename T>
+bool espNowCoPilot<T>::needsAppCrypto(const uint8_t* mac) const {
+    if (!mac) return true;  // nullptr sends to every peer, encrypted or not
+
+    esp_now_peer_info_t info;
+    if (esp_now_get_peer(mac, &info) != ESP_OK) return true;
+    return !info.encrypt;
+}
+
+template <typename T>
+void espNowCoPilot<T>::setCipher(packetCipher* c) {
+    cipher = c;
+    if (tagger) tagger->setCipher(cipher);
+    if (cipher && !esp_now_is_peer_exist(espNowBroadcastAddr)) {
+        addPeer(espNowBroadcastAddr, 0, nullptr);
+    }
+}
+
+template <typename T>
+void espNowCoPilot<T>::setTagger(packetTagger* t) {
+    tagger = t;
+    // onReceive() opens sealed frames before the tag check, so the tagger may let them through
+    if (tagger) tagger->setCipher(cipher);
 }
 
 template <typename T>
@@ -84,12 +157,24 @@ bool espNowCoPilot<T>::addPeer(const uint8_t* mac, uint8_t channel, const uint8_
     peerInfo.encrypt = (lmk != nullptr);
     if (lmk) memcpy(peerInfo.lmk, lmk, 16);
     peerInfo.ifidx = WIFI_IF_AP;
+    if (esp_now_is_peer_exist(mac)) {
+        // e.g. LMK rotation: the sender keeps counting, so its window stays; re-pairing calls forgetPeer()
+        return esp_now_mod_peer(&peerInfo) == ESP_OK;
+    }
+    forgetPeer(mac);  // Nothing seen from it yet that a window should hold against it
     return esp_now_add_peer(&peerInfo) == ESP_OK;
 #else
     return false;
 #endif
 }
 
+template <typename T>
+void espNowCoPilot<T>::forgetPeer(const uint8_t* mac) {
+    // After a reboot the sender counts from a new random start
+    if (cipher) cipher->replay().forget(mac);
+    if (tagger) tagger->replay().forget(mac);
+}
+
 template <typename T>
 ringBuffer<T, DEVICE_MSG_BUFFER_SIZE>* espNowCoPilot<T>::getRXQueue() { return rxQueue; }
 
@@ -0,0 +1,63 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Coalesces bursts of "something changed" events into a single action.
+ *
+ * The timer fires once the source has been quiet for `quietMs`, or once
+ * `maxDelayMs` has passed since the first unflushed change, whichever comes
+ * first. Timestamps are plain millis() values so it works on host builds too.
+ */
+class debounceTimer {
+public:
+    debounceTimer(unsigned long quietMs, unsigned long maxDelayMs)
+        : quietMs(quietMs), maxDelayMs(maxDelayMs) {}
+
+    void markDirty(unsigned long now) {
+        if (!dirty) firstChange = now;
+        lastChange = now;
+        dirty = true;
+    }
+
+    bool isDirty() const { return dirty; }
+
+    bool due(unsigned long now) const {
+        if (!dirty) return false;
+        return (now - lastChange >= quietMs) || (now - firstChange >= maxDelayMs);
+    }
+
+    void clear() { dirty = false; }
+
+private:
+    unsigned long quietMs;
+    unsigned long maxDelayMs;
+    unsigned long firstChange = 0;
+    unsigned long lastChange = 0;
+    bool dirty = false;
+};
@@ -7,5 +7,7 @@ enum class CommandCode : uint8_t {
     PairAccept   = 0x02,
     Heartbeat    = 0x03,
     Ack          = 0x04,
+    KeyRotate    = 0x05,
+    KeyConfirm   = 0x06,  // Worker's answer to PairAccept / KeyRotate, proving it derived the offered key
     // Add more as needed...
 };
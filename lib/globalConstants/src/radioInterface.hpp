@@ -1,9 +1,15 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
 
 class radioInterface {
 public:
+    // Adds mac, or replaces its LMK in place (rotation keeps the peer's replay state)
     virtual bool addPeer(const uint8_t* mac, uint8_t channel, const uint8_t* lmk = nullptr) = 0;
+    // The peer (re)paired and counts from a new start: drop what the replay windows remember of it
+    virtual void forgetPeer(const uint8_t* mac) = 0;
+    // As-is to mac (broadcast allowed), outside the tx queue and the packet cipher
+    virtual bool sendFrame(const uint8_t* mac, const uint8_t* data, size_t len) = 0;
     virtual ~radioInterface() = default;
 };
\ No newline at end of file
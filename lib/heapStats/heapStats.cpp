@@ -0,0 +1,313 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "heapStats.hpp"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(ESP32)
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+static portMUX_TYPE heapLock = portMUX_INITIALIZER_UNLOCKED;
+#define HEAP_LOCK() portENTER_CRITICAL(&heapLock)
+#define HEAP_UNLOCK() portEXIT_CRITICAL(&heapLock)
+#else
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+static std::atomic_flag heapLock = ATOMIC_FLAG_INIT;
+#define HEAP_LOCK() while (heapLock.test_and_set(std::memory_order_acquire)) {}
+#define HEAP_UNLOCK() heapLock.clear(std::memory_order_release)
+#endif
+
+static_assert((HEAP_STATS_SLOTS & (HEAP_STATS_SLOTS - 1)) == 0, "HEAP_STATS_SLOTS must be a power of two");
+
+namespace {
+
+constexpr uint32_t SIZE_MASK = 0x00FFFFFF; // Tag lives in the top byte
+constexpr size_t SLOT_MASK = HEAP_STATS_SLOTS - 1;
+constexpr size_t SLOTS_USABLE = HEAP_STATS_SLOTS / 4 * 3; // Keeps linear probes short
+
+struct slot {
+    uintptr_t ptr;
+    uint32_t sizeTag;
+};
+
+slot table[HEAP_STATS_SLOTS];
+size_t used = 0;
+heapTagStats tags[HEAP_TAG_COUNT];
+uint32_t untracked = 0;
+uint32_t largestFreeLow = UINT32_MAX;
+
+const char* const TAG_NAMES[HEAP_TAG_COUNT] = {"none", "config", "html", "webui", "beacon", "sync"};
+
+size_t home(uintptr_t ptr) {
+    uint32_t h = static_cast<uint32_t>(ptr >> 3) * 2654435761u;
+    return (h ^ (h >> 16)) & SLOT_MASK;
+}
+
+uint8_t currentTag() {
+#if defined(ESP32)
+    // Thread-local storage is only set up per task; early boot allocations go unaccounted
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) return HEAP_TAG_NONE;
+#endif
+    return heapCurrentTag();
+}
+
+// Callers hold the lock
+void insertLocked(uintptr_t ptr, size_t size, uint8_t tag) {
+    if (used >= SLOTS_USABLE || size > SIZE_MASK) {
+        ++untracked;
+        return;
+    }
+    size_t i = home(ptr);
+    while (table[i].ptr) i = (i + 1) & SLOT_MASK;
+    table[i].ptr = ptr;
+    table[i].sizeTag = static_cast<uint32_t>(size) | (static_cast<uint32_t>(tag) << 24);
+    ++used;
+
+    heapTagStats& s = tags[tag];
+    s.currentBytes += size;
+    if (s.currentBytes > s.peakBytes) s.peakBytes = s.currentBytes;
+    ++s.blocks;
+    ++s.allocations;
+}
+
+bool removeLocked(uintptr_t ptr, uint32_t& size, uint8_t& tag) {
+    size_t i = home(ptr);
+    while (table[i].ptr != ptr) {
+        if (!table[i].ptr) return false;
+        i = (i + 1) & SLOT_MASK;
+    }
+    size = table[i].sizeTag & SIZE_MASK;
+    tag = static_cast<uint8_t>(table[i].sizeTag >> 24);
+
+    // Backward-shift deletion: pull later entries of the probe run into the hole
+    for (size_t j = (i + 1) & SLOT_MASK; table[j].ptr; j = (j + 1) & SLOT_MASK) {
+        size_t k = home(table[j].ptr);
+        bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+        if (!stays) {
+            table[i] = table[j];
+            i = j;
+        }
+    }
+    table[i].ptr = 0;
+    --used;
+
+    heapTagStats& s = tags[tag];
+    s.currentBytes -= size;
+    --s.blocks;
+    ++s.frees;
+    return true;
+}
+
+} // namespace
+
+const char* heapTagName(heapTag tag) {
+    return tag < HEAP_TAG_COUNT ? TAG_NAMES[tag] : "?";
+}
+
+void heapStatsRecordAlloc(void* ptr, size_t size) {
+    if (!ptr) return;
+    uint8_t tag = currentTag();
+    if (tag == HEAP_TAG_NONE || tag >= HEAP_TAG_COUNT) return;
+    HEAP_LOCK();
+    insertLocked(reinterpret_cast<uintptr_t>(ptr), size, tag);
+    HEAP_UNLOCK();
+}
+
+void heapStatsRecordFree(void* ptr) {
+    // Unlocked peek: a block being freed cannot be mid-insert on another core
+    if (!ptr || used == 0) return;
+    uint32_t size;
+    uint8_t tag;
+    HEAP_LOCK();
+    removeLocked(reinterpret_cast<uintptr_t>(ptr), size, tag);
+    HEAP_UNLOCK();
+}
+
+heapTagStats heapStatsGet(heapTag tag) {
+    heapTagStats copy;
+    if (tag >= HEAP_TAG_COUNT) return copy;
+    HEAP_LOCK();
+    copy = tags[tag];
+    HEAP_UNLOCK();
+    return copy;
+}
+
+heapSystemStats heapStatsSystem() {
+    heapSystemStats s;
+#if defined(ESP32)
+    s.freeBytes = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    s.minFreeBytes = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    s.largestFreeBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+#endif
+    HEAP_LOCK();
+    s.largestFreeLow = largestFreeLow == UINT32_MAX ? s.largestFreeBlock : largestFreeLow;
+    s.untracked = untracked;
+    HEAP_UNLOCK();
+    return s;
+}
+
+void heapStatsSample() {
+#if defined(ESP32)
+    uint32_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    HEAP_LOCK();
+    if (largest < largestFreeLow) largestFreeLow = largest;
+    HEAP_UNLOCK();
+#endif
+}
+
+bool heapStatsLoop(unsigned long now, unsigned long dumpEveryMs) {
+    static unsigned long lastSample = 0;
+    static unsigned long lastDump = 0;
+    if (now - lastSample >= 1000) {
+        lastSample = now;
+        heapStatsSample();
+    }
+    if (dumpEveryMs == 0 || now - lastDump < dumpEveryMs) return false;
+    lastDump = now;
+    heapStatsDump();
+    return true;
+}
+
+void heapStatsResetPeaks() {
+    HEAP_LOCK();
+    for (heapTagStats& s : tags) s.peakBytes = s.currentBytes;
+    largestFreeLow = UINT32_MAX;
+    HEAP_UNLOCK();
+    heapStatsSample();
+}
+
+void heapStatsDump() {
+    Serial.printf("🧮 Heap by subsystem\n");
+    Serial.printf("   %-8s %9s %9s %7s %9s %9s\n", "tag", "current", "peak", "blocks", "allocs", "frees");
+    for (uint8_t t = HEAP_TAG_NONE + 1; t < HEAP_TAG_COUNT; ++t) {
+        heapTagStats s = heapStatsGet(static_cast<heapTag>(t));
+        Serial.printf("   %-8s %9u %9u %7u %9u %9u\n", TAG_NAMES[t], (unsigned)s.currentBytes,
+                      (unsigned)s.peakBytes, (unsigned)s.blocks, (unsigned)s.allocations, (unsigned)s.frees);
+    }
+    heapSystemStats h = heapStatsSystem();
+    Serial.printf("   heap free %u, min free %u, largest block %u (low %u), untracked allocs %u\n",
+                  (unsigned)h.freeBytes, (unsigned)h.minFreeBytes, (unsigned)h.largestFreeBlock,
+                  (unsigned)h.largestFreeLow, (unsigned)h.untracked);
+}
+
+size_t heapStatsToJson(char* out, size_t cap) {
+    size_t len = 0;
+    auto append = [&](const char* fmt, unsigned a, unsigned b, unsigned c, unsigned d, unsigned e,
+                      const char* name) {
+        if (len >= cap) return;
+        int n = name ? snprintf(out + len, cap - len, fmt, name, a, b, c, d, e)
+                     : snprintf(out + len, cap - len, fmt, a, b, c, d, e);
+        len = n < 0 ? cap : len + static_cast<size_t>(n);
+    };
+
+    if (cap) out[0] = '\0';
+    append("{\"tags\":{", 0, 0, 0, 0, 0, nullptr);
+    for (uint8_t t = HEAP_TAG_NONE + 1; t < HEAP_TAG_COUNT; ++t) {
+        heapTagStats s = heapStatsGet(static_cast<heapTag>(t));
+        append(t > 1 ? ",\"%s\":{\"current\":%u,\"peak\":%u,\"blocks\":%u,\"allocations\":%u,\"frees\":%u}"
+                     : "\"%s\":{\"current\":%u,\"peak\":%u,\"blocks\":%u,\"allocations\":%u,\"frees\":%u}",
+               s.currentBytes, s.peakBytes, s.blocks, s.allocations, s.frees, TAG_NAMES[t]);
+    }
+    heapSystemStats h = heapStatsSystem();
+    append("},\"heap\":{\"free\":%u,\"minFree\":%u,\"largestFree\":%u,\"largestFreeLow\":%u,\"untracked\":%u}}",
+           h.freeBytes, h.minFreeBytes, h.largestFreeBlock, h.largestFreeLow, h.untracked, nullptr);
+    return len < cap ? len : 0;
+}
+
+// ---- Allocator hooks ----------------------------------------------------------
+
+#if defined(ESP32) && defined(HEAP_STATS_WRAP_MALLOC)
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+void* __wrap_malloc(size_t size) {
+    void* ptr = __real_malloc(size);
+    heapStatsRecordAlloc(ptr, size);
+    return ptr;
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    void* ptr = __real_calloc(count, size);
+    heapStatsRecordAlloc(ptr, count * size);
+    return ptr;
+}
+
+// A grown String stays with the subsystem that owns it, even outside its scope
+void* __wrap_realloc(void* ptr, size_t size) {
+    uint32_t oldSize = 0;
+    uint8_t tag = HEAP_TAG_NONE;
+    bool tracked = false;
+    if (ptr && used) {
+        HEAP_LOCK();
+        tracked = removeLocked(reinterpret_cast<uintptr_t>(ptr), oldSize, tag);
+        HEAP_UNLOCK();
+    }
+    void* grown = __real_realloc(ptr, size);
+    void* keep = grown ? grown : (size ? ptr : nullptr); // On failure the old block is still live
+    size_t keepSize = grown ? size : oldSize;
+    if (!tracked) tag = currentTag();
+    if (keep && tag != HEAP_TAG_NONE && (tracked || grown)) {
+        HEAP_LOCK();
+        insertLocked(reinterpret_cast<uintptr_t>(keep), keepSize, tag);
+        HEAP_UNLOCK();
+    }
+    return grown;
+}
+
+void __wrap_free(void* ptr) {
+    heapStatsRecordFree(ptr);
+    __real_free(ptr);
+}
+}
+#elif !defined(ESP32)
+// Host: the String shim and std:: containers allocate through operator new
+void* operator new(size_t size) {
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    heapStatsRecordAlloc(ptr, size);
+    return ptr;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    void* ptr = malloc(size ? size : 1);
+    heapStatsRecordAlloc(ptr, size);
+    return ptr;
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete(void* ptr) noexcept {
+    heapStatsRecordFree(ptr);
+    free(ptr);
+}
+void operator delete[](void* ptr) noexcept { operator delete(ptr); }
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { operator delete(ptr); }
+#endif
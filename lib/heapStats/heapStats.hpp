@@ -0,0 +1,115 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Per-subsystem heap accounting.
+ *
+ * Code marks the work it does with a heapScope; every block allocated while
+ * the scope is open is charged to its tag until that block is freed, whoever
+ * frees it (a rendered page released by the web server after sending still
+ * comes off the htmlRenderer count). Per tag we keep current and peak bytes,
+ * live blocks, and allocation/free counts; heap-wide we sample free bytes and
+ * the largest free block, whose low-water mark is what a fragmented heap
+ * shows first.
+ *
+ * Scopes are header-only and cost one thread-local write, so libraries can
+ * use them without linking heapStats.cpp. The accounting itself needs an
+ * allocator hook from heapStats.cpp:
+ *   ESP32: link with -DHEAP_STATS_WRAP_MALLOC -Wl,--wrap=malloc,--wrap=free,
+ *          --wrap=realloc,--wrap=calloc (String, std:: containers and new all
+ *          end up in malloc)
+ *   host:  heapStats.cpp replaces the global operator new/delete, which is
+ *          where the host String shim allocates.
+ *
+ * Tagged blocks are remembered in a fixed table of HEAP_STATS_SLOTS entries;
+ * allocations that do not fit are counted as untracked, never charged twice.
+ */
+
+#ifndef HEAP_STATS_SLOTS
+#define HEAP_STATS_SLOTS 1024 // Power of two; 8 bytes each on the ESP32
+#endif
+
+enum heapTag : uint8_t {
+    HEAP_TAG_NONE = 0, // Not accounted
+    HEAP_TAG_CONFIG,
+    HEAP_TAG_HTML,
+    HEAP_TAG_WEBUI,
+    HEAP_TAG_BEACON,
+    HEAP_TAG_SYNC,
+    HEAP_TAG_COUNT
+};
+
+struct heapTagStats {
+    uint32_t currentBytes = 0;
+    uint32_t peakBytes = 0;
+    uint32_t blocks = 0;      // Live blocks
+    uint32_t allocations = 0;
+    uint32_t frees = 0;
+};
+
+struct heapSystemStats {
+    uint32_t freeBytes = 0;        // 0 on the host: no allocator introspection
+    uint32_t minFreeBytes = 0;
+    uint32_t largestFreeBlock = 0;
+    uint32_t largestFreeLow = 0;   // Smallest largest-free-block seen by heapStatsSample()
+    uint32_t untracked = 0;        // Tagged allocations the table had no room for
+};
+
+// Scope tag for the calling task; a function-local static keeps it C++11 and single-instance
+inline uint8_t& heapCurrentTag() {
+    static thread_local uint8_t tag = HEAP_TAG_NONE;
+    return tag;
+}
+
+class heapScope {
+public:
+    explicit heapScope(heapTag tag) : previous(heapCurrentTag()) { heapCurrentTag() = tag; }
+    ~heapScope() { heapCurrentTag() = previous; }
+    heapScope(const heapScope&) = delete;
+    heapScope& operator=(const heapScope&) = delete;
+
+private:
+    uint8_t previous;
+};
+
+const char* heapTagName(heapTag tag);
+
+// Allocator hooks, called by the wrappers in heapStats.cpp
+void heapStatsRecordAlloc(void* ptr, size_t size);
+void heapStatsRecordFree(void* ptr);
+
+heapTagStats heapStatsGet(heapTag tag);
+heapSystemStats heapStatsSystem();
+void heapStatsSample();                 // Refresh the largest-free-block low-water mark
+bool heapStatsLoop(unsigned long now, unsigned long dumpEveryMs); // Samples each second; true when it dumped
+void heapStatsResetPeaks();             // Peaks restart from the current bytes
+void heapStatsDump();                   // Table on Serial
+size_t heapStatsToJson(char* out, size_t cap); // 0 when it does not fit
@@ -0,0 +1,144 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "htmlRenderCache.h"
+#include <heapStats.hpp>
+#if defined(ESP32)
+#include <esp_heap_caps.h>
+#endif
+
+htmlRenderCache::htmlRenderCache(size_t budget)
+{
+#if defined(ESP32)
+    _psram = psramFound();
+#else
+    _psram = false;
+#endif
+    _budget = budget ? budget : _psram ? HTML_RENDER_CACHE_PSRAM_BYTES : HTML_RENDER_CACHE_HEAP_BYTES;
+}
+
+htmlRenderCache::~htmlRenderCache()
+{
+    clear();
+}
+
+uint8_t *htmlRenderCache::allocate(size_t length) const
+{
+#if defined(ESP32)
+    if (_psram)
+        return static_cast<uint8_t *>(heap_caps_malloc(length, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+#endif
+    return static_cast<uint8_t *>(malloc(length));
+}
+
+void htmlRenderCache::release(entry &e)
+{
+    free(e.data); // Also right for heap_caps_malloc() memory
+    _stats.bytes -= e.length;
+    e.data = nullptr;
+    e.length = 0;
+}
+
+bool htmlRenderCache::evictFor(size_t length)
+{
+    while (_stats.bytes + length > _budget && !_entries.empty())
+    {
+        auto oldest = _entries.begin();
+        for (auto it = _entries.begin(); it != _entries.end(); ++it)
+        {
+            if (it->second.lastUse < oldest->second.lastUse)
+                oldest = it;
+        }
+        // Pages are read part by part, front to back, twice per request (ETag, body).
+        // Pushing out an entry the next request reads again would make a page that
+        // overflows the budget miss on every part; only entries left idle go.
+        if (_clock - oldest->second.lastUse < HTML_RENDER_CACHE_IDLE_SERVES)
+            return false;
+        release(oldest->second);
+        _entries.erase(oldest);
+        ++_stats.evictions;
+    }
+    _stats.entries = _entries.size();
+    return true;
+}
+
+void htmlRenderCache::clear()
+{
+    for (auto &item : _entries)
+        release(item.second);
+    _entries.clear();
+    _stats.entries = 0;
+}
+
+bool htmlRenderCache::serve(htmlWriter &out, uint8_t page, const String &key, uint32_t revision,
+                            const partRenderer &render)
+{
+    ++_clock;
+    std::pair<uint8_t, String> id(page, key);
+    auto found = _entries.find(id);
+    if (found != _entries.end() && found->second.revision == revision)
+    {
+        ++_stats.hits;
+        found->second.lastUse = _clock;
+        out.write(reinterpret_cast<const char *>(found->second.data), found->second.length);
+        return true;
+    }
+
+    ++_stats.misses;
+    heapScope heap(HEAP_TAG_HTML);
+    String fresh;
+    htmlStringWriter collect(fresh);
+    if (!render(collect))
+        return false;
+    out.write(fresh.c_str(), fresh.length());
+
+    if (found != _entries.end())
+    {
+        release(found->second);
+        _entries.erase(found);
+    }
+    if (fresh.length() > _budget / 4) // One big part would push everything else out
+    {
+        _stats.entries = _entries.size();
+        return true;
+    }
+    if (!evictFor(fresh.length()))
+    {
+        _stats.entries = _entries.size();
+        return true; // Served; what is cached already is worth more
+    }
+    entry e;
+    e.data = allocate(fresh.length() ? fresh.length() : 1);
+    if (!e.data)
+        return true; // Served; just not kept
+    memcpy(e.data, fresh.c_str(), fresh.length());
+    e.length = fresh.length();
+    e.revision = revision;
+    e.lastUse = _clock;
+    _entries[id] = e;
+    _stats.bytes += e.length;
+    _stats.entries = _entries.size();
+    return true;
+}
@@ -0,0 +1,98 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <map>
+#include <functional>
+#include "htmlWriter.h"
+
+// Byte budgets: roomy when the board has PSRAM, small when entries share the internal heap
+#ifndef HTML_RENDER_CACHE_PSRAM_BYTES
+#define HTML_RENDER_CACHE_PSRAM_BYTES (128 * 1024)
+#endif
+#ifndef HTML_RENDER_CACHE_HEAP_BYTES
+#define HTML_RENDER_CACHE_HEAP_BYTES (8 * 1024)
+#endif
+
+// Serves an entry must go unread before a new part may evict it
+#ifndef HTML_RENDER_CACHE_IDLE_SERVES
+#define HTML_RENDER_CACHE_IDLE_SERVES 1024
+#endif
+
+struct htmlRenderCacheStats
+{
+    uint32_t hits = 0;
+    uint32_t misses = 0;    // Rendered: not cached yet, or cached from an older revision
+    uint32_t evictions = 0; // Dropped to stay within the budget
+    uint32_t bytes = 0;     // Currently held
+    uint32_t entries = 0;
+};
+
+/**
+ * @brief Rendered page parts kept between requests.
+ *
+ * An entry is one part of one page (in practice one config section of
+ * /configs or /all), stamped with the revision of the data it was rendered
+ * from. serve() writes a matching entry straight out; anything else is
+ * rendered once, kept and then written, so editing a section re-renders only
+ * that section. Entries live in PSRAM when the board has it, otherwise on the
+ * heap under a smaller budget. When the budget is full the least recently
+ * used entry makes room if it has been idle for HTML_RENDER_CACHE_IDLE_SERVES;
+ * otherwise the new part is served without being kept.
+ */
+class htmlRenderCache
+{
+public:
+    using partRenderer = std::function<bool(htmlWriter &out)>;
+
+    explicit htmlRenderCache(size_t budget = 0); // 0: the PSRAM or heap default
+    ~htmlRenderCache();
+
+    // False when render() says the part does not exist
+    bool serve(htmlWriter &out, uint8_t page, const String &key, uint32_t revision, const partRenderer &render);
+    void clear();
+
+    const htmlRenderCacheStats &stats() const { return _stats; }
+    bool inPsram() const { return _psram; }
+
+private:
+    struct entry
+    {
+        uint8_t *data = nullptr;
+        size_t length = 0;
+        uint32_t revision = 0;
+        uint32_t lastUse = 0;
+    };
+    std::map<std::pair<uint8_t, String>, entry> _entries;
+    size_t _budget;
+    bool _psram;
+    uint32_t _clock = 0; // Counts serve() calls
+    htmlRenderCacheStats _stats;
+
+    void release(entry &e);
+    bool evictFor(size_t length); // False: keep the current entries, do not store
+    uint8_t *allocate(size_t length) const;
+};
@@ -23,70 +23,49 @@
  */
 
 #include "htmlRenderer.h"
+#include "pageTemplates.h"
+#include <configJsonWriter.h>
+#include <iterator>
+#include <textCodec.hpp>
+#include <heapStats.hpp>
 
 htmlRenderer::htmlRenderer(const std::map<String, std::map<String, String>> *cfg) : config(cfg) {};
 
+// generate*() wrappers: the streamed page, collected into one String
+template <typename Render>
+static String collectPage(Render render)
+{
+    heapScope heap(HEAP_TAG_HTML);
+    String html;
+    htmlStringWriter out(html);
+    render(out);
+    return html;
+}
+
 htmlRenderer::~htmlRenderer() {}
 
 String htmlRenderer::generateHomePage() const
 {
-    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Home</title>") + embeddedStyle + "</head><body>";
-    html += "<h1>Main Dashboard</h1>";
-    html += "<ul>";
-    html += "<h2>\t\tℹ️\t\t<a href='/info'>Device Info</a></h2>";
-    html += "<hr>";
-    html += "<h2>\t\t🛠\t\t<a href='/configs'>Configuration Form</a></h2>";
-    html += "<h2>\t\t📃\t\t<a href='/all'>All Sections</a></h2>";
-    html += "<hr>";
-    html += "<h2>\t\t🗂\t\t<a href='/files'>View SPIFFS</a></h2>";
-    html += "<h2>\t\t📥\t\t<a href='/downloadPage'>Download from SPIFFS</a></h2>";
-    html += "<h2>\t\t📤\t\t<a href='/upload'>Upload to SPIFFS</a></h2>";
-    html += "<hr>";
-    html += "<h2>\t\t📤\t\t<a href='/firmware'>Update Firmware</a></h2>";
-    html += "<hr>";
-    html += "<h2>\t\t🔄\t\t<a href='/restart'>Restart Device</a></h2>";
-    html += "</ul>";
-    html += "</body></html>";
-    return html;
+    return collectPage([this](htmlWriter &out) { renderHomePage(out); });
+}
+
+void htmlRenderer::renderHomePage(htmlWriter &out) const
+{
+    htmlValue values[HOME_SLOTS];
+    values[HOME_STYLE] = styleLink;
+    renderTemplate(out, HOME_TEMPLATE, values);
 }
 
 String htmlRenderer::generateEspNowQrPage(const String& mac, const String& lmkHex) const {
-    String payload = "MAC=" + mac + ";LMK=" + lmkHex;
-
-    String html = String(R"rawlite(
-<!DOCTYPE html>
-<html>
-<head>
-  <meta charset="UTF-8">
-  <title>ESP-NOW QR Code</title>
-  <style>
-    body { font-family: sans-serif; background: #f6fff6; color: #2c3e50; text-align: center; padding: 2em; }
-    #qrcode { margin: 2em auto; }
-    .info { font-size: 0.9rem; color: #555; }
-  </style>
-</head>
-<body>
-  <h1>Scan to Pair</h1>
-  <div id="qrcode"></div>
-  <p class="info">MAC: )rawlite") + mac + R"rawlite(<br>LMK: )rawlite" + lmkHex + R"rawlite(</p>
-
-  <script src="https://cdn.jsdelivr.net/npm/qrcodejs@1.0.0/qrcode.min.js"></script>
-  <script>
-    const payload = ")rawlite" + payload + R"rawlite(";
-    new QRCode(document.getElementById("qrcode"), {
-      text: payload,
-      width: 256,
-      height: 256,
-      colorDark: "#000000",
-      colorLight: "#ffffff",
-      correctLevel: QRCode.CorrectLevel.H
-    });
-  </script>
-</body>
-</html>
-)rawlite";
+    return collectPage([&](htmlWriter& out) { renderEspNowQrPage(out, mac, lmkHex); });
+}
 
-    return html;
+void htmlRenderer::renderEspNowQrPage(htmlWriter& out, const String& mac, const String& lmkHex) const {
+    // The QR payload "MAC=...;LMK=..." is spelled out in the template, so nothing is concatenated here
+    htmlValue values[ESP_NOW_QR_SLOTS];
+    values[ESP_NOW_QR_MAC] = mac;
+    values[ESP_NOW_QR_LMK] = lmkHex;
+    renderTemplate(out, ESP_NOW_QR_TEMPLATE, values);
 }
 
 void htmlRenderer::printSectionData(const String &sectionName, const std::map<String, String> &sectionData) const
@@ -106,40 +85,50 @@ void htmlRenderer::printSectionData(const String &sectionName, const std::map<St
 }
 
 String htmlRenderer::generateConfigFormPage(const std::map<String, std::map<String, String>>& config, bool rowFormat) const {
+    return collectPage([&](htmlWriter& out) { renderConfigFormPage(out, config, rowFormat); });
+}
 
-    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Edit Config</title>") + embeddedStyle + "</head><body>";
-    html += "<h1>🛠 Edit Configuration</h1><form method='POST' action='/submit-section'>";
-//    html += "<table class='config-table'>\n";
+void htmlRenderer::renderConfigFormPage(htmlWriter& out, const std::map<String, std::map<String, String>>& configMap, bool rowFormat) const {
+    for (size_t part = 0; !out.full() && renderConfigFormPart(out, configMap, rowFormat, part); ++part) {}
+}
 
-//    const auto& configMap = config.getConfig();
-    const auto& configMap = config;
+// Part 0 is the head, 1..N one section each, N + 1 the tail
+bool htmlRenderer::renderConfigFormPart(htmlWriter& out, const std::map<String, std::map<String, String>>& configMap,
+                                        bool rowFormat, size_t part) const {
+    if (part == 0) {
+        out << "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Edit Config</title>" << styleLink << "</head><body>";
+        out << "<h1>🛠 Edit Configuration</h1><form method='POST' action='/submit-section'>";
+        return true;
+    }
 
-    for (const auto& section : configMap) {
-        const String& sectionName = section.first;
-        const auto& sectionData = section.second;
+    if (part <= configMap.size()) {
+        auto section = std::next(configMap.begin(), part - 1);
+        const String& sectionName = section->first;
+        const auto& sectionData = section->second;
 
         // Skip if this is a format definition section
-        if (sectionName.endsWith(".format")) continue;
+        if (sectionName.endsWith(".format")) return true;
 
-        // Look up format specifier
-        String formatID = sectionData.count("format.use") ? sectionData.at("format.use") : "";
-        const auto& formatMap = configMap.count(formatID)
-                                ? configMap.at(formatID)
-                                : std::map<String, String>();
+        // Look up format specifier (only needed when no compiled schema is attached)
+        static const std::map<String, String> noFormat;
+        auto formatID = sectionData.find("format.use");
+        auto formatSection = (schema || formatID == sectionData.end()) ? configMap.end() : configMap.find(formatID->second);
+        const auto& formatMap = formatSection != configMap.end() ? formatSection->second : noFormat;
 
-        html += renderConfigSection(sectionName, sectionData, formatMap, rowFormat);
+        renderConfigSection(out, sectionName, sectionData, formatMap, rowFormat);
+        return true;
     }
 
-    html += "</table>\n";
-    html += "<input type='submit' value='Save Configuration'>\n";
-    html += "</form>\n";
-    html += "<div style='text-align:center; margin:1.5em 0;'>"
+    if (part > configMap.size() + 1) return false;
+    out << "</table>\n";
+    out << "<input type='submit' value='Save Configuration'>\n";
+    out << "</form>\n";
+    out << "<div style='text-align:center; margin:1.5em 0;'>"
         "<a href=\"/espnow-manual.html\" target=\"_blank\" "
         "style=\"background:#003366; color:#fff; padding:0.6em 1.2em; border-radius:4px; "
         "text-decoration:none; font-weight:bold;\">"
         "📘 Open ESP-NOW Manual</a></div>";
-
-    return html;
+    return true;
 }
 
 /*!SECTION
@@ -148,7 +137,7 @@ String htmlRenderer::generateConfigFormPage(const std::map<String, std::map<Stri
         Serial.println("🔧 Starting config form generation...");
     }
 
-    String html = "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Edit Config</title>" + embeddedStyle + "</head><body>";
+    String html = "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Edit Config</title>" + styleLink + "</head><body>";
     html += "<h1>🛠 Edit Configuration</h1><form method='POST' action='/submit-section'>";
 
     for (const auto& section : *configMap) {
@@ -181,17 +170,7 @@ String htmlRenderer::renderInputField(const String& fullKey,
                                       const String& value,
                                       const String& type,
                                       const std::map<String, String>& formatMap) const {
-    String baseType = type;
-    bool isReadOnly = false;
-    bool isPassword = false;
-
-    int dotPos = type.indexOf('.');
-    if (dotPos != -1) {
-        baseType = type.substring(0, dotPos);
-        String suffix = type.substring(dotPos + 1);
-        isReadOnly = (suffix == "readonly");
-        isPassword = (suffix == "password");
-    }
+    configFieldSpec spec = configSchema::parseType(type);
 
     // Extract base key (strip section.)
     String baseKey = fullKey;
@@ -199,35 +178,79 @@ String htmlRenderer::renderInputField(const String& fullKey,
     if (dot != -1) baseKey = fullKey.substring(dot + 1);
 
     // Tooltip support
-    String tooltip = "";
     auto tooltipKey = baseKey + ".tooltip";
-    if (formatMap.count(tooltipKey)) {
-        tooltip = " title='" + formatMap.at(tooltipKey) + "'";
-    }
+    if (formatMap.count(tooltipKey)) spec.tooltip = formatMap.at(tooltipKey);
+
+    return renderInputField(fullKey, value, spec);
+}
+
+String htmlRenderer::renderInputField(const String& fullKey, const String& value, const configFieldSpec& spec) const {
+    String html;
+    htmlStringWriter out(html);
+    renderInputField(out, fullKey, String(), value, spec);
+    return html;
+}
+
+// name='section.key'; key may be empty when section already holds the full key
+void htmlRenderer::renderInputField(htmlWriter& out, const String& section, const String& key,
+                                    const String& value, const configFieldSpec& spec) const {
+    auto name = [&]() {
+        out << " name='" << section;
+        if (!key.isEmpty()) out << '.' << key;
+        out << "'";
+    };
+    auto tooltip = [&]() {
+        if (!spec.tooltip.isEmpty()) out << " title='" << spec.tooltip << "'";
+    };
 
     // Handle checkbox
-    if (baseType == "checkbox") {
+    if (spec.type == configFieldType::checkbox) {
         bool checked = (value == "true" || value == "1");
-        String html = "<input type='checkbox' name='" + fullKey + "'" + (checked ? " checked" : "");
-        if (isReadOnly) html += " disabled";
-        html += tooltip + ">";
-        if (isReadOnly) html += "<input type='hidden' name='" + fullKey + "' value='" + value + "'>";
-        return html;
+        out << "<input type='checkbox'";
+        name();
+        if (checked) out << " checked";
+        if (spec.readOnly) out << " disabled";
+        tooltip();
+        out << ">";
+        if (spec.readOnly) {
+            out << "<input type='hidden'";
+            name();
+            out << " value='" << value << "'>";
+        }
+        return;
     }
 
     // Text or password input
-    String html = "<input type='";
-    html += isPassword ? "password" : "text";
-    html += "' name='" + fullKey + "' value='" + value + "'";
-    if (isReadOnly) html += " readonly style='background:#f5f5f5; color:#555'";
-    html += tooltip + ">";
-    return html;
+    out << "<input type='" << (spec.type == configFieldType::password ? "password" : "text") << "'";
+    name();
+    out << " value='" << value << "'";
+    if (spec.readOnly) out << " readonly style='background:#f5f5f5; color:#555'";
+    tooltip();
+    out << ">";
 }
 
-String htmlRenderer::renderConfigSubmitSummaryPage(const std::map<String, String>& updatedFields, bool verbose) const {
+// Schema lookup when one is attached (no copy); the text format map is only parsed, into scratch, without it
+const configFieldSpec& htmlRenderer::specFor(const String& section, const String& key,
+                                             const std::map<String, String>& formatMap,
+                                             configFieldSpec& scratch) const {
+    if (schema) {
+        const configFieldSpec* spec = schema->field(section, key);
+        if (spec) return *spec;
+        scratch = configFieldSpec();
+        return scratch;
+    }
+    auto type = formatMap.find(key);
+    scratch = configSchema::parseType(type != formatMap.end() ? type->second : "string");
+    auto tooltip = formatMap.find(key + ".tooltip");
+    if (tooltip != formatMap.end()) scratch.tooltip = tooltip->second;
+    return scratch;
+}
+
+String htmlRenderer::renderConfigSubmitSummaryPage(const std::map<String, String>& updatedFields, bool) const {
+    heapScope heap(HEAP_TAG_HTML);
     Serial.printf("📬 Rendering submission summary (%zu fields updated)\n", updatedFields.size());
 
-    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Config Updated</title>") + embeddedStyle + "</head><body>";
+    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Config Updated</title>") + styleLink + "</head><body>";
     html += "<h1>✅ Configuration Updated</h1>";
     html += "<table class='config-table'><tr><th>Field</th><th>New Value</th></tr>";
 
@@ -243,7 +266,7 @@ String htmlRenderer::renderConfigSubmitSummaryPage(const std::map<String, String
 String htmlRenderer::generateConfigFormPage(const std::map<String, std::map<String, String>> *config) const
 {
     Serial.println("🔧 Starting config form generation...");
-    String html = "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Edit Config</title>" + embeddedStyle + "</head><body>";
+    String html = "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Edit Config</title>" + styleLink + "</head><body>";
     html += "<h1>🛠 Edit Configuration</h1><form method='POST' action='/submit-section'>";
 
     for (const auto &section : *config)
@@ -295,44 +318,43 @@ String htmlRenderer::generateConfigFormPage(const std::map<String, std::map<Stri
 String htmlRenderer::renderConfigSection(const String& sectionName,
                                          const std::map<String, String>& fields,
                                          const std::map<String, String>& formatMap,
-                                         bool rowFormat, bool verbose) const {
+                                         bool rowFormat, bool) const {
     String html;
+    htmlStringWriter out(html);
+    renderConfigSection(out, sectionName, fields, formatMap, rowFormat);
+    return html;
+}
+
+void htmlRenderer::renderConfigSection(htmlWriter& out, const String& sectionName,
+                                       const std::map<String, String>& fields,
+                                       const std::map<String, String>& formatMap, bool rowFormat) const {
+    configFieldSpec scratch;
 
     if (rowFormat) {
-        html += "<tr><th>" + sectionName + "</th><td>";
+        out << "<tr><th>" << sectionName << "</th><td>";
 
         for (const auto& kv : fields) {
             const String& key = kv.first;
-            const String& value = kv.second;
             if (key.startsWith("format.")) continue;
 
-            String type = formatMap.count(key) ? formatMap.at(key) : "string";
-            String fullKey = sectionName + "." + key;
-
-            html += "<label style='margin-right:1.5em'>" + key + ": ";
-            html += renderInputField(fullKey, value, type, formatMap);
-            html += "</label>";
+            out << "<label style='margin-right:1.5em'>" << key << ": ";
+            renderInputField(out, sectionName, key, kv.second, specFor(sectionName, key, formatMap, scratch));
+            out << "</label>";
         }
 
-        html += "</td></tr>\n";
+        out << "</td></tr>\n";
     } else {
-        html += "<tr><th colspan='2'>" + sectionName + "</th></tr>\n";
+        out << "<tr><th colspan='2'>" << sectionName << "</th></tr>\n";
 
         for (const auto& kv : fields) {
             const String& key = kv.first;
-            const String& value = kv.second;
             if (key.startsWith("format.")) continue;
 
-            String type = formatMap.count(key) ? formatMap.at(key) : "string";
-            String fullKey = sectionName + "." + key;
-
-            html += "<tr><td>" + key + "</td><td>";
-            html += renderInputField(fullKey, value, type, formatMap);
-            html += "</td></tr>\n";
+            out << "<tr><td>" << key << "</td><td>";
+            renderInputField(out, sectionName, key, kv.second, specFor(sectionName, key, formatMap, scratch));
+            out << "</td></tr>\n";
         }
     }
-
-    return html;
 }
 
 /*!SECTION
@@ -408,47 +430,92 @@ String htmlRenderer::renderConfigSection(const String& sectionName,
 
 String htmlRenderer::generateSPIFFSFileListPage() const
 {
-    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>SPIFFS Files</title>") + embeddedStyle + "</head><body>";
-    html += "<h1>🗂 SPIFFS File Browser</h1>";
-    html += "<table class='config-table'><th>Filename</th><th>Size (bytes)</th><th>Actions</th></tr>";
+    return collectPage([this](htmlWriter &out) { renderSPIFFSFileListPage(out); });
+}
+
+void htmlRenderer::renderSPIFFSFileListPage(htmlWriter &out) const
+{
+    out << "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>SPIFFS Files</title>" << styleLink << "</head><body>";
+    out << "<h1>🗂 SPIFFS File Browser</h1>";
+    out << "<table class='config-table'><th>Filename</th><th>Size (bytes)</th><th>Actions</th></tr>";
 
     File root = SPIFFS.open("/");
     File file = root.openNextFile();
 
-    while (file)
+    while (file && !out.full())
     {
-        String name = file.name();
-        size_t size = file.size();
-
-        html += "<tr><td>" + name + "</td><td>" + String(size) + "</td>";
-        html += "<td><a href='/files/view?name=" + name + "'>View</a></td></tr>";
+        const char *name = file.name();
+        out << "<tr><td>" << name << "</td><td>" << file.size() << "</td>";
+        out << "<td><a href='/files/view?name=" << name << "'>View</a></td></tr>";
 
         file = root.openNextFile();
     }
 
-    html += "</table><br><a href='/home'>Back to Home</a></body></html>";
+    out << "</table><br><a href='/home'>Back to Home</a></body></html>";
+}
+
+String htmlRenderer::generateFileContentPage(const String &filename) const
+{
+    File file = SPIFFS.open(filename, "r");
+    String html;
+    htmlStringWriter out(html);
+    for (size_t part = 0; renderFileContentPart(out, filename, file, part); ++part)
+    {
+    }
     return html;
 }
-String htmlRenderer::generateFileContentPage(const String& filename, const String& content, bool fileFound) const {
-    Serial.printf("🧾 Rendering file viewer for: %s (found: %s)\n", filename.c_str(), fileFound ? "yes" : "no");
 
-    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>View File</title>") + embeddedStyle + "</head><body>";
-    html += "<h1>📂 Viewing: " + filename + "</h1>";
+// Part 0 is the head, 1..N one HTML_FILE_VIEW_CHUNK of the file each, N + 1 the tail
+bool htmlRenderer::renderFileContentPart(htmlWriter &out, const String &filename, File &file, size_t part) const
+{
+    bool found = file && !file.isDirectory();
+    size_t chunks = found ? (file.size() + HTML_FILE_VIEW_CHUNK - 1) / HTML_FILE_VIEW_CHUNK : 0;
 
-    if (fileFound) {
-        html += "<pre style='border:1px solid #ccc; padding:1em; background:#fdfdfd'>" + content + "</pre>";
-    } else {
-        html += "<p style='color:red;'>❌ File not found: <code>" + filename + "</code></p>";
+    if (part == 0)
+    {
+        out << "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>View File</title>" << styleLink << "</head><body>";
+        out << "<h1>📂 Viewing: ";
+        out.printEscaped(filename);
+        out << "</h1>";
+        if (found)
+        {
+            out << "<pre style='border:1px solid #ccc; padding:1em; background:#fdfdfd'>";
+        }
+        else
+        {
+            out << "<p style='color:red;'>❌ File not found: <code>";
+            out.printEscaped(filename);
+            out << "</code></p>";
+        }
+        return true;
     }
 
-    html += "<br><a href='/files'>Back to Files</a> | <a href='/home'>Home</a></body></html>";
-    return html;
+    if (part <= chunks)
+    {
+        // Read on every call: htmlPartCursor renders a part that straddles two buffers twice.
+        // Parts mostly come in order, so the file is usually already there.
+        char buffer[HTML_FILE_VIEW_CHUNK];
+        size_t offset = (part - 1) * HTML_FILE_VIEW_CHUNK;
+        bool there = file.position() == offset || file.seek(offset);
+        size_t length = there ? file.read(reinterpret_cast<uint8_t *>(buffer), sizeof(buffer)) : 0;
+        out.writeEscaped(buffer, length);
+        return true;
+    }
+
+    if (part == chunks + 1)
+    {
+        if (found)
+            out << "</pre>";
+        out << "<br><a href='/files'>Back to Files</a> | <a href='/home'>Home</a></body></html>";
+        return true;
+    }
+    return false;
 }
 
 /*!SECTION
 String htmlRenderer::generateFileContentPage(const String &filename, const String &content, bool fileFound) const
 {
-    String html = "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>View File</title>" + embeddedStyle + "</head><body>";
+    String html = "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>View File</title>" + styleLink + "</head><body>";
     html += "<h1>📄 Viewing: " + filename + "</h1>";
 
     if (fileFound)
@@ -467,130 +534,178 @@ String htmlRenderer::generateFileContentPage(const String &filename, const Strin
 
 String htmlRenderer::generateInfoPage() const
 {
-    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Device Info</title>") + embeddedStyle + "</head><body>";
-    html += "<h1>📟 Device Information</h1>";
-    html += "<table class='config-table'>";
-    html += "<tr><th>Field</th><th>Value</th></tr>";
-
-    html += "<tr><td>Chip Model</td><td>" + String(ESP.getChipModel()) + "</td></tr>";
-    html += "<tr><td>Chip Revision</td><td>" + String(ESP.getChipRevision()) + "</td></tr>";
-    html += "<tr><td>CPU Frequency</td><td>" + String(ESP.getCpuFreqMHz()) + " MHz</td></tr>";
-    html += "<tr><td>Flash Size</td><td>" + String(ESP.getFlashChipSize() / (1024 * 1024)) + " MB</td></tr>";
-    html += "<tr><td>Sketch Size</td><td>" + String(ESP.getSketchSize()) + " bytes</td></tr>";
-    html += "<tr><td>Free Heap</td><td>" + String(ESP.getFreeHeap()) + " bytes</td></tr>";
-    html += "<tr><td>MAC Address</td><td>" + WiFi.macAddress() + "</td></tr>";
-    html += "<tr><td>Local IP</td><td>" + WiFi.localIP().toString() + "</td></tr>";
-    html += "<tr><td>Channel</td><td>" + String(WiFi.channel()) + "</td></tr>";
-    html += "<tr><td>SSID</td><td>" + WiFi.SSID() + "</td></tr>";
-    html += "<tr><td>Signal Strength</td><td>" + String(WiFi.RSSI()) + " dBm</td></tr>";
-
-    html += "</table>";
-    html += "<br><a href='/home'>Back to Home</a></body></html>";
-    return html;
+    return collectPage([this](htmlWriter &out) { renderInfoPage(out); });
+}
+
+void htmlRenderer::renderInfoPage(htmlWriter &out) const
+{
+    out << "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Device Info</title>" << styleLink << "</head><body>";
+    out << "<h1>📟 Device Information</h1>";
+    out << "<table class='config-table'>";
+    out << "<tr><th>Field</th><th>Value</th></tr>";
+
+    out << "<tr><td>Chip Model</td><td>" << ESP.getChipModel() << "</td></tr>";
+    out << "<tr><td>Chip Revision</td><td>" << ESP.getChipRevision() << "</td></tr>";
+    out << "<tr><td>CPU Frequency</td><td>" << ESP.getCpuFreqMHz() << " MHz</td></tr>";
+    out << "<tr><td>Flash Size</td><td>" << ESP.getFlashChipSize() / (1024 * 1024) << " MB</td></tr>";
+    out << "<tr><td>Sketch Size</td><td>" << ESP.getSketchSize() << " bytes</td></tr>";
+    out << "<tr><td>Free Heap</td><td>" << ESP.getFreeHeap() << " bytes</td></tr>";
+    uint8_t mac[6];
+    char macText[MAC_TEXT_LEN + 1];
+    WiFi.macAddress(mac);
+    formatMac(mac, macText);
+    IPAddress ip = WiFi.localIP();
+    uint8_t ipBytes[4] = {ip[0], ip[1], ip[2], ip[3]};
+    char ipText[IPV4_TEXT_MAX + 1];
+    formatIPv4(ipBytes, ipText);
+    out << "<tr><td>MAC Address</td><td>" << macText << "</td></tr>";
+    out << "<tr><td>Local IP</td><td>" << ipText << "</td></tr>";
+    out << "<tr><td>Channel</td><td>" << WiFi.channel() << "</td></tr>";
+    out << "<tr><td>SSID</td><td>" << WiFi.SSID() << "</td></tr>";
+    out << "<tr><td>Signal Strength</td><td>" << WiFi.RSSI() << " dBm</td></tr>";
+
+    out << "</table>";
+    out << "<br><a href='/home'>Back to Home</a></body></html>";
 }
 
 String htmlRenderer::generateAllSectionsPage() const
+{
+    return collectPage([this](htmlWriter &out) { renderAllSectionsPage(out); });
+}
+
+void htmlRenderer::renderAllSectionsPage(htmlWriter &out) const
+{
+    for (size_t part = 0; !out.full() && renderAllSectionsPart(out, part); ++part)
+    {
+    }
+}
+
+// Part 0 is the head, 1..N one section each, N + 1 the tail
+bool htmlRenderer::renderAllSectionsPart(htmlWriter &out, size_t part) const
 {
     if (!config)
-        return "<html><body><h1>No Config Loaded</h1></body></html>";
+    {
+        if (part == 0)
+            out << "<html><body><h1>No Config Loaded</h1></body></html>";
+        return part == 0;
+    }
 
-    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Edit All</title>") + embeddedStyle + "</head><body>";
-    html += "<h1>Edit All Configuration</h1>";
-    html += "<form method='POST' action='/submit-section'>";
+    if (part == 0)
+    {
+        out << "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Edit All</title>" << styleLink << "</head><body>";
+        out << "<h1>Edit All Configuration</h1>";
+        out << "<form method='POST' action='/submit-section'>";
+        return true;
+    }
 
-    for (const auto &section : *config)
+    if (part <= config->size())
     {
-        html += "<h2>[" + section.first + "]</h2>";
-        html += "<input type='hidden' name='section' value='" + section.first + "'>";
-        html += "<table class == 'config-table'><tr><th>Key</th><th>Value</th></tr>";
+        const auto &section = *std::next(config->begin(), part - 1);
+        out << "<h2>[" << section.first << "]</h2>";
+        out << "<input type='hidden' name='section' value='" << section.first << "'>";
+        out << "<table class == 'config-table'><tr><th>Key</th><th>Value</th></tr>";
 
         for (const auto &kv : section.second)
         {
-            html += "<tr><td>" + kv.first + "</td><td>";
-            html += "<input type='text' name='" + kv.first + "' value='" + kv.second + "'></td></tr>";
+            out << "<tr><td>" << kv.first << "</td><td>";
+            out << "<input type='text' name='" << kv.first << "' value='" << kv.second << "'></td></tr>";
         }
 
-        html += "</table><br>";
+        out << "</table><br>";
+        return true;
     }
 
-    html += "<input type='submit' value='Save All Changes'>";
-    html += "</form><br><a href='/home'>Back to Home</a>";
-    return html;
+    if (part > config->size() + 1)
+        return false;
+    out << "<input type='submit' value='Save All Changes'>";
+    out << "</form><br><a href='/home'>Back to Home</a>";
+    return true;
 }
 
 String htmlRenderer::generateUploadPage() const
 {
-    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Upload to SPIFFS</title>") + embeddedStyle + "</head><body>";
-    html += "<h1>Upload File to SPIFFS</h1>";
-    html += "<form method='POST' action='/upload' enctype='multipart/form-data'>";
-    html += "<input type='file' name='upload'><br><br><input type='submit' value='Upload'>";
-    html += "</form><br><a href='/home'>Back to Home</a></body></html>";
-    return html;
+    return collectPage([this](htmlWriter &out) { renderUploadPage(out); });
 }
 
-String htmlRenderer::generateFirmwareUpdatePage() const
+void htmlRenderer::renderUploadPage(htmlWriter &out) const
 {
-    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Firmware Update</title>") + embeddedStyle + "</head><body>";
-    html += "<h1>🧪 Firmware Update</h1>";
-
-    html += "<p><strong>Current Firmware Build:</strong><br>";
-    html += "Compiled on <code>" + String(__DATE__) + " at " + String(__TIME__) + "</code></p>";
+    htmlValue values[UPLOAD_SLOTS];
+    values[UPLOAD_STYLE] = styleLink;
+    renderTemplate(out, UPLOAD_TEMPLATE, values);
+}
 
-    html += "<form method='POST' action='/update' enctype='multipart/form-data'>";
-    html += "<input type='file' name='firmware'><br><br>";
-    html += "<input type='submit' value='Upload Firmware'>";
-    html += "</form>";
+String htmlRenderer::generateFirmwareUpdatePage() const
+{
+    return collectPage([this](htmlWriter &out) { renderFirmwareUpdatePage(out); });
+}
 
-    html += "<br><a href='/home'>Back to Home</a></body></html>";
-    return html;
+void htmlRenderer::renderFirmwareUpdatePage(htmlWriter &out) const
+{
+    htmlValue values[FIRMWARE_UPDATE_SLOTS];
+    values[FIRMWARE_UPDATE_STYLE] = styleLink;
+    values[FIRMWARE_UPDATE_BUILD_DATE] = __DATE__;
+    values[FIRMWARE_UPDATE_BUILD_TIME] = __TIME__;
+    renderTemplate(out, FIRMWARE_UPDATE_TEMPLATE, values);
 }
 
 String htmlRenderer::generateDownloadPage() const
 {
-    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Download SPIFFS File</title>") + embeddedStyle + "</head><body>";
-    html += "<h1>📥 Download a File from SPIFFS</h1>";
+    return collectPage([this](htmlWriter &out) { renderDownloadPage(out); });
+}
+
+void htmlRenderer::renderDownloadPage(htmlWriter &out) const
+{
+    out << "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Download SPIFFS File</title>" << styleLink << "</head><body>";
+    out << "<h1>📥 Download a File from SPIFFS</h1>";
 
-    html += "<form method='GET' action='/download'>";
-    html += "<label for='filename'>Select file:</label> ";
-    html += "<select name='filename'>";
+    out << "<form method='GET' action='/download'>";
+    out << "<label for='filename'>Select file:</label> ";
+    out << "<select name='filename'>";
 
     File root = SPIFFS.open("/");
     File file = root.openNextFile();
 
-    while (file)
+    while (file && !out.full())
     {
-        String name = file.name();
-        html += "<option value='" + name + "'>" + name + "</option>";
+        const char *name = file.name();
+        out << "<option value='" << name << "'>" << name << "</option>";
         file = root.openNextFile();
     }
 
-    html += "</select> <input type='submit' value='Download'>";
-    html += "</form><br><a href='/home'>Back to Home</a></body></html>";
-    return html;
+    out << "</select> <input type='submit' value='Download'>";
+    out << "</form><br><a href='/home'>Back to Home</a></body></html>";
 }
 
 String htmlRenderer::generateRestartPage() const
 {
-    return String("<html><head><meta charset='UTF-8'><title>Restart</title>") + embeddedStyle +
-           "</head><body><h1>Device Restarting...</h1>"
-           "<p>Please wait a few seconds before reconnecting.</p></body></html>";
+    return collectPage([this](htmlWriter &out) { renderRestartPage(out); });
+}
+
+void htmlRenderer::renderRestartPage(htmlWriter &out) const
+{
+    htmlValue values[RESTART_SLOTS];
+    values[RESTART_STYLE] = styleLink;
+    renderTemplate(out, RESTART_TEMPLATE, values);
 }
 
 String htmlRenderer::generateSectionEditForm(const String& sectionName,
                                              const std::map<String, String>& section,
                                              const std::map<String, std::map<String, String>>& configMap) const {
+    heapScope heap(HEAP_TAG_HTML);
     String html;
 
     html += "<form method='post' action='/submit-section'>\n";
     html += "<table class='config-table'>\n";
     html += "<tr><th colspan='2'>" + sectionName + "</th></tr>\n";
 
-    // Fetch format map if available
-    std::map<String, String> formatMap;
-    if (section.count("format.use")) {
+    // Fetch format map if available (only needed when no compiled schema is attached)
+    static const std::map<String, String> noFormat;
+    const std::map<String, String>* formatMap = &noFormat;
+    configFieldSpec scratch;
+    if (!schema && section.count("format.use")) {
         const String& formatID = section.at("format.use");
         if (configMap.count(formatID)) {
-            formatMap = configMap.at(formatID);
+            formatMap = &configMap.at(formatID);
         }
     }
 
@@ -600,11 +715,10 @@ String htmlRenderer::generateSectionEditForm(const String& sectionName,
 
         if (key.startsWith("format.")) continue;
 
-        String inputType = formatMap.count(key) ? formatMap.at(key) : "string";
         String fullKey = sectionName + "." + key;
 
         html += "<tr><td>" + key + "</td><td>";
-        html += renderInputField(fullKey, value, inputType, formatMap);
+        html += renderInputField(fullKey, value, specFor(sectionName, key, *formatMap, scratch));
         html += "</td></tr>\n";
     }
 
@@ -616,19 +730,23 @@ String htmlRenderer::generateSectionEditForm(const String& sectionName,
 }
 
 String htmlRenderer::generateConfigErrorPage(const String& errorMessage) const {
+    return collectPage([&](htmlWriter& out) { renderConfigErrorPage(out, errorMessage); });
+}
+
+void htmlRenderer::renderConfigErrorPage(htmlWriter& out, const String& errorMessage) const {
     Serial.println("🚨 Rendering configuration error page");
 
-    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Config Error</title>") + embeddedStyle + "</head><body>";
-    html += "<h1 style='color:red;'>Configuration Error</h1>";
-    html += "<p>" + errorMessage + "</p>";
-    html += "<br><a href='/configs'>Back to Config Editor</a> | <a href='/home'>Home</a></body></html>";
-    return html;
+    htmlValue values[CONFIG_ERROR_SLOTS];
+    values[CONFIG_ERROR_STYLE] = styleLink;
+    values[CONFIG_ERROR_MESSAGE] = errorMessage;
+    renderTemplate(out, CONFIG_ERROR_TEMPLATE, values);
 }
 
 String htmlRenderer::generateConfigSubmitSummaryPage(const std::map<String, String>& updatedFields) const {
+    heapScope heap(HEAP_TAG_HTML);
     Serial.printf("📬 Rendering submission summary (%zu fields updated)\n", updatedFields.size());
 
-    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Config Updated</title>") + embeddedStyle + "</head><body>";
+    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Config Updated</title>") + styleLink + "</head><body>";
     html += "<h1>✅ Configuration Updated</h1>";
     html += "<table class='config-table'><tr><th>Field</th><th>New Value</th></tr>";
 
@@ -656,6 +774,49 @@ String htmlRenderer::getInputTypeForField(const String& key, const std::map<Stri
     return "text";
 }
 
+// configJsonWriter sink that forwards into an htmlWriter (a response window or an ETag hash)
+class configJsonHtmlSink
+{
+public:
+    explicit configJsonHtmlSink(htmlWriter &out) : out(out) {}
+    size_t write(const uint8_t *buf, size_t len)
+    {
+        out.write(reinterpret_cast<const char *>(buf), len);
+        return len;
+    }
+
+private:
+    htmlWriter &out;
+};
+
+bool htmlRenderer::renderConfigJsonPart(htmlWriter &out, const String &section, size_t part) const
+{
+    configJsonHtmlSink sink(out);
+    configJsonWriter<configJsonHtmlSink> json(sink);
+    if (!section.isEmpty())
+    {
+        auto found = config->find(section);
+        if (part > 0 || found == config->end())
+            return false;
+        json.writeFields(found->second);
+    }
+    else if (part == 0)
+        json.openDocument();
+    else if (part <= config->size())
+    {
+        auto it = config->begin();
+        std::advance(it, part - 1);
+        json.writeSection(it->first, it->second, part == 1);
+    }
+    else if (part == config->size() + 1)
+        json.closeDocument(config->empty());
+    else
+        return false;
+    json.finish();
+    return true;
+}
+
+
 /*!SECTION
 const String htmlRenderer::embeddedStyle =
     "<style>"
@@ -679,4 +840,4 @@ const String htmlRenderer::embeddedStyle =
     "pre { background: #f0f0f0; padding: 1em; overflow-x: auto; }"
     "a { color: #3c763d; }"
     "</style>";
-*/
\ No newline at end of file
+*/
@@ -27,150 +27,81 @@
 #include <map>
 #include <vector>
 #include <SPIFFS.h>
-#if defined(ESP32)
-#include <WiFi.h>
-#elif defined(ESP8266)
+#include <configSchema.h>
+#include "htmlWriter.h"
+#include "styleAsset.h"
+#if defined(ESP8266)
 #include <ESP8266WiFi.h>
+#else
+#include <WiFi.h> // ESP32, or test/hostShim on a host build
 #endif
+
+// File bytes read per part of the file view; the stack buffer it is read into is all the page holds
+#ifndef HTML_FILE_VIEW_CHUNK
+#define HTML_FILE_VIEW_CHUNK 512
+#endif
+
 class htmlRenderer
 {
 private:
     const std::map<String, std::map<String, String>> *config;
     const std::map<String, std::map<String, String>> *templates;
     const std::map<String, std::vector<String>> *formatGroups;
+    const configSchema *schema = nullptr;
 
-    const char *embeddedStyle =
-        R"rawlite(
-<style>
-  body {
-    font-family: sans-serif;
-    margin: 20px;
-    background-color: #f6fff6;
-    color: #2c3e50;
-  }
-
-  h1, h2 {
-    color: #3c763d;
-  }
-
-  table {
-    border-collapse: collapse;
-    width: 100%;
-    background-color: #ffffff;
-  }
-
-  th, td {
-    border: 1px solid #b2d8b2;
-    padding: 8px;
-  }
-
-  th {
-    background-color: #dff0d8;
-    text-align: left;
-  }
-
-  td:first-child {
-    text-align: right;
-    font-weight: bold;
-    white-space: nowrap;
-    width: 20%;
-  }
-
-  td:last-child {
-    text-align: left;
-  }
-
-  input[type='text'],
-  input[type='password'] {
-    width: 100%;
-    box-sizing: border-box;
-    background-color: #fafff7;
-    border: 1px solid #c2e0c6;
-    padding: 6px;
-    font-size: 1rem;
-  }
-
-  input[type='checkbox'] {
-    transform: scale(1.1);
-    margin-right: 0.5em;
-  }
+    const configFieldSpec &specFor(const String &section, const String &key,
+                                   const std::map<String, String> &formatMap, configFieldSpec &scratch) const;
 
-  input[readonly] {
-    background: #f3f3f3;
-    color: #666;
-    border: 1px solid #ccc;
-  }
-
-  input[type='submit'],
-  input[type='button'] {
-    background-color: #4CAF50;
-    color: white;
-    border: none;
-    padding: 10px 20px;
-    cursor: pointer;
-  }
-
-  input[type='submit']:hover,
-  input[type='button']:hover {
-    background-color: #45a049;
-  }
-
-  .readonly-field {
-    display: inline-block;
-    padding: 6px 8px;
-    background: #f3f3f3;
-    color: #444;
-    font-family: monospace;
-  }
-
-  table.config-table {
-    width: 100%;
-    border-collapse: collapse;
-    table-layout: auto;
-    margin-bottom: 1.5em;
-  }
-
-  table.config-table th,
-  table.config-table td {
-    border: 1px solid #b2d8b2;
-    padding: 8px;
-  }
-
-  table.config-table input[type='text'],
-  table.config-table input[type='password'] {
-    width: 100%;
-  }
-
-  table.config-table label {
-    margin-right: 1.5em;
-    display: inline-block;
-  }
-
-  pre {
-    background: #f0f0f0;
-    padding: 1em;
-    overflow-x: auto;
-  }
-
-  a {
-    color: #3c763d;
-  }
-</style>
-)rawlite";
+    // Pages link the flash-resident stylesheet (style.css, see styleAsset.h) instead of inlining it
+    const char *styleLink = STYLE_CSS_LINK;
 
 public:
     htmlRenderer(const std::map<String, std::map<String, String>> *cfg);
 
     ~htmlRenderer();
 
+    // Compiled *.format specs; when set, forms are rendered without parsing type strings
+    void setSchema(const configSchema *compiled) { schema = compiled; }
+
     const char *getStyle() const
     {
-        return embeddedStyle;
+        return styleLink;
     }
+    // Streaming pages: fragments go to the writer as they are produced, so no
+    // page-sized String is ever built. The generate*() counterparts collect the
+    // same bytes into a String. The config pages also render part by part (head,
+    // one section per part, tail) for htmlPartCursor; false once past the tail.
+    void renderHomePage(htmlWriter &out) const;
+    void renderSPIFFSFileListPage(htmlWriter &out) const;
+    void renderInfoPage(htmlWriter &out) const;
+    void renderAllSectionsPage(htmlWriter &out) const;
+    void renderConfigFormPage(htmlWriter &out, const std::map<String, std::map<String, String>> &config, bool = false) const;
+    bool renderConfigFormPart(htmlWriter &out, const std::map<String, std::map<String, String>> &config,
+                              bool rowFormat, size_t part) const;
+    bool renderAllSectionsPart(htmlWriter &out, size_t part) const;
+    void renderDownloadPage(htmlWriter &out) const;
+    // Compiled templates (templates/*.html, see pageTemplates.h): fragments from flash plus slot values
+    void renderEspNowQrPage(htmlWriter &out, const String &mac, const String &lmkHex) const;
+    void renderUploadPage(htmlWriter &out) const;
+    void renderFirmwareUpdatePage(htmlWriter &out) const;
+    void renderRestartPage(htmlWriter &out) const;
+    void renderConfigErrorPage(htmlWriter &out, const String &errorMessage) const;
+    void renderConfigSection(htmlWriter &out, const String &sectionName,
+                             const std::map<String, String> &fields,
+                             const std::map<String, String> &formatMap, bool rowFormat = true) const;
+    void renderInputField(htmlWriter &out, const String &section, const String &key,
+                          const String &value, const configFieldSpec &spec) const;
+    // The config as JSON, in config.json's layout, for the REST API: "{", one part
+    // per section, then "}"; or, when section is set, just that section's fields as part 0
+    bool renderConfigJsonPart(htmlWriter &out, const String &section, size_t part) const;
+    // A SPIFFS file, HTML-escaped in a <pre>: the head, one part per HTML_FILE_VIEW_CHUNK
+    // bytes read at that offset, then the tail. A closed file renders the not-found page.
+    bool renderFileContentPart(htmlWriter &out, const String &filename, File &file, size_t part) const;
+
     String generateHomePage() const;
     String generateEspNowQrPage(const String &mac, const String &lmkHex) const;
     String generateSPIFFSFileListPage() const;
-    String generateFileContentPage(const String &filename, const String &content, bool fileFound) const;
+    String generateFileContentPage(const String &filename) const;
     String generateInfoPage() const;
     String generateAllSectionsPage() const;
     String generateConfigFormPage(const std::map<String, std::map<String, String>> &config, bool = false) const;
@@ -178,6 +109,7 @@ public:
                             const String &value,
                             const String &type,
                             const std::map<String, String> &formatMap) const;
+    String renderInputField(const String &fullKey, const String &value, const configFieldSpec &spec) const;
     String renderConfigSubmitSummaryPage(const std::map<String, String> &updatedFields, bool = true) const;
     String generateUploadPage() const;
     String generateFirmwareUpdatePage() const;
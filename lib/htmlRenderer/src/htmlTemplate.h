@@ -0,0 +1,77 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <string.h>
+#include "htmlWriter.h"
+
+/**
+ * @brief Page templates compiled at build time (scripts/compile_templates.py).
+ *
+ * A template is a table of steps: write a literal fragment from flash, then,
+ * unless the step has no slot, write the caller's value for that slot.
+ * Nothing is parsed or searched at runtime; the generated pageTemplates.h
+ * holds the fragments, the step tables and one slot enum per template.
+ */
+static const uint8_t HTML_TEMPLATE_NO_SLOT = 0xFF;
+
+struct htmlTemplateStep
+{
+    const char *text; // PROGMEM; flash is memory-mapped data on the ESP32
+    uint16_t length;
+    uint8_t slot;
+};
+
+struct htmlTemplate
+{
+    const htmlTemplateStep *steps;
+    uint8_t stepCount; // compile_templates.py refuses a template with more than 255 steps
+    uint8_t slotCount;
+};
+
+// Borrowed text for one slot; must outlive the renderTemplate() call
+struct htmlValue
+{
+    const char *data = "";
+    size_t length = 0;
+
+    htmlValue() {}
+    htmlValue(const char *text) : data(text), length(strlen(text)) {}
+    htmlValue(const String &text) : data(text.c_str()), length(text.length()) {}
+};
+
+// values holds page.slotCount entries, indexed by the template's slot enum
+inline bool renderTemplate(htmlWriter &out, const htmlTemplate &page, const htmlValue *values)
+{
+    for (uint8_t i = 0; i < page.stepCount && !out.full(); ++i)
+    {
+        const htmlTemplateStep &step = page.steps[i];
+        out.write(step.text, step.length);
+        if (step.slot != HTML_TEMPLATE_NO_SLOT)
+            out.write(values[step.slot].data, values[step.slot].length);
+    }
+    return !out.full();
+}
@@ -0,0 +1,242 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <string.h>
+#include <functional>
+#include <textCodec.hpp>
+
+/**
+ * @brief Sink for htmlRenderer::render*() pages.
+ *
+ * Pages are written as a sequence of fragments instead of one String, so the
+ * caller decides where the bytes go: htmlStringWriter collects them (what the
+ * generate*() wrappers return), htmlWindowWriter copies one slice straight
+ * into a chunked-response buffer and drops the rest, and htmlPartCursor
+ * walks a page part by part to fill such buffers one after another.
+ *
+ * write() returns false once the sink wants nothing more; renderers check
+ * full() between sections to stop early, but any fragment written after that
+ * is simply ignored.
+ */
+class htmlWriter
+{
+public:
+    virtual ~htmlWriter() {}
+
+    virtual bool write(const char *data, size_t len) = 0;
+    bool full() const { return _full; }
+
+    bool print(const char *text) { return write(text, strlen(text)); }
+    bool print(const String &text) { return write(text.c_str(), text.length()); }
+    bool print(char c) { return write(&c, 1); }
+    bool print(long value)
+    {
+        char text[INT_TEXT_MAX + 1];
+        return write(text, formatInt(static_cast<int32_t>(value), text));
+    }
+    bool print(unsigned long value)
+    {
+        char text[12];
+        int len = snprintf(text, sizeof(text), "%lu", value);
+        return write(text, len > 0 ? static_cast<size_t>(len) : 0);
+    }
+    bool print(int value) { return print(static_cast<long>(value)); }
+    bool print(unsigned int value) { return print(static_cast<unsigned long>(value)); }
+
+    // Text as element content or a quoted attribute: runs pass through, markup characters become entities
+    bool writeEscaped(const char *data, size_t len)
+    {
+        size_t run = 0;
+        for (size_t i = 0; i < len; ++i)
+        {
+            const char *entity;
+            switch (data[i])
+            {
+            case '&': entity = "&amp;"; break;
+            case '<': entity = "&lt;"; break;
+            case '>': entity = "&gt;"; break;
+            case '"': entity = "&quot;"; break;
+            case '\'': entity = "&#39;"; break;
+            default: continue;
+            }
+            if ((i > run && !write(data + run, i - run)) || !print(entity))
+                return false;
+            run = i + 1;
+        }
+        return len <= run || write(data + run, len - run);
+    }
+    bool printEscaped(const String &text) { return writeEscaped(text.c_str(), text.length()); }
+
+    template <typename T>
+    htmlWriter &operator<<(const T &value)
+    {
+        print(value);
+        return *this;
+    }
+
+protected:
+    bool _full = false;
+};
+
+// Whole page in one String: the generate*() path
+class htmlStringWriter : public htmlWriter
+{
+public:
+    explicit htmlStringWriter(String &out) : _out(out) {}
+    bool write(const char *data, size_t len) override
+    {
+        _out.concat(data, len);
+        return true;
+    }
+
+private:
+    String &_out;
+};
+
+/**
+ * Hashes a page instead of keeping it (64-bit FNV-1a), for ETags: rendering
+ * into this costs CPU but no heap, and a matching If-None-Match then saves
+ * sending the page at all.
+ */
+class htmlHashWriter : public htmlWriter
+{
+public:
+    static const size_t ETAG_LEN = 18; // Quoted 16 hex digits
+
+    bool write(const char *data, size_t len) override
+    {
+        for (size_t i = 0; i < len; ++i)
+        {
+            _hash ^= static_cast<uint8_t>(data[i]);
+            _hash *= 0x100000001b3ULL;
+        }
+        _length += len;
+        return true;
+    }
+
+    uint64_t hash() const { return _hash; }
+    size_t length() const { return _length; }
+
+    // Strong validator for the bytes written so far; out holds ETAG_LEN + 1
+    void etag(char *out) const
+    {
+        static const char digits[] = "0123456789abcdef";
+        out[0] = '"';
+        for (int i = 0; i < 16; ++i)
+            out[1 + i] = digits[(_hash >> (60 - 4 * i)) & 0xF];
+        out[17] = '"';
+        out[18] = '\0';
+    }
+
+private:
+    uint64_t _hash = 0xcbf29ce484222325ULL;
+    size_t _length = 0;
+};
+
+// Bytes [offset, offset + capacity) of what is written, copied into a caller buffer
+
+class htmlWindowWriter : public htmlWriter
+{
+public:
+    htmlWindowWriter(uint8_t *buffer, size_t capacity, size_t offset)
+        : _buffer(buffer), _capacity(capacity), _skip(offset)
+    {
+        _full = capacity == 0;
+    }
+
+    bool write(const char *data, size_t len) override
+    {
+        if (_full)
+            return false;
+        if (len <= _skip)
+        {
+            _skip -= len;
+            return true;
+        }
+        data += _skip;
+        len -= _skip;
+        _skip = 0;
+
+        size_t n = len < _capacity - _length ? len : _capacity - _length;
+        memcpy(_buffer + _length, data, n);
+        _length += n;
+        _full = _length == _capacity;
+        return !_full;
+    }
+
+    size_t length() const { return _length; } // 0 once the offset is past the end of the page
+
+private:
+    uint8_t *_buffer;
+    size_t _capacity;
+    size_t _skip;
+    size_t _length = 0;
+};
+
+/**
+ * Renders part `part` of a page (head, one part per config section, tail...)
+ * and returns true, or returns false once there is no such part.
+ */
+using htmlPartRenderer = std::function<bool(htmlWriter &out, size_t part)>;
+
+/**
+ * Feeds a chunked response from a part renderer, one caller buffer per call.
+ *
+ * Only the part the buffer starts in is rendered again, through an
+ * htmlWindowWriter that skips what earlier buffers already took, so the work
+ * per buffer is bounded by the largest part rather than the page. A part must
+ * render the same bytes each time, which holds while the config is not edited
+ * mid-response.
+ */
+class htmlPartCursor
+{
+public:
+    // Bytes placed in buffer; 0 once the page is complete
+    size_t fill(uint8_t *buffer, size_t capacity, const htmlPartRenderer &render)
+    {
+        size_t length = 0;
+        while (length < capacity)
+        {
+            htmlWindowWriter out(buffer + length, capacity - length, _offset);
+            if (!render(out, _part))
+                break;
+            length += out.length();
+            if (out.full())
+            {
+                _offset += out.length(); // Part may continue; the next buffer resumes here
+                break;
+            }
+            ++_part;
+            _offset = 0;
+        }
+        return length;
+    }
+
+private:
+    size_t _part = 0;
+    size_t _offset = 0;
+};
@@ -0,0 +1,103 @@
+// Generated by scripts/compile_templates.py from lib/htmlRenderer/templates; do not edit.
+#pragma once
+#include "htmlTemplate.h"
+
+// lib/htmlRenderer/templates/configError.html
+enum configErrorSlot : uint8_t
+{
+    CONFIG_ERROR_STYLE,
+    CONFIG_ERROR_MESSAGE,
+    CONFIG_ERROR_SLOTS
+};
+static const char CONFIG_ERROR_FRAGMENT_0[] PROGMEM = "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Config Error</title>";
+static const char CONFIG_ERROR_FRAGMENT_1[] PROGMEM = "</head><body>\n<h1 style='color:red;'>Configuration Error</h1>\n<p>";
+static const char CONFIG_ERROR_FRAGMENT_2[] PROGMEM = "</p>\n<br><a href='/configs'>Back to Config Editor</a> | <a href='/home'>Home</a></body></html>";
+static const htmlTemplateStep CONFIG_ERROR_STEPS[] = {
+    {CONFIG_ERROR_FRAGMENT_0, sizeof(CONFIG_ERROR_FRAGMENT_0) - 1, CONFIG_ERROR_STYLE},
+    {CONFIG_ERROR_FRAGMENT_1, sizeof(CONFIG_ERROR_FRAGMENT_1) - 1, CONFIG_ERROR_MESSAGE},
+    {CONFIG_ERROR_FRAGMENT_2, sizeof(CONFIG_ERROR_FRAGMENT_2) - 1, HTML_TEMPLATE_NO_SLOT},
+};
+static const htmlTemplate CONFIG_ERROR_TEMPLATE = {CONFIG_ERROR_STEPS, sizeof(CONFIG_ERROR_STEPS) / sizeof(CONFIG_ERROR_STEPS[0]), CONFIG_ERROR_SLOTS};
+
+// lib/htmlRenderer/templates/espNowQr.html
+enum espNowQrSlot : uint8_t
+{
+    ESP_NOW_QR_MAC,
+    ESP_NOW_QR_LMK,
+    ESP_NOW_QR_SLOTS
+};
+static const char ESP_NOW_QR_FRAGMENT_0[] PROGMEM = "<!DOCTYPE html>\n<html>\n<head>\n  <meta charset=\"UTF-8\">\n  <title>ESP-NOW QR Code</title>\n  <style>\n    body { font-family: sans-serif; background: #f6fff6; color: #2c3e50; text-align: center; padding: 2em; }\n    #qrcode { margin: 2em auto; }\n    .info { font-size: 0.9rem; color: #555; }\n  </style>\n</head>\n<body>\n  <h1>Scan to Pair</h1>\n  <div id=\"qrcode\"></div>\n  <p class=\"info\">MAC: ";
+static const char ESP_NOW_QR_FRAGMENT_1[] PROGMEM = "<br>LMK: ";
+static const char ESP_NOW_QR_FRAGMENT_2[] PROGMEM = "</p>\n\n  <script src=\"https://cdn.jsdelivr.net/npm/qrcodejs@1.0.0/qrcode.min.js\"></script>\n  <script>\n    const payload = \"MAC=";
+static const char ESP_NOW_QR_FRAGMENT_3[] PROGMEM = ";LMK=";
+static const char ESP_NOW_QR_FRAGMENT_4[] PROGMEM = "\";\n    new QRCode(document.getElementById(\"qrcode\"), {\n      text: payload,\n      width: 256,\n      height: 256,\n      colorDark: \"#000000\",\n      colorLight: \"#ffffff\",\n      correctLevel: QRCode.CorrectLevel.H\n    });\n  </script>\n</body>\n</html>\n";
+static const htmlTemplateStep ESP_NOW_QR_STEPS[] = {
+    {ESP_NOW_QR_FRAGMENT_0, sizeof(ESP_NOW_QR_FRAGMENT_0) - 1, ESP_NOW_QR_MAC},
+    {ESP_NOW_QR_FRAGMENT_1, sizeof(ESP_NOW_QR_FRAGMENT_1) - 1, ESP_NOW_QR_LMK},
+    {ESP_NOW_QR_FRAGMENT_2, sizeof(ESP_NOW_QR_FRAGMENT_2) - 1, ESP_NOW_QR_MAC},
+    {ESP_NOW_QR_FRAGMENT_3, sizeof(ESP_NOW_QR_FRAGMENT_3) - 1, ESP_NOW_QR_LMK},
+    {ESP_NOW_QR_FRAGMENT_4, sizeof(ESP_NOW_QR_FRAGMENT_4) - 1, HTML_TEMPLATE_NO_SLOT},
+};
+static const htmlTemplate ESP_NOW_QR_TEMPLATE = {ESP_NOW_QR_STEPS, sizeof(ESP_NOW_QR_STEPS) / sizeof(ESP_NOW_QR_STEPS[0]), ESP_NOW_QR_SLOTS};
+
+// lib/htmlRenderer/templates/firmwareUpdate.html
+enum firmwareUpdateSlot : uint8_t
+{
+    FIRMWARE_UPDATE_STYLE,
+    FIRMWARE_UPDATE_BUILD_DATE,
+    FIRMWARE_UPDATE_BUILD_TIME,
+    FIRMWARE_UPDATE_SLOTS
+};
+static const char FIRMWARE_UPDATE_FRAGMENT_0[] PROGMEM = "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Firmware Update</title>";
+static const char FIRMWARE_UPDATE_FRAGMENT_1[] PROGMEM = "</head><body>\n<h1>🧪 Firmware Update</h1>\n<p><strong>Current Firmware Build:</strong><br>\nCompiled on <code>";
+static const char FIRMWARE_UPDATE_FRAGMENT_2[] PROGMEM = " at ";
+static const char FIRMWARE_UPDATE_FRAGMENT_3[] PROGMEM = "</code></p>\n<form id='ota' method='POST' action='/update' enctype='multipart/form-data'>\n<label>SHA-256 of the image (<code>sha256sum firmware.bin</code>)<br>\n<input type='text' name='sha256' size='66' required pattern='[0-9A-Fa-f]{64}'></label><br><br>\n<input type='file' name='firmware' required><br><br>\n<input type='submit' value='Upload Firmware'>\n</form>\n<p id='progress'></p>\n<script>\ndocument.getElementById('ota').addEventListener('submit', function () {\n  var shown = document.getElementById('progress');\n  var events = new EventSource('/update/events');\n  events.addEventListener('progress', function (e) {\n    var p = JSON.parse(e.data);\n    shown.textContent = p.state + ': ' + p.percent + '% (' + p.kbps + ' KB/s)' + (p.error ? ' - ' + p.error : '');\n    if (p.state == 'done' || p.state == 'failed') events.close();\n  });\n});\n</script>\n<br><a href='/home'>Back to Home</a></body></html>";
+static const htmlTemplateStep FIRMWARE_UPDATE_STEPS[] = {
+    {FIRMWARE_UPDATE_FRAGMENT_0, sizeof(FIRMWARE_UPDATE_FRAGMENT_0) - 1, FIRMWARE_UPDATE_STYLE},
+    {FIRMWARE_UPDATE_FRAGMENT_1, sizeof(FIRMWARE_UPDATE_FRAGMENT_1) - 1, FIRMWARE_UPDATE_BUILD_DATE},
+    {FIRMWARE_UPDATE_FRAGMENT_2, sizeof(FIRMWARE_UPDATE_FRAGMENT_2) - 1, FIRMWARE_UPDATE_BUILD_TIME},
+    {FIRMWARE_UPDATE_FRAGMENT_3, sizeof(FIRMWARE_UPDATE_FRAGMENT_3) - 1, HTML_TEMPLATE_NO_SLOT},
+};
+static const htmlTemplate FIRMWARE_UPDATE_TEMPLATE = {FIRMWARE_UPDATE_STEPS, sizeof(FIRMWARE_UPDATE_STEPS) / sizeof(FIRMWARE_UPDATE_STEPS[0]), FIRMWARE_UPDATE_SLOTS};
+
+// lib/htmlRenderer/templates/home.html
+enum homeSlot : uint8_t
+{
+    HOME_STYLE,
+    HOME_SLOTS
+};
+static const char HOME_FRAGMENT_0[] PROGMEM = "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Home</title>";
+static const char HOME_FRAGMENT_1[] PROGMEM = "</head><body>\n<h1>Main Dashboard</h1>\n<ul>\n<h2>\t\tℹ️\t\t<a href='/info'>Device Info</a></h2>\n<hr>\n<h2>\t\t🛠\t\t<a href='/configs'>Configuration Form</a></h2>\n<h2>\t\t📃\t\t<a href='/all'>All Sections</a></h2>\n<hr>\n<h2>\t\t🗂\t\t<a href='/files'>View SPIFFS</a></h2>\n<h2>\t\t📥\t\t<a href='/downloadPage'>Download from SPIFFS</a></h2>\n<h2>\t\t📤\t\t<a href='/upload'>Upload to SPIFFS</a></h2>\n<hr>\n<h2>\t\t📤\t\t<a href='/firmware'>Update Firmware</a></h2>\n<hr>\n<h2>\t\t🔄\t\t<a href='/restart'>Restart Device</a></h2>\n</ul>\n</body></html>";
+static const htmlTemplateStep HOME_STEPS[] = {
+    {HOME_FRAGMENT_0, sizeof(HOME_FRAGMENT_0) - 1, HOME_STYLE},
+    {HOME_FRAGMENT_1, sizeof(HOME_FRAGMENT_1) - 1, HTML_TEMPLATE_NO_SLOT},
+};
+static const htmlTemplate HOME_TEMPLATE = {HOME_STEPS, sizeof(HOME_STEPS) / sizeof(HOME_STEPS[0]), HOME_SLOTS};
+
+// lib/htmlRenderer/templates/restart.html
+enum restartSlot : uint8_t
+{
+    RESTART_STYLE,
+    RESTART_SLOTS
+};
+static const char RESTART_FRAGMENT_0[] PROGMEM = "<html><head><meta charset='UTF-8'><title>Restart</title>";
+static const char RESTART_FRAGMENT_1[] PROGMEM = "</head><body><h1>Device Restarting...</h1>\n<p>Please wait a few seconds before reconnecting.</p></body></html>";
+static const htmlTemplateStep RESTART_STEPS[] = {
+    {RESTART_FRAGMENT_0, sizeof(RESTART_FRAGMENT_0) - 1, RESTART_STYLE},
+    {RESTART_FRAGMENT_1, sizeof(RESTART_FRAGMENT_1) - 1, HTML_TEMPLATE_NO_SLOT},
+};
+static const htmlTemplate RESTART_TEMPLATE = {RESTART_STEPS, sizeof(RESTART_STEPS) / sizeof(RESTART_STEPS[0]), RESTART_SLOTS};
+
+// lib/htmlRenderer/templates/upload.html
+enum uploadSlot : uint8_t
+{
+    UPLOAD_STYLE,
+    UPLOAD_SLOTS
+};
+static const char UPLOAD_FRAGMENT_0[] PROGMEM = "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Upload to SPIFFS</title>";
+static const char UPLOAD_FRAGMENT_1[] PROGMEM = "</head><body>\n<h1>Upload File to SPIFFS</h1>\n<form method='POST' action='/upload' enctype='multipart/form-data'>\n<input type='file' name='upload'><br><br><input type='submit' value='Upload'>\n</form><br><a href='/home'>Back to Home</a></body></html>";
+static const htmlTemplateStep UPLOAD_STEPS[] = {
+    {UPLOAD_FRAGMENT_0, sizeof(UPLOAD_FRAGMENT_0) - 1, UPLOAD_STYLE},
+    {UPLOAD_FRAGMENT_1, sizeof(UPLOAD_FRAGMENT_1) - 1, HTML_TEMPLATE_NO_SLOT},
+};
+static const htmlTemplate UPLOAD_TEMPLATE = {UPLOAD_STEPS, sizeof(UPLOAD_STEPS) / sizeof(UPLOAD_STEPS[0]), UPLOAD_SLOTS};
@@ -0,0 +1,48 @@
+// Generated by scripts/embed_style.py from style.css; do not edit.
+#pragma once
+#include <Arduino.h>
+
+// 1658 bytes of CSS, 1349 minified, 562 gzipped
+static const uint8_t STYLE_CSS_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x8d, 0x54, 0xdb, 0x8e, 0x9b, 0x30,
+    0x10, 0xfd, 0x95, 0x48, 0xab, 0x55, 0x5a, 0x69, 0x1d, 0x01, 0x49, 0xd8, 0xd4, 0xa8, 0x0f, 0x55,
+    0xa5, 0xfe, 0x44, 0x95, 0x07, 0x5f, 0xc1, 0x8a, 0xb1, 0x2d, 0xdb, 0x94, 0xa4, 0x88, 0x7f, 0xaf,
+    0x21, 0x24, 0x85, 0xc4, 0xab, 0x16, 0xbf, 0x80, 0xed, 0x99, 0x39, 0x73, 0xe6, 0x1c, 0xb0, 0xa6,
+    0x97, 0x8e, 0x6b, 0xe5, 0x01, 0x47, 0xb5, 0x90, 0x17, 0xe8, 0x90, 0x72, 0xc0, 0x31, 0x2b, 0x78,
+    0x51, 0x23, 0x5b, 0x0a, 0x05, 0xb3, 0xc4, 0x9c, 0x0b, 0x8c, 0xc8, 0xa9, 0xb4, 0xba, 0x51, 0x14,
+    0x10, 0x2d, 0xb5, 0x85, 0x2f, 0x3c, 0xe7, 0x9c, 0xe7, 0xc5, 0xf4, 0x95, 0x91, 0x2d, 0xdb, 0x27,
+    0x7d, 0x95, 0xbe, 0x55, 0x59, 0x37, 0xed, 0x6d, 0xc9, 0x7b, 0xbe, 0xa5, 0xbd, 0x47, 0x58, 0xb2,
+    0x0e, 0x6b, 0x4b, 0x99, 0x1d, 0x82, 0x25, 0x32, 0x8e, 0xc1, 0xdb, 0x4b, 0xd1, 0x0a, 0xea, 0x2b,
+    0x98, 0x26, 0xc9, 0x6b, 0xac, 0xc8, 0xf8, 0xf4, 0xbe, 0x7a, 0xf3, 0x74, 0x4a, 0x01, 0x53, 0x73,
+    0x5e, 0x39, 0x2d, 0x05, 0x5d, 0xbd, 0xe0, 0x8c, 0x1e, 0x70, 0x56, 0x18, 0x44, 0xa9, 0x50, 0x25,
+    0x3c, 0x98, 0x73, 0xb8, 0xda, 0x3d, 0xa7, 0xa1, 0x9c, 0x27, 0xf4, 0x50, 0x78, 0x76, 0xf6, 0x00,
+    0x49, 0x51, 0x2a, 0x28, 0x19, 0xf7, 0xbd, 0xa7, 0x90, 0x0b, 0xeb, 0x3c, 0x20, 0x95, 0x90, 0xb4,
+    0x9b, 0x1d, 0x5b, 0x51, 0x56, 0xbe, 0x18, 0x79, 0x69, 0xd9, 0xf0, 0x0e, 0xb1, 0x96, 0xb4, 0x68,
+    0x2b, 0xe1, 0x19, 0x70, 0x06, 0x11, 0x06, 0x95, 0x6e, 0x2d, 0x32, 0x13, 0xfc, 0x2c, 0x79, 0x1d,
+    0xb2, 0x49, 0x14, 0x4b, 0x36, 0xd6, 0x12, 0xca, 0x34, 0xfe, 0xa7, 0xbf, 0x18, 0xf6, 0x75, 0x3d,
+    0x9c, 0xad, 0x8f, 0x6f, 0xf3, 0x2d, 0x83, 0x9c, 0x6b, 0x43, 0x7f, 0xeb, 0x63, 0x37, 0x27, 0x44,
+    0x9f, 0x81, 0x13, 0xbf, 0x87, 0xde, 0x26, 0xfe, 0xc2, 0x4e, 0x8c, 0x26, 0x14, 0x58, 0x7a, 0x2f,
+    0x9e, 0x09, 0x22, 0x19, 0x4b, 0x48, 0x7e, 0x27, 0x28, 0x0f, 0x93, 0x1c, 0x9b, 0x0a, 0x49, 0x19,
+    0x4c, 0x2d, 0xab, 0x17, 0xb8, 0x48, 0xc5, 0xc8, 0x29, 0x54, 0x08, 0x20, 0xbc, 0x0d, 0x3a, 0xe0,
+    0xda, 0xd6, 0xd0, 0x11, 0x24, 0xd9, 0xa7, 0x74, 0x93, 0x7e, 0x9e, 0x04, 0x01, 0x46, 0x72, 0x60,
+    0xb2, 0xd9, 0xdf, 0xc3, 0x2d, 0x43, 0x54, 0x2b, 0x79, 0x39, 0xce, 0xb8, 0x0f, 0xa8, 0xb6, 0xc3,
+    0xba, 0x29, 0x24, 0xcf, 0xf3, 0x18, 0x40, 0x42, 0x16, 0x10, 0x5c, 0x83, 0x6b, 0xf1, 0x48, 0x0e,
+    0x6e, 0xbc, 0xd7, 0x6a, 0x7d, 0x8c, 0x4c, 0x76, 0xf7, 0xfd, 0xdb, 0x8f, 0x7d, 0x32, 0xd5, 0x18,
+    0xc7, 0x73, 0x2b, 0xa2, 0xb4, 0x62, 0xf7, 0xc6, 0xd3, 0xa0, 0xe1, 0xd5, 0x28, 0x64, 0xd2, 0x58,
+    0x17, 0xae, 0x1a, 0x2d, 0x94, 0x67, 0x36, 0x5a, 0x1b, 0x56, 0xfa, 0x17, 0xb3, 0x51, 0x04, 0xd7,
+    0xa3, 0x18, 0x8e, 0x3d, 0x4a, 0x76, 0x5f, 0xfa, 0xcd, 0x8d, 0x09, 0xc0, 0x05, 0x0b, 0x2a, 0xa0,
+    0xc2, 0x19, 0x89, 0x2e, 0x50, 0x28, 0x29, 0x14, 0x03, 0x58, 0x6a, 0x72, 0x9a, 0x4f, 0x63, 0x75,
+    0x58, 0x78, 0xeb, 0x91, 0xb3, 0xdd, 0x6e, 0x57, 0xcc, 0xcd, 0x59, 0x6b, 0xa5, 0x47, 0xf5, 0x5d,
+    0x4d, 0xb5, 0x21, 0x5a, 0x71, 0x51, 0x82, 0xab, 0xc3, 0x16, 0xba, 0xf9, 0xc0, 0x6c, 0xe3, 0x4d,
+    0x10, 0x10, 0xe9, 0xc6, 0x43, 0xd4, 0x78, 0x7d, 0x9b, 0x29, 0xd6, 0xa1, 0xc1, 0x1a, 0xa6, 0xe3,
+    0x50, 0x9f, 0x93, 0xaf, 0x06, 0x07, 0x46, 0x76, 0xff, 0xd7, 0x94, 0xcf, 0xa1, 0x11, 0x3f, 0xfc,
+    0xe3, 0x56, 0xd4, 0x22, 0xb1, 0xd4, 0x12, 0x61, 0x26, 0xbb, 0x85, 0x58, 0xc7, 0xbe, 0x8a, 0xd8,
+    0x34, 0x7a, 0x63, 0xd9, 0x52, 0xb5, 0xc9, 0xb0, 0xfe, 0x2a, 0x27, 0xc4, 0x0d, 0x33, 0xe7, 0x52,
+    0xb7, 0xe0, 0x3c, 0x72, 0xd6, 0xa3, 0x87, 0x3f, 0xdc, 0x1f, 0xfe, 0x5f, 0x32, 0x64, 0x45, 0x05,
+    0x00, 0x00,
+};
+static const size_t STYLE_CSS_GZ_LEN = sizeof(STYLE_CSS_GZ);
+static const size_t STYLE_CSS_LEN = 1349;
+static const char STYLE_CSS_ETAG[] = "\"10171940495bb35f\"";
+// The version in the URL changes with the CSS, so the file itself can be cached for good
+static const char STYLE_CSS_LINK[] = "<link rel='stylesheet' href='/style.css?v=10171940'>";
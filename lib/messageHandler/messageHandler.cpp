@@ -32,20 +32,29 @@ messageHandler::messageHandler(ringBuffer<deviceDataPacket, DEVICE_MSG_BUFFER_SI
 void messageHandler::loop() {
     deviceDataPacket pkt;
     if (rxQueue && handlerQueue && rxQueue->pop(pkt)) {
-        handlerQueue->push(pkt);
+        packetTraceDequeued(PACKET_QUEUE_RX);
+        packetTraceQueued(PACKET_QUEUE_HANDLER, handlerQueue->push(pkt));
     }
 }
 
 bool messageHandler::enqueue(const deviceDataPacket& pkt) {
-    return txQueue ? txQueue->push(pkt) : false;
+    if (!txQueue) return false;
+    bool queued = txQueue->push(pkt);
+    packetTraceQueued(PACKET_QUEUE_TX, queued);
+    return queued;
 }
 
 bool messageHandler::dequeue(deviceDataPacket& pkt) {
-    return rxQueue ? rxQueue->pop(pkt) : false;
+    if (!rxQueue || !rxQueue->pop(pkt)) return false;
+    packetTraceDequeued(PACKET_QUEUE_RX);
+    return true;
 }
 
 bool messageHandler::routeToHandler(const deviceDataPacket& pkt) {
-    return handlerQueue ? handlerQueue->push(pkt) : false;
+    if (!handlerQueue) return false;
+    bool queued = handlerQueue->push(pkt);
+    packetTraceQueued(PACKET_QUEUE_HANDLER, queued);
+    return queued;
 }
 
 ringBuffer<deviceDataPacket, DEVICE_MSG_BUFFER_SIZE>* messageHandler::getTxQueue() {
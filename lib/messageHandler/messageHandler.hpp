@@ -28,6 +28,7 @@
 #include <deviceDataPacket.h>
 #include <globalConstants.h>
 #include <ringBuffer.hpp>
+#include <packetTrace.hpp>
 #include <messageHandler.hpp>
 
 /**
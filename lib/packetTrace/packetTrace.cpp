@@ -0,0 +1,224 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "packetTrace.hpp"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <deviceDataPacket.h>
+#include <textCodec.hpp>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+static portMUX_TYPE traceLock = portMUX_INITIALIZER_UNLOCKED;
+#define TRACE_LOCK() portENTER_CRITICAL(&traceLock)
+#define TRACE_UNLOCK() portEXIT_CRITICAL(&traceLock)
+#else
+#include <atomic>
+static std::atomic_flag traceLock = ATOMIC_FLAG_INIT;
+#define TRACE_LOCK() while (traceLock.test_and_set(std::memory_order_acquire)) {}
+#define TRACE_UNLOCK() traceLock.clear(std::memory_order_release)
+#endif
+
+static_assert((PACKET_TRACE_EVENTS & (PACKET_TRACE_EVENTS - 1)) == 0, "PACKET_TRACE_EVENTS must be a power of two");
+static_assert(sizeof(packetTraceEvent) == 16, "packetTraceEvent is meant to stay 16 bytes");
+
+namespace {
+
+packetTraceEvent ring[PACKET_TRACE_EVENTS];
+uint32_t head = 0; // Sequence number of the next event; slot is head % PACKET_TRACE_EVENTS
+uint32_t counts[PACKET_KIND_COUNT];
+packetQueueStats queues[PACKET_QUEUE_COUNT];
+
+const char* const KIND_NAMES[PACKET_KIND_COUNT] = {"rx",  "rxFrame",  "rxRejected", "rxDropped",
+                                                   "tx", "txError", "txAcked",    "txFailed"};
+const char* const QUEUE_NAMES[PACKET_QUEUE_COUNT] = {"rx", "tx", "handler"};
+
+// snprintf at out + len; len runs to cap once anything did not fit
+void appendf(char* out, size_t cap, size_t& len, const char* fmt, ...) __attribute__((format(printf, 4, 5)));
+void appendf(char* out, size_t cap, size_t& len, const char* fmt, ...) {
+    if (len >= cap) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(out + len, cap - len, fmt, ap);
+    va_end(ap);
+    len = n < 0 || static_cast<size_t>(n) >= cap - len ? cap : len + static_cast<size_t>(n);
+}
+
+} // namespace
+
+void packetTraceRecord(packetTraceKind kind, const uint8_t* mac, const uint8_t* data, size_t len) {
+    if (kind >= PACKET_KIND_COUNT) return;
+    uint32_t now = millis();
+    TRACE_LOCK();
+    packetTraceEvent& e = ring[head & (PACKET_TRACE_EVENTS - 1)];
+    e.ms = now;
+    e.kind = kind;
+    e.len = len > 255 ? 255 : static_cast<uint8_t>(len);
+    memset(e.head, 0, sizeof(e.head));
+    if (data) memcpy(e.head, data, len < sizeof(e.head) ? len : sizeof(e.head));
+    if (mac) memcpy(e.mac, mac, sizeof(e.mac));
+    else memset(e.mac, 0, sizeof(e.mac));
+    ++head;
+    ++counts[kind];
+    TRACE_UNLOCK();
+}
+
+void packetTraceQueued(packetQueue queue, bool accepted) {
+    if (queue >= PACKET_QUEUE_COUNT) return;
+    TRACE_LOCK();
+    packetQueueStats& q = queues[queue];
+    if (accepted) {
+        ++q.in;
+        if (q.in - q.out > q.peak) q.peak = q.in - q.out;
+    } else {
+        ++q.full;
+    }
+    TRACE_UNLOCK();
+}
+
+void packetTraceDequeued(packetQueue queue) {
+    if (queue >= PACKET_QUEUE_COUNT) return;
+    TRACE_LOCK();
+    ++queues[queue].out;
+    TRACE_UNLOCK();
+}
+
+uint32_t packetTraceCount(packetTraceKind kind) {
+    if (kind >= PACKET_KIND_COUNT) return 0;
+    TRACE_LOCK();
+    uint32_t n = counts[kind];
+    TRACE_UNLOCK();
+    return n;
+}
+
+packetQueueStats packetTraceQueueStats(packetQueue queue) {
+    packetQueueStats q;
+    if (queue >= PACKET_QUEUE_COUNT) return q;
+    TRACE_LOCK();
+    q = queues[queue];
+    TRACE_UNLOCK();
+    return q;
+}
+
+const char* packetTraceKindName(packetTraceKind kind) {
+    return kind < PACKET_KIND_COUNT ? KIND_NAMES[kind] : "?";
+}
+
+uint32_t packetTraceHead() {
+    TRACE_LOCK();
+    uint32_t h = head;
+    TRACE_UNLOCK();
+    return h;
+}
+
+size_t packetTraceEventToJson(const packetTraceEvent& event, char* out, size_t cap) {
+    char mac[MAC_TEXT_LEN + 1];
+    formatMac(event.mac, mac);
+    size_t len = 0;
+    appendf(out, cap, len, "{\"t\":%u,\"ev\":\"%s\",\"mac\":\"%s\",\"len\":%u", static_cast<unsigned>(event.ms),
+            packetTraceKindName(static_cast<packetTraceKind>(event.kind)), mac, event.len);
+    if (event.len == sizeof(deviceDataPacket))
+        appendf(out, cap, len, ",\"cmd\":%u,\"flags\":%u,\"seq\":%u", event.head[1], event.head[2], event.head[3]);
+    else if (event.len)
+        appendf(out, cap, len, ",\"type\":%u", event.head[0]); // Beacons, sync frames
+    appendf(out, cap, len, "}");
+    return len < cap ? len : 0;
+}
+
+size_t packetTraceStatsToJson(uint32_t lost, char* out, size_t cap) {
+    uint32_t c[PACKET_KIND_COUNT];
+    packetQueueStats q[PACKET_QUEUE_COUNT];
+    TRACE_LOCK();
+    memcpy(c, counts, sizeof(c));
+    memcpy(q, queues, sizeof(q));
+    TRACE_UNLOCK();
+
+    size_t len = 0;
+    if (cap) out[0] = '\0';
+    appendf(out, cap, len, "{\"t\":%u,\"counts\":{", static_cast<unsigned>(millis()));
+    for (uint8_t k = 0; k < PACKET_KIND_COUNT; ++k)
+        appendf(out, cap, len, "%s\"%s\":%u", k ? "," : "", KIND_NAMES[k], static_cast<unsigned>(c[k]));
+    appendf(out, cap, len, "},\"queues\":{");
+    for (uint8_t i = 0; i < PACKET_QUEUE_COUNT; ++i)
+        appendf(out, cap, len, "%s\"%s\":{\"depth\":%u,\"peak\":%u,\"full\":%u,\"in\":%u}", i ? "," : "",
+                QUEUE_NAMES[i], static_cast<unsigned>(q[i].in - q[i].out), static_cast<unsigned>(q[i].peak),
+                static_cast<unsigned>(q[i].full), static_cast<unsigned>(q[i].in));
+    appendf(out, cap, len, "},\"lost\":%u}", static_cast<unsigned>(lost));
+    return len < cap ? len : 0;
+}
+
+// ---- Readers --------------------------------------------------------------------
+
+packetTraceReader::packetTraceReader() : _next(packetTraceHead()), _statsAt(millis()) {}
+
+bool packetTraceReader::next(packetTraceEvent& event) {
+    TRACE_LOCK();
+    if (head - _next > PACKET_TRACE_EVENTS) {
+        _lost += head - _next - PACKET_TRACE_EVENTS; // Overwritten before this viewer got to them
+        _next = head - PACKET_TRACE_EVENTS;
+    }
+    bool available = _next != head;
+    if (available) event = ring[_next++ & (PACKET_TRACE_EVENTS - 1)];
+    TRACE_UNLOCK();
+    return available;
+}
+
+// Next line into _line: counters when due (and first thing), else the next
+// event, preceded by a {"lost":n} line when the ring overtook this reader
+bool packetTraceReader::nextLine(uint32_t nowMs) {
+    size_t cap = sizeof(_line) - 1; // Room for the newline
+    size_t len = 0;
+    packetTraceEvent event;
+    if (!_statsSent || nowMs - _statsAt >= PACKET_TRACE_STATS_MS) {
+        _statsSent = true;
+        _statsAt = nowMs;
+        len = packetTraceStatsToJson(_lost, _line, cap);
+    } else if (next(event)) {
+        if (_lost != _lostReported) {
+            appendf(_line, cap, len, "{\"lost\":%u}\n", static_cast<unsigned>(_lost - _lostReported));
+            _lostReported = _lost;
+        }
+        size_t n = packetTraceEventToJson(event, _line + len, cap - len);
+        len = n ? len + n : 0;
+    }
+    if (len) _line[len++] = '\n';
+    _lineLen = len;
+    _lineSent = 0;
+    return len > 0;
+}
+
+size_t packetTraceReader::fill(uint8_t* buffer, size_t capacity, uint32_t nowMs) {
+    size_t length = 0;
+    while (length < capacity) {
+        if (_lineSent == _lineLen && !nextLine(nowMs)) break;
+        size_t n = _lineLen - _lineSent;
+        if (n > capacity - length) n = capacity - length;
+        memcpy(buffer + length, _line + _lineSent, n);
+        _lineSent += n;
+        length += n;
+    }
+    return length;
+}
@@ -0,0 +1,130 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Live view of ESP-NOW traffic: a summary of every frame received or
+ * sent, link counters and queue depths, for /packets/stream.
+ *
+ * The radio side (espNowCoPilot callbacks in the WiFi task, sends from the
+ * loop task) writes 16-byte summaries into a fixed ring of
+ * PACKET_TRACE_EVENTS entries under a short critical section; it never
+ * allocates and never waits for a reader. Each viewer reads through its own
+ * packetTraceReader cursor. A viewer that falls more than a ring behind loses
+ * the oldest events, is told how many, and nobody else is held up: a slow
+ * browser costs only its own history.
+ */
+
+#ifndef PACKET_TRACE_EVENTS
+#define PACKET_TRACE_EVENTS 256 // Power of two; 16 bytes each
+#endif
+
+#ifndef PACKET_TRACE_STATS_MS
+#define PACKET_TRACE_STATS_MS 1000 // Counter/queue line interval per viewer
+#endif
+
+#define PACKET_TRACE_LINE_MAX 512 // Longest line a reader emits (the counters line)
+
+enum packetTraceKind : uint8_t {
+    PACKET_RX = 0,       // Received and queued for the application
+    PACKET_RX_FRAME,     // Taken by the frame hook (config sync)
+    PACKET_RX_REJECTED,  // Wrong length, or failed the AEAD open / tag check
+    PACKET_RX_DROPPED,   // Valid, but the rx queue was full
+    PACKET_TX,           // Handed to esp_now_send
+    PACKET_TX_ERROR,     // Refused before it reached the air
+    PACKET_TX_ACKED,     // Send callback: delivered
+    PACKET_TX_FAILED,    // Send callback: no ack
+    PACKET_KIND_COUNT
+};
+
+enum packetQueue : uint8_t {
+    PACKET_QUEUE_RX = 0,  // Radio -> messageHandler
+    PACKET_QUEUE_TX,      // messageHandler -> radio
+    PACKET_QUEUE_HANDLER, // messageHandler -> pairing / application
+    PACKET_QUEUE_COUNT
+};
+
+struct packetTraceEvent {
+    uint32_t ms;
+    uint8_t kind;
+    uint8_t len;     // Frame length; 0 for send callbacks
+    uint8_t head[4]; // First bytes: version, command, flags, seqId of a deviceDataPacket
+    uint8_t mac[6];  // Peer; zero for "all peers"
+};
+
+// Depth is in - out; both sides count, so it needs no access to the queue itself
+struct packetQueueStats {
+    uint32_t in = 0;
+    uint32_t out = 0;
+    uint32_t full = 0;  // Pushes refused
+    uint32_t peak = 0;  // Deepest seen
+};
+
+// Radio side
+void packetTraceRecord(packetTraceKind kind, const uint8_t* mac, const uint8_t* data, size_t len);
+void packetTraceQueued(packetQueue queue, bool accepted);
+void packetTraceDequeued(packetQueue queue);
+
+uint32_t packetTraceCount(packetTraceKind kind);
+packetQueueStats packetTraceQueueStats(packetQueue queue);
+const char* packetTraceKindName(packetTraceKind kind);
+uint32_t packetTraceHead(); // Events recorded so far; the sequence number of the next one
+
+size_t packetTraceEventToJson(const packetTraceEvent& event, char* out, size_t cap); // 0 when it does not fit
+size_t packetTraceStatsToJson(uint32_t lost, char* out, size_t cap);                // 0 when it does not fit
+
+/**
+ * One viewer's position in the event ring, and the JSON-lines stream it is
+ * sent as: event lines, a counters line every PACKET_TRACE_STATS_MS, and a
+ * {"lost":n} line after falling behind. Lines are split freely across
+ * buffers, so any buffer size works.
+ */
+class packetTraceReader {
+public:
+    packetTraceReader(); // Starts at the newest event: traffic from the moment the viewer connected
+
+    bool next(packetTraceEvent& event); // false when caught up
+    uint32_t lost() const { return _lost; }
+
+    // Bytes placed in buffer; 0 when there is nothing to send yet
+    size_t fill(uint8_t* buffer, size_t capacity, uint32_t nowMs);
+
+private:
+    bool nextLine(uint32_t nowMs);
+
+    uint32_t _next;
+    uint32_t _lost = 0;
+    uint32_t _lostReported = 0;
+    uint32_t _statsAt;
+    bool _statsSent = false;
+    char _line[PACKET_TRACE_LINE_MAX];
+    size_t _lineLen = 0;
+    size_t _lineSent = 0;
+};
@@ -37,6 +37,14 @@ constexpr unsigned long heartbeatIntervalMs = 5000;
 pairingManager::pairingManager(radioInterface* radioIn, messageHandler* messengerIn)
     : radio(radioIn), messenger(messengerIn) {}
 
+void pairingManager::setSessionSecret(const uint8_t* secret, size_t len,
+                                      const uint8_t* localMac, const uint8_t* localNonce) {
+    sessionSecretLen = len < sizeof(sessionSecret) ? len : sizeof(sessionSecret);
+    memcpy(sessionSecret, secret, sessionSecretLen);
+    memcpy(selfMac, localMac, sizeof(selfMac));
+    memcpy(selfNonce, localNonce, sizeof(selfNonce));
+}
+
 void pairingManager::beginPairing() {
     pairSequence = random(1, 250);
     retryCount = 0;
@@ -68,7 +76,7 @@ deviceDataPacket pairingManager::makePacket(CommandCode cmd) {
 
 //    memcpy(pkt.senderMac, radio->getMacAddress(), 6);
     memcpy(pkt.nonce, &pkt.seqId, sizeof(pkt.nonce));  // Simple nonce example
-    memset(pkt.tag, 0, sizeof(pkt.tag));  // Optional: fill with HMAC or checksum
+    memset(pkt.tag, 0, sizeof(pkt.tag));  // Filled at send time by packetCipher or packetTagger
 
     return pkt;
 }
@@ -76,7 +84,7 @@ deviceDataPacket pairingManager::makePacket(CommandCode cmd) {
 void pairingManager::sendPairRequest() {
     deviceDataPacket pkt = makePacket(CommandCode::PairRequest);
     pkt.seqId = pairSequence;
-    pkt.flags |= 0x01;  // Example: mark as ackRequired
+    pkt.flags |= PKT_FLAG_ACK_REQUIRED;
     messenger->enqueue(pkt);
     lastAction = millis();
     ++retryCount;
@@ -116,10 +124,84 @@ void pairingManager::loop() {
     }
 }
 
+// Boss nonce of an offer (or of the confirmation echoing it): values[] then nonce[]
+static void offerNonce(const deviceDataPacket& pkt, uint8_t* bossNonce) {
+    memcpy(bossNonce, pkt.values, sizeof(pkt.values));
+    memcpy(bossNonce + sizeof(pkt.values), pkt.nonce, sizeof(pkt.nonce));
+}
+
+bool pairingManager::acceptSessionOffer(const deviceDataPacket& pkt, uint8_t* lmkOut) {
+    uint8_t bossNonce[SESSION_NONCE_LEN];
+    offerNonce(pkt, bossNonce);
+
+    if (!deriveSessionKey(sessionSecret, sessionSecretLen, selfNonce, bossNonce,
+                          selfMac, pkt.senderMac, pkt.seqId, lmkOut))
+        return false;
+
+    // Offers are broadcast; the confirmation tag tells us this one is ours
+    uint8_t expected[SESSION_CONFIRM_LEN];
+    computeSessionConfirm(lmkOut, selfMac, pkt.seqId, expected);
+    return memcmp(expected, pkt.tag, sizeof(expected)) == 0;
+}
+
+void pairingManager::sendKeyConfirm(const deviceDataPacket& offer, const uint8_t* lmk) {
+    if (!radio) return;
+    deviceDataPacket pkt = {};
+    pkt.version = 1;
+    pkt.command = static_cast<uint8_t>(CommandCode::KeyConfirm);
+    pkt.seqId = offer.seqId;
+    memcpy(pkt.values, offer.values, sizeof(pkt.values));  // Echo the boss nonce: names the offer
+    memcpy(pkt.nonce, offer.nonce, sizeof(pkt.nonce));
+    // Keyed with the new LMK and bound to the boss MAC, so an offer's own tag cannot pass for it
+    computeSessionConfirm(lmk, offer.senderMac, offer.seqId, pkt.tag);
+    memcpy(pkt.senderMac, selfMac, sizeof(selfMac));
+
+    // Broadcast: until it reads this, the boss still holds the previous LMK for us
+    static const uint8_t broadcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    radio->sendFrame(broadcast, reinterpret_cast<const uint8_t*>(&pkt), sizeof(pkt));
+}
+
 void pairingManager::handlePacket(const deviceDataPacket& pkt) {
     CommandCode cmd = static_cast<CommandCode>(pkt.command);
 
-    if (cmd == CommandCode::PairAccept || cmd == CommandCode::Ack) {
+    if (sessionSecretLen && (cmd == CommandCode::PairAccept || cmd == CommandCode::KeyRotate)) {
+        bool fromPeer = state == pairingState::connected && memcmp(peerMac, pkt.senderMac, 6) == 0;
+        if (cmd == CommandCode::KeyRotate && !fromPeer) return;
+
+        // The offer we already run on, sent again because our confirmation was lost
+        uint8_t bossNonce[SESSION_NONCE_LEN];
+        offerNonce(pkt, bossNonce);
+        bool current = fromPeer && pkt.seqId == keyEpoch && memcmp(bossNonce, peerNonce, sizeof(peerNonce)) == 0;
+        // Rotations only move forward, so a replayed older KeyRotate cannot roll the key back
+        if (cmd == CommandCode::KeyRotate && !current && static_cast<int8_t>(pkt.seqId - keyEpoch) <= 0) return;
+
+        uint8_t lmk[SESSION_KEY_LEN];
+        if (!acceptSessionOffer(pkt, lmk)) {
+            memset(lmk, 0, sizeof(lmk));
+            return;  // Someone else's offer, or forged
+        }
+
+        if (!current) {
+            memcpy(peerMac, pkt.senderMac, 6);
+            memcpy(peerNonce, bossNonce, sizeof(peerNonce));
+            keyEpoch = pkt.seqId;
+            uint8_t channel = pkt.flags & PKT_OFFER_CHANNEL_MASK;
+            bool appCrypto = (pkt.flags & PKT_OFFER_APP_CRYPTO) && cipher;
+            if (appCrypto) cipher->setPeerKey(peerMac, lmk);
+            if (radio) {
+                // A PairAccept is a new session: the boss may have rebooted and restarted its counter
+                if (cmd == CommandCode::PairAccept) radio->forgetPeer(peerMac);
+                // Replaces the LMK in place on rotation
+                radio->addPeer(peerMac, channel, appCrypto ? nullptr : lmk);
+            }
+            if (cmd == CommandCode::PairAccept) {
+                peerLastSequence = pkt.seqId;
+                transition(pairingState::connected);
+            }
+        }
+        sendKeyConfirm(pkt, lmk);
+        memset(lmk, 0, sizeof(lmk));
+    } else if (cmd == CommandCode::PairAccept || cmd == CommandCode::Ack) {
         memcpy(peerMac, pkt.senderMac, 6);
         peerLastSequence = pkt.seqId;
 
@@ -27,6 +27,8 @@
 #include <Arduino.h>
 #include <globalConstants.h>
 #include <deviceDataPacket.h>
+#include <sessionKey.hpp>
+#include <packetCipher.hpp>
 
 class radioInterface;
 class messageHandler;
@@ -49,6 +51,12 @@ public:
     static const char* toString(pairingState state);
     void setRadio(radioInterface* radioIn) { radio = radioIn; }
 
+    // Enables LMK derivation from PairAccept / KeyRotate offers
+    void setSessionSecret(const uint8_t* secret, size_t len,
+                          const uint8_t* localMac, const uint8_t* localNonce);
+    uint8_t getKeyEpoch() const { return keyEpoch; }
+    void setCipher(packetCipher* c) { cipher = c; }
+
 private:
     pairingState state = pairingState::idle;
     radioInterface* radio = nullptr;
@@ -60,8 +68,18 @@ private:
     uint8_t peerLastSequence = 0;
     uint8_t peerMac[6] = {0};
 
+    uint8_t sessionSecret[64] = {0};
+    size_t sessionSecretLen = 0;
+    uint8_t selfMac[6] = {0};
+    uint8_t selfNonce[SESSION_NONCE_LEN] = {0};
+    uint8_t keyEpoch = 0;
+    uint8_t peerNonce[SESSION_NONCE_LEN] = {0};  // Boss half of the salt for the installed key
+    packetCipher* cipher = nullptr;
+
     void transition(pairingState nextState);
     void sendPairRequest();
     void sendHeartbeat();
     deviceDataPacket makePacket(CommandCode cmd);
+    bool acceptSessionOffer(const deviceDataPacket& pkt, uint8_t* lmkOut);
+    void sendKeyConfirm(const deviceDataPacket& offer, const uint8_t* lmk);
 };
\ No newline at end of file
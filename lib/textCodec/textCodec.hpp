@@ -0,0 +1,253 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @brief Allocation-free text conversions for MACs, IPv4 addresses, hex keys,
+ * integers and HTTP byte ranges.
+ *
+ * Everything works on (pointer, length) and caller-owned buffers, so callers
+ * pass String::c_str() / length() and a stack array. Parsers are strict:
+ * trailing junk, overflow or a wrong digit count fails instead of being
+ * silently truncated the way strtol() would.
+ */
+
+constexpr size_t MAC_TEXT_LEN = 17;   // "AA:BB:CC:DD:EE:FF"
+constexpr size_t IPV4_TEXT_MAX = 15;  // "255.255.255.255"
+constexpr size_t INT_TEXT_MAX = 11;   // "-2147483648"
+
+// Nibble value of each character; 0xFF for anything that is not a hex digit
+constexpr uint8_t TEXT_HEX_VALUE[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+constexpr char TEXT_HEX_DIGITS[] = "0123456789ABCDEF";
+
+inline uint8_t hexValue(char c) { return TEXT_HEX_VALUE[static_cast<uint8_t>(c)]; }
+
+/**
+ * @brief Hex text to bytes. Accepts an optional "0x" prefix and ':', '-' or
+ * ' ' between digits. Returns the byte count, or 0 when a character is not
+ * hex, the digit count is odd, or more than outMax bytes would be written.
+ */
+inline size_t parseHex(const char* text, size_t len, uint8_t* out, size_t outMax) {
+    if (len >= 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        text += 2;
+        len -= 2;
+    }
+    size_t n = 0;
+    uint8_t hi = 0xFF;
+    for (size_t i = 0; i < len; ++i) {
+        char c = text[i];
+        if (c == ':' || c == '-' || c == ' ') continue;
+        uint8_t nibble = hexValue(c);
+        if (nibble == 0xFF) return 0;
+        if (hi == 0xFF) {
+            if (n == outMax) return 0;
+            hi = nibble;
+            continue;
+        }
+        out[n++] = static_cast<uint8_t>((hi << 4) | nibble);
+        hi = 0xFF;
+    }
+    return hi == 0xFF ? n : 0;
+}
+
+// Upper-case hex, optionally split by sep; writes a terminating NUL. Returns the text length.
+inline size_t formatHex(const uint8_t* data, size_t len, char* out, size_t outCap, char sep = 0) {
+    size_t per = sep ? 3 : 2;
+    if (outCap == 0 || (len && len * per - (sep ? 1 : 0) + 1 > outCap)) {
+        if (outCap) out[0] = '\0';
+        return 0;
+    }
+    char* p = out;
+    for (size_t i = 0; i < len; ++i) {
+        if (sep && i) *p++ = sep;
+        *p++ = TEXT_HEX_DIGITS[data[i] >> 4];
+        *p++ = TEXT_HEX_DIGITS[data[i] & 0x0F];
+    }
+    *p = '\0';
+    return p - out;
+}
+
+/**
+ * @brief "AA:BB:CC:DD:EE:FF", "aa-bb-cc-dd-ee-ff" or twelve bare hex digits.
+ * Separators, when present, must sit between every pair.
+ */
+inline bool parseMac(const char* text, size_t len, uint8_t* mac) {
+    if (len != 12 && len != MAC_TEXT_LEN) return false;
+    size_t step = len == 12 ? 2 : 3;
+    char sep = len == 12 ? 0 : text[2];
+    if (sep && sep != ':' && sep != '-') return false;
+    for (size_t i = 0; i < 6; ++i) {
+        const char* p = text + i * step;
+        uint8_t hi = hexValue(p[0]);
+        uint8_t lo = hexValue(p[1]);
+        if (hi == 0xFF || lo == 0xFF) return false;
+        if (sep && i < 5 && p[2] != sep) return false;
+        mac[i] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    return true;
+}
+
+// Canonical upper-case, colon-separated form; out needs MAC_TEXT_LEN + 1 bytes
+inline size_t formatMac(const uint8_t* mac, char* out) {
+    return formatHex(mac, 6, out, MAC_TEXT_LEN + 1, ':');
+}
+
+// Dotted-quad IPv4, one to three digits per octet
+inline bool parseIPv4(const char* text, size_t len, uint8_t* ip) {
+    size_t part = 0, digits = 0;
+    unsigned octet = 0;
+    for (size_t i = 0; i <= len; ++i) {
+        char c = i < len ? text[i] : '.';
+        if (c >= '0' && c <= '9') {
+            octet = octet * 10 + (c - '0');
+            if (++digits > 3 || octet > 255) return false;
+        } else if (c == '.' && digits > 0 && part < 4) {
+            ip[part++] = static_cast<uint8_t>(octet);
+            digits = octet = 0;
+        } else {
+            return false;
+        }
+    }
+    return part == 4;
+}
+
+// out needs IPV4_TEXT_MAX + 1 bytes
+inline size_t formatIPv4(const uint8_t* ip, char* out) {
+    char* p = out;
+    for (size_t i = 0; i < 4; ++i) {
+        if (i) *p++ = '.';
+        uint8_t v = ip[i];
+        if (v >= 100) *p++ = '0' + v / 100;
+        if (v >= 10) *p++ = '0' + v / 10 % 10;
+        *p++ = '0' + v % 10;
+    }
+    *p = '\0';
+    return p - out;
+}
+
+// Optional '-', then decimal digits only; fails on overflow of int32_t
+inline bool parseInt(const char* text, size_t len, int32_t& out) {
+    bool negative = len > 0 && text[0] == '-';
+    size_t i = negative ? 1 : 0;
+    if (i == len) return false;
+    uint32_t limit = negative ? 2147483648u : 2147483647u;
+    uint32_t value = 0;
+    for (; i < len; ++i) {
+        char c = text[i];
+        if (c < '0' || c > '9') return false;
+        uint32_t digit = c - '0';
+        if (value > (limit - digit) / 10) return false;
+        value = value * 10 + digit;
+    }
+    out = negative ? static_cast<int32_t>(0u - value) : static_cast<int32_t>(value);
+    return true;
+}
+
+// out needs INT_TEXT_MAX + 1 bytes
+inline size_t formatInt(int32_t value, char* out) {
+    char digits[INT_TEXT_MAX];
+    size_t n = 0;
+    uint32_t v = value < 0 ? 0u - static_cast<uint32_t>(value) : static_cast<uint32_t>(value);
+    do {
+        digits[n++] = '0' + v % 10;
+        v /= 10;
+    } while (v);
+    char* p = out;
+    if (value < 0) *p++ = '-';
+    while (n) *p++ = digits[--n];
+    *p = '\0';
+    return p - out;
+}
+
+// HTTP Range header (RFC 7233), single range only
+enum byteRangeResult : uint8_t {
+    BYTE_RANGE_NONE,          // Not one well-formed bytes range: ignore it and send everything
+    BYTE_RANGE_OK,            // [first, last] lies within the resource
+    BYTE_RANGE_UNSATISFIABLE  // Well formed, but starts past the end: 416
+};
+
+// "bytes=a-b", "bytes=a-" or "bytes=-n" against a resource of total bytes; last is clamped to the end
+inline byteRangeResult parseByteRange(const char* text, size_t len, size_t total, size_t& first, size_t& last) {
+    static const char unit[] = "bytes=";
+    const size_t unitLen = sizeof(unit) - 1;
+    if (len <= unitLen || memcmp(text, unit, unitLen) != 0) return BYTE_RANGE_NONE;
+    text += unitLen;
+    len -= unitLen;
+
+    size_t dash = 0;
+    while (dash < len && text[dash] != '-') ++dash;
+    if (dash == len) return BYTE_RANGE_NONE;
+    auto number = [](const char* digits, size_t n, size_t& out) {
+        if (n == 0 || n > 10) return false;
+        uint64_t value = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (digits[i] < '0' || digits[i] > '9') return false;
+            value = value * 10 + (digits[i] - '0');
+        }
+        if (value > SIZE_MAX) return false;
+        out = static_cast<size_t>(value);
+        return true;
+    };
+
+    size_t start = 0, end = 0;
+    bool hasStart = dash > 0, hasEnd = dash + 1 < len;
+    if ((hasStart && !number(text, dash, start)) || (hasEnd && !number(text + dash + 1, len - dash - 1, end)))
+        return BYTE_RANGE_NONE; // Also catches lists: "0-1,5-6"
+    if (!hasStart) {
+        if (!hasEnd) return BYTE_RANGE_NONE;
+        if (end == 0 || total == 0) return BYTE_RANGE_UNSATISFIABLE; // Suffix of nothing
+        first = end < total ? total - end : 0;
+        last = total - 1;
+        return BYTE_RANGE_OK;
+    }
+    if (hasEnd && end < start) return BYTE_RANGE_NONE;
+    if (start >= total) return BYTE_RANGE_UNSATISFIABLE;
+    first = start;
+    last = hasEnd && end < total ? end : total - 1;
+    return BYTE_RANGE_OK;
+}
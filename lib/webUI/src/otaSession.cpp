@@ -0,0 +1,203 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "otaSession.h"
+#include <textCodec.hpp>
+#if defined(ESP32)
+#include <Update.h>
+
+namespace
+{
+class updateSink : public otaSink
+{
+public:
+    bool begin(size_t maxSize) override { return Update.begin(maxSize ? maxSize : UPDATE_SIZE_UNKNOWN); }
+    size_t write(const uint8_t *data, size_t len) override { return Update.write(const_cast<uint8_t *>(data), len); }
+    bool end() override { return Update.end(true); } // maxSize included the multipart framing
+    void abort() override { Update.abort(); }
+    const char *errorText() override { return Update.errorString(); }
+};
+} // namespace
+
+otaSink &firmwareSink()
+{
+    static updateSink sink;
+    return sink;
+}
+#endif
+
+otaSession::~otaSession()
+{
+    _writer.end(); // Update is not touched from two tasks at once
+    if (_state == OTA_WRITING || _state == OTA_VERIFYING)
+        _sink.abort(); // Dropped connection: the running image stays
+}
+
+bool otaSession::begin(const String &expectedHex, size_t maxSize)
+{
+    _startMs = millis();
+    _maxSize = maxSize;
+    if (parseHex(expectedHex.c_str(), expectedHex.length(), _expected, sizeof(_expected)) != sizeof(_expected))
+    {
+        fail("expected a SHA-256 digest (64 hex digits)", true);
+        return false;
+    }
+    if (!_writer.begin())
+    {
+        fail("not enough memory");
+        return false;
+    }
+    if (!_sink.begin(maxSize))
+    {
+        fail(_sink.errorText());
+        return false;
+    }
+    _hash.reset();
+    _state = OTA_WRITING;
+    return true;
+}
+
+bool otaSession::write(const uint8_t *data, size_t len)
+{
+    if (_state != OTA_WRITING)
+        return false;
+    _hash.update(data, len);
+    _received += len;
+    if (!_writer.write(data, len)) // A block written earlier may be the one that failed
+    {
+        fail(_sink.errorText());
+        return false;
+    }
+    return true;
+}
+
+bool otaSession::finish()
+{
+    if (_state != OTA_WRITING)
+        return false;
+    uint8_t digest[sha256Stream::DIGEST_LEN];
+    _hash.finish(digest);
+    uint8_t diff = 0;
+    for (size_t i = 0; i < sizeof(digest); ++i)
+        diff |= digest[i] ^ _expected[i];
+    _digestOk = diff == 0;
+    _state = OTA_VERIFYING;
+    _writer.finish(complete);
+    return true;
+}
+
+// Runs on the deferredWork worker once the last block is written (inline without a worker)
+void otaSession::complete(void *self)
+{
+    otaSession *session = static_cast<otaSession *>(self);
+    if (session->_writer.failed())
+        session->stop(session->_sink.errorText(), false);
+    else if (!session->_digestOk)
+        session->stop("SHA-256 mismatch", true);
+    else if (!session->_sink.end())
+        session->stop(session->_sink.errorText(), false);
+    else
+    {
+        session->_endMs = millis();
+        session->_state = OTA_DONE;
+    }
+}
+
+// Runs on the deferredWork worker, or inline when it cannot take the block
+bool otaSession::writeToSink(void *self, const uint8_t *data, size_t len)
+{
+    return static_cast<otaSession *>(self)->_sink.write(data, len) == len;
+}
+
+void otaSession::fail(const char *why, bool rejected)
+{
+    _writer.end();
+    stop(why, rejected);
+}
+
+void otaSession::stop(const char *why, bool rejected)
+{
+    if (_state == OTA_WRITING || _state == OTA_VERIFYING)
+        _sink.abort();
+    _error = why;
+    _rejected = rejected;
+    _endMs = millis();
+    _state = OTA_FAILED;
+}
+
+const char *otaSession::stateText() const
+{
+    switch (_state)
+    {
+    case OTA_WRITING:
+        return "writing";
+    case OTA_VERIFYING:
+        return "verifying";
+    case OTA_DONE:
+        return "done";
+    case OTA_FAILED:
+        return "failed";
+    default:
+        return "idle";
+    }
+}
+
+uint8_t otaSession::percent() const
+{
+    if (_state == OTA_DONE)
+        return 100;
+    if (!_maxSize)
+        return 0;
+    size_t p = static_cast<uint64_t>(_received) * 100 / _maxSize;
+    return p > 99 ? 99 : static_cast<uint8_t>(p); // The bound includes the framing
+}
+
+uint32_t otaSession::kbPerSecond() const
+{
+    uint32_t ms = (_endMs ? _endMs : millis()) - _startMs;
+    return ms ? static_cast<uint32_t>(static_cast<uint64_t>(_received) * 1000 / 1024 / ms) : 0;
+}
+
+bool otaSession::progressDue()
+{
+    uint8_t now = percent();
+    if (now == _reportedPercent && _state == _reportedState)
+        return false;
+    _reportedPercent = now;
+    _reportedState = _state;
+    return true;
+}
+
+bool otaSession::progressJson(char *out, size_t capacity) const
+{
+    int n = snprintf(out, capacity, "{\"state\":\"%s\",\"received\":%u,\"expected\":%u,\"percent\":%u,\"kbps\":%u",
+                     stateText(), static_cast<unsigned>(_received), static_cast<unsigned>(_maxSize), percent(),
+                     static_cast<unsigned>(kbPerSecond()));
+    if (n > 0 && _error && static_cast<size_t>(n) < capacity)
+        n += snprintf(out + n, capacity - n, ",\"error\":\"%s\"", _error); // Fixed texts; no quotes to escape
+    if (n > 0 && static_cast<size_t>(n) < capacity)
+        n += snprintf(out + n, capacity - n, "}");
+    return n > 0 && static_cast<size_t>(n) < capacity;
+}
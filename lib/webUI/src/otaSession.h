@@ -0,0 +1,124 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <cryptoBackend.hpp>
+#include <deferredWork.hpp>
+#include <atomic>
+
+// Blocks handed to the sink: one flash sector, what Update erases and writes at a time
+#ifndef OTA_WRITE_BLOCK
+#define OTA_WRITE_BLOCK 4096
+#endif
+
+/**
+ * @brief Where an OTA image goes once it has been hashed; firmwareSink()
+ * writes through the core's Update to the next OTA partition.
+ */
+class otaSink
+{
+public:
+    virtual ~otaSink() {}
+    virtual bool begin(size_t maxSize) = 0; // maxSize bounds the image: early "does not fit"
+    virtual size_t write(const uint8_t *data, size_t len) = 0;
+    virtual bool end() = 0; // Image complete: make it the boot image
+    virtual void abort() = 0;
+    virtual const char *errorText() = 0;
+};
+
+otaSink &firmwareSink(); // Defined for ESP32 builds only
+
+/**
+ * @brief One firmware update, streamed: every chunk is hashed (SHA-256) as
+ * it is written, and finish() only activates the image when the digest
+ * matches the one the operator supplied with the upload.
+ *
+ * Hashing happens in the caller's task; the sink is written in OTA_WRITE_BLOCK
+ * blocks by the deferredWork worker, DEFERRED_WRITER_BLOCKS held at most, so
+ * memory does not grow with the image and the web callback does not wait on
+ * flash erases as long as it keeps within room(). finish() checks the digest
+ * and leaves the last block and the activation to the worker; the state stays
+ * OTA_VERIFYING until that has run. A session that is destroyed before it
+ * reached OTA_DONE aborts the sink; the running firmware stays the boot image.
+ */
+class otaSession
+{
+public:
+    enum state : uint8_t
+    {
+        OTA_IDLE,
+        OTA_WRITING,
+        OTA_VERIFYING,
+        OTA_DONE,
+        OTA_FAILED
+    };
+
+    explicit otaSession(otaSink &sink) : _sink(sink), _writer("ota", OTA_WRITE_BLOCK, writeToSink, this) {}
+    ~otaSession();
+
+    // expectedHex: 64 hex digits; maxSize: Content-Length, the upper bound on the image
+    bool begin(const String &expectedHex, size_t maxSize);
+    bool write(const uint8_t *data, size_t len);
+    bool finish(); // Returns at once; OTA_VERIFYING until the worker has activated the image
+    void fail(const char *why, bool rejected = false);
+
+    size_t room() const { return _writer.room(); } // What write() takes without waiting on flash
+    state getState() const { return _state; }
+    const char *stateText() const;
+    const char *error() const { return _error; }
+    bool rejected() const { return _rejected; } // The image or its digest was at fault, not the flash
+    size_t received() const { return _received; }
+    uint8_t percent() const;
+    uint32_t kbPerSecond() const;
+
+    // True when the browser should hear about it: another percent, or a new state
+    bool progressDue();
+    // {"state":..,"received":..,"expected":..,"percent":..,"kbps":..[,"error":..]}; false if it did not fit
+    bool progressJson(char *out, size_t capacity) const;
+
+private:
+    otaSession(const otaSession &) = delete;
+    otaSession &operator=(const otaSession &) = delete;
+
+    static bool writeToSink(void *self, const uint8_t *data, size_t len);
+    static void complete(void *self);
+    void stop(const char *why, bool rejected);
+
+    otaSink &_sink;
+    deferredWriter _writer;
+    sha256Stream _hash;
+    uint8_t _expected[sha256Stream::DIGEST_LEN];
+    std::atomic<state> _state{OTA_IDLE}; // complete() sets it on the worker, after _error and _endMs
+    bool _digestOk = false;
+    const char *_error = nullptr;
+    bool _rejected = false;
+    size_t _maxSize = 0;
+    size_t _received = 0;
+    uint32_t _startMs = 0;
+    uint32_t _endMs = 0;
+    uint8_t _reportedPercent = 0;
+    state _reportedState = OTA_IDLE;
+};
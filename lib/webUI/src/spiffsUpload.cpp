@@ -0,0 +1,211 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "spiffsUpload.h"
+#include <heapStats.hpp>
+
+static const size_t SPIFFS_PATH_MAX = 31; // SPIFFS_OBJ_NAME_LEN minus the terminator
+
+std::atomic<size_t> spiffsUpload::_inFlight{0};
+uint32_t spiffsUpload::_serial = 0;
+
+spiffsUpload::~spiffsUpload()
+{
+    _writer.end(); // The worker may still be on a block, or in complete()
+    if (!_done)
+        discard();
+}
+
+void spiffsUpload::abandon()
+{
+    _writer.end(); // A block may still be on its way to _file
+    discard();
+}
+
+// Closes and removes the temporary file and gives back the reservation; runs on the worker from complete()
+void spiffsUpload::discard()
+{
+    if (_file)
+        _file.close();
+    if (_tmpPath.length() && SPIFFS.exists(_tmpPath))
+        SPIFFS.remove(_tmpPath);
+    if (_quotaHeld)
+        _inFlight -= _expected;
+    _quotaHeld = false;
+    _done = true;
+    _doneMs = millis();
+}
+
+spiffsUpload::result spiffsUpload::begin(const String &name, size_t expected)
+{
+    _startMs = millis();
+    String base = name;
+    base.trim();
+    if (base.startsWith("/"))
+        base = base.substring(1);
+    _path = "/" + base;
+    if (base.length() == 0 || base.indexOf('/') >= 0 || _path.length() > SPIFFS_PATH_MAX)
+        return _status = UPLOAD_BAD_NAME;
+
+    // The file being replaced gives its space back, but only after the new one is complete
+    size_t total = SPIFFS.totalBytes();
+    size_t used = SPIFFS.usedBytes() + _inFlight;
+    if (used + expected + SPIFFS_UPLOAD_RESERVE > total)
+    {
+        Serial.printf("⚠️ Upload %s refused: %u bytes, %u free\n", _path.c_str(), static_cast<unsigned>(expected),
+                      static_cast<unsigned>(total > used ? total - used : 0));
+        return _status = UPLOAD_NO_SPACE;
+    }
+
+    bool buffered;
+    {
+        heapScope heap(HEAP_TAG_WEBUI);
+        buffered = _writer.begin();
+    }
+    _tmpPath = "/~upload" + String(++_serial) + ".tmp";
+    _file = buffered ? SPIFFS.open(_tmpPath, "w") : File();
+    if (!_file)
+    {
+        _writer.end();
+        return _status = UPLOAD_OPEN_FAILED;
+    }
+    _expected = expected;
+    _inFlight += expected;
+    _quotaHeld = true; // Given back by discard(), once the file is in place or gone
+    return _status = UPLOAD_OK;
+}
+
+// Runs on the deferredWork worker, or inline when it cannot take the block
+bool spiffsUpload::writeToFile(void *self, const uint8_t *data, size_t len)
+{
+    return static_cast<spiffsUpload *>(self)->_file.write(data, len) == len;
+}
+
+spiffsUpload::result spiffsUpload::write(const uint8_t *data, size_t len)
+{
+    if (_status != UPLOAD_OK || _done || _finishing)
+        return _status;
+    _received += len;
+    if (!_writer.write(data, len))
+    {
+        abandon();
+        return _status = UPLOAD_WRITE_FAILED;
+    }
+    return _status;
+}
+
+spiffsUpload::result spiffsUpload::finish()
+{
+    if (_status != UPLOAD_OK || _done || _finishing)
+        return _status;
+    _finishing = true;
+    _writer.finish(complete);
+    return UPLOAD_OK; // So far: _status is the worker's from here until pending() clears
+}
+
+// Runs on the deferredWork worker once the last block is on flash (inline without a worker)
+void spiffsUpload::complete(void *self)
+{
+    spiffsUpload *upload = static_cast<spiffsUpload *>(self);
+    upload->_status = upload->moveIntoPlace();
+    upload->_finished = true;
+}
+
+spiffsUpload::result spiffsUpload::moveIntoPlace()
+{
+    if (_writer.failed())
+    {
+        discard();
+        return UPLOAD_WRITE_FAILED;
+    }
+    _file.close();
+    // SPIFFS cannot rename over an existing file: park the old one until the new one is in place
+    String backup;
+    if (SPIFFS.exists(_path))
+    {
+        backup = _tmpPath.substring(0, _tmpPath.length() - 4) + ".bak";
+        if (!SPIFFS.rename(_path, backup))
+        {
+            discard();
+            return UPLOAD_WRITE_FAILED;
+        }
+    }
+    if (!SPIFFS.rename(_tmpPath, _path))
+    {
+        if (backup.length() && !SPIFFS.rename(backup, _path))
+            Serial.printf("❌ Upload %s failed; previous version left in %s\n", _path.c_str(), backup.c_str());
+        discard();
+        return UPLOAD_WRITE_FAILED;
+    }
+    if (backup.length())
+        SPIFFS.remove(backup);
+    _tmpPath = "";
+    discard(); // Nothing left to remove; gives back the reservation and stamps the end time
+    return UPLOAD_OK;
+}
+
+uint8_t spiffsUpload::percent() const
+{
+    if (_done && _status == UPLOAD_OK)
+        return 100;
+    if (!_expected)
+        return 0;
+    size_t p = static_cast<uint64_t>(_received) * 100 / _expected;
+    return p > 99 ? 99 : static_cast<uint8_t>(p); // Content-Length overshoots the file by the framing
+}
+
+uint32_t spiffsUpload::kbPerSecond() const
+{
+    uint32_t ms = elapsedMs();
+    return ms ? static_cast<uint32_t>(static_cast<uint64_t>(_received) * 1000 / 1024 / ms) : 0;
+}
+
+uint8_t spiffsUpload::progressStep()
+{
+    uint8_t now = percent() / 10 * 10;
+    if (now <= _reported)
+        return 0;
+    _reported = now;
+    return now;
+}
+
+const char *spiffsUpload::statusText() const
+{
+    switch (_status)
+    {
+    case UPLOAD_OK:
+        return "ok";
+    case UPLOAD_BAD_NAME:
+        return "bad file name";
+    case UPLOAD_NO_SPACE:
+        return "not enough free space";
+    case UPLOAD_OPEN_FAILED:
+        return "cannot create file";
+    case UPLOAD_WRITE_FAILED:
+        return "write failed";
+    default:
+        return "no file received";
+    }
+}
@@ -0,0 +1,123 @@
+
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Peter K Green (pkg40)
+ * Email: pkg40@yahoo.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <deferredWork.hpp>
+#include <atomic>
+
+// Writes reach flash in whole buffers; a multiple of the SPIFFS page so that no
+// page is programmed twice (CONFIG_SPIFFS_PAGE_SIZE is 256 on the ESP32 cores)
+#ifndef SPIFFS_UPLOAD_PAGE
+#define SPIFFS_UPLOAD_PAGE 256
+#endif
+#ifndef SPIFFS_UPLOAD_BUFFER
+#define SPIFFS_UPLOAD_BUFFER (16 * SPIFFS_UPLOAD_PAGE)
+#endif
+// Kept free after any upload, so config saves still fit
+#ifndef SPIFFS_UPLOAD_RESERVE
+#define SPIFFS_UPLOAD_RESERVE (16 * 1024)
+#endif
+
+/**
+ * @brief One file upload into SPIFFS, owned by the request that carries it.
+ *
+ * begin() checks the name and that the expected size fits next to the files
+ * already there and the uploads still in flight, then opens a temporary file.
+ * write() collects the body's chunks, whatever their size, into blocks of
+ * SPIFFS_UPLOAD_BUFFER, written by the deferredWork worker while the next ones
+ * fill; it never waits on flash as long as the caller keeps within room().
+ * finish() leaves the last block and the move into place to the worker too:
+ * the temporary file goes over the target once it is complete, so a dropped
+ * connection never leaves half a file under the real name, and the old file is
+ * renamed aside first and put back if the move fails. pending() is true until
+ * that has run; only then are status() and the timings final. Destroying an
+ * unfinished upload removes the temporary file.
+ */
+class spiffsUpload
+{
+public:
+    enum result : uint8_t
+    {
+        UPLOAD_OK,
+        UPLOAD_BAD_NAME,
+        UPLOAD_NO_SPACE,
+        UPLOAD_OPEN_FAILED,
+        UPLOAD_WRITE_FAILED,
+        UPLOAD_NOT_STARTED
+    };
+
+    spiffsUpload() : _writer("upload", SPIFFS_UPLOAD_BUFFER, writeToFile, this) {}
+    ~spiffsUpload();
+
+    // name as the form sent it; expected is an upper bound (Content-Length includes the multipart framing)
+    result begin(const String &name, size_t expected);
+    result write(const uint8_t *data, size_t len);
+    result finish(); // Returns at once; see pending()
+
+    size_t room() const { return _writer.room(); } // What write() takes without waiting on flash
+    bool pending() const { return _finishing && !_finished.load(); }
+
+    result status() const { return _status; }
+    const char *statusText() const;
+    const String &path() const { return _path; }
+    size_t received() const { return _received; }
+    size_t expected() const { return _expected; }
+    uint8_t percent() const;
+    uint32_t elapsedMs() const { return (_done ? _doneMs : millis()) - _startMs; }
+    uint32_t kbPerSecond() const;
+
+    // Nonzero once another 10% has arrived since the last call: for progress logs
+    uint8_t progressStep();
+
+private:
+    spiffsUpload(const spiffsUpload &) = delete;
+    spiffsUpload &operator=(const spiffsUpload &) = delete;
+
+    static std::atomic<size_t> _inFlight; // Bytes promised to uploads not finished yet; complete() gives back on the worker
+    static uint32_t _serial;
+
+    result _status = UPLOAD_NOT_STARTED;
+    String _path;
+    String _tmpPath;
+    File _file;
+    deferredWriter _writer; // Declared after _file: the worker is done with it before it closes
+    size_t _expected = 0;
+    size_t _received = 0;
+    uint32_t _startMs = 0;
+    uint32_t _doneMs = 0;
+    uint8_t _reported = 0;
+    bool _done = false;
+    bool _quotaHeld = false;
+    bool _finishing = false;
+    std::atomic<bool> _finished{false}; // Set by complete() on the worker, last
+
+    static bool writeToFile(void *self, const uint8_t *data, size_t len);
+    static void complete(void *self);
+    result moveIntoPlace();
+    void abandon();
+    void discard();
+};
@@ -25,10 +25,14 @@
 #include "webUI.h"
 
 webUI::webUI(configManager2 *cfg)
-    : server(80), configManager(cfg)
+    : server(80), configManager(cfg), otaEvents("/update/events")
 {
+#if defined(ESP32)
+    heldAcksLock = xSemaphoreCreateMutexStatic(&heldAcksBuffer);
+#endif
     renderer = new htmlRenderer(
         &configManager->getConfig());
+    renderer->setSchema(&configManager->getSchema());
 }
 
 webUI::~webUI()
@@ -41,123 +45,831 @@ configManager2 *webUI::getConfigManager()
     return configManager;
 }
 
-void webUI::begin(bool verbose)
-{
-    if (verbose)
-        Serial.println("🌐 Starting Web UI on port 80...");
+static const char *PAGE_CACHE_CONTROL = "no-cache";                             // Keep, but revalidate every view
+static const char *STYLE_CACHE_CONTROL = "public, max-age=31536000, immutable"; // URL is versioned by content
 
-    server.on("/home", HTTP_GET, [this](AsyncWebServerRequest *request)
-              { request->send(200, "text/html", renderer->generateHomePage()); });
+bool webUI::sendNotModified(AsyncWebServerRequest *request, const char *etag, const char *cacheControl)
+{
+    AsyncWebHeader *match = request->getHeader("If-None-Match");
+    if (!match || (match->value() != "*" && match->value().indexOf(etag) < 0))
+        return false;
+
+    AsyncWebServerResponse *response = request->beginResponse(304);
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", cacheControl);
+    request->send(response);
+    return true;
+}
 
-    server.on("/files/view", HTTP_GET, [this](AsyncWebServerRequest *request)
+void webUI::sendPage(AsyncWebServerRequest *request, std::function<void(htmlWriter &)> render, bool conditional)
+{
+    sendParts(request, [render](htmlWriter &out, size_t part)
               {
-    Serial.println("🛠️ /files/view handler triggered");
+                  if (part == 0)
+                      render(out);
+                  return part == 0; }, conditional);
+}
+
+void webUI::sendParts(AsyncWebServerRequest *request, htmlPartRenderer render, bool conditional,
+                      const char *contentType)
+{
+    char etag[htmlHashWriter::ETAG_LEN + 1] = "";
+    if (conditional)
+    {
+        // One extra render into a hash; a browser that already has the page then gets a bare 304
+        htmlHashWriter hash;
+        {
+            heapScope heap(HEAP_TAG_HTML);
+            configLockGuard guard(*configManager); // Pages read the store in place
+            for (size_t part = 0; render(hash, part); ++part)
+            {
+            }
+        }
+        hash.etag(etag);
+        if (sendNotModified(request, etag, PAGE_CACHE_CONTROL))
+            return;
+    }
+
+    // Called once per TCP-sized buffer until it returns 0; the cursor remembers where the last one stopped
+    std::shared_ptr<htmlPartCursor> cursor(new htmlPartCursor());
+    AsyncWebServerResponse *response =
+        request->beginChunkedResponse(contentType,
+                                      [this, render, cursor](uint8_t *buffer, size_t maxLen, size_t) -> size_t
+                                      {
+                                          heapScope heap(HEAP_TAG_HTML);
+                                          uint32_t start = micros();
+                                          configLockGuard guard(*configManager);
+                                          size_t n = cursor->fill(buffer, maxLen, render);
+                                          callbacks.record("(response)", micros() - start);
+                                          return n;
+                                      });
+    if (conditional)
+    {
+        response->addHeader("ETag", etag);
+        response->addHeader("Cache-Control", PAGE_CACHE_CONTROL);
+    }
+    request->send(response);
+}
+
+// Page ids in pageCache
+static const uint8_t CACHED_CONFIG_FORM = 0;
+static const uint8_t CACHED_ALL_SECTIONS = 1;
+
+bool webUI::renderCachedPart(htmlWriter &out, uint8_t page, size_t part, const htmlPartRenderer &render)
+{
+    const std::map<String, std::map<String, String>> &config = configManager->getConfig();
+    if (part == 0 || part > config.size())
+        return render(out, part); // Head and tail are fixed text
+
+    // A section is rendered again only once it (or a format, or the whole config) has changed
+    const String &section = std::next(config.begin(), part - 1)->first;
+    return pageCache.serve(out, page, section, configManager->getSectionRevision(section),
+                           [&render, part](htmlWriter &fresh)
+                           { return render(fresh, part); });
+}
+
+void webUI::sendStyle(AsyncWebServerRequest *request)
+{
+    if (sendNotModified(request, STYLE_CSS_ETAG, STYLE_CACHE_CONTROL))
+        return;
 
-    if (!request->hasParam("name")) {
-        Serial.println("⚠️ Missing 'name' parameter on /files/view");
-        request->send(400, "text/plain", "Missing 'name' parameter");
+    AsyncWebServerResponse *response = request->beginResponse_P(200, "text/css", STYLE_CSS_GZ, STYLE_CSS_GZ_LEN);
+    response->addHeader("Content-Encoding", "gzip");
+    response->addHeader("ETag", STYLE_CSS_ETAG);
+    response->addHeader("Cache-Control", STYLE_CACHE_CONTROL);
+    request->send(response);
+}
+
+void webUI::sendGzipFile(AsyncWebServerRequest *request, const String &path, const char *contentType)
+{
+    static const char *cacheControl = "max-age=3600";
+    File file = SPIFFS.open(path + ".gz", "r");
+    if (!file || file.size() < 18)
+    {
+        request->send(404, "text/plain", "File not found: " + path);
         return;
     }
 
-    String filename = request->getParam("name")->value();
-    filename = "/"+filename; // Ensure leading slash for SPIFFS
-    filename = filename.substring(0, 32); // Limit filename length
-    filename.trim(); 
-    if (filename.length() > 32) {
-        Serial.println("⚠️ Filename too long: " + filename);
+    // The last 8 bytes of a gzip member are CRC-32 and length of the original; no need to read the rest
+    uint8_t trailer[8];
+    file.seek(file.size() - sizeof(trailer));
+    bool haveTrailer = file.read(trailer, sizeof(trailer)) == sizeof(trailer);
+    file.close();
+
+    char etag[htmlHashWriter::ETAG_LEN + 1] = "";
+    if (haveTrailer)
+    {
+        formatHex(trailer, sizeof(trailer), etag + 1, sizeof(etag) - 2);
+        etag[0] = '"';
+        etag[htmlHashWriter::ETAG_LEN - 1] = '"';
+        etag[htmlHashWriter::ETAG_LEN] = '\0';
+        if (sendNotModified(request, etag, cacheControl))
+            return;
+    }
+
+    // AsyncFileResponse picks up path + ".gz" and sets Content-Encoding itself
+    AsyncWebServerResponse *response = request->beginResponse(SPIFFS, path, contentType);
+    if (haveTrailer)
+        response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", cacheControl);
+    request->send(response);
+}
+
+static const size_t SPIFFS_PATH_MAX = 32;
+
+// "/name" from a query parameter, or false once 400 has been sent
+static bool spiffsPathParam(AsyncWebServerRequest *request, const char *param, String &path)
+{
+    if (!request->hasParam(param))
+    {
+        Serial.printf("⚠️ Missing '%s' parameter on %s\n", param, request->url().c_str());
+        request->send(400, "text/plain", String("Missing '") + param + "' parameter");
+        return false;
+    }
+
+    String name = request->getParam(param)->value();
+    name.trim();
+    path = name.startsWith("/") ? name : "/" + name; // The file list links names with or without it
+    if (path.length() > SPIFFS_PATH_MAX)
+    {
+        Serial.println("⚠️ Filename too long: " + path);
         request->send(400, "text/plain", "Filename too long");
+        return false;
+    }
+    return true;
+}
+
+void webUI::sendFileView(AsyncWebServerRequest *request)
+{
+    heapScope heap(HEAP_TAG_WEBUI);
+    String path;
+    if (!spiffsPathParam(request, "name", path))
+        return;
+
+    File file = SPIFFS.exists(path) ? SPIFFS.open(path, "r") : File();
+    if (file)
+        Serial.printf("📂 File view requested: %s (%u bytes)\n", path.c_str(), static_cast<unsigned>(file.size()));
+    else
+        Serial.println("❌ File not found in SPIFFS: " + path);
+
+    // The handle travels with the response and closes with it. No ETag: that would
+    // read the whole file once more on every view.
+    sendParts(request, [this, path, file](htmlWriter &out, size_t part) mutable
+              { return renderer->renderFileContentPart(out, path, file, part); }, false);
+}
+
+void webUI::sendFileDownload(AsyncWebServerRequest *request)
+{
+    String path;
+    if (!spiffsPathParam(request, "filename", path))
+        return;
+    File file = SPIFFS.exists(path) ? SPIFFS.open(path, "r") : File();
+    if (!file || file.isDirectory())
+    {
+        request->send(404, "text/plain", "File not found: " + path);
         return;
     }
-    Serial.println("📂 File view requested: " + filename);
 
-    bool found = SPIFFS.exists(filename);
-    String content = "";
+    size_t size = file.size();
+    size_t first = 0, last = size ? size - 1 : 0;
+    byteRangeResult range = BYTE_RANGE_NONE;
+    AsyncWebHeader *header = request->getHeader("Range");
+    if (header)
+        range = parseByteRange(header->value().c_str(), header->value().length(), size, first, last);
+
+    char contentRange[40];
+    if (range == BYTE_RANGE_UNSATISFIABLE)
+    {
+        snprintf(contentRange, sizeof(contentRange), "bytes */%u", static_cast<unsigned>(size));
+        AsyncWebServerResponse *response = request->beginResponse(416, "text/plain", "Range not satisfiable");
+        response->addHeader("Content-Range", contentRange);
+        request->send(response);
+        return;
+    }
+
+    // Each TCP buffer is filled from the file at its offset; nothing else is held
+    size_t length = size ? last - first + 1 : 0;
+    AsyncWebServerResponse *response = request->beginResponse(
+        "application/octet-stream", length,
+        [this, file, first, length](uint8_t *buffer, size_t maxLen, size_t index) mutable -> size_t
+        {
+            if (index >= length || (file.position() != first + index && !file.seek(first + index)))
+                return 0;
+            uint32_t start = micros();
+            size_t n = file.read(buffer, maxLen < length - index ? maxLen : length - index);
+            callbacks.record("(response)", micros() - start);
+            return n;
+        });
+    response->addHeader("Accept-Ranges", "bytes");
+    response->addHeader("Content-Disposition", "attachment; filename=\"" + path.substring(1) + "\"");
+    if (range == BYTE_RANGE_OK)
+    {
+        snprintf(contentRange, sizeof(contentRange), "bytes %u-%u/%u", static_cast<unsigned>(first),
+                 static_cast<unsigned>(last), static_cast<unsigned>(size));
+        response->setCode(206);
+        response->addHeader("Content-Range", contentRange);
+    }
+    request->send(response);
+}
+
+static const uint8_t PACKET_STREAM_VIEWERS = 3; // Each holds a reader (~530 bytes) and a response
+
+void webUI::sendPacketStream(AsyncWebServerRequest *request)
+{
+    heapScope heap(HEAP_TAG_WEBUI);
+    if (packetStreams >= PACKET_STREAM_VIEWERS)
+    {
+        request->send(503, "text/plain", "Too many packet stream viewers");
+        return;
+    }
+    // Lives as long as the response: the filler's copy goes when the connection does
+    struct viewer
+    {
+        packetTraceReader reader;
+        uint8_t &count;
+        explicit viewer(uint8_t &c) : count(c) { ++count; }
+        ~viewer() { --count; }
+    };
+    std::shared_ptr<viewer> stream = std::make_shared<viewer>(packetStreams);
+    AsyncWebServerResponse *response = request->beginChunkedResponse(
+        "application/x-ndjson", [this, stream](uint8_t *buffer, size_t maxLen, size_t) -> size_t
+        {
+            uint32_t start = micros();
+            size_t n = stream->reader.fill(buffer, maxLen, millis());
+            callbacks.record("(response)", micros() - start);
+            return n ? n : RESPONSE_TRY_AGAIN; // Idle: asked again on the next poll
+        });
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
+}
+
+// TCP_WND on the ESP32 cores is 4 * 1436; a held window lets at most that much more in
+static const size_t WEB_UPLOAD_WINDOW = 5744;
+static const size_t WEB_UPLOAD_SEGMENT = 1460;
+static const size_t WEB_UPLOAD_HOLD = WEB_UPLOAD_WINDOW + WEB_UPLOAD_SEGMENT;
+
+// Called after every chunk. Room was at least WEB_UPLOAD_HOLD before it, so once the
+// window is held the writer still takes everything the sender may send without waiting
+void webUI::paceUpload(AsyncWebServerRequest *request, std::function<size_t()> room)
+{
+    bool full = room() < WEB_UPLOAD_HOLD;
+    if (full)
+        request->client()->ackLater(); // This segment stays unacknowledged until loop() lets it go
+    lockHeldAcks();
+    auto held = std::find_if(heldAcks.begin(), heldAcks.end(), [request](const heldAck &h)
+                             { return h.request == request; });
+    if (full && held == heldAcks.end())
+        heldAcks.push_back({request, room});
+    else if (!full && held != heldAcks.end())
+    {
+        heldAcks.erase(held);
+        request->client()->ack(SIZE_MAX); // Already drained: no need to wait for loop()
+    }
+    unlockHeldAcks();
+}
+
+// Before the upload or session behind room() goes away
+void webUI::dropHeldAck(AsyncWebServerRequest *request)
+{
+    lockHeldAcks();
+    heldAcks.erase(std::remove_if(heldAcks.begin(), heldAcks.end(), [request](const heldAck &h)
+                                  { return h.request == request; }),
+                   heldAcks.end());
+    unlockHeldAcks();
+}
 
-    if (found) {
-        File file = SPIFFS.open(filename, "r");
-        if (file) {
-            content = file.readString();
-            file.close();
-            Serial.printf("📄 Opened %s (%u bytes)\n", filename.c_str(), content.length());
-        } else {
-            Serial.println("❌ Failed to open file after exists() check passed");
+void webUI::releaseHeldAcks()
+{
+    lockHeldAcks();
+    for (auto held = heldAcks.begin(); held != heldAcks.end();)
+    {
+        if (held->room() < WEB_UPLOAD_HOLD)
+        {
+            ++held;
+            continue;
         }
-    } else {
-        Serial.println("❌ File not found in SPIFFS: " + filename);
+        held->request->client()->ack(SIZE_MAX); // Reopens the window; lwIP sends the update
+        held = heldAcks.erase(held);
     }
+    unlockHeldAcks();
+}
 
-    request->send(200, "text/html", renderer->generateFileContentPage(filename, content, found)); });
+void webUI::sendWhenReady(AsyncWebServerRequest *request, std::function<bool()> ready,
+                          std::function<int(String &)> render)
+{
+    if (ready())
+    {
+        String html;
+        int code = render(html);
+        request->send(code, "text/html", html);
+        return;
+    }
+    // The status line has gone out by the time the worker is done: 200, the outcome is in the page
+    struct page
+    {
+        String html;
+        bool rendered = false;
+    };
+    std::shared_ptr<page> out = std::make_shared<page>();
+    AsyncWebServerResponse *response = request->beginChunkedResponse(
+        "text/html", [ready, render, out](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+        {
+            if (!out->rendered)
+            {
+                if (!ready())
+                    return RESPONSE_TRY_AGAIN; // Asked again on the next poll
+                render(out->html);
+                out->rendered = true;
+            }
+            size_t n = out->html.length() > index ? std::min(maxLen, out->html.length() - index) : 0;
+            memcpy(buffer, out->html.c_str() + index, n);
+            return n;
+        });
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
+}
 
-    server.on("/files", HTTP_GET, [this](AsyncWebServerRequest *request)
-              { request->send(200, "text/html", renderer->generateSPIFFSFileListPage()); });
+void webUI::handleUploadChunk(AsyncWebServerRequest *request, const String &filename, size_t index,
+                              uint8_t *data, size_t len, bool final)
+{
+    if (index == 0)
+    {
+        heapScope heap(HEAP_TAG_WEBUI);
+        std::unique_ptr<spiffsUpload> &upload = uploads[request];
+        if (upload)
+        {
+            Serial.printf("⚠️ Upload %s ignored: one file per request\n", filename.c_str());
+            return;
+        }
+        upload.reset(new spiffsUpload());
+        request->onDisconnect([this, request]()
+                              {
+                                  dropHeldAck(request);
+                                  uploads.erase(request); // Drops the temporary file of an aborted upload
+                              });
+        Serial.printf("📁 Starting upload: %s (%u bytes expected)\n", filename.c_str(),
+                      static_cast<unsigned>(request->contentLength()));
+        upload->begin(filename, request->contentLength());
+    }
 
-    server.on("/files/view", HTTP_GET, [this](AsyncWebServerRequest *request)
-              {
-    if (!request->hasParam("name")) {
-        Serial.println("⚠️ Missing 'name' parameter on /files/view");
-        request->send(400, "text/plain", "Missing 'name' parameter");
+    auto found = uploads.find(request);
+    if (found == uploads.end())
+        return;
+    spiffsUpload *upload = found->second.get();
+    upload->write(data, len);
+    if (uint8_t step = upload->progressStep())
+        Serial.printf("📶 Upload %s: %u%% (%u bytes)\n", upload->path().c_str(), step,
+                      static_cast<unsigned>(upload->received()));
+
+    if (final)
+        upload->finish(); // The worker writes the last block and moves the file into place
+    else
+        paceUpload(request, [upload]
+                   { return upload->room(); });
+}
+
+void webUI::handleUploadDone(AsyncWebServerRequest *request)
+{
+    auto found = uploads.find(request);
+    if (found == uploads.end())
+    {
+        request->send(400, "text/plain", "No file received");
         return;
     }
+    dropHeldAck(request);
+    request->client()->ack(SIZE_MAX);
+    std::shared_ptr<spiffsUpload> upload(found->second.release());
+    uploads.erase(found);
+
+    sendWhenReady(request, [upload]
+                  { return !upload->pending(); },
+                  [this, upload](String &html) -> int
+                  {
+                      int code;
+                      switch (upload->status())
+                      {
+                      case spiffsUpload::UPLOAD_OK:
+                          code = 200;
+                          break;
+                      case spiffsUpload::UPLOAD_NO_SPACE:
+                          code = 507;
+                          break;
+                      case spiffsUpload::UPLOAD_BAD_NAME:
+                          code = 400;
+                          break;
+                      default:
+                          code = 500;
+                      }
+
+                      htmlStringWriter out(html);
+                      out << "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Upload Complete</title></head><body>";
+                      if (code == 200)
+                      {
+                          Serial.printf("✅ Completed upload: %s (%u bytes, %u ms, %u KB/s)\n", upload->path().c_str(),
+                                        static_cast<unsigned>(upload->received()), upload->elapsedMs(),
+                                        upload->kbPerSecond());
+                          if (configManager && upload->path() == configManager->getPath())
+                              configManager->invalidateSnapshot(); // Next boot parses the uploaded JSON
+                          out << "<h2>✅ File uploaded to SPIFFS</h2><p><code>";
+                          out.printEscaped(upload->path());
+                          out << "</code>: " << static_cast<unsigned>(upload->received()) << " bytes in "
+                              << upload->elapsedMs() << " ms (" << upload->kbPerSecond() << " KB/s)</p>";
+                      }
+                      else
+                      {
+                          Serial.printf("❌ Upload %s failed: %s\n", upload->path().c_str(), upload->statusText());
+                          out << "<h2>❌ Upload failed: " << upload->statusText() << "</h2>";
+                      }
+                      out << "<a href='/upload'>Upload another</a> | <a href='/home'>Back to Home</a></body></html>";
+                      return code;
+                  });
+}
 
-    String filename = request->getParam("name")->value();
-    Serial.println("📂 File view requested: " + filename);
+void webUI::handleOtaChunk(AsyncWebServerRequest *request, const String &filename, size_t index,
+                           uint8_t *data, size_t len, bool final)
+{
+    if (index == 0)
+    {
+        if (otaRequest && otaRequest != request)
+        {
+            Serial.printf("⚠️ OTA %s refused: another update is in progress\n", filename.c_str());
+            return;
+        }
+        // The digest comes as a header (scripts), a form field ahead of the file (the page) or in the query
+        String digest;
+        if (request->hasHeader("X-Image-SHA256"))
+            digest = request->getHeader("X-Image-SHA256")->value();
+        else if (request->hasParam("sha256", true))
+            digest = request->getParam("sha256", true)->value();
+        else if (request->hasParam("sha256"))
+            digest = request->getParam("sha256")->value();
+
+        ota.reset(new otaSession(firmwareSink()));
+        otaRequest = request;
+        request->onDisconnect([this, request]()
+                              {
+                                  dropHeldAck(request);
+                                  if (otaRequest != request)
+                                      return;
+                                  otaRequest = nullptr;
+                                  if (ota->getState() == otaSession::OTA_WRITING)
+                                  {
+                                      ota->fail("connection lost"); // The running image stays the boot image
+                                      publishOtaProgress();
+                                  }
+                              });
+        Serial.printf("⚙️ OTA Begin: %s (at most %u bytes)\n", filename.c_str(),
+                      static_cast<unsigned>(request->contentLength()));
+        if (!ota->begin(digest, request->contentLength()))
+            Serial.printf("❌ OTA refused: %s\n", ota->error());
+        publishOtaProgress();
+    }
+    if (!ota || otaRequest != request || ota->getState() != otaSession::OTA_WRITING)
+        return;
 
-    bool found = SPIFFS.exists("/" + filename);
-    String content = found ? SPIFFS.open(filename, "r").readString() : "";
+    uint8_t before = ota->percent();
+    if (ota->write(data, len) && final)
+        ota->finish(); // Checked here; the worker writes the last block and activates the image
+    else if (ota->getState() == otaSession::OTA_WRITING) // Failures are logged with the response
+    {
+        if (ota->percent() / 10 != before / 10)
+            Serial.printf("📶 Progress: %u%% (%u bytes, %u KB/s)\n", ota->percent(),
+                          static_cast<unsigned>(ota->received()), static_cast<unsigned>(ota->kbPerSecond()));
+        std::shared_ptr<otaSession> session = ota;
+        paceUpload(request, [session]
+                   { return session->room(); });
+    }
+    if (ota->progressDue())
+        publishOtaProgress();
+}
 
-    if (!found) {
-        Serial.println("❌ File not found: " + filename);
-    } else {
-        Serial.printf("📄 Opened %s (%u bytes)\n", filename.c_str(), content.length());
+void webUI::handleOtaDone(AsyncWebServerRequest *request)
+{
+    if (!ota || otaRequest != request)
+    {
+        if (otaRequest)
+            request->send(409, "text/plain", "Another firmware update is in progress");
+        else
+            request->send(400, "text/plain", "No firmware received");
+        return;
     }
+    otaRequest = nullptr;
+    dropHeldAck(request);
+    request->client()->ack(SIZE_MAX);
+
+    if (ota->getState() == otaSession::OTA_WRITING)
+        ota->fail("upload incomplete", true);
+    std::shared_ptr<otaSession> session = ota; // A new update may replace ota while this one settles
+    sendWhenReady(request, [session]
+                  { return session->getState() != otaSession::OTA_VERIFYING; },
+                  [this, session](String &html) -> int
+                  {
+                      bool done = session->getState() == otaSession::OTA_DONE;
+                      if (done)
+                          Serial.printf("✅ OTA verified and complete: %u bytes, %u KB/s\n",
+                                        static_cast<unsigned>(session->received()),
+                                        static_cast<unsigned>(session->kbPerSecond()));
+                      else
+                          Serial.printf("❌ OTA failed: %s\n", session->error());
+                      htmlStringWriter out(html);
+                      out << "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Firmware Update</title></head><body>";
+                      if (done)
+                          out << "<h2>✅ Firmware verified and installed. Rebooting...</h2>";
+                      else
+                          out << "<h2>❌ Firmware not installed: " << session->error() << "</h2>";
+                      out << "<a href='/home'>Back to Home</a></body></html>";
+                      if (session == ota)
+                          publishOtaProgress();
+                      if (done)
+                          scheduleRestart(1000);
+                      return done ? 200 : session->rejected() ? 400 : 500;
+                  });
+}
 
-    request->send(200, "text/html", renderer->generateFileContentPage(filename, content, found)); });
+void webUI::publishOtaProgress(AsyncEventSourceClient *client)
+{
+    char json[192];
+    if (!ota || !ota->progressJson(json, sizeof(json)))
+        return;
+    if (client)
+        client->send(json, "progress", millis());
+    else
+        otaEvents.send(json, "progress", millis());
+}
 
-    server.on("/info", HTTP_GET, [this](AsyncWebServerRequest *request)
-              { request->send(200, "text/html", renderer->generateInfoPage()); });
+void webUI::scheduleRestart(unsigned long delayMs)
+{
+    restartAt = millis() + delayMs;
+    restartPending = true;
+}
 
-    server.on("/all", HTTP_GET, [this](AsyncWebServerRequest *request)
-              { request->send(200, "text/html", renderer->generateAllSectionsPage()); });
+void webUI::loop(unsigned long now)
+{
+    releaseHeldAcks();
+    if (restartPending && static_cast<long>(now - restartAt) >= 0)
+    {
+        Serial.println("🔄 Restarting");
+        delay(100); // Let Serial drain
+        ESP.restart();
+    }
+}
 
-    server.on("/configs", HTTP_GET, [this](AsyncWebServerRequest *request)
-              {
-                const std::map<String, std::map<String, String>> config = configManager->getConfig();  // or however you load it
-                request->send(200, "text/html", renderer->generateConfigFormPage(config, true)); });
+static const char *CONFIG_API_PATH = "/api/config";
+static const size_t CONFIG_API_BODY_MAX = 4096; // PATCH bodies are a handful of keys
+
+// "mqtt" for /api/config/mqtt, empty for /api/config itself
+static String configApiSection(AsyncWebServerRequest *request)
+{
+    const String &url = request->url();
+    size_t prefix = strlen(CONFIG_API_PATH) + 1;
+    return url.length() > prefix ? url.substring(prefix) : String();
+}
 
-    server.on("/upload", HTTP_GET, [this](AsyncWebServerRequest *request)
-              { request->send(200, "text/html", renderer->generateUploadPage()); });
+// {"<name>": {fields}}: error and rejection bodies of the JSON API
+static String configApiMessage(const char *name, const std::map<String, String> &fields)
+{
+    String body;
+    configStringSink sink(body);
+    configJsonWriter<configStringSink> json(sink);
+    json.openDocument();
+    json.writeSection(name, fields, true);
+    json.closeDocument(false);
+    json.finish();
+    return body;
+}
 
-    server.on("/firmware", HTTP_GET, [this](AsyncWebServerRequest *request)
-              { request->send(200, "text/html", renderer->generateFirmwareUpdatePage()); });
+static void sendConfigApiError(AsyncWebServerRequest *request, int code, const char *message)
+{
+    request->send(code, "application/json", configApiMessage("error", {{"message", message}}));
+}
 
-    server.on("/downloadPage", HTTP_GET, [this](AsyncWebServerRequest *request)
-              { request->send(200, "text/html", renderer->generateDownloadPage()); });
+// Same bytes sendParts() hashes for a GET, so a GET's ETag is what If-Match is checked against
+void webUI::configEtag(const String &section, char *etag) const
+{
+    htmlHashWriter hash;
+    for (size_t part = 0; renderer->renderConfigJsonPart(hash, section, part); ++part)
+    {
+    }
+    hash.etag(etag);
+}
 
-    server.on("/download", HTTP_GET, [](AsyncWebServerRequest *request)
-              {
-    if (!request->hasParam("filename")) {
-        request->send(400, "text/plain", "Missing 'filename' parameter");
+void webUI::handleConfigGet(AsyncWebServerRequest *request)
+{
+    String section = configApiSection(request);
+    {
+        configLockGuard guard(*configManager);
+        if (!section.isEmpty() && !configManager->getConfig().count(section))
+        {
+            sendConfigApiError(request, 404, "unknown section");
+            return;
+        }
+    }
+    sendParts(request, [this, section](htmlWriter &out, size_t part)
+              { return renderer->renderConfigJsonPart(out, section, part); }, true, "application/json");
+}
+
+void webUI::handleConfigPatch(AsyncWebServerRequest *request)
+{
+    heapScope heap(HEAP_TAG_WEBUI);
+    String section = configApiSection(request);
+    // Held from the section check to the edit, so the If-Match precondition still holds when the patch lands
+    configLockGuard guard(*configManager);
+    if (!section.isEmpty() && !configManager->getConfig().count(section))
+    {
+        sendConfigApiError(request, 404, "unknown section");
+        return;
+    }
+
+    // Optimistic concurrency: an edit made against a copy that is no longer current is refused
+    AsyncWebHeader *ifMatch = request->getHeader("If-Match");
+    if (ifMatch && ifMatch->value() != "*")
+    {
+        char etag[htmlHashWriter::ETAG_LEN + 1];
+        configEtag(section, etag);
+        if (ifMatch->value().indexOf(etag) < 0)
+        {
+            AsyncWebServerResponse *response = request->beginResponse(
+                412, "application/json", configApiMessage("error", {{"message", "resource changed"}}));
+            response->addHeader("ETag", etag);
+            request->send(response);
+            return;
+        }
+    }
+
+    size_t length = request->contentLength();
+    const char *body = static_cast<const char *>(request->_tempObject); // Collected by the body callback
+    if (length > CONFIG_API_BODY_MAX)
+    {
+        sendConfigApiError(request, 413, "body too large");
+        return;
+    }
+    if (!body || length == 0)
+    {
+        sendConfigApiError(request, 400, "missing body");
         return;
     }
 
-    String filename = "/"+request->getParam("filename")->value();
-    if (!SPIFFS.exists(filename)) {
-        request->send(404, "text/plain", "File not found: " + filename);
+    // /api/config takes {"section": {"key": value}}, /api/config/<section> just {"key": value}
+    configMemorySource source(body, length);
+    configJsonReader<configMemorySource> reader(source);
+    std::map<String, std::map<String, String>> patch;
+    if (!(section.isEmpty() ? reader.parse(patch) : reader.parseFields(patch[section])))
+    {
+        sendConfigApiError(request, 400, reader.error() ? reader.error() : "invalid JSON");
         return;
     }
 
-    File file = SPIFFS.open(filename, "r");
-    request->send(file, filename, "application/octet-stream"); });
+    std::map<String, String> rejected;
+    if (!configManager->patchValues(patch, &rejected))
+    {
+        request->send(422, "application/json", configApiMessage("rejected", rejected));
+        return;
+    }
+    Serial.printf("🔧 PATCH %s: %u section(s) updated\n", request->url().c_str(), (unsigned)patch.size());
 
-    server.on("/restart", HTTP_GET, [this](AsyncWebServerRequest *request)
-              {
-                  request->send(200, "text/html", renderer->generateRestartPage());
-                  delay(500);    // Let response flush
-                  ESP.restart(); // Soft reboot (optional)
-              });
+    // Written by configManager2::loop() once edits settle; only the touched sections are marked dirty
+    sendParts(request, [this, section](htmlWriter &out, size_t part)
+              { return renderer->renderConfigJsonPart(out, section, part); }, true, "application/json");
+}
 
-    server.on("/submit-section", HTTP_POST, [this](AsyncWebServerRequest *request)
+void webUI::callbackStats::record(const char *uri, uint32_t us)
+{
+    ++calls;
+    if (us > WEB_CALLBACK_BUDGET_US)
+        ++overBudget;
+    if (us > longestUs)
+    {
+        longestUs = us;
+        longestUri = uri;
+    }
+}
+
+void webUI::on(const char *uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+               ArUploadHandlerFunction onUpload, ArBodyHandlerFunction onBody)
+{
+    // uri is a literal (or CONFIG_API_PATH): safe to keep as the label
+    ArUploadHandlerFunction upload;
+    if (onUpload)
+        upload = [this, uri, onUpload](AsyncWebServerRequest *request, const String &filename, size_t index,
+                                       uint8_t *data, size_t len, bool final)
+        {
+            uint32_t start = micros();
+            onUpload(request, filename, index, data, len, final);
+            callbacks.record(uri, micros() - start);
+        };
+    ArBodyHandlerFunction body;
+    if (onBody)
+        body = [this, uri, onBody](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+        {
+            uint32_t start = micros();
+            onBody(request, data, len, index, total);
+            callbacks.record(uri, micros() - start);
+        };
+    server.on(uri, method, [this, uri, onRequest](AsyncWebServerRequest *request)
               {
+                  uint32_t start = micros();
+                  onRequest(request);
+                  callbacks.record(uri, micros() - start); }, upload, body);
+}
+
+void webUI::begin(bool verbose)
+{
+    if (verbose)
+        Serial.println("🌐 Starting Web UI on port 80...");
+
+    // Upload and OTA blocks are written by this task instead of the web callbacks
+    if (!deferredWorkBegin())
+        Serial.println("⚠️ Deferred work task not started: uploads write flash from the web callbacks");
+
+    on("/style.css", HTTP_GET, [this](AsyncWebServerRequest *request)
+       { sendStyle(request); });
+
+    on("/home", HTTP_GET, [this](AsyncWebServerRequest *request)
+       { sendPage(request, [this](htmlWriter &out) { renderer->renderHomePage(out); }); });
+
+    on("/files", HTTP_GET, [this](AsyncWebServerRequest *request)
+       { sendPage(request, [this](htmlWriter &out) { renderer->renderSPIFFSFileListPage(out); }); });
+
+    on("/files/view", HTTP_GET, [this](AsyncWebServerRequest *request)
+       { sendFileView(request); });
+
+    on("/info", HTTP_GET, [this](AsyncWebServerRequest *request)
+       { sendPage(request, [this](htmlWriter &out) { renderer->renderInfoPage(out); }, false); }); // Live heap figures
+
+    on(CONFIG_API_PATH, HTTP_GET, [this](AsyncWebServerRequest *request)
+       { handleConfigGet(request); });
+
+    on(CONFIG_API_PATH, HTTP_PATCH, [this](AsyncWebServerRequest *request)
+       { handleConfigPatch(request); }, nullptr,
+       [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+       {
+           // Collect the body; the request frees _tempObject when it is done
+           if (total > CONFIG_API_BODY_MAX)
+               return;
+           if (index == 0)
+               request->_tempObject = calloc(total + 1, 1);
+           if (request->_tempObject && index + len <= total)
+               memcpy(static_cast<uint8_t *>(request->_tempObject) + index, data, len);
+       });
+
+    on("/heap", HTTP_GET, [](AsyncWebServerRequest *request)
+       {
+           char json[640];
+           if (heapStatsToJson(json, sizeof(json)))
+               request->send(200, "application/json", json);
+           else
+               request->send(500, "text/plain", "heap stats do not fit");
+       });
+
+    on("/metrics", HTTP_GET, [this](AsyncWebServerRequest *request)
+       {
+           char work[256];
+           if (!deferredWorkStatsToJson(work, sizeof(work)))
+               strcpy(work, "null");
+           char json[448];
+           snprintf(json, sizeof(json),
+                    "{\"web\":{\"callbacks\":%u,\"overBudget\":%u,\"budgetUs\":%u,\"longestUs\":%u,\"longestUri\":\"%s\"},"
+                    "\"work\":%s}",
+                    static_cast<unsigned>(callbacks.calls), static_cast<unsigned>(callbacks.overBudget),
+                    static_cast<unsigned>(WEB_CALLBACK_BUDGET_US), static_cast<unsigned>(callbacks.longestUs),
+                    callbacks.longestUri, work);
+           request->send(200, "application/json", json);
+       });
+
+    on("/packets/stream", HTTP_GET, [this](AsyncWebServerRequest *request)
+       { sendPacketStream(request); });
+
+    on("/all", HTTP_GET, [this](AsyncWebServerRequest *request)
+       { sendParts(request, [this](htmlWriter &out, size_t part)
+                   { return renderCachedPart(out, CACHED_ALL_SECTIONS, part, [this](htmlWriter &o, size_t p)
+                                             { return renderer->renderAllSectionsPart(o, p); }); }); });
+
+    on("/configs", HTTP_GET, [this](AsyncWebServerRequest *request)
+       { sendParts(request, [this](htmlWriter &out, size_t part)
+                   { return renderCachedPart(out, CACHED_CONFIG_FORM, part, [this](htmlWriter &o, size_t p)
+                                             { return renderer->renderConfigFormPart(o, configManager->getConfig(), true, p); }); }); });
+
+    on("/upload", HTTP_GET, [this](AsyncWebServerRequest *request)
+       { sendPage(request, [this](htmlWriter &out) { renderer->renderUploadPage(out); }); });
+
+    on("/firmware", HTTP_GET, [this](AsyncWebServerRequest *request)
+       { sendPage(request, [this](htmlWriter &out) { renderer->renderFirmwareUpdatePage(out); }); });
+
+    on("/downloadPage", HTTP_GET, [this](AsyncWebServerRequest *request)
+       { sendPage(request, [this](htmlWriter &out) { renderer->renderDownloadPage(out); }); });
+
+    on("/download", HTTP_GET, [this](AsyncWebServerRequest *request)
+       { sendFileDownload(request); });
+
+    on("/restart", HTTP_GET, [this](AsyncWebServerRequest *request)
+       {
+           request->send(200, "text/html", renderer->generateRestartPage());
+           scheduleRestart(500); // Soft reboot once the page is out
+       });
+
+    on("/submit-section", HTTP_POST, [this](AsyncWebServerRequest *request)
+       {
+    heapScope heap(HEAP_TAG_WEBUI);
     if (!configManager) {
         request->send(500, "text/plain", "❌ Configuration manager unavailable.");
         return;
@@ -186,20 +898,19 @@ void webUI::begin(bool verbose)
         Serial.printf("🔧 Updating [%s][%s] = %s\n", section.c_str(), key.c_str(), finalValue.c_str());
     }
 
-    // Apply to configManager2
-    for (const auto& s : updates) {
-        for (const auto& kv : s.second) {
-            configManager->setValue(s.first, kv.first, kv.second);
-        }
-    }
+    // Apply to configManager2 as one batch: subscribers see the whole form at once
+    std::map<String, String> rejected;
+    configManager->applyUpdates(updates, &rejected);
 
-    configManager->saveToJson("/config.json", configManager->getConfig());
+    configManager->scheduleSave();  // Written by configManager2::loop() once edits settle
 
-    // Flattened view for summary page
+    // Flattened view for summary page; show what was stored, or why it was not
     std::map<String, String> flat;
     for (const auto& s : updates) {
         for (const auto& kv : s.second) {
-            flat[s.first + "." + kv.first] = kv.second;
+            String fullKey = s.first + "." + kv.first;
+            flat[fullKey] = rejected.count(fullKey) ? "⚠️ not saved: " + rejected[fullKey]
+                                                    : configManager->getValue(s.first, kv.first);
         }
     }
 
@@ -207,90 +918,28 @@ void webUI::begin(bool verbose)
 
     /*!SECTION
 
-        server.on("/submit-section", HTTP_POST, [this](AsyncWebServerRequest *request)
+        on("/submit-section", HTTP_POST, [this](AsyncWebServerRequest *request)
                   { handleFullConfigFormSubmission(request); });
     */
 
-    server.on("/upload", HTTP_POST, [](AsyncWebServerRequest *request)
-              { request->send(200, "text/html",
-                              "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Upload Complete</title></head><body>"
-                              "<h2>✅ File uploaded to SPIFFS</h2><a href='/home'>Back to Home</a></body></html>"); }, [](AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final)
-              {
-            static File uploadFile;
-
-            if (index == 0)
-            {
-                Serial.printf("📁 Starting upload: %s\n", filename.c_str());
-                if (SPIFFS.exists("/" + filename))
-                    SPIFFS.remove("/" + filename);
-                uploadFile = SPIFFS.open("/" + filename, FILE_WRITE);
-            }
-
-            if (uploadFile)
-                uploadFile.write(data, len);
+    on("/upload", HTTP_POST, [this](AsyncWebServerRequest *request)
+       { handleUploadDone(request); },
+       [this](AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final)
+       { handleUploadChunk(request, filename, index, data, len, final); });
 
-            if (final)
-            {
-                Serial.printf("✅ Completed upload: %s (%u bytes)\n", filename.c_str(), index + len);
-                uploadFile.close();
-            } });
+    on("/update", HTTP_POST, [this](AsyncWebServerRequest *request)
+       { handleOtaDone(request); },
+       [this](AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final)
+       { handleOtaChunk(request, filename, index, data, len, final); },
+       [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+       { handleOtaChunk(request, "(body)", index, data, len, index + len == total); }); // curl --data-binary
 
-    server.on(
-        "/update", HTTP_POST,
-        [](AsyncWebServerRequest *request)
-        {
-            request->send(200, "text/html",
-                          "<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Firmware Updated</title></head><body>"
-                          "<h2>✅ Firmware uploaded successfully. Rebooting...</h2>"
-                          "<a href='/home'>Back to Home</a></body></html>");
-            delay(1000);
-            ESP.restart();
-        },
-        [](AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final)
-        {
-            static size_t totalReceived = 0;
-            static size_t contentLen = 0;
+    otaEvents.onConnect([this](AsyncEventSourceClient *client)
+                        { publishOtaProgress(client); }); // A page opened mid-update sees where it is
+    server.addHandler(&otaEvents);
 
-            if (index == 0)
-            {
-                contentLen = request->contentLength();
-                totalReceived = 0;
-                Serial.printf("⚙️ OTA Begin: %s (%u bytes expected)\n", filename.c_str(), contentLen);
-                if (!Update.begin())
-                {
-                    Update.printError(Serial);
-                }
-            }
-
-            totalReceived += len;
-            if (Update.write(data, len) != len)
-            {
-                Update.printError(Serial);
-            }
-
-            // Log progress every 10%
-            static int lastProgress = 0;
-            int progress = (100 * totalReceived) / contentLen;
-            if (progress >= lastProgress + 10 || final)
-            {
-                Serial.printf("📶 Progress: %d%% (%u/%u bytes)\n", progress, totalReceived, contentLen);
-                lastProgress = progress;
-            }
-
-            if (final)
-            {
-                if (Update.end(true))
-                {
-                    Serial.printf("✅ OTA Complete. Total: %u bytes\n", totalReceived);
-                }
-                else
-                {
-                    Update.printError(Serial);
-                }
-            }
-        });
-    server.serveStatic("/schema_manual.html", SPIFFS, "/schema_manual.html.gz")
-        .setCacheControl("max-age=3600");
+    on("/schema_manual.html", HTTP_GET, [this](AsyncWebServerRequest *request)
+       { sendGzipFile(request, "/schema_manual.html", "text/html"); });
 
     server.begin();
     Serial.println("✅ WebUI routes registered and server is live.");
@@ -311,6 +960,7 @@ void webUI::handleFirmwareUploadPage(AsyncWebServerRequest *request)
 
 void webUI::handleFullConfigFormSubmission(AsyncWebServerRequest *request, bool verbose)
 {
+    heapScope heap(HEAP_TAG_WEBUI);
     if (!configManager)
     {
         request->send(500, "text/plain", "❌ Configuration manager not available.");
@@ -345,18 +995,12 @@ void webUI::handleFullConfigFormSubmission(AsyncWebServerRequest *request, bool
             Serial.printf("💾 Parsed: [%s][%s] = %s\n", section.c_str(), key.c_str(), finalValue.c_str());
     }
 
-    // Apply updates to config manager
-    for (const auto &sectionPair : updated)
-    {
-        const String &section = sectionPair.first;
-        for (const auto &kv : sectionPair.second)
-        {
-            configManager->setValue(section, kv.first, kv.second);
-        }
-    }
+    // Apply updates to config manager; subscribers are notified once the whole form is in
+    std::map<String, String> rejected;
+    configManager->applyUpdates(updated, &rejected);
 
-    // Save config to disk
-    configManager->saveToJson("/config.json", configManager->getConfig());
+    // Save config to disk (debounced, see configManager2::loop())
+    configManager->scheduleSave();
 
     // Optionally: show confirmation page
     std::map<String, String> flatUpdates;
@@ -364,7 +1008,9 @@ void webUI::handleFullConfigFormSubmission(AsyncWebServerRequest *request, bool
     {
         for (const auto &kv : s.second)
         {
-            flatUpdates[s.first + "." + kv.first] = kv.second;
+            String fullKey = s.first + "." + kv.first;
+            flatUpdates[fullKey] = rejected.count(fullKey) ? "⚠️ not saved: " + rejected[fullKey]
+                                                           : configManager->getValue(s.first, kv.first);
         }
     }
 
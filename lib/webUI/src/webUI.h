@@ -26,8 +26,30 @@
 #include <ESPAsyncWebServer.h>
 #include <configManager2.h>
 #include <htmlRenderer.h>
+#include <htmlRenderCache.h>
+#include "spiffsUpload.h"
+#include "otaSession.h"
 #include <SPIFFS.h>
-#include <Update.h>
+#include <heapStats.hpp>
+#include <packetTrace.hpp>
+#include <deferredWork.hpp>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#else
+#include <mutex>
+#endif
+
+// A callback longer than this holds up every other connection noticeably: all of
+// them are served by the one async_tcp task
+#ifndef WEB_CALLBACK_BUDGET_US
+#define WEB_CALLBACK_BUDGET_US 20000
+#endif
 
 class webUI
 {
@@ -35,12 +57,114 @@ private:
     AsyncWebServer server;
     configManager2 *configManager; // Provided by constructor, not owned
     htmlRenderer *renderer;        // Owned
+    htmlRenderCache pageCache;     // Section parts of /configs and /all, by section revision
+
+    // Every route is registered through on(), which times each request, upload and
+    // body callback; response fillers time themselves. Only the async_tcp task
+    // writes these, and GET /metrics reads them there too.
+    struct callbackStats
+    {
+        uint32_t calls = 0;
+        uint32_t overBudget = 0; // Longer than WEB_CALLBACK_BUDGET_US
+        uint32_t longestUs = 0;
+        const char *longestUri = ""; // Route, or "(response)" for a filler
+        void record(const char *uri, uint32_t us);
+    } callbacks;
+    void on(const char *uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+            ArUploadHandlerFunction onUpload = nullptr, ArBodyHandlerFunction onBody = nullptr);
+
+    // Chunked responses rendered a buffer at a time; no page-sized String on the heap.
+    // Conditional pages carry an ETag (hash of the rendered bytes) and answer a
+    // matching If-None-Match with 304; pages that change on every view opt out.
+    void sendPage(AsyncWebServerRequest *request, std::function<void(htmlWriter &)> render, bool conditional = true);
+    void sendParts(AsyncWebServerRequest *request, htmlPartRenderer render, bool conditional = true,
+                   const char *contentType = "text/html");
+
+    // Part `part` of a section-per-part page, section parts through pageCache
+    bool renderCachedPart(htmlWriter &out, uint8_t page, size_t part, const htmlPartRenderer &render);
+
+    // Flash-resident, pre-gzipped stylesheet (styleAsset.h)
+    void sendStyle(AsyncWebServerRequest *request);
+    // SPIFFS file stored as path + ".gz"; the ETag comes from the gzip trailer
+    void sendGzipFile(AsyncWebServerRequest *request, const String &path, const char *contentType);
+    static bool sendNotModified(AsyncWebServerRequest *request, const char *etag, const char *cacheControl);
+
+    // SPIFFS files, never held whole: the viewer reads HTML_FILE_VIEW_CHUNK bytes per
+    // part, downloads read straight into each TCP buffer and honour one Range
+    void sendFileView(AsyncWebServerRequest *request);
+    void sendFileDownload(AsyncWebServerRequest *request);
+
+    // GET /packets/stream: ESP-NOW traffic as JSON lines, each viewer with its own
+    // packetTraceReader filled as its TCP window allows; a stalled viewer loses its
+    // own oldest events and never holds up the radio or the other viewers
+    uint8_t packetStreams = 0;
+    void sendPacketStream(AsyncWebServerRequest *request);
+
+    // POST /upload: each request owns its spiffsUpload from the first chunk until the
+    // response (or the disconnect), so concurrent uploads cannot touch each other's file
+    std::map<AsyncWebServerRequest *, std::unique_ptr<spiffsUpload>> uploads;
+    void handleUploadChunk(AsyncWebServerRequest *request, const String &filename, size_t index,
+                           uint8_t *data, size_t len, bool final);
+    void handleUploadDone(AsyncWebServerRequest *request);
+
+    // POST /update (multipart from the firmware page, or the raw image as the body):
+    // one update at a time, hashed as it is written and activated only when the
+    // SHA-256 matches. Progress goes out as Server-Sent Events on /update/events.
+    AsyncEventSource otaEvents;
+    std::shared_ptr<otaSession> ota; // Shared with a response still waiting on the worker
+    AsyncWebServerRequest *otaRequest = nullptr; // The request feeding ota
+    void handleOtaChunk(AsyncWebServerRequest *request, const String &filename, size_t index,
+                        uint8_t *data, size_t len, bool final);
+    void handleOtaDone(AsyncWebServerRequest *request);
+    void publishOtaProgress(AsyncEventSourceClient *client = nullptr);
+
+    // Upload flow control: a chunk that leaves its writer short of room keeps the
+    // TCP window shut (ackLater), so the sender stops within the window it already
+    // has; loop() opens it again once the worker has made room. The web callbacks
+    // never wait on flash. The list is shared between async_tcp and loop().
+    struct heldAck
+    {
+        AsyncWebServerRequest *request;
+        std::function<size_t()> room;
+    };
+    std::vector<heldAck> heldAcks;
+#if defined(ESP32)
+    StaticSemaphore_t heldAcksBuffer;
+    SemaphoreHandle_t heldAcksLock;
+    void lockHeldAcks() { xSemaphoreTake(heldAcksLock, portMAX_DELAY); }
+    void unlockHeldAcks() { xSemaphoreGive(heldAcksLock); }
+#else
+    std::mutex heldAcksLock;
+    void lockHeldAcks() { heldAcksLock.lock(); }
+    void unlockHeldAcks() { heldAcksLock.unlock(); }
+#endif
+    void paceUpload(AsyncWebServerRequest *request, std::function<size_t()> room);
+    void dropHeldAck(AsyncWebServerRequest *request);
+    void releaseHeldAcks();
+
+    // Answers with render()'s page once ready() holds; until then the response waits,
+    // polled by the server, instead of the callback waiting on the worker
+    void sendWhenReady(AsyncWebServerRequest *request, std::function<bool()> ready,
+                       std::function<int(String &)> render);
+
+    // Restarts wait for loop(), so the response that announced them gets out first
+    bool restartPending = false;
+    unsigned long restartAt = 0;
+    void scheduleRestart(unsigned long delayMs);
+
+    // JSON config API: GET and PATCH on /api/config (whole config) and
+    // /api/config/<section>. ETags hash the JSON a GET returns; a PATCH with
+    // If-Match is refused with 412 once the resource has moved on.
+    void handleConfigGet(AsyncWebServerRequest *request);
+    void handleConfigPatch(AsyncWebServerRequest *request);
+    void configEtag(const String &section, char *etag) const;
 
 public:
     webUI(configManager2 *cfg); // Inject config manager
     ~webUI();
 
     void begin(bool = true);
+    void loop(unsigned long now); // Call from the sketch's loop(): runs deferred work such as restarts
     void handleFirmwareUploadPage(AsyncWebServerRequest *request);
     void handleFullConfigFormSubmission(AsyncWebServerRequest *request, bool verbose);
 
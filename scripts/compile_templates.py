@@ -0,0 +1,138 @@
+# Compiles lib/htmlRenderer/templates/*.html into pageTemplates.h: each page
+# becomes flash-resident literal fragments and a step table, so rendering is a
+# run of fragment writes and value substitutions with nothing parsed at runtime.
+#
+# A placeholder is {{name}} (letters and digits). For a template fooBar.html
+# the header defines
+#   enum fooBarSlot { FOO_BAR_NAME, ..., FOO_BAR_SLOTS }   in order of first use
+#   static const htmlTemplate FOO_BAR_TEMPLATE
+# and htmlRenderer fills an htmlValue[FOO_BAR_SLOTS] for renderTemplate().
+# The newline an editor leaves at the end of the file is not part of the page.
+#
+# Runs as a PlatformIO pre-script (extra_scripts = pre:scripts/compile_templates.py)
+# and can be run by hand: python3 scripts/compile_templates.py
+# The header is only rewritten when its content changes, so builds stay incremental.
+import glob
+import os
+import re
+import sys
+
+try:
+    Import("env")  # noqa: F821 (provided by SCons under PlatformIO)
+    ROOT = env.subst("$PROJECT_DIR")  # noqa: F821
+except NameError:
+    ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+TEMPLATE_DIR = os.path.join(ROOT, "lib", "htmlRenderer", "templates")
+HEADER_PATH = os.path.join(ROOT, "lib", "htmlRenderer", "src", "pageTemplates.h")
+
+PLACEHOLDER = re.compile(r"\{\{([A-Za-z][A-Za-z0-9]*)\}\}")
+MAX_FRAGMENT = 0xFFFF  # htmlTemplateStep::length
+# htmlTemplate::stepCount. Every slot takes a step before the trailing literal, so
+# this also keeps slotCount <= 254, below HTML_TEMPLATE_NO_SLOT (0xFF)
+MAX_STEPS = 0xFF
+
+
+def fail(path, message):
+    sys.stderr.write("compile_templates: %s: %s\n" % (os.path.relpath(path, ROOT), message))
+    sys.exit(1)
+
+
+def upper_snake(name):
+    return re.sub(r"(?<=[a-z0-9])(?=[A-Z])", "_", name).upper()
+
+
+def c_literal(text):
+    out = []
+    for ch in text:
+        if ch == "\\":
+            out.append("\\\\")
+        elif ch == '"':
+            out.append('\\"')
+        elif ch == "\n":
+            out.append("\\n")
+        elif ch == "\t":
+            out.append("\\t")
+        elif ord(ch) < 0x20:
+            out.append("\\%03o" % ord(ch))
+        else:
+            out.append(ch)  # UTF-8 passes through, as in the hand-written pages
+    return '"' + "".join(out) + '"'
+
+
+def split_fragments(path, text):
+    """[(literal, slotName or None)], ending with the trailing literal."""
+    steps, pos = [], 0
+    for match in PLACEHOLDER.finditer(text):
+        steps.append((text[pos:match.start()], match.group(1)))
+        pos = match.end()
+    steps.append((text[pos:], None))
+    for literal, _ in steps:
+        if "{{" in literal or "}}" in literal:
+            fail(path, "malformed placeholder near %r" % literal[max(0, literal.find("{{")):][:40])
+        if len(literal.encode("utf-8")) > MAX_FRAGMENT:
+            fail(path, "fragment longer than %d bytes" % MAX_FRAGMENT)
+    return steps
+
+
+def compile_template(path):
+    name = os.path.splitext(os.path.basename(path))[0]
+    if not re.match(r"^[a-z][A-Za-z0-9]*$", name):
+        fail(path, "template names are camelCase identifiers")
+    with open(path, "r", encoding="utf-8") as f:
+        text = f.read()
+    if text.endswith("\n"):
+        text = text[:-1]
+
+    prefix = upper_snake(name)
+    steps = split_fragments(path, text)
+    slots = []
+    for _, slot in steps:
+        if slot and slot not in slots:
+            slots.append(slot)
+    if len(steps) > MAX_STEPS:
+        fail(path, "%d steps, at most %d fit htmlTemplate::stepCount" % (len(steps), MAX_STEPS))
+
+    lines = ["// %s" % os.path.relpath(path, ROOT).replace(os.sep, "/")]
+    lines.append("enum %sSlot : uint8_t" % name)
+    lines.append("{")
+    for slot in slots:
+        lines.append("    %s_%s," % (prefix, upper_snake(slot)))
+    lines.append("    %s_SLOTS" % prefix)
+    lines.append("};")
+    for i, (literal, _) in enumerate(steps):
+        lines.append("static const char %s_FRAGMENT_%d[] PROGMEM = %s;" % (prefix, i, c_literal(literal)))
+    lines.append("static const htmlTemplateStep %s_STEPS[] = {" % prefix)
+    for i, (_, slot) in enumerate(steps):
+        target = "%s_%s" % (prefix, upper_snake(slot)) if slot else "HTML_TEMPLATE_NO_SLOT"
+        lines.append("    {%s_FRAGMENT_%d, sizeof(%s_FRAGMENT_%d) - 1, %s}," % (prefix, i, prefix, i, target))
+    lines.append("};")
+    lines.append("static const htmlTemplate %s_TEMPLATE = {%s_STEPS, sizeof(%s_STEPS) / sizeof(%s_STEPS[0]), %s_SLOTS};"
+                 % (prefix, prefix, prefix, prefix, prefix))
+    return "\n".join(lines)
+
+
+def main():
+    paths = sorted(glob.glob(os.path.join(TEMPLATE_DIR, "*.html")))
+    parts = [
+        "// Generated by scripts/compile_templates.py from lib/htmlRenderer/templates; do not edit.",
+        "#pragma once",
+        "#include \"htmlTemplate.h\"",
+    ]
+    for path in paths:
+        parts.append("")
+        parts.append(compile_template(path))
+    header = "\n".join(parts) + "\n"
+
+    try:
+        with open(HEADER_PATH, "r", encoding="utf-8") as f:
+            if f.read() == header:
+                return
+    except OSError:
+        pass
+    with open(HEADER_PATH, "w", encoding="utf-8", newline="\n") as f:
+        f.write(header)
+    print("compile_templates: wrote %s (%d templates)" % (os.path.relpath(HEADER_PATH, ROOT), len(paths)))
+
+
+main()
@@ -0,0 +1,73 @@
+# Compresses lib/htmlRenderer/src/style.css into styleAsset.h, a flash-resident
+# gzip blob plus the ETag and versioned link the web UI serves it under.
+#
+# Runs as a PlatformIO pre-script (extra_scripts = pre:scripts/embed_style.py)
+# and can be run by hand: python3 scripts/embed_style.py
+# The header is only rewritten when its content changes, so builds stay incremental.
+import gzip
+import hashlib
+import os
+import re
+
+try:
+    Import("env")  # noqa: F821 (provided by SCons under PlatformIO)
+    ROOT = env.subst("$PROJECT_DIR")  # noqa: F821
+except NameError:
+    ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+SRC_DIR = os.path.join(ROOT, "lib", "htmlRenderer", "src")
+CSS_PATH = os.path.join(SRC_DIR, "style.css")
+HEADER_PATH = os.path.join(SRC_DIR, "styleAsset.h")
+
+
+def minify(css):
+    css = re.sub(r"/\*.*?\*/", "", css, flags=re.S)
+    css = re.sub(r"\s+", " ", css)
+    css = re.sub(r"\s*([{};,])\s*", r"\1", css)
+    css = re.sub(r":\s+", ":", css)
+    return css.replace(";}", "}").strip()
+
+
+def render_header(css):
+    body = minify(css).encode("utf-8")
+    # mtime=0 and no file name: the same CSS always compresses to the same bytes
+    packed = gzip.compress(body, compresslevel=9, mtime=0)
+    digest = hashlib.sha256(body).hexdigest()
+
+    rows = []
+    for i in range(0, len(packed), 16):
+        rows.append("    " + ", ".join("0x%02x" % b for b in packed[i:i + 16]) + ",")
+
+    return "\n".join([
+        "// Generated by scripts/embed_style.py from style.css; do not edit.",
+        "#pragma once",
+        "#include <Arduino.h>",
+        "",
+        "// %d bytes of CSS, %d minified, %d gzipped" % (len(css.encode("utf-8")), len(body), len(packed)),
+        "static const uint8_t STYLE_CSS_GZ[] PROGMEM = {",
+        *rows,
+        "};",
+        "static const size_t STYLE_CSS_GZ_LEN = sizeof(STYLE_CSS_GZ);",
+        "static const size_t STYLE_CSS_LEN = %d;" % len(body),
+        'static const char STYLE_CSS_ETAG[] = "\\"%s\\"";' % digest[:16],
+        "// The version in the URL changes with the CSS, so the file itself can be cached for good",
+        "static const char STYLE_CSS_LINK[] = \"<link rel='stylesheet' href='/style.css?v=%s'>\";" % digest[:8],
+        "",
+    ])
+
+
+def main():
+    with open(CSS_PATH, "r", encoding="utf-8") as f:
+        header = render_header(f.read())
+    try:
+        with open(HEADER_PATH, "r", encoding="utf-8") as f:
+            if f.read() == header:
+                return
+    except OSError:
+        pass
+    with open(HEADER_PATH, "w", encoding="utf-8", newline="\n") as f:
+        f.write(header)
+    print("embed_style: wrote %s" % os.path.relpath(HEADER_PATH, ROOT))
+
+
+main()
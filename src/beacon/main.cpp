@@ -128,7 +128,7 @@ void setup()
         // ✅ Start ESP-NOW Safely
         esp_wifi_set_promiscuous(true);
         myEspNow.connectEspnow(channel, WIFI_MODE_STA, true);
-        config.saveToJson(filename.c_str(), config.getConfig());
+        config.save();  // Only writes if setup changed something
     }
     else
     {
@@ -140,11 +140,13 @@ void setup()
 
 void loop()
 {
+    config.loop(millis());
     static unsigned long startMillis = millis(); // Non-blocking delay alternative
     static deviceDataPacket dataPacket = {0, 0, 0, 0, 0}; // Initialize data packet
 
     while (millis() - startMillis < 10000)
     {
+        ui.loop(millis()); // Deferred restarts after /update and /restart
         delay(100); // Small increments instead of full 10s block
     }
     startMillis = millis(); // Reset for next loop
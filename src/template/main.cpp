@@ -46,6 +46,9 @@
 #include <messageHandler.hpp>
 #include <radioInterface.hpp>
 #include <deviceDataPacket.h>
+#include <configSync.hpp>
+#include <heapStats.hpp>
+#include <packetTrace.hpp>
 
 const String configFile = "/config.json";
 configManager2 config;
@@ -65,6 +68,61 @@ messageHandler* messenger = nullptr;
 
 beaconHandler beacon;
 
+// Application-layer security, keyed from security.secret
+static packetCipher cipher;
+static packetTagger tagger;
+static bool aeadEnabled = false;
+static bool tagEnabled = false;
+
+// Per-subsystem heap table on Serial; also served live at /heap
+constexpr unsigned long HEAP_DUMP_EVERY_MS = 10UL * 60 * 1000;
+
+// Boss pushes config deltas to workers; frames bypass the deviceDataPacket queues
+static configSync fleetSync;
+
+static bool sendSyncFrame(const uint8_t* mac, const uint8_t* data, size_t len, void*) {
+    // Workers beyond the peer list hear it on broadcast; the tag names the one it is for
+    const uint8_t* dest = esp_now_is_peer_exist(mac) ? mac : espNowBroadcastAddr;
+    bool sent = esp_now_send(dest, data, len) == ESP_OK;
+    packetTraceRecord(sent ? PACKET_TX : PACKET_TX_ERROR, mac, data, len);
+    return sent;
+}
+
+static bool onSyncFrame(const uint8_t* mac, const uint8_t* data, int len, void*) {
+    return fleetSync.onFrame(mac, data, len);
+}
+
+// Runs once at setup and again whenever the secret is changed from the web UI,
+// so the derived keys are rebuilt on change instead of read per packet.
+static void onSecretChanged(const String&, const String&, const String& secret, void*) {
+    const uint8_t* raw = reinterpret_cast<const uint8_t*>(secret.c_str());
+    if (aeadEnabled) {
+        uint8_t groupKey[AEAD_KEY_LEN];
+        if (deriveGroupKey(raw, secret.length(), groupKey)) {
+            cipher.setGroupKey(groupKey);
+        }
+        memset(groupKey, 0, sizeof(groupKey));
+    }
+    if (tagEnabled) {
+        uint8_t tagKey[TAG_KEY_LEN];
+        if (deriveTagKey(raw, secret.length(), tagKey)) {
+            tagger.setKey(tagKey);
+            tagger.setRequireTag(true);
+        }
+        memset(tagKey, 0, sizeof(tagKey));
+    }
+    uint8_t syncKey[SESSION_KEY_LEN];
+    if (deriveConfigKey(raw, secret.length(), syncKey)) {
+        fleetSync.setKey(syncKey);
+    }
+    memset(syncKey, 0, sizeof(syncKey));
+#ifndef I_AM_A_BOSS
+    uint8_t selfMac[6];
+    WiFi.macAddress(selfMac);
+    pairing->setSessionSecret(raw, secret.length(), selfMac, beacon.getSessionNonce());
+#endif
+}
+
 #include "espNowCallbacks.cpp"
 
 void setup() {
@@ -89,7 +147,7 @@ void setup() {
     if (wifi->begin(&config, true)) {
         ui.begin();
     }
-    config.saveToJson(configFile.c_str(), config.getConfig());
+    config.save();  // Only writes if setup changed something
 
     // Instantiate message handler
     static messageHandler messengerInstance(&txQueue, &rxQueue, &handlerQueue);
@@ -110,25 +168,65 @@ void setup() {
     int channel = config.getValue("espnow", "channel").toInt();
     radio->begin(channel, WIFI_MODE_STA, true);
 
+    // Application-layer AEAD for broadcast and peers beyond the encrypted-peer limit
+    uint8_t selfMac[6];
+    WiFi.macAddress(selfMac);
+    // On unless turned off: config files from before the key do not have it
+    if (config.getValue("security", "aead") != "false") {
+        cipher.begin(selfMac);
+        cipher.setRequireSealed(true);  // Peers we hold a key for always seal; their frames in the clear are forged
+        radio->setCipher(&cipher);
+        pairing->setCipher(&cipher);
+        aeadEnabled = true;
+        Serial.printf("[AEAD] Enabled (%s)\n", cipher.backendName());
+    }
+
+    // SipHash short tags on everything that is not AEAD-sealed
+    if (config.getValue("security", "tag") == "true") {
+        if (aeadEnabled) tagger.shareReplayWindow(cipher.replay());  // One counter for sealed and tagged frames
+        tagger.begin(selfMac);
+        radio->setTagger(&tagger);
+        tagEnabled = true;
+        Serial.println("[TAG] SipHash-2-4/32 packet tags enabled");
+    }
+
+    beacon.setRadio(radio);
 #ifdef I_AM_A_BOSS
     Serial.println("[ROLE] Boss mode enabled");
-    beacon.beginPairingWindow(&config, BEACON_TIMEOUT);
+    beacon.beginPairing(&config);
+    fleetSync.begin(&config, selfMac, true, sendSyncFrame);
 #else
     Serial.println("[ROLE] Worker mode enabled");
     beacon.begin(&config);
+    fleetSync.begin(&config, selfMac, false, sendSyncFrame);
 #endif
+    radio->setFrameHook(onSyncFrame);
+
+    // Keys derived from the secret follow it; the first call happens right here
+    config.subscribe("security", "secret", onSecretChanged);
+
+    heapStatsDump();
+    heapStatsResetPeaks(); // Boot-time peaks are in the dump above; track steady state from here
 }
 
 void loop() {
+    config.loop(millis());
     if (messenger) messenger->loop();
     if (pairing) pairing->loop();
     if (radio) radio->loop();
-
-#ifdef I_AM_A_BOSS
-    if (!beacon.isPaired()) {
-        beacon.processQueue();
+    fleetSync.loop(millis());
+    ui.loop(millis());      // Deferred restarts after /update and /restart
+
+    deviceDataPacket inbound;
+    while (pairing && handlerQueue.pop(inbound)) {
+        packetTraceDequeued(PACKET_QUEUE_HANDLER);
+        if (beacon.handlePacket(inbound)) continue;  // Boss: KeyConfirm completes a key offer
+        pairing->handlePacket(inbound);
     }
-#else
-    beacon.loop(millis());
+
+#ifndef I_AM_A_BOSS
+    if (pairing && pairing->isPaired()) beacon.stopBroadcasting();
 #endif
+    beacon.loop(millis());  // Boss: admits workers; worker: emits beacons
+    heapStatsLoop(millis(), HEAP_DUMP_EVERY_MS);
 }
\ No newline at end of file
@@ -0,0 +1,163 @@
+// JSON config API (/api/config) versus the HTML form path, for fleet tooling
+// that changes one setting, on data/config.json:
+//   read   what a tool downloads to learn the current values: the /configs
+//          form it would scrape, or the JSON for the whole config / one section
+//   edit   one key: the form posts every field on the page and webUI rebuilds
+//          the nested map from the params before applyUpdates(); a PATCH sends
+//          only that key and goes through patchValues()
+// Plus the semantics webUI relies on: all-or-nothing PATCH, ETags that follow
+// edits per section, and that only the touched section is marked dirty.
+// Host only; nothing here ran on an ESP32.
+//   g++ -std=c++17 -O2 -I../hostShim -I../../lib/configManager2 -I../../lib/globalConstants/src -I../../lib/textCodec
+//       -I../../lib/heapStats -I../../lib/htmlRenderer/src bench.cpp ../../lib/configManager2/configManager2.cpp
+//       ../../lib/configManager2/configSchema.cpp ../../lib/htmlRenderer/src/htmlRenderer.cpp -o bench
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <configManager2.h>
+#include <htmlRenderer.h>
+
+using clk = std::chrono::steady_clock;
+using configMap = std::map<String, std::map<String, String>>;
+
+static std::string readFile(const char* path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+static String renderJson(const htmlRenderer& renderer, const String& section) {
+    String json;
+    htmlStringWriter out(json);
+    for (size_t part = 0; renderer.renderConfigJsonPart(out, section, part); ++part) {}
+    return json;
+}
+
+// What webUI::configEtag() computes
+static String etagOf(const htmlRenderer& renderer, const String& section) {
+    htmlHashWriter hash;
+    for (size_t part = 0; renderer.renderConfigJsonPart(hash, section, part); ++part) {}
+    char etag[htmlHashWriter::ETAG_LEN + 1];
+    hash.etag(etag);
+    return String(etag);
+}
+
+// The form's fields as the browser posts them: name=section.key, every field on the page
+static std::vector<std::pair<String, String>> formParams(const configMap& config) {
+    std::vector<std::pair<String, String>> params;
+    for (const auto& section : config) {
+        if (section.first.endsWith(".format")) continue;
+        for (const auto& field : section.second) {
+            if (field.first.startsWith("format.")) continue;
+            params.push_back({section.first + "." + field.first, field.second});
+        }
+    }
+    return params;
+}
+
+static size_t encodedLength(const std::vector<std::pair<String, String>>& params) {
+    size_t n = 0;
+    for (const auto& p : params) n += p.first.length() + 1 + p.second.length() + 1; // Unescaped: a floor
+    return n ? n - 1 : 0;
+}
+
+static bool patch(configManager2& config, const String& section, const char* body,
+                  std::map<String, String>* rejected = nullptr) {
+    configMemorySource source(body, strlen(body));
+    configJsonReader<configMemorySource> reader(source);
+    configMap update;
+    if (!(section.isEmpty() ? reader.parse(update) : reader.parseFields(update[section]))) return false;
+    return config.patchValues(update, rejected);
+}
+
+static bool checks(configManager2& config, const htmlRenderer& renderer) {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("FAILED: %s\n", what);
+        ok = ok && cond;
+    };
+
+    // GET /api/config is config.json as save() writes it
+    String saved;
+    configStringSink sink(saved);
+    configJsonWriter<configStringSink> writer(sink);
+    writer.write(config.getConfig());
+    expect(renderJson(renderer, "") == saved, "whole config matches the saved layout");
+    configStore reread;
+    String section = renderJson(renderer, "mqtt");
+    configMemorySource source(section.c_str(), section.length());
+    configJsonReader<configMemorySource> reader(source);
+    expect(reader.parseFields(reread["mqtt"]) && reread["mqtt"] == config.getConfig().at("mqtt"), "section round trip");
+    htmlHashWriter ignored;
+    expect(!renderer.renderConfigJsonPart(ignored, "nosuch", 0), "unknown section");
+
+    config.save(true);
+    String espnowTag = etagOf(renderer, "espnow"), mqttTag = etagOf(renderer, "mqtt"), allTag = etagOf(renderer, "");
+
+    // All or nothing: one bad field keeps the good one out too
+    std::map<String, String> rejected;
+    expect(!patch(config, "espnow", "{\"channel\": \"6\", \"devicemac\": \"not-a-mac\"}", &rejected) &&
+           rejected.count("espnow.devicemac") && config.getValue("espnow", "channel") == "1", "rejects whole patch");
+    rejected.clear();
+    expect(!patch(config, "", "{\"wifiSTA\": {\"channel\": \"3\"}, \"mqtt\": {\"nosuch\": \"1\"}}", &rejected) &&
+           String(rejected["wifiSTA.channel"]) == "read-only" && String(rejected["mqtt.nosuch"]) == "unknown key",
+           "read-only and unknown keys");
+    expect(!config.isDirty() && etagOf(renderer, "espnow") == espnowTag, "rejected patch leaves no trace");
+
+    // Accepted: canonical value stored, only that section dirty, only its ETag (and the whole one) move
+    expect(patch(config, "espnow", "{\"channel\": 6, \"remotemac\": \"aa-bb-cc-dd-ee-01\"}"), "accepts patch");
+    expect(config.getValue("espnow", "channel") == "6" &&
+           config.getValue("espnow", "remotemac") == "AA:BB:CC:DD:EE:01", "stored canonically");
+    expect(config.isSectionDirty("espnow") && !config.isSectionDirty("mqtt"), "only the touched section is dirty");
+    expect(etagOf(renderer, "espnow") != espnowTag && etagOf(renderer, "mqtt") == mqttTag &&
+           etagOf(renderer, "") != allTag, "ETags follow the edit");
+    expect(!patch(config, "espnow", "{\"channel\": }"), "malformed body");
+    return ok;
+}
+
+int main() {
+    Serial.quiet = true;
+    configManager2 config;
+    config.setSnapshotEnabled(false);
+    SPIFFS.setRoot("/tmp/bench_config_api");
+    SPIFFS.begin(true);
+    if (!config.jsonStringToConfig(String(readFile("../../data/config.json")), false)) {
+        printf("cannot load data/config.json\n");
+        return 1;
+    }
+    htmlRenderer renderer(&config.getConfig());
+    renderer.setSchema(&config.getSchema());
+
+    String form = renderer.generateConfigFormPage(config.getConfig(), true);
+    size_t whole = renderJson(renderer, "").length();
+    printf("read   /configs form %6u bytes   /api/config %6zu bytes   /api/config/mqtt %4u bytes\n",
+           form.length(), whole, renderJson(renderer, "mqtt").length());
+
+    const int rounds = 20000;
+    auto params = formParams(config.getConfig());
+    const char* body = "{\"port\": \"1884\"}";
+    auto t0 = clk::now();
+    for (int i = 0; i < rounds; ++i) {
+        params[0].second = (i & 1) ? "true" : "false";
+        configMap updates; // webUI::handleFullConfigFormSubmission()
+        for (const auto& p : params) {
+            int split = p.first.indexOf('.');
+            updates[p.first.substring(0, split)][p.first.substring(split + 1)] = p.second;
+        }
+        config.applyUpdates(updates);
+    }
+    double formUs = std::chrono::duration<double, std::micro>(clk::now() - t0).count() / rounds;
+    t0 = clk::now();
+    for (int i = 0; i < rounds; ++i) patch(config, "mqtt", (i & 1) ? body : "{\"port\": \"1883\"}");
+    double patchUs = std::chrono::duration<double, std::micro>(clk::now() - t0).count() / rounds;
+    printf("edit   form post %4zu fields %5zu bytes %6.1f us   PATCH /api/config/mqtt %zu bytes %6.1f us\n",
+           params.size(), encodedLength(params), formUs, strlen(body), patchUs);
+    printf("       either way the save that follows rewrites config.json once (%zu bytes)\n\n", whole);
+
+    bool ok = checks(config, renderer);
+    printf("API semantics: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+// Hot-path config reads: getValue() + String parsing versus pre-resolved handles
+// and state cached by change subscriptions. Builds against the host shims.
+//   g++ -std=c++17 -O2 -I../hostShim -I../../lib/configManager2 -I../../lib/globalConstants/src -I../../lib/textCodec -I../../lib/heapStats
+//       bench.cpp ../../lib/configManager2/configManager2.cpp ../../lib/configManager2/configSchema.cpp -o bench
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <configManager2.h>
+
+using clk = std::chrono::steady_clock;
+
+static volatile size_t allocations = 0;
+void* operator new(size_t n) {
+    ++allocations;
+    if (void* p = malloc(n)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// Roughly the shape of data/config.json, padded out with extra sections
+static String makeConfig(int sections, int keys) {
+    String json = "{\n";
+    for (int s = 0; s < sections; ++s) {
+        json += "  \"section" + String(s) + "\": {\n";
+        for (int k = 0; k < keys; ++k) {
+            json += "    \"key" + String(k) + "\": \"value" + String(k) + "\",\n";
+        }
+        json += "    \"last\": \"x\"\n  },\n";
+    }
+    json += "  \"espnow\": { \"channel\": \"6\", \"remotemac\": \"24:6F:28:AA:BB:CC\", \"beaconInterval\": \"2000\" },\n";
+    json += "  \"security\": { \"encrypt\": \"true\", \"secret\": \"42273211\", "
+            "\"lmk\": \"DEADBEEFDEADBEEFDEADBEEFDEADBEEF\" }\n}\n";
+    return json;
+}
+
+// What a consumer keeps when it subscribes instead of polling
+struct derivedState {
+    bool secure = false;
+    uint8_t key[16] = {0};
+    int updates = 0;
+};
+
+static void onSecurity(const String&, const String& key, const String& value, void* context) {
+    derivedState* state = static_cast<derivedState*>(context);
+    if (key == "encrypt") state->secure = value == "true";
+    if (key == "lmk") {
+        for (size_t i = 0; i < sizeof(state->key) && 2 * i + 1 < value.length(); ++i) {
+            state->key[i] = strtoul(value.substring(2 * i, 2 * i + 2).c_str(), nullptr, 16);
+        }
+    }
+    ++state->updates;
+}
+
+template <typename F>
+static void measure(const char* label, int rounds, F&& op) {
+    size_t before = allocations;
+    auto t0 = clk::now();
+    for (int i = 0; i < rounds; ++i) op();
+    double ns = std::chrono::duration<double, std::nano>(clk::now() - t0).count() / rounds;
+    printf("%-34s %8.1f ns/read  %5.2f allocs/read\n", label, ns, double(allocations - before) / rounds);
+}
+
+int main() {
+    Serial.quiet = true;
+    configManager2 config;
+    config.jsonStringToConfig(makeConfig(20, 10));
+
+    constexpr int ROUNDS = 1000000;
+    volatile long sink = 0;
+
+    printf("Per-beacon read set: secret + encrypt flag\n");
+    measure("getValue (String copy + compare)", ROUNDS, [&] {
+        String secret = config.getValue("security", "secret");
+        bool encrypt = config.getValue("security", "encrypt") == "true";
+        sink += secret.length() + encrypt;
+    });
+
+    configHandle hSecret = config.handle("security", "secret");
+    configHandle hEncrypt = config.handle("security", "encrypt");
+    measure("handle (getString + getBool)", ROUNDS, [&] {
+        String secret = config.getString(hSecret);
+        sink += secret.length() + config.getBool(hEncrypt);
+    });
+
+    printf("\nInteger and byte fields\n");
+    measure("getValue(...).toInt()", ROUNDS, [&] { sink += config.getValue("espnow", "channel").toInt(); });
+    configHandle hChannel = config.handle("espnow", "channel");
+    measure("getInt(handle)", ROUNDS, [&] { sink += config.getInt(hChannel); });
+
+    uint8_t lmk[16];
+    measure("parseHexStringToBytes(getValue)", ROUNDS, [&] {
+        config.parseHexStringToBytes(config.getValue("security", "lmk"), lmk, sizeof(lmk));
+        sink += lmk[0];
+    });
+    configHandle hLmk = config.handle("security", "lmk");
+    measure("getBytes(handle)", ROUNDS, [&] {
+        sink += config.getBytes(hLmk, lmk, sizeof(lmk));
+    });
+
+    printf("\nSubscribed: derived state rebuilt on change only\n");
+    derivedState state;
+    config.subscribe("security", "", onSecurity, &state);
+    measure("cached flag + parsed key", ROUNDS, [&] { sink += state.secure + state.key[0]; });
+    measure("setValue, unrelated key", ROUNDS / 10, [&] { config.setValue("section3", "key1", String(sink & 7)); });
+    measure("setValue, watched key", ROUNDS / 10, [&] { config.setValue("security", "encrypt", (sink++ & 1) ? "true" : "false"); });
+
+    // Handles and subscribers follow writes; a batch and a reload notify once per changed key
+    config.setValue("security", "encrypt", "false");
+    config.setValue("espnow", "channel", "11");
+    bool tracks = !config.getBool(hEncrypt) && config.getInt(hChannel) == 11 && !state.secure;
+
+    int before = state.updates;
+    config.setValue("security", "encrypt", "false");  // Unchanged: no callback
+    bool quiet = state.updates == before;
+
+    config.applyUpdates({{"security", {{"encrypt", "true"}, {"lmk", "00112233445566778899AABBCCDDEEFF"}}}});
+    bool batched = state.updates == before + 2 && state.secure && state.key[15] == 0xFF;
+
+    before = state.updates;
+    String json = makeConfig(20, 10);
+    json.replace("\"encrypt\": \"true\"", "\"encrypt\": \"false\"");
+    config.jsonStringToConfig(json);  // encrypt and lmk both differ from the live store
+    bool reload = state.updates == before + 2 && !state.secure && state.key[0] == 0xDE;
+
+    printf("\nHandles follow setValue():  %s\n", tracks ? "ok" : "STALE");
+    printf("Unchanged write is silent:  %s\n", quiet ? "ok" : "NOISY");
+    printf("Batch notifies per key:     %s\n", batched ? "ok" : "WRONG");
+    printf("Reload notifies the diff:   %s\n", reload ? "ok" : "WRONG");
+    return tracks && quiet && batched && reload ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+// Config load cost versus size: streaming parse from a file source, and the
+// older whole-file String path (readString + jsonStringToMap) for comparison.
+//   g++ -std=c++17 -O2 -I../hostShim -I../../lib/configManager2 -I../../lib/globalConstants/src -I../../lib/textCodec -I../../lib/heapStats
+//       bench.cpp ../../lib/configManager2/configManager2.cpp ../../lib/configManager2/configSchema.cpp -o bench
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include <configManager2.h>
+
+using clk = std::chrono::steady_clock;
+
+// Heap accounting: every block carries its size so frees can be subtracted.
+// All the replaceable forms go through the same header, so no new/delete pair
+// mixes ours with the library's. (heapStats' host hooks only follow
+// HEAP_STATS_SLOTS live blocks, fewer than a 64 KB config holds.)
+static size_t liveBytes = 0;
+static size_t peakBytes = 0;
+static void* trackedAlloc(size_t n) noexcept {
+    size_t* p = static_cast<size_t*>(malloc(n + sizeof(size_t) * 2));
+    if (!p) return nullptr;
+    p[0] = n;
+    liveBytes += n;
+    if (liveBytes > peakBytes) peakBytes = liveBytes;
+    return p + 2;
+}
+// Out of line: inlined into a caller, GCC would see a new-expression's pointer reach free()
+__attribute__((noinline)) static void trackedFree(void* q) noexcept {
+    if (!q) return;
+    size_t* p = static_cast<size_t*>(q) - 2;
+    liveBytes -= p[0];
+    free(p);
+}
+void* operator new(size_t n) {
+    void* p = trackedAlloc(n);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t n) {
+    void* p = trackedAlloc(n);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new(size_t n, const std::nothrow_t&) noexcept { return trackedAlloc(n); }
+void* operator new[](size_t n, const std::nothrow_t&) noexcept { return trackedAlloc(n); }
+void operator delete(void* q) noexcept { trackedFree(q); }
+void operator delete[](void* q) noexcept { trackedFree(q); }
+void operator delete(void* q, size_t) noexcept { trackedFree(q); }
+void operator delete[](void* q, size_t) noexcept { trackedFree(q); }
+void operator delete(void* q, const std::nothrow_t&) noexcept { trackedFree(q); }
+void operator delete[](void* q, const std::nothrow_t&) noexcept { trackedFree(q); }
+
+// FILE*-backed stand-in for an Arduino File opened for reading
+class hostFileSource {
+public:
+    explicit hostFileSource(const char* path) : f(fopen(path, "rb")) {}
+    ~hostFileSource() { if (f) fclose(f); }
+    size_t read(uint8_t* buf, size_t len) { return f ? fread(buf, 1, len, f) : 0; }
+    String readString() {
+        std::string all;
+        char chunk[256];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) all.append(chunk, n);
+        return String(all);
+    }
+
+private:
+    FILE* f;
+};
+
+static size_t writeConfig(const char* path, size_t targetBytes) {
+    std::string json = "{\n";
+    for (int s = 0; json.size() < targetBytes; ++s) {
+        json += "  \"section" + std::to_string(s) + "\": {\n";
+        for (int k = 0; k < 8; ++k) {
+            json += "    \"key" + std::to_string(k) + "\": \"value-" + std::to_string(s * 8 + k) + "\",\n";
+        }
+        json += "    \"mac\": \"24:6F:28:AA:BB:CC\"\n  },\n";
+    }
+    json += "  \"security\": { \"encrypt\": \"true\", \"secret\": \"42273211\" }\n}\n";
+    FILE* f = fopen(path, "wb");
+    fwrite(json.data(), 1, json.size(), f);
+    fclose(f);
+    return json.size();
+}
+
+// One load through either path; the heap figures are taken around it
+struct loadSample {
+    double us;
+    size_t peak, store, sections;
+};
+
+static loadSample loadOnce(const char* path, int mode) {
+    configStore loaded;
+    size_t base = liveBytes;
+    peakBytes = base;
+    auto t0 = clk::now();
+    hostFileSource file(path);
+    if (mode == 0) {
+        configJsonReader<hostFileSource> reader(file);
+        reader.parse(loaded);
+    } else {
+        configManager2 scratch;
+        String text = file.readString();
+        loaded = scratch.jsonStringToMap(text);
+    }
+    double us = std::chrono::duration<double, std::micro>(clk::now() - t0).count();
+    return {us, peakBytes - base, liveBytes - base, loaded.size()};
+}
+
+int main() {
+    Serial.quiet = true;
+    const char* path = "/tmp/bench_config_load.json";
+    const size_t sizes[] = {2 * 1024, 16 * 1024, 64 * 1024};
+    constexpr int ROUNDS = 201;
+
+    // Both paths run the same parser; they differ in how the bytes reach it. The modes
+    // alternate round by round after a warm-up, and the median is reported, so neither
+    // gets the warm allocator or page cache the other left behind.
+    printf("%-7s %-12s %10s %10s %12s %12s\n", "size", "path", "median us", "p90 us", "peak heap", "store heap");
+    for (size_t target : sizes) {
+        size_t bytes = writeConfig(path, target);
+        std::vector<double> us[2];
+        loadSample last[2];
+        for (int mode = 0; mode < 2; ++mode) loadOnce(path, mode);
+        for (int r = 0; r < ROUNDS; ++r) {
+            for (int i = 0; i < 2; ++i) {
+                int mode = (r + i) % 2;
+                last[mode] = loadOnce(path, mode);
+                us[mode].push_back(last[mode].us);
+            }
+        }
+        for (int mode = 0; mode < 2; ++mode) {
+            std::sort(us[mode].begin(), us[mode].end());
+            printf("%5zuKB %-12s %10.1f %10.1f %10zu B %10zu B  (%zu sections)\n", bytes / 1024,
+                   mode == 0 ? "streaming" : "whole-file", us[mode][ROUNDS / 2], us[mode][ROUNDS * 9 / 10],
+                   last[mode].peak, last[mode].store, last[mode].sections);
+        }
+    }
+    remove(path);
+    return 0;
+}
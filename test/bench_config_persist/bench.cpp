@@ -0,0 +1,160 @@
+// Flash bytes written per simulated day: write-on-every-call (old saveToJson)
+// versus dirty-tracked, debounced, skip-if-unchanged saves. Also exercises the
+// temp-file recovery path and web edits landing on another task mid-save.
+// SPIFFS is the directory-backed host shim.
+//   g++ -std=c++17 -O2 -I../hostShim -I../../lib/configManager2 -I../../lib/globalConstants/src -I../../lib/textCodec -I../../lib/heapStats
+//       bench.cpp ../../lib/configManager2/configManager2.cpp ../../lib/configManager2/configSchema.cpp -o bench
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <configManager2.h>
+
+static const char* ROOT = "/tmp/bench_config_persist";
+static const char* PATH = "/config.json";
+
+// Old behaviour: serialise and rewrite the file on every call
+static void legacySave(configManager2& config) {
+    File f = SPIFFS.open(PATH, "w");
+    f.print(config.mapToJsonString(config.getConfig()));
+    f.close();
+}
+
+static void advance(configManager2& config, bool legacy, unsigned long ms) {
+    // Main loop runs every 10 ms; only the new path does anything in it
+    for (unsigned long end = hostClock::nowMs + ms; hostClock::nowMs < end; hostClock::nowMs += 10) {
+        if (!legacy) config.loop(hostClock::nowMs);
+    }
+}
+
+static void persist(configManager2& config, bool legacy) {
+    if (legacy) legacySave(config);
+    else config.scheduleSave();
+}
+
+// One day: 4 reboots, 5 pairing bursts of 20 workers, 4 web edit sessions of 3 submits
+static size_t simulateDay(bool legacy, configSaveStats& stats, unsigned& writes) {
+    remove((String(ROOT) + PATH).c_str());
+    SPIFFS.stats = hostFsStats();
+    hostClock::nowMs = 0;
+
+    configManager2 config;
+    config.begin(PATH, false);
+    if (legacy) legacySave(config); else config.save();
+    size_t baseline = SPIFFS.stats.bytesWritten;  // Writing the defaults once is the same for both
+
+    int worker = 0;
+    for (int hour = 0; hour < 24; ++hour) {
+        if (hour % 6 == 0) {
+            // Reboot: setup() re-applies Wi-Fi state (usually unchanged) and saves
+            config.begin(PATH, false);
+            config.setValue("wifiSTA", "channel", "6");
+            config.setValue("wifiSTA", "active", "true");
+            config.setValue("wifiAP", "active", "false");
+            if (legacy) legacySave(config); else config.save();
+            persist(config, legacy);  // webUI::begin() used to save unconditionally as well
+        }
+        if (hour % 5 == 1) {
+            // Pairing burst: beaconHandler::flushPeers() already batches, then saves
+            for (int i = 0; i < 20; ++i, ++worker) {
+                char mac[24];
+                snprintf(mac, sizeof(mac), "24:6F:28:00:%02X:%02X", worker >> 8, worker & 0xFF);
+                config.setValue("peers", mac, "6");
+                config.setValue("espnow", "remotemac", mac);
+                advance(config, legacy, 150);
+            }
+            if (legacy) legacySave(config); else config.save();
+        }
+        if (hour % 6 == 3) {
+            // Web edit session: three submits 10 s apart, five fields each, mostly unchanged
+            for (int submit = 0; submit < 3; ++submit) {
+                config.setValue("mqtt", "topic", submit == 2 ? String("site/") + String(hour) : "rudename");
+                config.setValue("mqtt", "port", "1883");
+                config.setValue("mqtt", "ip", "10.0.0.88");
+                config.setValue("wifiAP", "ssid", "espNowAP");
+                config.setValue("wifiAP", "channel", "1");
+                persist(config, legacy);
+                advance(config, legacy, 10000);
+            }
+        }
+        advance(config, legacy, 60000);  // Rest of the hour is quiet; one minute is enough to flush
+    }
+    stats = config.getSaveStats();
+    writes = SPIFFS.stats.filesOpenedForWrite - 1;
+    return SPIFFS.stats.bytesWritten - baseline;
+}
+
+static bool checkRecovery() {
+    configManager2 config;
+    config.begin(PATH, false);
+    config.setValue("mqtt", "topic", "recovered");
+    config.save();
+
+    // Crash between remove(config.json) and rename(config.json.tmp): only the temp file is left
+    String full = String(ROOT) + PATH;
+    rename(full.c_str(), (full + ".tmp").c_str());
+    configManager2 after;
+    after.begin(PATH, false);
+    bool recovered = after.getValue("mqtt", "topic") == "recovered" && !SPIFFS.exists(String(PATH) + ".tmp");
+
+    // Crash while writing the temp file: the stale temp is discarded, the real file wins
+    File junk = SPIFFS.open(String(PATH) + ".tmp", "w");
+    junk.print("{\"mqtt\": {\"topic\": \"torn");
+    junk.close();
+    configManager2 again;
+    again.begin(PATH, false);
+    return recovered && again.getValue("mqtt", "topic") == "recovered" && !SPIFFS.exists(String(PATH) + ".tmp");
+}
+
+// Form posts on another thread (async_tcp) while this one saves (loop task): every
+// file written must hold one whole submit, and handle reads must never tear
+static bool checkConcurrentEdits() {
+    configManager2 config;
+    config.begin(PATH, false);
+    configHandle topic = config.handle("mqtt", "topic");
+    config.applyUpdates({{"mqtt", {{"topic", "site/0"}, {"port", "10000"}}}});
+    std::atomic<bool> done(false);
+    std::thread web([&] {
+        for (int i = 1; i < 2000; ++i)
+            config.applyUpdates({{"mqtt", {{"topic", String("site/") + String(i)}, {"port", String(10000 + i)}}}});
+        done = true;
+    });
+
+    bool ok = true;
+    int saves = 0;
+    configManager2 reader;
+    while (!done || saves == 0) {
+        String read = config.getString(topic);
+        ok = ok && read.startsWith("site/");
+        ok = ok && config.save(true);
+        ++saves;
+
+        String json;
+        reader.loadConfigString(PATH, &json, false);
+        auto saved = reader.jsonStringToMap(json);
+        const String& t = saved["mqtt"]["topic"];
+        long port = saved["mqtt"]["port"].toInt();
+        ok = ok && t.startsWith("site/") && t.substring(5).toInt() == port - 10000;
+    }
+    web.join();
+    return ok;
+}
+
+int main() {
+    Serial.quiet = true;
+    hostClock::manual = true;
+    SPIFFS.setRoot(ROOT);
+    SPIFFS.begin(true);
+
+    configSaveStats legacyStats, newStats;
+    unsigned legacyWrites, newWrites;
+    size_t legacyBytes = simulateDay(true, legacyStats, legacyWrites);
+    size_t newBytes = simulateDay(false, newStats, newWrites);
+
+    printf("Simulated day: 4 reboots, 100 pairings in 5 bursts, 4 web sessions x 3 submits\n");
+    printf("write-every-call : %7zu bytes/day (%u file writes)\n", legacyBytes, legacyWrites);
+    printf("dirty + debounced: %7zu bytes/day (%u file writes, %u skipped as unchanged)\n",
+           newBytes, newWrites, newStats.skipped);
+    printf("Interrupted-save recovery: %s\n", checkRecovery() ? "ok" : "FAILED");
+    printf("Edits from another task during saves: %s\n", checkConcurrentEdits() ? "ok" : "FAILED");
+    return 0;
+}
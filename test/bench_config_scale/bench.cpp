@@ -0,0 +1,123 @@
+// configManager2 over large generated configs: begin() from JSON and from the
+// snapshot, a forced save(), and key lookups through getValue() versus handles.
+// Sections of 16 keys are added until the JSON reaches each target size.
+// SPIFFS is the directory-backed host shim, so times are host CPU only.
+//   g++ -std=c++17 -O2 -I../hostShim -I../../lib/configManager2 -I../../lib/globalConstants/src -I../../lib/textCodec -I../../lib/heapStats
+//       bench.cpp ../../lib/configManager2/configManager2.cpp ../../lib/configManager2/configSchema.cpp -o bench
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <configManager2.h>
+
+using clk = std::chrono::steady_clock;
+
+static const char* ROOT = "/tmp/bench_config_scale";
+static const char* PATH = "/config.json";
+static const int KEYS_PER_SECTION = 16;
+
+static int generate(size_t targetBytes) {
+    std::string json = "{\n";
+    int sections = 0;
+    for (; json.size() < targetBytes; ++sections) {
+        json += std::string(sections ? ",\n" : "") + "  \"section" + std::to_string(sections) + "\": {\n";
+        for (int k = 0; k < KEYS_PER_SECTION; ++k) {
+            json += "    \"key" + std::to_string(k) + "\": \"value-" + std::to_string(sections * KEYS_PER_SECTION + k) + "\"";
+            json += k + 1 < KEYS_PER_SECTION ? ",\n" : "\n";
+        }
+        json += "  }";
+    }
+    json += "\n}\n";
+    File f = SPIFFS.open(PATH, "w");
+    f.write(reinterpret_cast<const uint8_t*>(json.data()), json.size());
+    f.close();
+    SPIFFS.remove("/config.snap");
+    return sections;
+}
+
+template <typename Fn>
+static double average(int runs, Fn fn) {
+    auto t0 = clk::now();
+    for (int i = 0; i < runs; ++i) fn(i);
+    return std::chrono::duration<double, std::micro>(clk::now() - t0).count() / runs;
+}
+
+static volatile size_t sink;
+
+static bool run(const char* label, size_t targetBytes) {
+    int sections = generate(targetBytes);
+    int keys = sections * KEYS_PER_SECTION;
+    const int runs = targetBytes > 64 * 1024 ? 20 : 100;
+
+    double parseUs = average(runs, [](int) {
+        configManager2 config;
+        config.setSnapshotEnabled(false);
+        config.begin(PATH, false);
+        sink += config.getConfig().size();
+    });
+
+    {
+        configManager2 seed; // First boot builds the snapshot from loop()
+        seed.begin(PATH, false);
+        seed.loop(0);
+    }
+    bool fromSnapshot = false;
+    double snapUs = average(runs, [&](int) {
+        configManager2 config;
+        config.begin(PATH, false);
+        fromSnapshot = config.loadedFromSnapshot();
+        sink += config.getConfig().size();
+    });
+
+    configManager2 config;
+    config.setSnapshotEnabled(false);
+    config.begin(PATH, false);
+    size_t bytesBefore = SPIFFS.stats.bytesWritten;
+    double saveUs = average(runs, [&](int i) {
+        config.setValue("section0", "key0", String("changed-") + String(i));
+        config.save();
+    });
+    size_t bytesPerSave = (SPIFFS.stats.bytesWritten - bytesBefore) / runs;
+
+    // Lookups spread across the whole store, in a fixed pseudo-random order
+    const int lookups = 200000;
+    std::vector<std::pair<String, String>> names;
+    std::vector<configHandle> handles;
+    for (int i = 0; i < 1024; ++i) {
+        uint32_t n = (i * 2654435761u) % keys;
+        names.emplace_back(String("section") + String(n / KEYS_PER_SECTION), String("key") + String(n % KEYS_PER_SECTION));
+        handles.push_back(config.handle(names.back().first, names.back().second));
+    }
+    double getValueNs = 1000 * average(lookups, [&](int i) {
+        const auto& name = names[i & 1023];
+        sink += config.getValue(name.first, name.second).length();
+    });
+    double handleNs = 1000 * average(lookups, [&](int i) { sink += config.getString(handles[i & 1023]).length(); });
+
+    configManager2 reloaded;
+    reloaded.setSnapshotEnabled(false);
+    reloaded.begin(PATH, false);
+    bool same = reloaded.getConfig() == config.getConfig() && fromSnapshot;
+    for (size_t i = 0; i < handles.size(); ++i)
+        same = same && config.getString(handles[i]) == config.getValue(names[i].first, names[i].second);
+
+    printf("%-6s %7zu B %5d keys  %9.1f us  %8.1f us  %9.1f us %7zu B  %7.1f ns  %5.1f ns  %s\n",
+           label, targetBytes, keys, parseUs, snapUs, saveUs, bytesPerSave, getValueNs, handleNs,
+           same ? "ok" : "MISMATCH");
+    return same;
+}
+
+int main() {
+    Serial.quiet = true;
+    SPIFFS.setRoot(ROOT);
+    SPIFFS.begin(true);
+
+    printf("%-6s %9s %10s  %12s  %11s  %12s %9s  %10s  %8s\n", "", "target", "", "begin(json)",
+           "begin(snap)", "save()", "written", "getValue", "handle");
+    bool ok = true;
+    ok = run("4KB", 4 * 1024) && ok;
+    ok = run("16KB", 16 * 1024) && ok;
+    ok = run("64KB", 64 * 1024) && ok;
+    ok = run("256KB", 256 * 1024) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+// Field type resolution for form rendering: parsing the *.format text per field
+// (what htmlRenderer did) versus the compiled configSchema. Also checks that
+// setValue() validates and canonicalises typed fields.
+//   g++ -std=c++17 -O2 -I../hostShim -I../../lib/configManager2 -I../../lib/globalConstants/src -I../../lib/textCodec -I../../lib/heapStats
+//       bench.cpp ../../lib/configManager2/configManager2.cpp ../../lib/configManager2/configSchema.cpp -o bench
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <configManager2.h>
+
+using clk = std::chrono::steady_clock;
+
+static String readFile(const char* path) {
+    std::string all;
+    FILE* f = fopen(path, "rb");
+    if (!f) return String();
+    char chunk[512];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) all.append(chunk, n);
+    fclose(f);
+    return String(all);
+}
+
+template <typename F>
+static void measure(const char* label, int rounds, F&& op) {
+    auto t0 = clk::now();
+    for (int i = 0; i < rounds; ++i) op();
+    double us = std::chrono::duration<double, std::micro>(clk::now() - t0).count() / rounds;
+    printf("%-36s %8.2f us/form\n", label, us);
+}
+
+int main() {
+    Serial.quiet = true;
+    configManager2 config;
+    config.jsonStringToConfig(readFile("../../data/config.json"));
+    const configStore& store = config.getConfig();
+
+    // Every data field the config form renders
+    size_t fields = 0;
+    for (const auto& section : store) {
+        if (section.first.endsWith(".format")) continue;
+        for (const auto& kv : section.second) fields += !kv.first.startsWith("format.");
+    }
+    printf("data/config.json: %zu rendered fields\n", fields);
+
+    volatile int sink = 0;
+    measure("format text: lookup + parseType", 20000, [&] {
+        for (const auto& section : store) {
+            if (section.first.endsWith(".format")) continue;
+            auto use = section.second.find("format.use");
+            static const std::map<String, String> none;
+            const auto& formatMap = (use != section.second.end() && store.count(use->second)) ? store.at(use->second) : none;
+            for (const auto& kv : section.second) {
+                if (kv.first.startsWith("format.")) continue;
+                configFieldSpec spec = configSchema::parseType(formatMap.count(kv.first) ? formatMap.at(kv.first) : "string");
+                if (formatMap.count(kv.first + ".tooltip")) spec.tooltip = formatMap.at(kv.first + ".tooltip");
+                sink += int(spec.type) + spec.readOnly;
+            }
+        }
+    });
+    const configSchema& schema = config.getSchema();
+    measure("compiled schema: field()", 20000, [&] {
+        for (const auto& section : store) {
+            if (section.first.endsWith(".format")) continue;
+            for (const auto& kv : section.second) {
+                if (kv.first.startsWith("format.")) continue;
+                const configFieldSpec* spec = schema.field(section.first, kv.first);
+                sink += spec ? int(spec->type) + spec->readOnly : 0;
+            }
+        }
+    });
+    measure("compile() after a format change", 20000, [&] { configSchema s; s.compile(store); });
+
+    // Validation and canonical storage
+    struct check { const char* section; const char* key; const char* value; bool ok; const char* stored; };
+    const check checks[] = {
+        {"espnow", "channel", "11", true, "11"},
+        {"espnow", "channel", "eleven", false, nullptr},
+        {"espnow", "devicemac", "24-6f-28-aa-bb-cc", true, "24:6F:28:AA:BB:CC"},
+        {"espnow", "remotemac", "24:6F:28:AA:BB", false, nullptr},
+        {"espnow", "broadcast", "on", true, "true"},
+        {"espnow", "broadcast", "maybe", false, nullptr},
+        {"mqtt", "serverIP", "10.0.0.256", false, nullptr},
+        {"mqtt", "serverIP", "10.0.0.88", true, "10.0.0.88"},
+        {"wifiSTA", "password", "anything goes", true, "anything goes"},
+        {"updates", "topic", "no format, no checks", true, "no format, no checks"},
+    };
+    bool allOk = true;
+    for (const auto& c : checks) {
+        bool ok = config.setValue(c.section, c.key, c.value) == c.ok &&
+                  (!c.stored || config.getValue(c.section, c.key) == c.stored);
+        allOk &= ok;
+        if (!ok) printf("FAILED: [%s][%s] = '%s'\n", c.section, c.key, c.value);
+    }
+
+    // Form posts skip read-only fields and report rejects
+    std::map<String, String> rejected;
+    size_t applied = config.applyUpdates({{"wifiSTA", {{"channel", "9"}, {"ssid", "lab"}}},
+                                          {"espnow", {{"channel", "x"}}}}, &rejected);
+    bool form = applied == 1 && config.getValue("wifiSTA", "channel") == "1" &&
+                rejected.size() == 1 && rejected.count("espnow.channel");
+
+    const configFieldSpec* pw = schema.field("wifiAP", "password");
+    bool legacySpelling = pw && pw->type == configFieldType::password;
+
+    printf("\nsetValue validation:            %s\n", allOk ? "ok" : "FAILED");
+    printf("form skips read-only, reports:  %s\n", form ? "ok" : "FAILED");
+    printf("\"password.format\" spelling:     %s\n", legacySpelling ? "ok" : "FAILED");
+    return allOk && form && legacySpelling ? 0 : 1;
+}
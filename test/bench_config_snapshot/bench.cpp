@@ -0,0 +1,149 @@
+// Boot-to-ready for configManager2::begin(): parsing config.json versus loading
+// the binary snapshot built from it. Also checks that stale and torn snapshots
+// fall back to the JSON. SPIFFS is the directory-backed host shim.
+//   g++ -std=c++17 -O2 -I../hostShim -I../../lib/configManager2 -I../../lib/globalConstants/src -I../../lib/textCodec -I../../lib/heapStats
+//       bench.cpp ../../lib/configManager2/configManager2.cpp ../../lib/configManager2/configSchema.cpp -o bench
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <utime.h>
+#include <configManager2.h>
+
+using clk = std::chrono::steady_clock;
+
+static const char* ROOT = "/tmp/bench_config_snapshot";
+static const char* PATH = "/config.json";
+
+static void writeJson(const std::string& json) {
+    File f = SPIFFS.open(PATH, "w");
+    f.write(reinterpret_cast<const uint8_t*>(json.data()), json.size());
+    f.close();
+}
+
+// SPIFFS mtimes are whole seconds; move the file's on instead of sleeping past one
+static void touchLater(const char* path, int seconds) {
+    std::string full = std::string(ROOT) + path;
+    struct stat st;
+    stat(full.c_str(), &st);
+    utimbuf times = {st.st_atime, st.st_mtime + seconds};
+    utime(full.c_str(), &times);
+}
+
+static std::string syntheticConfig(size_t targetBytes) {
+    std::string json = "{\n";
+    for (int s = 0; json.size() < targetBytes; ++s) {
+        json += "  \"section" + std::to_string(s) + "\": {\n";
+        for (int k = 0; k < 8; ++k) {
+            json += "    \"key" + std::to_string(k) + "\": \"value-" + std::to_string(s * 8 + k) + "\",\n";
+        }
+        json += "    \"mac\": \"24:6F:28:AA:BB:CC\"\n  },\n";
+    }
+    json += "  \"security\": { \"encrypt\": \"true\", \"secret\": \"42273211\" }\n}\n";
+    return json;
+}
+
+static std::string readFile(const char* path) {
+    std::string all;
+    FILE* f = fopen(path, "rb");
+    if (!f) return all;
+    char chunk[512];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) all.append(chunk, n);
+    fclose(f);
+    return all;
+}
+
+// Average begin() time; the first begin() with snapshots on builds the snapshot via loop()
+static double bootMicros(bool snapshot, bool& fromSnapshot, configStore& loaded) {
+    {
+        configManager2 first;
+        first.setSnapshotEnabled(snapshot);
+        first.begin(PATH, false);
+        first.loop(0);
+    }
+    const int runs = 200;
+    auto t0 = clk::now();
+    for (int i = 0; i < runs; ++i) {
+        configManager2 config;
+        config.setSnapshotEnabled(snapshot);
+        config.begin(PATH, false);
+        if (i == runs - 1) {
+            fromSnapshot = config.loadedFromSnapshot();
+            loaded = config.getConfig();
+        }
+    }
+    return std::chrono::duration<double, std::micro>(clk::now() - t0).count() / runs;
+}
+
+static void compare(const char* label, const std::string& json) {
+    writeJson(json);
+    SPIFFS.remove("/config.snap");
+    bool viaJson, viaSnap;
+    configStore fromJson, fromSnap;
+    double jsonUs = bootMicros(false, viaJson, fromJson);
+    double snapUs = bootMicros(true, viaSnap, fromSnap);
+    printf("%-16s %6zu B json  %8.1f us parse  %8.1f us snapshot  %4.1fx  %s\n",
+           label, json.size(), jsonUs, snapUs, jsonUs / snapUs,
+           viaSnap && !viaJson && fromJson == fromSnap ? "same store" : "MISMATCH");
+}
+
+static bool checkFallbacks() {
+    writeJson(syntheticConfig(4096));
+    configManager2 seed;
+    seed.begin(PATH, false);
+    seed.loop(0);
+
+    // Hand edit of config.json behind our back, same size on purpose so only the mtime
+    // gives it away: snapshot is stale, JSON wins, snapshot is rebuilt
+    std::string edited = syntheticConfig(4096);
+    edited.replace(edited.find("42273211"), 8, "deadbeef");
+    writeJson(edited);
+    touchLater(PATH, 2);
+    configManager2 afterEdit;
+    afterEdit.begin(PATH, false);
+    bool stale = !afterEdit.loadedFromSnapshot() && afterEdit.getValue("security", "secret") == "deadbeef";
+    afterEdit.loop(0);
+    configManager2 rebuilt;
+    rebuilt.begin(PATH, false);
+    stale = stale && rebuilt.loadedFromSnapshot() && rebuilt.getValue("security", "secret") == "deadbeef";
+
+    // Torn snapshot write: payload CRC fails, JSON wins
+    std::string snap = readFile((std::string(ROOT) + "/config.snap").c_str());
+    File torn = SPIFFS.open("/config.snap", "w");
+    torn.write(reinterpret_cast<const uint8_t*>(snap.data()), snap.size() / 2);
+    torn.close();
+    configManager2 afterTear;
+    afterTear.begin(PATH, false);
+    bool tornOk = !afterTear.loadedFromSnapshot() && afterTear.getValue("security", "secret") == "deadbeef";
+
+    // Saves keep the JSON authoritative; the next boot parses once, then uses the snapshot again
+    afterTear.loop(0);
+    afterTear.setValue("mqtt", "topic", "changed");
+    afterTear.save();
+    configManager2 afterSave;
+    afterSave.begin(PATH, false);
+    bool saved = !afterSave.loadedFromSnapshot() && afterSave.getValue("mqtt", "topic") == "changed";
+    afterSave.loop(0);
+    configManager2 again;
+    again.begin(PATH, false);
+    saved = saved && again.loadedFromSnapshot() && again.getValue("mqtt", "topic") == "changed";
+
+    printf("stale snapshot after hand edit: %s\n", stale ? "ok" : "FAILED");
+    printf("torn snapshot:                  %s\n", tornOk ? "ok" : "FAILED");
+    printf("snapshot after save:            %s\n", saved ? "ok" : "FAILED");
+    return stale && tornOk && saved;
+}
+
+int main() {
+    Serial.quiet = true;
+    SPIFFS.setRoot(ROOT);
+    SPIFFS.begin(true);
+
+    printf("begin() to ready, averaged over 200 boots\n");
+    compare("data/config.json", readFile("../../data/config.json"));
+    compare("4KB synthetic", syntheticConfig(4 * 1024));
+    compare("16KB synthetic", syntheticConfig(16 * 1024));
+    compare("64KB synthetic", syntheticConfig(64 * 1024));
+    printf("\n");
+    return checkFallbacks() ? 0 : 1;
+}
@@ -0,0 +1,405 @@
+// Fleet config push: a boss and 100 workers on a simulated ESP-NOW channel.
+// Compares a one-key delta with a full-config transfer (every section, as a
+// worker the boss journal no longer covers would get), with and without frame
+// loss, and checks atomic apply, replay, tamper and failed-save handling.
+//
+// Airtime is modelled, not measured: 1 Mbit/s ESP-NOW action frames with a
+// fixed per-frame cost for preamble, 802.11 header, MAC ACK and backoff. Each
+// worker flash save is charged SAVE_COST_MS, the same assumption as bench_pairing.
+//   g++ -std=c++17 -O2 -I../hostShim -I../../lib/configManager2 -I../../lib/globalConstants/src -I../../lib/textCodec -I../../lib/heapStats
+//       -I../../lib/configSync -I../../lib/cryptoHelper bench.cpp ../../lib/configManager2/configManager2.cpp
+//       ../../lib/configManager2/configSchema.cpp ../../lib/configSync/configSync.cpp
+//       ../../lib/cryptoHelper/cryptoBackend.cpp -lmbedcrypto -o bench
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <configSync.hpp>
+
+constexpr size_t WORKERS = 100;
+constexpr unsigned long FRAME_OVERHEAD_US = 900;  // Preamble + header + vendor IE + ACK + DIFS/backoff
+constexpr unsigned long US_PER_BYTE = 8;          // 1 Mbit/s
+constexpr unsigned long SAVE_COST_MS = 60;        // SPIFFS rewrite of a ~3 KB config
+constexpr unsigned long LOOP_TICK_US = 1000;
+constexpr unsigned long SIM_LIMIT_US = 120UL * 1000 * 1000;
+
+static const char* ROOT = "/tmp/bench_config_sync";
+static const uint8_t SECRET[] = "42273211";
+
+struct node {
+    uint8_t mac[6];
+    configManager2 config;
+    configSync sync;
+    unsigned long busyUntilUs = 0;  // Still saving the last delta
+    uint32_t savesSeen = 0;
+};
+
+struct airFrame {
+    unsigned long atUs;  // Handed to the radio, or once onAir, received
+    uint64_t order;
+    bool onAir;
+    uint8_t from[6];
+    uint8_t to[6];
+    std::string bytes;
+    bool operator>(const airFrame& o) const {
+        return atUs != o.atUs ? atUs > o.atUs : order > o.order;
+    }
+};
+
+// One shared channel: frames go out back to back in the order they are handed over
+static struct {
+    std::priority_queue<airFrame, std::vector<airFrame>, std::greater<airFrame>> events;
+    unsigned long nowUs = 0;
+    unsigned long freeAtUs = 0;
+    uint64_t order = 0;
+    double loss = 0;
+    std::mt19937 rng{7};
+    std::vector<node*> nodes;
+    std::string lastDeltaFrame;  // For the replay check
+    uint8_t lastDeltaTo[6];
+} sim;
+
+static bool radioSend(const uint8_t* mac, const uint8_t* data, size_t len, void* context) {
+    node* sender = static_cast<node*>(context);
+
+    // A worker acks only after its flash save, which takes SAVE_COST_MS
+    uint32_t saves = sender->config.getSaveStats().saves;
+    if (saves != sender->savesSeen) {
+        sender->savesSeen = saves;
+        sender->busyUntilUs = sim.nowUs + SAVE_COST_MS * 1000;
+    }
+    if (data[1] == static_cast<uint8_t>(configSyncType::Delta)) {
+        sim.lastDeltaFrame.assign(reinterpret_cast<const char*>(data), len);
+        memcpy(sim.lastDeltaTo, mac, 6);
+    }
+
+    unsigned long ready = sim.nowUs > sender->busyUntilUs ? sim.nowUs : sender->busyUntilUs;
+    airFrame frame{ready, sim.order++, false, {}, {}, std::string(reinterpret_cast<const char*>(data), len)};
+    memcpy(frame.from, sender->mac, 6);
+    memcpy(frame.to, mac, 6);
+    sim.events.push(frame);
+    return true;
+}
+
+// Handoffs are processed in time order, so the channel is claimed in the order frames are ready
+static void transmit(airFrame frame) {
+    unsigned long start = frame.atUs > sim.freeAtUs ? frame.atUs : sim.freeAtUs;
+    sim.freeAtUs = start + FRAME_OVERHEAD_US + frame.bytes.size() * US_PER_BYTE;
+    if (std::uniform_real_distribution<double>(0, 1)(sim.rng) < sim.loss) return;  // Lost on air
+    frame.atUs = sim.freeAtUs;
+    frame.onAir = true;
+    sim.events.push(frame);
+}
+
+static node* findNode(const uint8_t* mac) {
+    for (node* n : sim.nodes) if (memcmp(n->mac, mac, 6) == 0) return n;
+    return nullptr;
+}
+
+static void deliver(const airFrame& frame) {
+    node* to = findNode(frame.to);
+    if (!to) return;
+    to->sync.onFrame(frame.from, reinterpret_cast<const uint8_t*>(frame.bytes.data()), frame.bytes.size());
+
+    // Workers handle it straight away; the boss on its next loop tick
+    if (to == sim.nodes[0]) return;
+    hostClock::nowMs = sim.nowUs / 1000;
+    to->sync.loop(hostClock::nowMs);
+}
+
+static void writeFile(const std::string& path, const std::string& text) {
+    FILE* f = fopen((std::string(ROOT) + path).c_str(), "wb");
+    fwrite(text.data(), 1, text.size(), f);
+    fclose(f);
+}
+
+static std::string readFile(const char* path) {
+    std::string all;
+    FILE* f = fopen(path, "rb");
+    if (!f) return all;
+    char chunk[512];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) all.append(chunk, n);
+    fclose(f);
+    return all;
+}
+
+static void macFor(size_t i, uint8_t* mac) {
+    const uint8_t base[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x00};
+    memcpy(mac, base, 6);
+    mac[4] = i >> 8;
+    mac[5] = i & 0xFF;
+}
+
+struct fleet {
+    std::vector<std::unique_ptr<node>> nodes;
+    node& boss() { return *nodes[0]; }
+};
+
+// Boss plus WORKERS workers, all starting from the same config.json at the same version
+static void buildFleet(fleet& f, const std::string& json, const std::set<String>* trackAll) {
+    sim.nodes.clear();
+    sim.events = decltype(sim.events)();
+    sim.nowUs = sim.freeAtUs = 0;
+    hostClock::nowMs = 0;
+
+    uint8_t key[SESSION_KEY_LEN];
+    deriveConfigKey(SECRET, sizeof(SECRET) - 1, key);
+
+    f.nodes.clear();
+    for (size_t i = 0; i <= WORKERS; ++i) {
+        f.nodes.emplace_back(new node);
+        node& n = *f.nodes.back();
+        macFor(i, n.mac);
+        char path[24];
+        snprintf(path, sizeof(path), "/n%03u.json", (unsigned)i);
+        writeFile(path, json);
+        n.config.setSnapshotEnabled(false);
+        n.config.begin(path, false);
+        sim.nodes.push_back(&n);
+    }
+
+    node& boss = f.boss();
+    boss.sync.begin(&boss.config, boss.mac, true, radioSend, &boss);
+    if (trackAll) boss.config.trackVersions(*trackAll);
+    boss.sync.setKey(key);
+    for (size_t i = 1; i <= WORKERS; ++i) {
+        node& w = *f.nodes[i];
+        w.sync.begin(&w.config, w.mac, false, radioSend, &w);
+        w.sync.setKey(key);
+        char mac[18];
+        snprintf(mac, sizeof(mac), "%02X:%02X:%02X:%02X:%02X:%02X",
+                 w.mac[0], w.mac[1], w.mac[2], w.mac[3], w.mac[4], w.mac[5]);
+        boss.config.setValue("peers", mac, "6");  // As beaconHandler::flushPeers() does
+    }
+}
+
+// Runs the channel until every worker is confirmed at the boss version; returns elapsed µs
+static unsigned long runUntilSynced(fleet& f, unsigned long limitUs = SIM_LIMIT_US) {
+    node& boss = f.boss();
+    unsigned long started = sim.nowUs;
+    unsigned long nextTick = sim.nowUs;
+    while (sim.nowUs - started < limitUs) {
+        if (!sim.events.empty() && sim.events.top().atUs <= nextTick) {
+            airFrame frame = sim.events.top();
+            sim.events.pop();
+            sim.nowUs = frame.atUs;
+            if (frame.onAir) deliver(frame);
+            else transmit(frame);
+            continue;
+        }
+        sim.nowUs = nextTick;
+        hostClock::nowMs = sim.nowUs / 1000;
+        boss.sync.loop(hostClock::nowMs);
+        nextTick += LOOP_TICK_US;
+        if (boss.sync.syncedCount() == WORKERS && sim.events.empty()) break;
+    }
+    return sim.nowUs - started;
+}
+
+struct result {
+    unsigned long us;
+    uint32_t frames;
+    uint32_t bytes;
+    uint32_t fullSyncs;
+    uint32_t retries;
+    bool converged;
+};
+
+static result measure(fleet& f, void (*change)(configManager2&), const char* section, const char* key) {
+    node& boss = f.boss();
+    uint32_t frames = 0, bytes = 0;
+    for (auto& n : f.nodes) {
+        frames += n->sync.getStats().framesSent;
+        bytes += n->sync.getStats().bytesSent;
+    }
+    configSyncStats before = boss.sync.getStats();
+
+    change(boss.config);
+    unsigned long us = runUntilSynced(f);
+
+    result r{us, 0, 0, 0, 0, true};
+    for (auto& n : f.nodes) {
+        r.frames += n->sync.getStats().framesSent;
+        r.bytes += n->sync.getStats().bytesSent;
+    }
+    r.frames -= frames;
+    r.bytes -= bytes;
+    r.fullSyncs = boss.sync.getStats().fullSyncs - before.fullSyncs;
+    r.retries = boss.sync.getStats().retries - before.retries;
+    String want = boss.config.getValue(section, key);
+    for (size_t i = 1; i <= WORKERS; ++i) {
+        node& w = *f.nodes[i];
+        r.converged = r.converged && w.config.getVersion() == boss.config.getVersion() &&
+                      w.config.getValue(section, key) == want;
+    }
+    return r;
+}
+
+static void print(const char* label, const result& r) {
+    printf("%-34s %8.1f ms %6u frames %8u bytes %4u full %4u retries  %s\n", label, r.us / 1000.0,
+           (unsigned)r.frames, (unsigned)r.bytes, (unsigned)r.fullSyncs, (unsigned)r.retries,
+           r.converged ? "ok" : "NOT CONVERGED");
+}
+
+static void changeTopic(configManager2& c) { c.setValue("mqtt", "topic", "fleet/moved"); }
+
+// The boss rebooted since the change, so the journal cannot tell what a v0 worker lacks
+static void changeTopicAndReboot(configManager2& c) {
+    c.setValue("mqtt", "topic", "fleet/moved");
+    c.save();
+    c.begin("/n000.json", false);
+}
+
+static bool checks(const std::string& json) {
+    fleet f;
+    buildFleet(f, json, nullptr);
+    runUntilSynced(f);
+    node& boss = f.boss();
+    node& w = *f.nodes[1];
+
+    // A delta with one invalid value leaves the worker untouched
+    configDelta bad;
+    bad.fromVersion = w.config.getVersion();
+    bad.toVersion = bad.fromVersion + 1;
+    bad.changes.push_back({"mqtt", "topic", "half/applied"});
+    bad.changes.push_back({"mqtt.format", "serverIP", "ipaddress"});
+    bad.changes.push_back({"mqtt", "serverIP", "999.1.1.1"});
+    String topic = w.config.getValue("mqtt", "topic");
+    std::map<String, String> rejected;
+    bool atomic = !w.config.applyDelta(bad, &rejected) && rejected.count("mqtt.serverIP") &&
+                  w.config.getValue("mqtt", "topic") == topic && w.config.getVersion() == bad.fromVersion &&
+                  w.config.getValue("mqtt.format", "serverIP") == "ipaddress";
+
+    // Out of sequence
+    configDelta skip = bad;
+    skip.fromVersion = bad.fromVersion + 5;
+    skip.changes.resize(1);
+    bool ordered = !w.config.applyDelta(skip) && w.config.getValue("mqtt", "topic") == topic;
+
+    // Replaying the last delta frame after the worker moved on changes nothing
+    boss.config.setValue("mqtt", "topic", "first");
+    runUntilSynced(f);
+    std::string replay = sim.lastDeltaFrame;
+    node* target = findNode(sim.lastDeltaTo);
+    boss.config.setValue("mqtt", "topic", "second");
+    runUntilSynced(f);
+    uint32_t applied = target->sync.getStats().applied;
+    target->sync.onFrame(boss.mac, reinterpret_cast<const uint8_t*>(replay.data()), replay.size());
+    target->sync.loop(hostClock::nowMs);
+    bool replayed = target->config.getValue("mqtt", "topic") == "second" &&
+                    target->sync.getStats().applied == applied;
+
+    // A flipped payload byte fails the tag
+    replay[sizeof(configSyncHeader)] ^= 1;
+    uint32_t rejects = target->sync.getStats().rejected;
+    target->sync.onFrame(boss.mac, reinterpret_cast<const uint8_t*>(replay.data()), replay.size());
+    target->sync.loop(hostClock::nowMs);
+    bool tampered = target->sync.getStats().rejected == rejects + 1;
+
+    // A worker whose save fails holds its ack, and acks once a retry lands. A
+    // non-empty directory where the temp file goes makes writeAtomic() fail.
+    node& stuck = *f.nodes[2];
+    std::string blocker = std::string(ROOT) + "/n002.json.tmp";
+    mkdir(blocker.c_str(), 0755);
+    writeFile("/n002.json.tmp/keep", "x");
+    uint32_t stuckApplied = stuck.sync.getStats().applied;
+    boss.config.setValue("mqtt", "topic", "unsaved");
+    runUntilSynced(f, 2UL * 1000 * 1000);
+    bool held = stuck.config.getValue("mqtt", "topic") == "unsaved" && stuck.sync.getStats().saveFailures > 0 &&
+                stuck.sync.getStats().applied == stuckApplied &&
+                boss.sync.peerVersion(stuck.mac) != boss.config.getVersion() &&
+                boss.sync.syncedCount() == WORKERS - 1;
+    remove((blocker + "/keep").c_str());
+    rmdir(blocker.c_str());
+    runUntilSynced(f);
+    held = held && boss.sync.syncedCount() == WORKERS && stuck.sync.getStats().applied == stuckApplied + 1;
+
+    // Settings outside the pushed sections stay local
+    boss.config.setValue("wifiSTA", "ssid", "boss-only");
+    runUntilSynced(f);
+    bool scoped = w.config.getValue("wifiSTA", "ssid") != "boss-only" &&
+                  w.config.getVersion() == boss.config.getVersion();
+
+    printf("invalid value rolls delta back: %s\n", atomic ? "ok" : "FAILED");
+    printf("out-of-sequence delta refused:  %s\n", ordered ? "ok" : "FAILED");
+    printf("replayed frame ignored:         %s\n", replayed ? "ok" : "FAILED");
+    printf("tampered frame rejected:        %s\n", tampered ? "ok" : "FAILED");
+    printf("failed save holds the ack:      %s\n", held ? "ok" : "FAILED");
+    printf("untracked section not pushed:   %s\n", scoped ? "ok" : "FAILED");
+    return atomic && ordered && replayed && tampered && held && scoped;
+}
+
+int main() {
+    Serial.quiet = true;
+    hostClock::manual = true;
+    SPIFFS.setRoot(ROOT);
+    SPIFFS.begin(true);
+
+    std::string json = readFile("../../data/config.json");
+    if (json.empty()) {
+        printf("run from test/bench_config_sync (needs ../../data/config.json)\n");
+        return 1;
+    }
+
+    // Every section a full re-provisioning would carry; peers and fleet are per device
+    std::set<String> everything;
+    {
+        configManager2 probe;
+        probe.jsonStringToConfig(json.c_str());
+        for (const auto& section : probe.getConfig()) everything.insert(section.first);
+    }
+
+    printf("%u workers, modelled 1 Mbit/s channel, %lu ms per worker save\n\n", (unsigned)WORKERS, SAVE_COST_MS);
+
+    fleet f;
+    buildFleet(f, json, nullptr);
+    result probe = measure(f, [](configManager2&) {}, "mqtt", "topic");
+    print("boot: learn worker versions", probe);
+
+    for (double loss : {0.0, 0.10}) {
+        sim.loss = loss;
+        char label[64];
+
+        buildFleet(f, json, nullptr);
+        runUntilSynced(f);
+        snprintf(label, sizeof(label), "one-key delta, %.0f%% loss", loss * 100);
+        print(label, measure(f, changeTopic, "mqtt", "topic"));
+
+        buildFleet(f, json, &everything);
+        runUntilSynced(f);
+        snprintf(label, sizeof(label), "full-config transfer, %.0f%% loss", loss * 100);
+        print(label, measure(f, changeTopicAndReboot, "mqtt", "topic"));
+    }
+    sim.loss = 0;
+
+    // Host CPU per worker: encode on the boss, decode + apply on the worker
+    {
+        buildFleet(f, json, nullptr);
+        runUntilSynced(f);
+        node& boss = f.boss();
+        boss.config.setValue("mqtt", "topic", "cpu");
+        configDelta delta = boss.config.diffSince(0);
+        std::vector<uint8_t> wire;
+        const int rounds = 20000;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; ++i) {
+            delta = boss.config.diffSince(boss.config.getVersion() - 1);
+            configSync::encodeDelta(delta, wire);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        configDelta decoded;
+        for (int i = 0; i < rounds; ++i) configSync::decodeDelta(wire.data(), wire.size(), decoded);
+        auto t2 = std::chrono::steady_clock::now();
+        double encUs = std::chrono::duration<double, std::micro>(t1 - t0).count() / rounds;
+        double decUs = std::chrono::duration<double, std::micro>(t2 - t1).count() / rounds;
+        printf("\nhost CPU, one-key delta (%u payload bytes): diff+encode %.2f us, decode %.2f us\n\n",
+               (unsigned)wire.size(), encUs, decUs);
+    }
+
+    return checks(json) ? 0 : 1;
+}
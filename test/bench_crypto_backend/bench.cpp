@@ -0,0 +1,103 @@
+// Per-operation cost of each crypto backend on the host (mbedtls only; the
+// ESP32 peripherals are measured, and cross-checked against mbedtls, on target
+// by the esp32s3_crypto_bench env).
+//   g++ -std=c++17 -O2 -I../../lib/cryptoHelper bench.cpp ../../lib/cryptoHelper/cryptoBackend.cpp -lmbedcrypto -o bench
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cryptoBackend.hpp>
+#include <mbedtls/md.h>
+
+using clk = std::chrono::steady_clock;
+
+static const uint8_t SHA256_ABC[32] = {
+    0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+    0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad};
+
+// FIPS-197 appendix C.1
+static const uint8_t AES_KEY[16] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                                    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+static const uint8_t AES_PT[16] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                                   0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+static const uint8_t AES_CT[16] = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+                                   0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a};
+
+template <typename F>
+static double nsPerOp(int rounds, F&& op) {
+    auto t0 = clk::now();
+    for (int i = 0; i < rounds; ++i) op(i);
+    return std::chrono::duration<double, std::nano>(clk::now() - t0).count() / rounds;
+}
+
+static void run(cryptoBackend& b) {
+    uint8_t out[32];
+    cryptoSpan abc = {reinterpret_cast<const uint8_t*>("abc"), 3};
+    b.sha256(&abc, 1, out);
+    bool shaOk = memcmp(out, SHA256_ABC, 32) == 0;
+    aesKeySchedule ks;
+    b.aesExpandKey(AES_KEY, ks);
+    b.aesEncrypt(ks, AES_PT, out);
+    bool aesOk = memcmp(out, AES_CT, 16) == 0;
+
+    // HMAC construction and the OTA-style streamed digest against mbedtls' own one-shot calls
+    const char msg[] = "The quick brown fox jumps over the lazy dog, twice over for a second block";
+    const uint8_t* m = reinterpret_cast<const uint8_t*>(msg);
+    const mbedtls_md_info_t* md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    uint8_t ref[32];
+    cryptoSpan split[2] = {{m, 7}, {m + 7, sizeof(msg) - 8}};
+    mbedtls_md_hmac(md, AES_KEY, sizeof(AES_KEY), m, sizeof(msg) - 1, ref);
+    b.hmacSha256(AES_KEY, sizeof(AES_KEY), split, 2, out);
+    bool hmacOk = memcmp(out, ref, 32) == 0;
+    sha256Stream st;
+    for (size_t i = 0; i < sizeof(msg) - 1; i += 5) st.update(m + i, sizeof(msg) - 1 - i < 5 ? sizeof(msg) - 1 - i : 5);
+    st.finish(out);
+    cryptoSpan whole = {m, sizeof(msg) - 1};
+    b.sha256(&whole, 1, ref);
+    bool streamOk = memcmp(out, ref, 32) == 0;
+    printf("== %s (SHA-256 %s, AES-128 %s, HMAC vs mbedtls %s, stream %s)\n", b.name(),
+           shaOk ? "ok" : "MISMATCH", aesOk ? "ok" : "MISMATCH",
+           hmacOk ? "ok" : "MISMATCH", streamOk ? "ok" : "MISMATCH");
+
+    constexpr int ROUNDS = 200000;
+    const char secret[] = "mytoon42273211";
+    const uint8_t* key = reinterpret_cast<const uint8_t*>(secret);
+    unsigned sink = 0;
+
+    // Beacon-shaped message: mac[6] + sequenceId/channel[2] + nonce[8]
+    uint8_t beacons[32][16];
+    uint8_t tags[32][32];
+    hmacVerifyJob jobs[32];
+    for (int i = 0; i < 32; ++i) {
+        memset(beacons[i], i, sizeof(beacons[i]));
+        cryptoSpan parts[3] = {{beacons[i], 6}, {beacons[i] + 6, 2}, {beacons[i] + 8, 8}};
+        b.hmacSha256(key, sizeof(secret) - 1, parts, 3, tags[i]);
+        jobs[i] = {{parts[0], parts[1], parts[2]}, 3, tags[i], false};
+    }
+
+    uint8_t block[64] = {0};
+    cryptoSpan blockSpan = {block, sizeof(block)};
+    double shaNs = nsPerOp(ROUNDS, [&](int i) { block[0] = i; b.sha256(&blockSpan, 1, out); sink += out[0]; });
+    double aesNs = nsPerOp(ROUNDS, [&](int i) { block[0] = i; b.aesEncrypt(ks, block, out); sink += out[0]; });
+    double expandNs = nsPerOp(ROUNDS, [&](int i) { block[0] = i; b.aesExpandKey(block, ks); sink += ks.key[0]; });
+    double hmacNs = nsPerOp(ROUNDS, [&](int i) {
+        b.hmacSha256(key, sizeof(secret) - 1, jobs[i & 31].parts, 3, out);
+        sink += memcmp(out, tags[i & 31], 32) == 0;
+    });
+    double batchNs = nsPerOp(ROUNDS / 32, [&](int) {
+        sink += b.verifyHmacBatch(key, sizeof(secret) - 1, jobs, 32);
+    }) / 32;
+    size_t valid = b.verifyHmacBatch(key, sizeof(secret) - 1, jobs, 32);
+
+    printf("sha256 64 B          %8.1f ns\n", shaNs);
+    printf("aes128 block         %8.1f ns\n", aesNs);
+    printf("aes128 key setup     %8.1f ns\n", expandNs);
+    printf("hmac beacon (single) %8.1f ns\n", hmacNs);
+    printf("hmac beacon (batch)  %8.1f ns/tag, %zu/32 valid\n", batchNs, valid);
+    printf("(sink %u)\n", sink);
+}
+
+int main() {
+    run(softwareCrypto());
+    if (cryptoBackend* hw = hardwareCrypto()) run(*hw);
+    return 0;
+}
@@ -0,0 +1,301 @@
+// Flash writes out of the web callbacks. An upload arrives as TCP segments at a
+// fixed network rate; each segment is one spiffsUpload::write() call, as in
+// webUI::handleUploadChunk(), and its time is what the async_tcp task (and so
+// every other connection) waits for:
+//   before   no worker: every full SPIFFS_UPLOAD_BUFFER is written inside the call
+//   after    deferredWork worker: full blocks are written by the worker while the
+//            next ones fill, the last one and the rename too after finish(). When
+//            room() drops below a TCP window the acks are held, as webUI::paceUpload()
+//            does: the sender gets at most one more window in, then stalls until
+//            loop() sees room again. The stall is network time, not callback time.
+// Flash is the host shim charging hostFlash::pageWriteUs per 256-byte page:
+// 700 us, a typical SPI NOR page-program time. SPIFFS bookkeeping, garbage
+// collection and sector erases come on top on the device and are not modelled.
+// Host threads stand in for the tasks; nothing here ran on an ESP32.
+//   g++ -std=c++17 -O2 -pthread -I../hostShim -I../../lib/heapStats -I../../lib/deferredWork -I../../lib/webUI/src
+//       bench.cpp ../../lib/webUI/src/spiffsUpload.cpp ../../lib/heapStats/heapStats.cpp
+//       ../../lib/deferredWork/deferredWork.cpp -o bench
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <deferredWork.hpp>
+#include <spiffsUpload.h>
+
+using clk = std::chrono::steady_clock;
+
+static const size_t SEGMENTS[] = {1436, 1436, 536, 1436, 1072, 1436, 1460, 288};
+static const unsigned PAGE_WRITE_US = 700;
+
+static std::string payload(size_t bytes, unsigned seed) {
+    std::string data(bytes, '\0');
+    for (size_t i = 0; i < bytes; ++i) data[i] = char((i * 131 + seed * 7 + (i >> 9)) & 0xFF);
+    return data;
+}
+
+static std::string readBack(const char* path) {
+    File file = SPIFFS.open(path, "r");
+    return file ? file.readString().str() : std::string();
+}
+
+struct callbackTimes {
+    double p50Us, p99Us, maxUs, totalMs;
+    size_t calls, slow; // slow: over 5 ms
+    size_t stalls;      // Times the sender ran out of window
+    double stalledMs;
+};
+
+// As webUI: a held window lets at most one more TCP window in
+static const size_t WINDOW = 5744;
+static const size_t HOLD = WINDOW + 1460;
+
+// Segments paced at kbPerSecond; the time of each write() call recorded
+static callbackTimes upload(const char* name, const std::string& body, unsigned kbPerSecond) {
+    std::vector<double> us;
+    spiffsUpload session;
+    session.begin(name, body.size());
+    auto start = clk::now(), next = start;
+    size_t index = 0, stalls = 0;
+    bool held = false;
+    size_t sinceHeld = 0;
+    double stalledMs = 0;
+    for (unsigned s = 0; index < body.size(); ++s) {
+        size_t len = std::min(SEGMENTS[s % 8], body.size() - index);
+        if (held && sinceHeld + len > WINDOW && session.room() < HOLD) {
+            auto t0 = clk::now();
+            while (session.room() < HOLD) std::this_thread::sleep_for(std::chrono::milliseconds(1)); // loop()
+            stalledMs += std::chrono::duration<double, std::milli>(clk::now() - t0).count();
+            ++stalls;
+            next = std::max(next, clk::now());
+        }
+        next += std::chrono::microseconds(len * 1000000 / (kbPerSecond * 1024));
+        std::this_thread::sleep_until(next);
+        auto t0 = clk::now();
+        session.write(reinterpret_cast<const uint8_t*>(body.data()) + index, len);
+        if (index + len == body.size())
+            session.finish();
+        else if (session.room() < HOLD) {
+            sinceHeld = held ? sinceHeld + len : 0;
+            held = true;
+        } else
+            held = false;
+        us.push_back(std::chrono::duration<double, std::micro>(clk::now() - t0).count());
+        index += len;
+    }
+    while (session.pending()) std::this_thread::sleep_for(std::chrono::milliseconds(1)); // The response polls
+    double totalMs = std::chrono::duration<double, std::milli>(clk::now() - start).count();
+    if (session.status() != spiffsUpload::UPLOAD_OK || readBack(name) != body) printf("FAILED: %s content\n", name);
+    std::sort(us.begin(), us.end());
+    size_t slow = us.end() - std::upper_bound(us.begin(), us.end(), 5000.0);
+    return {us[us.size() / 2], us[us.size() * 99 / 100], us.back(), totalMs, us.size(), slow, stalls, stalledMs};
+}
+
+// A sink in RAM that can be told to fail, and to take its time
+struct memorySink {
+    std::string data;
+    size_t failAt = SIZE_MAX;
+    unsigned delayUs = 0;
+    std::atomic<unsigned> calls{0};
+    static bool write(void* self, const uint8_t* bytes, size_t len) {
+        memorySink* sink = static_cast<memorySink*>(self);
+        ++sink->calls;
+        if (sink->delayUs) std::this_thread::sleep_for(std::chrono::microseconds(sink->delayUs));
+        if (sink->data.size() + len > sink->failAt) return false;
+        sink->data.append(reinterpret_cast<const char*>(bytes), len);
+        return true;
+    }
+};
+
+static std::atomic<bool> gateOpen(false);
+static std::atomic<unsigned> gatedRuns(0);
+static void gatedJob(void*) {
+    while (!gateOpen) std::this_thread::yield();
+    ++gatedRuns;
+}
+static void slowJob(void*) { std::this_thread::sleep_for(std::chrono::milliseconds(5)); }
+
+static bool checks() {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("FAILED: %s\n", what);
+        ok = ok && cond;
+    };
+    hostFlash::pageWriteUs = 0;
+
+    // The queue is bounded: one job running, DEFERRED_WORK_SLOTS waiting, the next refused
+    deferredWorkStats before = deferredWorkGetStats();
+    expect(deferWork("gated", gatedJob, nullptr), "first job queued");
+    while (deferredWorkDepth()) std::this_thread::yield(); // The worker has it and is stuck
+    bool allQueued = true;
+    for (int i = 0; i < DEFERRED_WORK_SLOTS; ++i) allQueued = deferWork("gated", gatedJob, nullptr) && allQueued;
+    expect(allQueued && deferredWorkDepth() == DEFERRED_WORK_SLOTS, "queue fills to its slots");
+    expect(!deferWork("gated", gatedJob, nullptr), "full queue refuses");
+    gateOpen = true;
+    while (gatedRuns < DEFERRED_WORK_SLOTS + 1u) std::this_thread::yield();
+    expect(deferWork("slow", slowJob, nullptr), "queue usable again");
+    while (deferredWorkGetStats().completed < before.completed + DEFERRED_WORK_SLOTS + 2) std::this_thread::yield();
+    deferredWorkStats after = deferredWorkGetStats();
+    expect(after.refused == before.refused + 1 && after.peakDepth == DEFERRED_WORK_SLOTS &&
+               after.queued == before.queued + DEFERRED_WORK_SLOTS + 2,
+           "queue stats");
+    expect(after.longestUs >= 5000, "longest job timed");
+    char json[256];
+    expect(deferredWorkStatsToJson(json, sizeof(json)) && strstr(json, "\"running\":true") &&
+               strstr(json, "\"refused\":") && strstr(json, "\"writerWaits\":"),
+           "stats as JSON");
+    expect(deferredWorkStatsToJson(json, 40) == 0, "truncation reported");
+
+    // deferredWriter: same bytes whatever the chunking, the partial block written after finish()
+    std::string body = payload(50000, 3);
+    static std::atomic<unsigned> finished(0);
+    deferredJob countFinished = [](void*) { ++finished; };
+    auto settle = [&](unsigned count) {
+        while (finished < count) std::this_thread::yield();
+    };
+    for (size_t step : {1, 700, 4096, 50000}) {
+        memorySink sink;
+        sink.delayUs = 200;
+        deferredWriter writer("check", 4096, memorySink::write, &sink);
+        writer.begin();
+        bool wrote = true;
+        for (size_t at = 0; at < body.size(); at += step)
+            wrote = writer.write(reinterpret_cast<const uint8_t*>(body.data()) + at, std::min(step, body.size() - at)) &&
+                    wrote;
+        unsigned count = finished;
+        expect(wrote && writer.finish(countFinished), "writer finish");
+        settle(count + 1);
+        expect(sink.data == body, "writer content");
+        expect(sink.calls == body.size() / 4096 + 1, "whole blocks, then the rest");
+    }
+    {
+        // finish() leaves the queued blocks to the worker instead of waiting on them
+        memorySink sink;
+        sink.delayUs = 20000;
+        deferredWriter writer("check", 4096, memorySink::write, &sink);
+        writer.begin();
+        writer.write(reinterpret_cast<const uint8_t*>(body.data()), 3 * 4096 + 100);
+        unsigned count = finished;
+        writer.finish(countFinished);
+        expect(finished == count && sink.calls < 4, "finish() does not wait");
+        settle(count + 1);
+        expect(sink.data == body.substr(0, 3 * 4096 + 100) && writer.waits() == 0, "finish() content");
+    }
+    {
+        // A caller that keeps within room() never waits, however slow the sink
+        memorySink sink;
+        sink.delayUs = 2000;
+        deferredWriter writer("check", 4096, memorySink::write, &sink);
+        writer.begin();
+        deferredWorkStats waitsBefore = deferredWorkGetStats();
+        for (size_t at = 0; at < body.size();) {
+            size_t n = std::min({writer.room(), size_t(1436), body.size() - at});
+            if (!n) {
+                std::this_thread::yield(); // Holding the sender off
+                continue;
+            }
+            writer.write(reinterpret_cast<const uint8_t*>(body.data()) + at, n);
+            at += n;
+        }
+        unsigned count = finished;
+        writer.finish(countFinished);
+        settle(count + 1);
+        expect(sink.data == body && writer.waits() == 0 && deferredWorkGetStats().writerWaits == waitsBefore.writerWaits,
+               "no waits within room()");
+    }
+    {
+        // Writing past room() waits for the worker rather than lose data, and is counted
+        memorySink sink;
+        sink.delayUs = 2000;
+        deferredWriter writer("check", 4096, memorySink::write, &sink);
+        writer.begin();
+        deferredWorkStats waitsBefore = deferredWorkGetStats();
+        writer.write(reinterpret_cast<const uint8_t*>(body.data()), body.size());
+        deferredWorkStats waitsAfter = deferredWorkGetStats();
+        uint32_t waited = waitsAfter.writerWaits - waitsBefore.writerWaits;
+        expect(writer.waits() >= 5 && waited == writer.waits() &&
+                   waitsAfter.writerWaitUs - waitsBefore.writerWaitUs >= 5 * 1000,
+               "writer waits counted");
+        unsigned count = finished;
+        writer.finish(countFinished);
+        settle(count + 1);
+        expect(sink.data == body, "content after waits");
+    }
+    {
+        memorySink sink;
+        sink.failAt = 10000;
+        deferredWriter writer("check", 4096, memorySink::write, &sink);
+        writer.begin();
+        bool wrote = true;
+        for (size_t at = 0; at < body.size() && wrote; at += 1000)
+            wrote = writer.write(reinterpret_cast<const uint8_t*>(body.data()) + at, 1000);
+        unsigned count = finished;
+        writer.finish(countFinished);
+        settle(count + 1);
+        expect(writer.failed(), "sink error surfaces");
+    }
+    {
+        // end() drops what is still queued; it waits for the block being written only
+        memorySink sink;
+        sink.delayUs = 20000;
+        deferredWriter writer("check", 4096, memorySink::write, &sink);
+        writer.begin();
+        writer.write(reinterpret_cast<const uint8_t*>(body.data()), 3 * 4096);
+        writer.end();
+        unsigned calls = sink.calls;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        expect(calls < 3 && sink.calls == calls, "end() drops queued blocks");
+    }
+
+    // An upload dropped while a block is with the worker leaves no temporary file
+    hostFlash::pageWriteUs = PAGE_WRITE_US;
+    {
+        spiffsUpload dropped;
+        dropped.begin("dropped.bin", body.size());
+        dropped.write(reinterpret_cast<const uint8_t*>(body.data()), SPIFFS_UPLOAD_BUFFER + 10);
+    }
+    File root = SPIFFS.open("/");
+    bool leftover = false;
+    for (File f = root.openNextFile(); f; f = root.openNextFile()) leftover = leftover || strstr(f.name(), "~upload");
+    expect(!leftover && !SPIFFS.exists("/dropped.bin"), "dropped upload cleaned up");
+    hostFlash::pageWriteUs = 0;
+    return ok;
+}
+
+int main() {
+    Serial.quiet = true;
+    system("rm -rf /tmp/bench_deferred_work && mkdir -p /tmp/bench_deferred_work");
+    SPIFFS.setRoot("/tmp/bench_deferred_work");
+    SPIFFS.begin(true);
+    hostFlash::pageWriteUs = PAGE_WRITE_US;
+
+    std::string body = payload(256 * 1024, 1);
+    const unsigned rates[] = {150, 400};
+    callbackTimes before[2], after[2];
+    for (int r = 0; r < 2; ++r) before[r] = upload("/before.bin", body, rates[r]);
+    if (!deferredWorkBegin()) printf("FAILED: worker did not start\n");
+    for (int r = 0; r < 2; ++r) after[r] = upload("/after.bin", body, rates[r]);
+
+    printf("256 KB upload, flash %u us per page; time per write() call on the web task\n", PAGE_WRITE_US);
+    printf("%-10s %-8s %10s %10s %10s %12s %10s %7s %10s\n", "network", "", "p50", "p99", "max", "over 5 ms", "upload",
+           "stalls", "stalled");
+    for (int r = 0; r < 2; ++r) {
+        char label[16];
+        snprintf(label, sizeof(label), "%u KB/s", rates[r]);
+        for (const callbackTimes* t : {&before[r], &after[r]})
+            printf("%-10s %-8s %7.0f us %7.0f us %7.0f us %5zu of %3zu %7.0f ms %7zu %7.0f ms\n",
+                   t == &before[r] ? label : "", t == &before[r] ? "before" : "after", t->p50Us, t->p99Us, t->maxUs,
+                   t->slow, t->calls, t->totalMs, t->stalls, t->stalledMs);
+    }
+    deferredWorkStats stats = deferredWorkGetStats();
+    printf("worker: %u jobs run, longest %u us (%s), peak depth %u; writes past room() %u, %u us\n\n",
+           unsigned(stats.completed), unsigned(stats.longestUs), stats.longestName, unsigned(stats.peakDepth),
+           unsigned(stats.writerWaits), unsigned(stats.writerWaitUs));
+
+    bool ok = checks();
+    printf("deferred work checks: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,248 @@
+// /files/view and /download on SPIFFS files of growing size (a capture log with
+// markup characters in it), rooted at /tmp/bench_file_stream:
+//   view before   readString() into a String, then the page concatenated around it
+//   view now      renderFileContentPart() through htmlPartCursor into 1436-byte
+//                 buffers, as webUI::sendFileView() sends it
+//   download      webUI::sendFileDownload()'s filler, whole file and in Range pieces
+// "peak" is the most heap live at once above what was live before the request.
+// Host only; String is the std::string-backed shim. Nothing here ran on an ESP32.
+//   g++ -std=c++17 -O2 -I../hostShim -I../../lib/configManager2 -I../../lib/globalConstants/src -I../../lib/textCodec
+//       -I../../lib/heapStats -I../../lib/htmlRenderer/src bench.cpp ../../lib/configManager2/configManager2.cpp
+//       ../../lib/configManager2/configSchema.cpp ../../lib/htmlRenderer/src/htmlRenderer.cpp -o bench
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+#include <string>
+#include <configManager2.h>
+#include <htmlRenderer.h>
+
+static size_t live = 0, peak = 0;
+
+void* operator new(size_t n) {
+    void* p = malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    live += malloc_usable_size(p);
+    if (live > peak) peak = live;
+    return p;
+}
+void operator delete(void* p) noexcept {
+    if (p) live -= malloc_usable_size(p);
+    free(p);
+}
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+
+using clk = std::chrono::steady_clock;
+
+static const size_t CHUNK = 1436;
+
+// ---- Previous implementation --------------------------------------------------
+
+static String legacyFileView(const htmlRenderer& renderer, const String& filename) {
+    bool found = SPIFFS.exists(filename);
+    String content = "";
+    if (found) {
+        File file = SPIFFS.open(filename, "r");
+        content = file.readString();
+        file.close();
+    }
+    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>View File</title>") +
+                  renderer.getStyle() + "</head><body>";
+    html += "<h1>📂 Viewing: " + filename + "</h1>";
+    if (found) {
+        html += "<pre style='border:1px solid #ccc; padding:1em; background:#fdfdfd'>" + content + "</pre>";
+    } else {
+        html += "<p style='color:red;'>❌ File not found: <code>" + filename + "</code></p>";
+    }
+    html += "<br><a href='/files'>Back to Files</a> | <a href='/home'>Home</a></body></html>";
+    return html;
+}
+
+// ---- As webUI sends them ------------------------------------------------------
+
+// sendFileView(): the response buffers go to the socket; here they are hashed, or kept when asked
+static size_t streamView(const htmlRenderer& renderer, const String& path, String* keep = nullptr) {
+    File file = SPIFFS.exists(path) ? SPIFFS.open(path, "r") : File();
+    htmlPartRenderer render = [&renderer, path, file](htmlWriter& out, size_t part) mutable {
+        return renderer.renderFileContentPart(out, path, file, part);
+    };
+    htmlPartCursor cursor;
+    htmlHashWriter wire;
+    uint8_t buffer[CHUNK];
+    for (size_t n; (n = cursor.fill(buffer, sizeof(buffer), render)) > 0;) {
+        wire.write(reinterpret_cast<const char*>(buffer), n);
+        if (keep) keep->concat(reinterpret_cast<const char*>(buffer), n);
+    }
+    return wire.length();
+}
+
+// sendFileDownload(): status, then the body through the filler
+static int download(const String& path, const char* rangeHeader, std::string& body) {
+    File file = SPIFFS.open(path, "r");
+    size_t size = file.size();
+    size_t first = 0, last = size ? size - 1 : 0;
+    byteRangeResult range = rangeHeader ? parseByteRange(rangeHeader, strlen(rangeHeader), size, first, last)
+                                        : BYTE_RANGE_NONE;
+    if (range == BYTE_RANGE_UNSATISFIABLE) return 416;
+    size_t length = size ? last - first + 1 : 0;
+    auto filler = [file, first, length](uint8_t* buffer, size_t maxLen, size_t index) mutable -> size_t {
+        if (index >= length || (file.position() != first + index && !file.seek(first + index))) return 0;
+        return file.read(buffer, maxLen < length - index ? maxLen : length - index);
+    };
+    uint8_t buffer[CHUNK];
+    body.clear();
+    for (size_t n; body.size() < length && (n = filler(buffer, sizeof(buffer), body.size())) > 0;)
+        body.append(reinterpret_cast<const char*>(buffer), n);
+    return range == BYTE_RANGE_OK ? 206 : 200;
+}
+
+// ---- Fixture ------------------------------------------------------------------
+
+static std::string writeCapture(const char* name, size_t bytes) {
+    std::string text;
+    for (unsigned line = 0; text.size() < bytes; ++line) {
+        char row[96];
+        snprintf(row, sizeof(row), "%08u rx <mac=24:6F:28:%02X:1B:2C> rssi=-%u & seq=%u \"ok\"\n", line * 37,
+                 line & 0xFF, 40 + line % 50, line);
+        text += row;
+    }
+    text.resize(bytes);
+    File file = SPIFFS.open(String("/") + name, "w");
+    file.write(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    file.close();
+    return text;
+}
+
+static std::string escaped(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        switch (c) {
+        case '&': out += "&amp;"; break;
+        case '<': out += "&lt;"; break;
+        case '>': out += "&gt;"; break;
+        case '"': out += "&quot;"; break;
+        case '\'': out += "&#39;"; break;
+        default: out += c;
+        }
+    }
+    return out;
+}
+
+static bool checks(const htmlRenderer& renderer, const std::string& capture) {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("FAILED: %s\n", what);
+        ok = ok && cond;
+    };
+
+    // The old page, with the file escaped and a <file name> escaped in the heading
+    std::string legacy = legacyFileView(renderer, "/capture_64k.log").str();
+    size_t pre = legacy.find("<pre");
+    size_t body = legacy.find('>', pre) + 1;
+    std::string expected = legacy.substr(0, body) + escaped(capture) + legacy.substr(body + capture.size());
+    String streamed;
+    streamView(renderer, "/capture_64k.log", &streamed);
+    expect(streamed.str() == expected, "streamed view is the old page, escaped");
+    expect(renderer.generateFileContentPage("/capture_64k.log") == streamed, "generate*() collects the same bytes");
+    String missing;
+    streamView(renderer, "/<nosuch>", &missing);
+    expect(missing.indexOf("File not found: <code>/&lt;nosuch&gt;</code>") > 0 && missing.indexOf("<pre") < 0,
+           "missing file");
+    String empty;
+    streamView(renderer, "/empty.log", &empty);
+    expect(empty.indexOf("background:#fdfdfd'></pre>") > 0, "empty file");
+
+    // Range header parsing
+    struct { const char* header; size_t total; byteRangeResult result; size_t first, last; } ranges[] = {
+        {"bytes=0-99", 1000, BYTE_RANGE_OK, 0, 99},
+        {"bytes=900-", 1000, BYTE_RANGE_OK, 900, 999},
+        {"bytes=990-2000", 1000, BYTE_RANGE_OK, 990, 999},
+        {"bytes=-100", 1000, BYTE_RANGE_OK, 900, 999},
+        {"bytes=-5000", 1000, BYTE_RANGE_OK, 0, 999},
+        {"bytes=1000-", 1000, BYTE_RANGE_UNSATISFIABLE, 0, 0},
+        {"bytes=-0", 1000, BYTE_RANGE_UNSATISFIABLE, 0, 0},
+        {"bytes=0-", 0, BYTE_RANGE_UNSATISFIABLE, 0, 0},
+        {"bytes=5-2", 1000, BYTE_RANGE_NONE, 0, 0},
+        {"bytes=0-1,5-6", 1000, BYTE_RANGE_NONE, 0, 0},
+        {"bytes=-", 1000, BYTE_RANGE_NONE, 0, 0},
+        {"bytes=x-1", 1000, BYTE_RANGE_NONE, 0, 0},
+        {"items=0-1", 1000, BYTE_RANGE_NONE, 0, 0},
+        {"bytes=99999999999-", 1000, BYTE_RANGE_NONE, 0, 0},
+    };
+    for (const auto& r : ranges) {
+        size_t first = 0, last = 0;
+        byteRangeResult result = parseByteRange(r.header, strlen(r.header), r.total, first, last);
+        bool match = result == r.result && (result != BYTE_RANGE_OK || (first == r.first && last == r.last));
+        if (!match) printf("  %s -> %d %zu-%zu\n", r.header, result, first, last);
+        expect(match, "range parse");
+    }
+
+    // A download resumed in pieces reassembles the file
+    std::string piece, joined;
+    for (size_t at = 0; at < capture.size(); at += 20000) {
+        char header[48];
+        snprintf(header, sizeof(header), "bytes=%zu-%zu", at, at + 19999);
+        expect(download("/capture_64k.log", header, piece) == 206, "206");
+        joined += piece;
+    }
+    expect(joined == capture, "pieces reassemble the file");
+    expect(download("/capture_64k.log", "bytes=-100", piece) == 206 && piece == capture.substr(capture.size() - 100),
+           "suffix range");
+    expect(download("/capture_64k.log", nullptr, piece) == 200 && piece == capture, "whole file");
+    expect(download("/capture_64k.log", "bytes=0-1,5-6", piece) == 200 && piece == capture, "lists ignored");
+    expect(download("/capture_64k.log", "bytes=70000-", piece) == 416, "416");
+    return ok;
+}
+
+int main() {
+    Serial.quiet = true;
+    system("rm -rf /tmp/bench_file_stream && mkdir -p /tmp/bench_file_stream");
+    SPIFFS.setRoot("/tmp/bench_file_stream");
+    SPIFFS.begin(true);
+    configManager2 config;
+    htmlRenderer renderer(&config.getConfig());
+    std::string capture = writeCapture("capture_64k.log", 64 * 1024);
+    writeCapture("empty.log", 0);
+
+    printf("%-10s %22s %22s %22s\n", "file", "view before", "view now", "download");
+    for (size_t kb : {4, 64, 256, 1024}) {
+        char name[32];
+        snprintf(name, sizeof(name), "/capture_%zuk.log", kb);
+        writeCapture(name + 1, kb * 1024);
+        const int rounds = kb >= 256 ? 20 : 200;
+
+        size_t base = live;
+        peak = live;
+        auto t0 = clk::now();
+        for (int i = 0; i < rounds; ++i) legacyFileView(renderer, name);
+        double beforeUs = std::chrono::duration<double, std::micro>(clk::now() - t0).count() / rounds;
+        size_t beforePeak = peak - base;
+
+        peak = live;
+        t0 = clk::now();
+        for (int i = 0; i < rounds; ++i) streamView(renderer, name);
+        double nowUs = std::chrono::duration<double, std::micro>(clk::now() - t0).count() / rounds;
+        size_t nowPeak = peak - base;
+
+        // The body string is the client's side of the socket; only the filler's own heap counts
+        std::string body;
+        body.reserve(kb * 1024);
+        size_t reserved = live;
+        peak = live;
+        t0 = clk::now();
+        for (int i = 0; i < rounds; ++i) download(name, nullptr, body);
+        double downloadUs = std::chrono::duration<double, std::micro>(clk::now() - t0).count() / rounds;
+        size_t downloadPeak = peak - reserved;
+
+        char label[16];
+        snprintf(label, sizeof(label), "%zu KB", kb);
+        printf("%-10s %8.0f us %7zu B %8.0f us %7zu B %8.0f us %7zu B\n", label, beforeUs, beforePeak, nowUs,
+               nowPeak, downloadUs, downloadPeak);
+    }
+    printf("\n");
+
+    bool ok = checks(renderer, capture);
+    printf("file stream checks: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
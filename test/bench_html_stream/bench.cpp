@@ -0,0 +1,244 @@
+// Streamed page rendering versus whole-page Strings for the config form
+// (/configs) on data/config.json grown with extra sections. Three ways to
+// serve it:
+//   previous  /configs as it was: copy the config map, build the page with the
+//             String-returning renderer code that htmlRenderer used before
+//   String    generateConfigFormPage(): the streamed renderer collected into a String
+//   replayed  the whole page rendered again for every 1436-byte buffer, keeping
+//             only that buffer's window (no state between calls)
+//   by part   htmlPartCursor over renderConfigFormPart(), as webUI::sendParts()
+//             serves it: only the section a buffer starts in is rendered again
+// Peak is heapStats' html-tag peak above what was live before, time to first
+// byte is how long until the first buffer could go out. Host CPU only; nothing
+// here ran on an ESP32. The table is enlarged so the 79-section config fits.
+//   g++ -std=c++17 -O2 -DHEAP_STATS_SLOTS=8192 -I../hostShim -I../../lib/configManager2 -I../../lib/globalConstants/src -I../../lib/textCodec
+//       -I../../lib/heapStats -I../../lib/htmlRenderer/src bench.cpp ../../lib/heapStats/heapStats.cpp
+//       ../../lib/configManager2/configManager2.cpp ../../lib/configManager2/configSchema.cpp
+//       ../../lib/htmlRenderer/src/htmlRenderer.cpp -o bench
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <configManager2.h>
+#include <htmlRenderer.h>
+#include <heapStats.hpp>
+
+using clk = std::chrono::steady_clock;
+using configMap = std::map<String, std::map<String, String>>;
+
+static const size_t CHUNK = 1436; // One TCP segment, roughly what AsyncTCP offers per callback
+
+// ---- Previous implementation --------------------------------------------------
+
+static String legacyInputField(const String& fullKey, const String& value, const configFieldSpec& spec) {
+    String tooltip = "";
+    if (!spec.tooltip.isEmpty()) tooltip = " title='" + spec.tooltip + "'";
+    if (spec.type == configFieldType::checkbox) {
+        bool checked = (value == "true" || value == "1");
+        String html = "<input type='checkbox' name='" + fullKey + "'" + (checked ? " checked" : "");
+        if (spec.readOnly) html += " disabled";
+        html += tooltip + ">";
+        if (spec.readOnly) html += "<input type='hidden' name='" + fullKey + "' value='" + value + "'>";
+        return html;
+    }
+    String html = "<input type='";
+    html += spec.type == configFieldType::password ? "password" : "text";
+    html += "' name='" + fullKey + "' value='" + value + "'";
+    if (spec.readOnly) html += " readonly style='background:#f5f5f5; color:#555'";
+    html += tooltip + ">";
+    return html;
+}
+
+static String legacyConfigForm(const configMap& configMap, const configSchema& schema, const char* style) {
+    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Edit Config</title>") + style + "</head><body>";
+    html += "<h1>🛠 Edit Configuration</h1><form method='POST' action='/submit-section'>";
+    for (const auto& section : configMap) {
+        const String& sectionName = section.first;
+        if (sectionName.endsWith(".format")) continue;
+        String part;
+        part += "<tr><th>" + sectionName + "</th><td>";
+        for (const auto& kv : section.second) {
+            if (kv.first.startsWith("format.")) continue;
+            String fullKey = sectionName + "." + kv.first;
+            const configFieldSpec* found = schema.field(sectionName, kv.first);
+            configFieldSpec spec = found ? *found : configFieldSpec();
+            part += "<label style='margin-right:1.5em'>" + kv.first + ": ";
+            part += legacyInputField(fullKey, kv.second, spec);
+            part += "</label>";
+        }
+        part += "</td></tr>\n";
+        html += part;
+    }
+    html += "</table>\n";
+    html += "<input type='submit' value='Save Configuration'>\n";
+    html += "</form>\n";
+    html += "<div style='text-align:center; margin:1.5em 0;'>"
+        "<a href=\"/espnow-manual.html\" target=\"_blank\" "
+        "style=\"background:#003366; color:#fff; padding:0.6em 1.2em; border-radius:4px; "
+        "text-decoration:none; font-weight:bold;\">"
+        "📘 Open ESP-NOW Manual</a></div>";
+    return html;
+}
+
+// ---- Harness ------------------------------------------------------------------
+
+static std::string readFile(const char* path) {
+    std::string all;
+    FILE* f = fopen(path, "rb");
+    if (!f) return all;
+    char chunk[512];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) all.append(chunk, n);
+    fclose(f);
+    return all;
+}
+
+static String grownConfig(int extraSections) {
+    std::string json = readFile("../../data/config.json");
+    json.erase(json.find_last_of('}'));
+    for (int s = 0; s < extraSections; ++s) {
+        json += ",\n  \"node" + std::to_string(s) + "\": { \"format.use\": \"mqtt.format\", \"use\": \"true\", "
+                "\"user\": \"node-" + std::to_string(s) + "\", \"topic\": \"site/line/" + std::to_string(s) +
+                "/status\", \"serverIP\": \"10.0.0." + std::to_string(s % 250 + 1) +
+                "\", \"serverPort\": \"1883\", \"password\": \"secret" + std::to_string(s) + "\" }";
+    }
+    return String(json + "\n}\n");
+}
+
+struct result {
+    double firstByteUs = 0;
+    double totalUs = 0;
+    uint32_t peak = 0;
+    uint32_t allocations = 0;
+    size_t bytes = 0;
+    size_t rendered = 0; // Bytes the renderer produced, counting the re-rendered prefixes
+};
+
+template <typename Fn>
+static result measure(int runs, Fn serve) {
+    result r;
+    heapStatsResetPeaks();
+    uint32_t liveBefore = heapStatsGet(HEAP_TAG_HTML).currentBytes;
+    uint32_t allocsBefore = heapStatsGet(HEAP_TAG_HTML).allocations;
+    for (int i = 0; i < runs; ++i) serve(r);
+    r.peak = heapStatsGet(HEAP_TAG_HTML).peakBytes - liveBefore;
+    r.allocations = (heapStatsGet(HEAP_TAG_HTML).allocations - allocsBefore) / runs;
+    r.firstByteUs /= runs;
+    r.totalUs /= runs;
+    r.bytes /= runs;
+    r.rendered /= runs;
+    return r;
+}
+
+static double since(clk::time_point t0) {
+    return std::chrono::duration<double, std::micro>(clk::now() - t0).count();
+}
+
+static bool run(int extraSections) {
+    configManager2 config;
+    config.jsonStringToConfig(grownConfig(extraSections), false);
+    htmlRenderer renderer(&config.getConfig());
+    renderer.setSchema(&config.getSchema());
+    const int runs = 200;
+
+    result previous = measure(runs, [&](result& r) {
+        auto t0 = clk::now();
+        heapScope heap(HEAP_TAG_HTML);
+        const configMap copy = config.getConfig();
+        String page = legacyConfigForm(copy, config.getSchema(), renderer.getStyle());
+        double built = since(t0);
+        r.firstByteUs += built;
+        r.totalUs += built;
+        r.bytes += page.length();
+        r.rendered += page.length();
+    });
+
+    String reference = renderer.generateConfigFormPage(config.getConfig(), true);
+    result whole = measure(runs, [&](result& r) {
+        auto t0 = clk::now();
+        String page = renderer.generateConfigFormPage(config.getConfig(), true);
+        double built = since(t0);
+        r.firstByteUs += built;
+        r.totalUs += built;
+        r.bytes += page.length();
+        r.rendered += page.length();
+    });
+
+    bool same = true;
+    result replayed = measure(runs, [&](result& r) {
+        uint8_t buffer[CHUNK];
+        size_t index = 0;
+        auto t0 = clk::now();
+        for (;;) {
+            heapScope heap(HEAP_TAG_HTML);
+            htmlWindowWriter out(buffer, sizeof(buffer), index);
+            renderer.renderConfigFormPage(out, config.getConfig(), true);
+            if (index == 0) r.firstByteUs += since(t0);
+            r.rendered += index + out.length();
+            if (out.length() == 0) break;
+            same = same && memcmp(reference.c_str() + index, buffer, out.length()) == 0;
+            index += out.length();
+        }
+        r.totalUs += since(t0);
+        r.bytes += index;
+    });
+
+    size_t renderedBytes = 0;
+    htmlPartRenderer form = [&](htmlWriter& out, size_t part) {
+        // Count what the renderer produces, skipped prefix included
+        struct counting : htmlWriter {
+            htmlWriter& inner;
+            size_t& total;
+            counting(htmlWriter& w, size_t& t) : inner(w), total(t) {}
+            bool write(const char* data, size_t len) override {
+                total += len;
+                bool more = inner.write(data, len);
+                _full = inner.full();
+                return more;
+            }
+        } out2(out, renderedBytes);
+        return renderer.renderConfigFormPart(out2, config.getConfig(), true, part);
+    };
+    result byPart = measure(runs, [&](result& r) {
+        uint8_t buffer[CHUNK];
+        htmlPartCursor cursor;
+        size_t index = 0;
+        renderedBytes = 0;
+        auto t0 = clk::now();
+        for (;;) {
+            heapScope heap(HEAP_TAG_HTML);
+            size_t n = cursor.fill(buffer, sizeof(buffer), form);
+            if (index == 0) r.firstByteUs += since(t0);
+            if (n == 0) break;
+            same = same && memcmp(reference.c_str() + index, buffer, n) == 0;
+            index += n;
+        }
+        r.totalUs += since(t0);
+        r.bytes += index;
+        r.rendered += renderedBytes;
+    });
+    same = same && replayed.bytes == reference.length() && byPart.bytes == reference.length() &&
+           previous.bytes == reference.length();
+
+    auto row = [](const char* name, const result& r) {
+        printf("  %-9s %7u B peak %6u allocs   first byte %8.1f us   all %8.1f us   rendered %5.1fx\n",
+               name, (unsigned)r.peak, (unsigned)r.allocations, r.firstByteUs, r.totalUs,
+               double(r.rendered) / double(r.bytes));
+    };
+    printf("%d sections, %u B page%s\n", (int)config.getConfig().size(), reference.length(),
+           same ? "" : "  MISMATCH");
+    row("previous", previous);
+    row("String", whole);
+    row("replayed", replayed);
+    row("by part", byPart);
+    return same;
+}
+
+int main() {
+    Serial.quiet = true;
+    bool ok = true;
+    ok = run(0) && ok;
+    ok = run(16) && ok;
+    ok = run(64) && ok;
+    printf("\nstreamed output matches the String page byte for byte: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,213 @@
+// POST /update through otaSession into a sink that keeps the image in RAM (the
+// flash write is the same cost before and after, so it is left out). The body
+// arrives in TCP-segment-sized chunks, as AsyncWebServer hands it over:
+//   before   the old handler: every chunk straight to Update, nothing checked
+//   after    otaSession: every chunk hashed (SHA-256) then written; the image
+//            is only activated when the digest matches
+// The difference is mbedtls' SHA-256 in software on the host CPU. On target
+// ESP-IDF's mbedtls runs it on the SHA peripheral, so the device number has to
+// come from a real update. Nothing here ran on an ESP32.
+//   g++ -std=c++17 -O2 -pthread -I../hostShim -I../../lib/cryptoHelper -I../../lib/textCodec -I../../lib/deferredWork
+//       -I../../lib/webUI/src bench.cpp ../../lib/webUI/src/otaSession.cpp ../../lib/cryptoHelper/cryptoBackend.cpp
+//       ../../lib/deferredWork/deferredWork.cpp -lmbedcrypto -o bench
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <otaSession.h>
+
+using clk = std::chrono::steady_clock;
+
+// Segment sizes seen on a WiFi upload: full MSS mostly, with short ones mixed in
+static const size_t SEGMENTS[] = {1436, 1436, 536, 1436, 1072, 1436, 1460, 288};
+
+// Update as far as otaSession can tell: begin/write/end/abort, with the image kept
+struct memorySink : otaSink {
+    std::string image;
+    size_t limit = 0x1E0000;  // An OTA slot of the default 4 MB partition table
+    size_t failAt = SIZE_MAX; // write() comes up short once this many bytes are in
+    bool begun = false, activated = false, aborted = false;
+    const char* error = "";
+
+    bool begin(size_t maxSize) override {
+        image.clear();
+        begun = true;
+        activated = aborted = false;
+        error = maxSize > limit ? "Not Enough Space" : "";
+        return maxSize <= limit;
+    }
+    size_t write(const uint8_t* data, size_t len) override {
+        if (image.size() + len > failAt) {
+            error = "Flash Write Failed";
+            return 0;
+        }
+        image.append(reinterpret_cast<const char*>(data), len);
+        return len;
+    }
+    bool end() override { return activated = true; }
+    void abort() override { aborted = true; }
+    const char* errorText() override { return error; }
+};
+
+static std::string firmware(size_t bytes, unsigned seed) {
+    std::string data(bytes, '\0');
+    for (size_t i = 0; i < bytes; ++i) data[i] = char((i * 2654435761u + seed) >> 13);
+    return data;
+}
+
+static String hexDigest(const std::string& image) {
+    uint8_t digest[32];
+    cryptoSpan part = {reinterpret_cast<const uint8_t*>(image.data()), image.size()};
+    softwareCrypto().sha256(&part, 1, digest);
+    char hex[65];
+    for (int i = 0; i < 32; ++i) snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+    return String(hex);
+}
+
+template <typename Chunk>
+static void feed(const std::string& body, Chunk chunk) {
+    size_t index = 0;
+    for (unsigned s = 0; index < body.size(); ++s) {
+        size_t len = std::min(SEGMENTS[s % 8], body.size() - index);
+        chunk(reinterpret_cast<const uint8_t*>(body.data()) + index, len, index + len == body.size());
+        index += len;
+    }
+}
+
+// As webUI::handleOtaChunk(), minus logging and events; returns the events that would have been sent
+static size_t update(memorySink& sink, const std::string& image, const String& digest, bool& done) {
+    otaSession session(sink);
+    session.begin(digest, image.size() + 200); // Content-Length includes the multipart framing
+    size_t events = 1;
+    feed(image, [&](const uint8_t* data, size_t len, bool final) {
+        if (session.getState() != otaSession::OTA_WRITING) return;
+        if (session.write(data, len) && final) session.finish();
+        events += session.progressDue();
+    });
+    done = session.getState() == otaSession::OTA_DONE;
+    return events;
+}
+
+static bool checks() {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("FAILED: %s\n", what);
+        ok = ok && cond;
+    };
+
+    // The streamed digest is the one-shot digest, whatever the chunking
+    std::string image = firmware(300000, 1);
+    for (size_t step : {1, 63, 64, 65, 1436, 300000}) {
+        sha256Stream stream;
+        for (size_t at = 0; at < image.size(); at += step)
+            stream.update(reinterpret_cast<const uint8_t*>(image.data()) + at, std::min(step, image.size() - at));
+        uint8_t digest[32];
+        stream.finish(digest);
+        char hex[65];
+        for (int i = 0; i < 32; ++i) snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+        expect(String(hex) == hexDigest(image), "streamed digest");
+    }
+
+    memorySink sink;
+    bool done = false;
+    size_t events = update(sink, image, hexDigest(image), done);
+    expect(done && sink.activated && !sink.aborted && sink.image == image, "matching digest activates");
+    expect(events >= 90 && events <= 102, "an event per percent");
+
+    String right = hexDigest(image);
+    String wrong = right.substring(0, 10) + (right[10] == '0' ? "1" : "0") + right.substring(11);
+    update(sink, image, wrong, done);
+    expect(!done && !sink.activated && sink.aborted, "mismatch is not activated");
+    String upper = hexDigest(image);
+    upper.toUpperCase();
+    update(sink, image, upper, done);
+    expect(done, "digest case does not matter");
+
+    memorySink untouched;
+    otaSession missing(untouched);
+    expect(!missing.begin("", 1000) && missing.rejected() && !untouched.begun, "no digest, nothing written");
+    otaSession truncated(sink);
+    expect(!truncated.begin(hexDigest(image).substring(2), 1000) && truncated.rejected(), "short digest");
+
+    memorySink small;
+    small.limit = 1000;
+    otaSession tooBig(small);
+    expect(!tooBig.begin(hexDigest(image), 5000) && !tooBig.rejected() && String(tooBig.error()) == "Not Enough Space",
+           "too big for the slot");
+
+    memorySink failing;
+    failing.failAt = 10000;
+    update(failing, image, hexDigest(image), done);
+    expect(!done && failing.aborted && !failing.activated, "write error aborts");
+
+    // A dropped connection: the session goes away mid-image and the old firmware stays
+    {
+        otaSession dropped(sink);
+        dropped.begin(hexDigest(image), image.size());
+        dropped.write(reinterpret_cast<const uint8_t*>(image.data()), 5000);
+        sink.aborted = false;
+    }
+    expect(sink.aborted && !sink.activated, "dropped upload aborts");
+
+    // Progress JSON: never 100% until verified, zero Content-Length does not divide
+    otaSession progress(sink);
+    progress.begin(hexDigest(image), 0);
+    progress.write(reinterpret_cast<const uint8_t*>(image.data()), 1000);
+    char json[192];
+    expect(progress.progressJson(json, sizeof(json)) && String(json).indexOf("\"percent\":0") > 0, "no length");
+    otaSession nearly(sink);
+    nearly.begin(hexDigest(image), image.size());
+    nearly.write(reinterpret_cast<const uint8_t*>(image.data()), image.size());
+    nearly.progressJson(json, sizeof(json));
+    expect(String(json).indexOf("\"state\":\"writing\"") > 0 && String(json).indexOf("\"percent\":99") > 0,
+           "99% until verified");
+    nearly.finish();
+    nearly.progressJson(json, sizeof(json));
+    expect(String(json).indexOf("\"state\":\"done\"") > 0 && String(json).indexOf("\"percent\":100") > 0, "done");
+    otaSession failed(sink);
+    failed.begin(wrong, image.size());
+    failed.write(reinterpret_cast<const uint8_t*>(image.data()), image.size());
+    failed.finish();
+    expect(failed.progressJson(json, sizeof(json)) && String(json).indexOf("\"error\":\"SHA-256 mismatch\"") > 0,
+           "error reported");
+    expect(!failed.progressJson(json, 40), "truncation reported");
+    return ok;
+}
+
+int main() {
+    Serial.quiet = true;
+    printf("%-8s %16s %16s %16s\n", "image", "before", "after", "SHA-256 share");
+    for (size_t kb : {256, 1024, 1900}) {
+        std::string image = firmware(kb * 1024, unsigned(kb));
+        String digest = hexDigest(image);
+        memorySink sink;
+        const int rounds = 10;
+
+        auto t0 = clk::now();
+        for (int i = 0; i < rounds; ++i) {
+            sink.begin(image.size());
+            feed(image, [&](const uint8_t* data, size_t len, bool final) {
+                sink.write(data, len);
+                if (final) sink.end();
+            });
+        }
+        double before = std::chrono::duration<double>(clk::now() - t0).count() / rounds;
+
+        bool done = false;
+        t0 = clk::now();
+        for (int i = 0; i < rounds; ++i) update(sink, image, digest, done);
+        double after = std::chrono::duration<double>(clk::now() - t0).count() / rounds;
+        if (!done || sink.image != image) printf("FAILED: %zu KB image\n", kb);
+
+        char label[16];
+        snprintf(label, sizeof(label), "%zu KB", kb);
+        printf("%-8s %10.1f MB/s %10.1f MB/s %14.0f %%\n", label, kb / 1024.0 / before, kb / 1024.0 / after,
+               100 * (after - before) / after);
+    }
+    printf("otaSession state: %zu bytes, plus %u %u-byte write blocks while an update runs\n\n", sizeof(otaSession),
+           unsigned(DEFERRED_WRITER_BLOCKS), unsigned(OTA_WRITE_BLOCK));
+
+    bool ok = checks();
+    printf("ota checks: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
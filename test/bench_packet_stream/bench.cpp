@@ -0,0 +1,179 @@
+// packetTrace on the host: what the radio path pays per frame, and what the
+// /packets/stream viewers get when one of them cannot keep up.
+//   before    watching traffic meant a Serial.printf per frame in the callback;
+//             here the same line is formatted into a buffer (the UART wait on
+//             the device comes on top and is not modelled)
+//   record    packetTraceRecord(): a 16-byte copy into the ring under the lock
+// Then a producer thread records frames at a fixed rate while a fast viewer and
+// a stalled one read through their own packetTraceReader, as the chunked
+// responses of webUI::sendPacketStream() would. Host threads stand in for the
+// WiFi and async_tcp tasks; nothing here ran on an ESP32.
+//   g++ -std=c++17 -O2 -pthread -I../hostShim -I../../lib/packetTrace -I../../lib/commonTypes/src -I../../lib/textCodec
+//       bench.cpp ../../lib/packetTrace/packetTrace.cpp -o bench
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <deviceDataPacket.h>
+#include <packetTrace.hpp>
+
+using clk = std::chrono::steady_clock;
+
+static const uint8_t PEER[6] = {0x24, 0x6F, 0x28, 0x1B, 0x2C, 0x3D};
+
+static deviceDataPacket packet(uint8_t seq) {
+    deviceDataPacket pkt{};
+    pkt.version = 1;
+    pkt.command = 7;
+    pkt.flags = PKT_FLAG_TAGGED;
+    pkt.seqId = seq;
+    return pkt;
+}
+
+static void recordRx(uint8_t seq) {
+    deviceDataPacket pkt = packet(seq);
+    packetTraceRecord(PACKET_RX, PEER, reinterpret_cast<const uint8_t*>(&pkt), sizeof(pkt));
+}
+
+// Everything a reader has to give right now, as the response filler would send it
+static std::string drain(packetTraceReader& reader, size_t buffer, uint32_t nowMs) {
+    std::string out;
+    uint8_t chunk[4096];
+    for (size_t n; (n = reader.fill(chunk, buffer, nowMs)) > 0;) out.append(reinterpret_cast<char*>(chunk), n);
+    return out;
+}
+
+static size_t countLines(const std::string& text, const char* prefix) {
+    size_t n = 0;
+    for (size_t at = 0; (at = text.find(prefix, at)) != std::string::npos; at += strlen(prefix)) ++n;
+    return n;
+}
+
+static bool checks() {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("FAILED: %s\n", what);
+        ok = ok && cond;
+    };
+    hostClock::manual = true;
+    hostClock::nowMs = 5000;
+
+    recordRx(1); // Before the viewer connected: not shown
+    packetTraceReader reader;
+    recordRx(2);
+    std::string first = drain(reader, 4096, 5000);
+    size_t eol = first.find('\n');
+    expect(first.compare(0, 25, "{\"t\":5000,\"counts\":{\"rx\":") == 0, "counters line first");
+    expect(first.substr(eol + 1) ==
+               "{\"t\":5000,\"ev\":\"rx\",\"mac\":\"24:6F:28:1B:2C:3D\",\"len\":22,\"cmd\":7,\"flags\":8,\"seq\":2}\n",
+           "event line");
+    expect(drain(reader, 4096, 5999).empty(), "nothing new, nothing sent");
+    expect(countLines(drain(reader, 4096, 6000), "\"counts\"") == 1, "counters once a second");
+
+    packetTraceRecord(PACKET_TX_FAILED, PEER, nullptr, 0);
+    uint8_t beacon[40] = {1};
+    packetTraceRecord(PACKET_TX, nullptr, beacon, sizeof(beacon));
+    std::string sends = drain(reader, 4096, 6000);
+    expect(sends.find("\"ev\":\"txFailed\",\"mac\":\"24:6F:28:1B:2C:3D\",\"len\":0}") != std::string::npos &&
+               sends.find("\"ev\":\"tx\",\"mac\":\"00:00:00:00:00:00\",\"len\":40,\"type\":1}") != std::string::npos,
+           "send callback and broadcast lines");
+
+    // Lines split across any buffer size come out the same
+    packetTraceReader byteWise, whole;
+    for (int i = 0; i < 50; ++i) recordRx(uint8_t(i));
+    expect(drain(byteWise, 7, 6000) == drain(whole, 4096, 6000), "lines split across buffers");
+    expect(drain(byteWise, 1, 7000) == drain(whole, 4096, 7000), "one byte at a time");
+
+    // A reader that falls a ring behind is told, then resumes at the oldest event still held
+    packetTraceReader behind;
+    drain(behind, 4096, 7000);
+    for (int i = 0; i < 1000; ++i) recordRx(uint8_t(i));
+    std::string resumed = drain(behind, 4096, 7000);
+    unsigned lost = 1000 - PACKET_TRACE_EVENTS;
+    char lostLine[32];
+    snprintf(lostLine, sizeof(lostLine), "{\"lost\":%u}\n{", lost);
+    expect(resumed.compare(0, strlen(lostLine), lostLine) == 0 && behind.lost() == lost, "lost reported");
+    expect(countLines(resumed, "\"ev\":\"rx\"") == PACKET_TRACE_EVENTS, "the rest of the ring delivered");
+    std::string tail = drain(behind, 4096, 8000);
+    expect(tail.find("\"lost\":" + std::to_string(lost) + "}") != std::string::npos, "lost in the counters line");
+
+    // Queue depths come from both ends' counts
+    packetQueueStats before = packetTraceQueueStats(PACKET_QUEUE_TX);
+    for (int i = 0; i < 5; ++i) packetTraceQueued(PACKET_QUEUE_TX, true);
+    packetTraceQueued(PACKET_QUEUE_TX, false);
+    for (int i = 0; i < 3; ++i) packetTraceDequeued(PACKET_QUEUE_TX);
+    packetQueueStats q = packetTraceQueueStats(PACKET_QUEUE_TX);
+    expect(q.in - q.out == 2 + before.in - before.out && q.peak >= 5 && q.full == before.full + 1, "queue stats");
+    char json[PACKET_TRACE_LINE_MAX];
+    expect(packetTraceStatsToJson(0, json, sizeof(json)) && strstr(json, "\"tx\":{\"depth\":2,\"peak\":5,\"full\":1"),
+           "queue stats in JSON");
+    expect(packetTraceStatsToJson(0, json, 64) == 0, "truncation reported");
+
+    hostClock::manual = false;
+    return ok;
+}
+
+int main() {
+    // Per-frame cost in the radio path
+    const int frames = 1000000;
+    char line[160];
+    volatile size_t sink = 0; // Keeps the formatting from being optimised out
+    auto t0 = clk::now();
+    for (int i = 0; i < frames; ++i) {
+        deviceDataPacket pkt = packet(uint8_t(i));
+        sink += snprintf(line, sizeof(line), "📥 RX from %02X:%02X:%02X:%02X:%02X:%02X cmd=%u flags=%u seq=%u len=%u\n",
+                         PEER[0], PEER[1], PEER[2], PEER[3], PEER[4], PEER[5], pkt.command, pkt.flags, pkt.seqId,
+                         unsigned(sizeof(pkt)));
+    }
+    double printfNs = std::chrono::duration<double, std::nano>(clk::now() - t0).count() / frames;
+    t0 = clk::now();
+    for (int i = 0; i < frames; ++i) recordRx(uint8_t(i));
+    double recordNs = std::chrono::duration<double, std::nano>(clk::now() - t0).count() / frames;
+    printf("per frame in the radio path: before %.0f ns (format only), record %.0f ns\n\n", printfNs, recordNs);
+
+    // A producer at a fixed rate; one viewer keeping up, one stalled for most of the run
+    printf("%-10s %10s %10s %10s %10s %14s\n", "rate", "recorded", "viewer", "delivered", "lost", "record p99");
+    for (unsigned perSecond : {1000u, 20000u}) {
+        std::atomic<bool> running(true);
+        uint32_t start = packetTraceHead();
+        packetTraceReader fast, stalled;
+        std::vector<double> costs;
+        std::thread radio([&] {
+            auto next = clk::now();
+            for (unsigned i = 0; i < perSecond / 2; ++i) { // Half a second of traffic
+                next += std::chrono::nanoseconds(1000000000 / perSecond);
+                std::this_thread::sleep_until(next);
+                auto r0 = clk::now();
+                recordRx(uint8_t(i));
+                costs.push_back(std::chrono::duration<double, std::nano>(clk::now() - r0).count());
+            }
+            running = false;
+        });
+        size_t fastLines = 0, stalledLines = 0;
+        while (running) {
+            fastLines += countLines(drain(fast, 1436, millis()), "\"ev\"");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        radio.join();
+        fastLines += countLines(drain(fast, 1436, millis()), "\"ev\"");
+        stalledLines += countLines(drain(stalled, 1436, millis()), "\"ev\"");
+        std::sort(costs.begin(), costs.end());
+        uint32_t recorded = packetTraceHead() - start;
+        char label[16];
+        snprintf(label, sizeof(label), "%u/s", perSecond);
+        printf("%-10s %10u %10s %10zu %10u %11.0f ns\n", label, recorded, "fast", fastLines, fast.lost(),
+               costs[costs.size() * 99 / 100]);
+        printf("%-10s %10s %10s %10zu %10u\n", "", "", "stalled", stalledLines, stalled.lost());
+        if (fastLines + fast.lost() != recorded || stalledLines + stalled.lost() != recorded)
+            printf("FAILED: delivered + lost != recorded\n");
+    }
+    printf("\n");
+
+    bool ok = checks();
+    printf("packet stream checks: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
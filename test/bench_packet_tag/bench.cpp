@@ -0,0 +1,124 @@
+// Host cost of the SipHash-2-4/32 packet tag versus a full HMAC-SHA256 per packet.
+//   g++ -std=c++17 -O2 -I../../lib/cryptoHelper -I../../lib/commonTypes/src -I../../lib/globalConstants/src
+//       bench.cpp ../../lib/cryptoHelper/packetTagger.cpp ../../lib/cryptoHelper/cryptoBackend.cpp -lmbedcrypto -o bench
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <packetTagger.hpp>
+#include <sessionKey.hpp>
+#include <sipHash.hpp>
+
+using clk = std::chrono::steady_clock;
+
+template <typename F>
+static double nsPerOp(int rounds, F&& op) {
+    auto t0 = clk::now();
+    for (int i = 0; i < rounds; ++i) op(i);
+    return std::chrono::duration<double, std::nano>(clk::now() - t0).count() / rounds;
+}
+
+// Reference vectors from the SipHash paper (key 00..0f, message 00..0e)
+static bool checkSipHashVector() {
+    uint8_t key[16], msg[15];
+    for (int i = 0; i < 16; ++i) key[i] = i;
+    for (int i = 0; i < 15; ++i) msg[i] = i;
+    return sipHash24(key, msg, sizeof(msg)) == 0xa129ca6149be45e5ULL;
+}
+
+int main() {
+    printf("SipHash-2-4 reference vector: %s\n", checkSipHashVector() ? "ok" : "MISMATCH");
+
+    uint8_t bossMac[6] = {0x24, 0x6F, 0x28, 0xAA, 0xBB, 0xCC};
+    uint8_t workerMac[6] = {0x24, 0x6F, 0x28, 0x01, 0x02, 0x03};
+    const char secret[] = "mytoon42273211";
+    uint8_t key[TAG_KEY_LEN];
+    deriveTagKey(reinterpret_cast<const uint8_t*>(secret), sizeof(secret) - 1, key);
+
+    packetTagger tx, rx;
+    tx.begin(workerMac);
+    rx.begin(bossMac);
+    tx.setKey(key);
+    rx.setKey(key);
+    rx.setRequireTag(true);
+
+    deviceDataPacket pkt = {};
+    pkt.version = 1;
+    pkt.command = static_cast<uint8_t>(CommandCode::Heartbeat);
+
+    constexpr int ROUNDS = 2000000;
+    unsigned sink = 0;
+    deviceDataPacket out;
+
+    double signNs = nsPerOp(ROUNDS, [&](int i) {
+        out = pkt;
+        out.seqId = i;
+        tx.sign(out);
+        sink += out.tag[0];
+    });
+
+    // verify() refuses a counter twice, so every round needs its own signed frame
+    constexpr int VERIFY_ROUNDS = 200000;
+    std::vector<deviceDataPacket> signedPkts(VERIFY_ROUNDS);
+    for (int i = 0; i < VERIFY_ROUNDS; ++i) {
+        signedPkts[i] = pkt;
+        signedPkts[i].seqId = i;
+        tx.sign(signedPkts[i]);
+    }
+    double verifyNs = nsPerOp(VERIFY_ROUNDS, [&](int i) { sink += rx.verify(signedPkts[i]); });
+    uint32_t acceptedRejects = rx.rejectCount();
+
+    // Replays are refused, a late frame within the window is not, and re-pairing starts afresh
+    uint32_t before = rx.rejectCount();
+    bool replay = !rx.verify(signedPkts[VERIFY_ROUNDS - 1]) && !rx.verify(signedPkts[VERIFY_ROUNDS - 40]);
+    deviceDataPacket late = pkt, newest = pkt;
+    tx.sign(late);
+    tx.sign(newest);
+    bool reordered = rx.verify(newest) && rx.verify(late) && !rx.verify(late);
+    rx.replay().forget(workerMac);
+    bool repaired = rx.verify(signedPkts[0]);
+    replay = replay && rx.rejectCount() == before + 3;
+
+    // Every single-bit flip outside tag[] must be caught
+    unsigned missed = 0;
+    for (size_t byte = 0; byte < sizeof(deviceDataPacket); ++byte) {
+        if (byte >= offsetof(deviceDataPacket, tag) && byte < offsetof(deviceDataPacket, senderMac)) continue;
+        for (int bit = 0; bit < 8; ++bit) {
+            deviceDataPacket bad = signedPkts[7];
+            reinterpret_cast<uint8_t*>(&bad)[byte] ^= 1 << bit;
+            // These hand the frame to the pairing offer's own confirmation tag
+            if (packetCipher::isExempt(bad)) continue;
+            missed += rx.verify(bad);
+        }
+    }
+    deviceDataPacket untagged = pkt;
+    missed += rx.verify(untagged);
+
+    // With no cipher set, PKT_FLAG_ENCRYPTED must not stand in for a tag
+    uint32_t beforeForgery = rx.rejectCount();
+    deviceDataPacket flagOnly = pkt;
+    flagOnly.flags |= PKT_FLAG_ENCRYPTED;
+    deviceDataPacket flipped = signedPkts[9];
+    flipped.flags = (flipped.flags & ~PKT_FLAG_TAGGED) | PKT_FLAG_ENCRYPTED;
+    bool flagForgery = !rx.verify(flagOnly) && !rx.verify(flipped) && rx.rejectCount() == beforeForgery + 2;
+
+    constexpr int HMAC_ROUNDS = 200000;
+    uint8_t mac[32];
+    double hmacNs = nsPerOp(HMAC_ROUNDS, [&](int i) {
+        out = pkt;
+        out.seqId = i;
+        computeHmacSHA256(key, sizeof(key), reinterpret_cast<const uint8_t*>(&out), sizeof(out), mac);
+        sink += mac[0];
+    });
+
+    printf("sign   (SipHash-2-4/32)   %7.1f ns/packet\n", signNs);
+    printf("verify (SipHash-2-4/32)   %7.1f ns/packet\n", verifyNs);
+    printf("HMAC-SHA256 (reference)   %7.1f ns/packet\n", hmacNs);
+    printf("Valid packets rejected: %u, tampered packets accepted: %u, rejectCount %u\n",
+           acceptedRejects, missed, rx.rejectCount());
+    printf("replayed frame rejected: %s, late frame accepted: %s, re-pair resets window: %s\n",
+           replay ? "ok" : "FAILED", reordered ? "ok" : "FAILED", repaired ? "ok" : "FAILED");
+    printf("ENCRYPTED flag without a cipher rejected: %s\n", flagForgery ? "ok" : "FAILED");
+    printf("(sink %u)\n", sink);
+    return 0;
+}
@@ -0,0 +1,190 @@
+// Compiled page templates (templates/*.html -> pageTemplates.h) versus the
+// String concatenation they replaced, for the ESP-NOW QR page, the firmware
+// update page and the config error page. Rendered three ways:
+//   previous   the old generate*() body, copied below
+//   String     generate*() now: the template collected into one String
+//   streamed   render*() into a writer that keeps nothing (what a chunked
+//              response or the ETag hash sees), so only the page's own work counts
+// Host only; String is the std::string-backed shim, so allocation counts are a
+// floor for the Arduino String. Nothing here ran on an ESP32.
+//   g++ -std=c++17 -O2 -I../hostShim -I../../lib/configManager2 -I../../lib/globalConstants/src -I../../lib/textCodec
+//       -I../../lib/heapStats -I../../lib/htmlRenderer/src bench.cpp ../../lib/configManager2/configManager2.cpp
+//       ../../lib/configManager2/configSchema.cpp ../../lib/htmlRenderer/src/htmlRenderer.cpp -o bench
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <configManager2.h>
+#include <htmlRenderer.h>
+#include <pageTemplates.h>
+
+static size_t allocations = 0;
+
+void* operator new(size_t n) {
+    ++allocations;
+    void* p = malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// ---- Previous implementations -------------------------------------------------
+
+static String legacyEspNowQrPage(const String& mac, const String& lmkHex) {
+    String payload = "MAC=" + mac + ";LMK=" + lmkHex;
+
+    String html = String(R"rawlite(
+<!DOCTYPE html>
+<html>
+<head>
+  <meta charset="UTF-8">
+  <title>ESP-NOW QR Code</title>
+  <style>
+    body { font-family: sans-serif; background: #f6fff6; color: #2c3e50; text-align: center; padding: 2em; }
+    #qrcode { margin: 2em auto; }
+    .info { font-size: 0.9rem; color: #555; }
+  </style>
+</head>
+<body>
+  <h1>Scan to Pair</h1>
+  <div id="qrcode"></div>
+  <p class="info">MAC: )rawlite") + mac + R"rawlite(<br>LMK: )rawlite" + lmkHex + R"rawlite(</p>
+
+  <script src="https://cdn.jsdelivr.net/npm/qrcodejs@1.0.0/qrcode.min.js"></script>
+  <script>
+    const payload = ")rawlite" + payload + R"rawlite(";
+    new QRCode(document.getElementById("qrcode"), {
+      text: payload,
+      width: 256,
+      height: 256,
+      colorDark: "#000000",
+      colorLight: "#ffffff",
+      correctLevel: QRCode.CorrectLevel.H
+    });
+  </script>
+</body>
+</html>
+)rawlite";
+
+    return html;
+}
+
+static String legacyFirmwareUpdatePage(const char* style) {
+    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Firmware Update</title>") + style + "</head><body>";
+    html += "<h1>🧪 Firmware Update</h1>";
+
+    html += "<p><strong>Current Firmware Build:</strong><br>";
+    html += "Compiled on <code>" + String(__DATE__) + " at " + String(__TIME__) + "</code></p>";
+
+    html += "<form method='POST' action='/update' enctype='multipart/form-data'>";
+    html += "<input type='file' name='firmware'><br><br>";
+    html += "<input type='submit' value='Upload Firmware'>";
+    html += "</form>";
+
+    html += "<br><a href='/home'>Back to Home</a></body></html>";
+    return html;
+}
+
+static String legacyConfigErrorPage(const char* style, const String& errorMessage) {
+    String html = String("<!DOCTYPE html><html><head><meta charset='UTF-8'><title>Config Error</title>") + style + "</head><body>";
+    html += "<h1 style='color:red;'>Configuration Error</h1>";
+    html += "<p>" + errorMessage + "</p>";
+    html += "<br><a href='/configs'>Back to Config Editor</a> | <a href='/home'>Home</a></body></html>";
+    return html;
+}
+
+// ---- Timing -------------------------------------------------------------------
+
+// Counts bytes and drops them, like a chunked response buffer that is already on the wire
+class discardWriter : public htmlWriter {
+public:
+    bool write(const char*, size_t len) override { bytes += len; return true; }
+    size_t bytes = 0;
+};
+
+static volatile size_t sink;
+
+template <typename Fn>
+static void time(int rounds, Fn fn, double& nsOut, double& allocOut) {
+    size_t before = allocations;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) sink += fn();
+    auto t1 = std::chrono::steady_clock::now();
+    nsOut = std::chrono::duration<double, std::nano>(t1 - t0).count() / rounds;
+    allocOut = double(allocations - before) / rounds;
+}
+
+template <typename Legacy, typename Collected, typename Streamed>
+static void compare(const char* what, Legacy legacy, Collected collected, Streamed streamed) {
+    const int rounds = 200000;
+    double ns[3], allocs[3];
+    time(rounds, legacy, ns[0], allocs[0]);
+    time(rounds, collected, ns[1], allocs[1]);
+    time(rounds, streamed, ns[2], allocs[2]);
+    printf("%-16s", what);
+    for (int i = 0; i < 3; ++i) printf(" %8.0f ns %5.1f allocs", ns[i], allocs[i]);
+    printf("\n");
+}
+
+static bool checks(const htmlRenderer& renderer, const String& mac, const String& lmk) {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("FAILED: %s\n", what);
+        ok = ok && cond;
+    };
+
+    // Same markup as before; the QR page no longer starts with a blank line ahead of <!DOCTYPE>
+    String qr = renderer.generateEspNowQrPage(mac, lmk);
+    expect("\n" + qr == legacyEspNowQrPage(mac, lmk), "QR page");
+    expect(qr.indexOf("const payload = \"MAC=" + mac + ";LMK=" + lmk + "\";") > 0, "QR payload");
+
+    String error = renderer.generateConfigErrorPage("bad <value>");
+    String legacyError = legacyConfigErrorPage(renderer.getStyle(), "bad <value>");
+    error.replace("\n", "");
+    expect(error == legacyError, "error page (template line breaks aside)");
+
+    // Every slot is filled and the step table covers the whole page
+    size_t literal = 0;
+    for (uint8_t i = 0; i < ESP_NOW_QR_TEMPLATE.stepCount; ++i) {
+        const htmlTemplateStep& step = ESP_NOW_QR_TEMPLATE.steps[i];
+        literal += step.length;
+        expect(step.slot == HTML_TEMPLATE_NO_SLOT || step.slot < ESP_NOW_QR_SLOTS, "slot index");
+    }
+    expect(literal + 2 * (mac.length() + lmk.length()) == qr.length(), "fragments plus values");
+
+    // A full sink stops the template early
+    char window[64];
+    htmlWindowWriter first(reinterpret_cast<uint8_t*>(window), sizeof(window), 0);
+    renderer.renderEspNowQrPage(first, mac, lmk);
+    expect(first.length() == sizeof(window) && memcmp(window, qr.c_str(), sizeof(window)) == 0, "window");
+    return ok;
+}
+
+int main() {
+    Serial.quiet = true; // generateConfigErrorPage() logs each render
+    configManager2 config;
+    htmlRenderer renderer(&config.getConfig());
+    const String mac = "24:6F:28:0A:1B:2C";
+    const String lmk = "00112233445566778899AABBCCDDEEFF";
+    const String message = "Section 'mqtt' is missing 'serverIP'";
+
+    printf("%-16s %25s %25s %25s\n", "", "previous", "String", "streamed");
+    compare("ESP-NOW QR",
+            [&] { return legacyEspNowQrPage(mac, lmk).length(); },
+            [&] { return renderer.generateEspNowQrPage(mac, lmk).length(); },
+            [&] { discardWriter out; renderer.renderEspNowQrPage(out, mac, lmk); return out.bytes; });
+    compare("firmware update",
+            [&] { return legacyFirmwareUpdatePage(renderer.getStyle()).length(); },
+            [&] { return renderer.generateFirmwareUpdatePage().length(); },
+            [&] { discardWriter out; renderer.renderFirmwareUpdatePage(out); return out.bytes; });
+    compare("config error",
+            [&] { return legacyConfigErrorPage(renderer.getStyle(), message).length(); },
+            [&] { return renderer.generateConfigErrorPage(message).length(); },
+            [&] { discardWriter out; renderer.renderConfigErrorPage(out, message); return out.bytes; });
+
+    printf("\n");
+    bool ok = checks(renderer, mac, lmk);
+    printf("template output checks: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
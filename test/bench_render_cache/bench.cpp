@@ -0,0 +1,170 @@
+// Render cache for /configs and /all, keyed by configManager2 section
+// revisions, on data/config.json and on a copy grown to 88 sections. Each
+// request is served the way webUI does it: one pass into htmlHashWriter for the
+// ETag, then the page in 1436-byte buffers through htmlPartCursor. Cases:
+//   uncached      every section rendered for every pass (previous behaviour)
+//   warm          nothing changed since the last request
+//   one edit      setValue() on one section before each request
+//   format edit   a *.format change before each request: every section is stale
+// "renders" counts section renders per request; uncached that is two per
+// section plus one for each section that straddles a buffer boundary. The grown
+// config runs with the PSRAM budget, data/config.json as it is with the heap
+// budget; both are plain malloc here. Host only; nothing here ran on an ESP32.
+//   g++ -std=c++17 -O2 -I../hostShim -I../../lib/configManager2 -I../../lib/globalConstants/src -I../../lib/textCodec
+//       -I../../lib/heapStats -I../../lib/htmlRenderer/src bench.cpp ../../lib/configManager2/configManager2.cpp
+//       ../../lib/configManager2/configSchema.cpp ../../lib/htmlRenderer/src/htmlRenderer.cpp
+//       ../../lib/htmlRenderer/src/htmlRenderCache.cpp -o bench
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <configManager2.h>
+#include <htmlRenderer.h>
+#include <htmlRenderCache.h>
+
+using clk = std::chrono::steady_clock;
+
+static const size_t CHUNK = 1436;
+
+static std::string readFile(const char* path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+static String grownConfig(int extraSections) {
+    std::string json = readFile("../../data/config.json");
+    json.erase(json.find_last_of('}'));
+    for (int s = 0; s < extraSections; ++s) {
+        json += ",\n  \"node" + std::to_string(s) + "\": { \"format.use\": \"mqtt.format\", \"use\": \"true\", "
+                "\"user\": \"node-" + std::to_string(s) + "\", \"topic\": \"site/line/" + std::to_string(s) +
+                "/status\", \"serverIP\": \"10.0.0." + std::to_string(s % 250 + 1) +
+                "\", \"serverPort\": \"1883\", \"password\": \"secret" + std::to_string(s) + "\" }";
+    }
+    return String(json + "\n}\n");
+}
+
+struct fixture {
+    configManager2 config;
+    htmlRenderer renderer{&config.getConfig()};
+    htmlRenderCache cache;
+    size_t renders = 0;
+
+    fixture(size_t budget, int extraSections) : cache(budget) {
+        config.jsonStringToConfig(grownConfig(extraSections), false);
+        renderer.setSchema(&config.getSchema());
+    }
+
+    bool direct(htmlWriter& out, bool form, size_t part) {
+        if (part > 0 && part <= config.getConfig().size()) ++renders;
+        return form ? renderer.renderConfigFormPart(out, config.getConfig(), true, part)
+                    : renderer.renderAllSectionsPart(out, part);
+    }
+
+    // As webUI::renderCachedPart()
+    bool cached(htmlWriter& out, bool form, size_t part) {
+        const auto& map = config.getConfig();
+        if (part == 0 || part > map.size()) return direct(out, form, part);
+        const String& section = std::next(map.begin(), part - 1)->first;
+        return cache.serve(out, form ? 0 : 1, section, config.getSectionRevision(section),
+                           [&](htmlWriter& fresh) { return direct(fresh, form, part); });
+    }
+
+    // As webUI::sendParts(): ETag pass, then the chunked body
+    String serve(const htmlPartRenderer& render) {
+        htmlHashWriter hash;
+        for (size_t part = 0; render(hash, part); ++part) {}
+        String body;
+        htmlPartCursor cursor;
+        uint8_t buffer[CHUNK];
+        for (size_t n; (n = cursor.fill(buffer, sizeof(buffer), render)) > 0;)
+            body.concat(reinterpret_cast<const char*>(buffer), n);
+        return body;
+    }
+};
+
+static void row(const char* what, fixture& f, bool useCache, bool form, std::function<void(int)> before) {
+    const int rounds = 300;
+    htmlPartRenderer render = [&](htmlWriter& out, size_t part) {
+        return useCache ? f.cached(out, form, part) : f.direct(out, form, part);
+    };
+    f.serve(render); // Warm up
+    f.renders = 0;
+    double us = 0;
+    for (int i = 0; i < rounds; ++i) {
+        before(i);
+        auto t0 = clk::now();
+        f.serve(render);
+        us += std::chrono::duration<double, std::micro>(clk::now() - t0).count();
+    }
+    printf("  %-12s %8.1f us %8.1f renders\n", what, us / rounds, double(f.renders) / rounds);
+}
+
+static bool checks() {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("FAILED: %s\n", what);
+        ok = ok && cond;
+    };
+
+    fixture f(HTML_RENDER_CACHE_PSRAM_BYTES, 73);
+    htmlPartRenderer form = [&](htmlWriter& out, size_t part) { return f.cached(out, true, part); };
+    htmlPartRenderer all = [&](htmlWriter& out, size_t part) { return f.cached(out, false, part); };
+    expect(f.serve(form) == f.renderer.generateConfigFormPage(f.config.getConfig(), true), "form, cold");
+    expect(f.serve(form) == f.renderer.generateConfigFormPage(f.config.getConfig(), true), "form, warm");
+    expect(f.serve(all) == f.renderer.generateAllSectionsPage(), "all sections");
+
+    // Revisions: per section on setValue, everything on format changes and reloads
+    uint32_t mqtt = f.config.getSectionRevision("mqtt"), espnow = f.config.getSectionRevision("espnow");
+    f.config.setValue("mqtt", "port", "1884");
+    expect(f.config.getSectionRevision("mqtt") > mqtt && f.config.getSectionRevision("espnow") == espnow,
+           "setValue moves only its section");
+    f.renders = 0;
+    expect(f.serve(form).indexOf("value='1884'") > 0 && f.renders == 1, "only the edited section re-renders");
+    f.config.setValue("mqtt", "port", "1884");
+    expect(f.config.getSectionRevision("mqtt") == f.config.getRevision(), "unchanged value keeps the revision");
+    f.config.setValue("mqtt.format", "serverPort", "string");
+    expect(f.config.getSectionRevision("espnow") > espnow, "format change moves every section");
+    f.renders = 0;
+    f.serve(form);
+    expect(f.renders == f.config.getConfig().size(), "format change re-renders every section, once");
+
+    // A budget far below the page still serves it byte for byte
+    fixture small(4096, 0);
+    htmlPartRenderer smallForm = [&](htmlWriter& out, size_t part) { return small.cached(out, true, part); };
+    String reference = small.renderer.generateConfigFormPage(small.config.getConfig(), true);
+    expect(small.serve(smallForm) == reference && small.serve(smallForm) == reference, "small budget");
+    expect(small.cache.stats().bytes <= 4096 && small.cache.stats().hits > 0, "budget held, entries still hit");
+    small.config.setValue("mqtt.format", "serverPort", "string");
+    expect(small.serve(smallForm) == small.renderer.generateConfigFormPage(small.config.getConfig(), true) &&
+           small.cache.stats().evictions == 0, "stale entries replaced in place");
+    return ok;
+}
+
+int main() {
+    Serial.quiet = true;
+    struct { int extraSections; size_t budget; const char* label; } setups[] = {
+        {0, HTML_RENDER_CACHE_HEAP_BYTES, "heap"}, {73, HTML_RENDER_CACHE_PSRAM_BYTES, "PSRAM"}};
+    for (const auto& setup : setups) {
+        for (bool form : {true, false}) {
+            fixture f(setup.budget, setup.extraSections);
+            printf("%s, %zu sections, %u-byte page, %s budget %zu\n", form ? "/configs" : "/all",
+                   f.config.getConfig().size(),
+                   form ? f.renderer.generateConfigFormPage(f.config.getConfig(), true).length()
+                        : f.renderer.generateAllSectionsPage().length(),
+                   setup.label, setup.budget);
+            row("uncached", f, false, form, [](int) {});
+            row("warm", f, true, form, [](int) {});
+            row("one edit", f, true, form, [&](int i) { f.config.setValue("mqtt", "port", String(1000 + i)); });
+            row("format edit", f, true, form,
+                [&](int i) { f.config.setValue("mqtt.format", "serverPort", i & 1 ? "string" : "text"); });
+            const htmlRenderCacheStats& s = f.cache.stats();
+            printf("  cache: %u entries, %u bytes, %u evictions\n\n", s.entries, s.bytes, s.evictions);
+        }
+    }
+    bool ok = checks();
+    printf("cache checks: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
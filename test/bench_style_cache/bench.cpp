@@ -0,0 +1,142 @@
+// Bytes per page view with the stylesheet inlined into every page (before)
+// versus linked as the flash-resident, gzipped /style.css with ETags (after).
+// Pages are rendered from data/config.json with SPIFFS rooted at data/.
+//   before     page with the old inline <style> block, sent in full every view
+//   first      page with the <link>, plus the 562-byte style.css on the first view only
+//   repeat     page with the <link>, stylesheet served from the browser cache
+//   304        page unchanged since the last view: ETag matches, no body
+// Body bytes only; response headers come on top in every column (a 304 is
+// about 120 bytes of them). Host only, nothing here ran on an ESP32.
+//   g++ -std=c++17 -O2 -I../hostShim -I../../lib/configManager2 -I../../lib/globalConstants/src -I../../lib/textCodec
+//       -I../../lib/heapStats -I../../lib/htmlRenderer/src bench.cpp ../../lib/configManager2/configManager2.cpp
+//       ../../lib/configManager2/configSchema.cpp ../../lib/htmlRenderer/src/htmlRenderer.cpp -o bench
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <configManager2.h>
+#include <htmlRenderer.h>
+
+using clk = std::chrono::steady_clock;
+
+static std::string readFile(const char* path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+// The inline block the pages carried before: style.css indented into a <style> element
+static std::string legacyInlineStyle() {
+    std::istringstream css(readFile("../../lib/htmlRenderer/src/style.css"));
+    std::string block = "\n<style>\n", line;
+    while (std::getline(css, line)) block += (line.empty() ? "" : "  ") + line + "\n";
+    return block + "</style>\n";
+}
+
+struct page {
+    const char* path;
+    bool conditional; // webUI sends an ETag; /info has live heap figures and does not
+    std::function<void(htmlWriter&)> render;
+};
+
+static String etagOf(const page& p) {
+    htmlHashWriter hash;
+    p.render(hash);
+    char etag[htmlHashWriter::ETAG_LEN + 1];
+    hash.etag(etag);
+    return String(etag);
+}
+
+static bool checks(configManager2& config, htmlRenderer& renderer, const std::vector<page>& pages) {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("FAILED: %s\n", what);
+        ok = ok && cond;
+    };
+
+    expect(STYLE_CSS_GZ[0] == 0x1f && STYLE_CSS_GZ[1] == 0x8b, "gzip magic");
+    const uint8_t* isize = STYLE_CSS_GZ + STYLE_CSS_GZ_LEN - 4;
+    expect(size_t(isize[0] | isize[1] << 8 | isize[2] << 16 | isize[3] << 24) == STYLE_CSS_LEN, "gzip length trailer");
+    expect(strstr(STYLE_CSS_LINK, "/style.css?v=") != nullptr, "versioned link");
+
+    for (const page& p : pages) {
+        String html;
+        htmlStringWriter out(html);
+        p.render(out);
+        expect(html.indexOf(STYLE_CSS_LINK) > 0 && html.indexOf("<style>") < 0, p.path);
+        expect(etagOf(p) == etagOf(p), "ETag stable across renders");
+    }
+
+    // Same bytes through the String and hash writers give the same ETag; an edit changes it
+    const page& configs = pages[4];
+    htmlHashWriter direct;
+    direct.print(renderer.generateConfigFormPage(config.getConfig(), true));
+    char etag[htmlHashWriter::ETAG_LEN + 1];
+    direct.etag(etag);
+    String before = etagOf(configs);
+    expect(before == etag, "hash of collected page");
+    config.setValue("Server", "ip", "192.168.1.77");
+    expect(etagOf(configs) != before, "ETag follows config edits");
+    return ok;
+}
+
+int main() {
+    configManager2 config;
+    if (!config.jsonStringToConfig(String(readFile("../../data/config.json")), false)) {
+        printf("cannot load data/config.json\n");
+        return 1;
+    }
+    SPIFFS.setRoot("../../data");
+    htmlRenderer renderer(&config.getConfig());
+    renderer.setSchema(&config.getSchema());
+
+    std::vector<page> pages = {
+        {"/home", true, [&](htmlWriter& out) { renderer.renderHomePage(out); }},
+        {"/files", true, [&](htmlWriter& out) { renderer.renderSPIFFSFileListPage(out); }},
+        {"/info", false, [&](htmlWriter& out) { renderer.renderInfoPage(out); }},
+        {"/all", true, [&](htmlWriter& out) { renderer.renderAllSectionsPage(out); }},
+        {"/configs", true, [&](htmlWriter& out) { renderer.renderConfigFormPage(out, config.getConfig(), true); }},
+        {"/downloadPage", true, [&](htmlWriter& out) { renderer.renderDownloadPage(out); }},
+        {"/upload", true, [&](htmlWriter& out) { renderer.renderUploadPage(out); }},
+        {"/firmware", true, [&](htmlWriter& out) { renderer.renderFirmwareUpdatePage(out); }},
+    };
+
+    const size_t inlineStyle = legacyInlineStyle().size();
+    const size_t link = strlen(STYLE_CSS_LINK);
+    printf("style: %zu bytes inline before; now %zu-byte link, style.css %zu bytes minified, %zu gzipped\n\n",
+           inlineStyle, link, STYLE_CSS_LEN, STYLE_CSS_GZ_LEN);
+    printf("%-14s %8s %8s %8s %8s %10s\n", "page", "before", "first", "repeat", "304", "ETag cost");
+
+    size_t sessionBefore = 0, sessionAfter = 0;
+    bool styleCached = false;
+    for (const page& p : pages) {
+        htmlHashWriter size;
+        p.render(size);
+        size_t after = size.length();
+        size_t before = after - link + inlineStyle;
+
+        // What webUI::sendParts() spends on the extra hashing render
+        const int rounds = 2000;
+        auto t0 = clk::now();
+        for (int i = 0; i < rounds; ++i) etagOf(p);
+        double us = std::chrono::duration<double, std::micro>(clk::now() - t0).count() / rounds;
+
+        char revalidated[12];
+        snprintf(revalidated, sizeof(revalidated), p.conditional ? "0" : "%zu", after);
+        printf("%-14s %8zu %8zu %8zu %8s %7.1f us\n", p.path, before, after + STYLE_CSS_GZ_LEN, after,
+               revalidated, p.conditional ? us : 0.0);
+
+        // A session that opens every page twice without editing anything
+        sessionBefore += 2 * before;
+        sessionAfter += (styleCached ? 0 : STYLE_CSS_GZ_LEN) + after + (p.conditional ? 0 : after);
+        styleCached = true;
+    }
+    printf("\nevery page viewed twice: %zu bytes before, %zu after (%.1f%%)\n", sessionBefore, sessionAfter,
+           100.0 * sessionAfter / sessionBefore);
+
+    bool ok = checks(config, renderer, pages);
+    printf("asset and ETag checks: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
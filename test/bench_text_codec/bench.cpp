@@ -0,0 +1,203 @@
+// textCodec versus the code it replaced: MAC and IPv4 checks from
+// configSchema::normalize() (already char-based), sprintf MAC formatting from
+// beaconHandler, hex key parsing from configManager2::parseHexStringToBytes()
+// and String::toInt(). Host only;
+// String is the std::string-backed shim, so allocation counts are a floor
+// for the Arduino String (smaller inline buffer).
+//   g++ -std=c++17 -O2 -I../hostShim -I../../lib/textCodec bench.cpp -o bench
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <Arduino.h>
+#include <textCodec.hpp>
+
+static size_t allocations = 0;
+
+void* operator new(size_t n) {
+    ++allocations;
+    void* p = malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// ---- Previous implementations -------------------------------------------------
+
+static bool legacyParseHex(const String& hexInput, uint8_t* out, size_t outLen) {
+    String hex = hexInput;
+    hex.replace(" ", "");
+    hex.toUpperCase();
+    if (hex.startsWith("0X")) hex = hex.substring(2);
+    if (hex.length() != outLen * 2) return false;
+    for (size_t i = 0; i < outLen; ++i) {
+        char byteStr[3] = {hex[2 * i], hex[2 * i + 1], '\0'};
+        char* end = nullptr;
+        out[i] = static_cast<uint8_t>(strtol(byteStr, &end, 16));
+        if (*end != '\0') return false;
+    }
+    return true;
+}
+
+static String legacyFormatMac(const uint8_t* mac) {
+    char macStr[18];
+    sprintf(macStr, "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    return String(macStr);
+}
+
+// configSchema::normalize() before textCodec: hand-rolled MAC canonicalisation
+static bool legacyNormalizeMac(const char* p, size_t len, char* mac) {
+    size_t digits = 0, i = 0;
+    for (; i < len && digits < 12; ++i) {
+        char c = p[i];
+        int n = (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+              : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+        if (n < 0) {
+            if ((c == ':' || c == '-') && digits % 2 == 0 && digits > 0) continue;
+            break;
+        }
+        static const char hex[] = "0123456789ABCDEF";
+        mac[digits / 2 * 3 + digits % 2] = hex[n];
+        ++digits;
+    }
+    if (digits != 12 || i != len) return false;
+    for (int b = 0; b < 5; ++b) mac[b * 3 + 2] = ':';
+    mac[17] = '\0';
+    return true;
+}
+
+// ...and its IPv4 check, which validated but kept the text as typed
+static bool legacyValidateIPv4(const char* p, size_t len) {
+    int parts = 0, digits = 0, octet = 0;
+    for (size_t i = 0; i <= len; ++i) {
+        char c = i < len ? p[i] : '.';
+        if (c >= '0' && c <= '9') {
+            octet = octet * 10 + (c - '0');
+            if (++digits > 3 || octet > 255) return false;
+        } else if (c == '.' && digits > 0) {
+            ++parts;
+            digits = octet = 0;
+        } else {
+            return false;
+        }
+    }
+    return parts == 4;
+}
+
+// ---- Timing -------------------------------------------------------------------
+
+template <typename Fn>
+static void time(const char* label, int rounds, Fn fn, double& nsOut, double& allocOut) {
+    size_t before = allocations;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) fn(i);
+    auto t1 = std::chrono::steady_clock::now();
+    nsOut = std::chrono::duration<double, std::nano>(t1 - t0).count() / rounds;
+    allocOut = double(allocations - before) / rounds;
+    (void)label;
+}
+
+static volatile uint32_t sink;
+
+static void compare(const char* what, int rounds,
+                    void (*legacy)(int), void (*codec)(int)) {
+    double oldNs, oldAlloc, newNs, newAlloc;
+    time("legacy", rounds, legacy, oldNs, oldAlloc);
+    time("codec", rounds, codec, newNs, newAlloc);
+    printf("%-28s %8.1f ns %5.1f allocs   %7.1f ns %5.1f allocs   %5.1fx\n",
+           what, oldNs, oldAlloc, newNs, newAlloc, oldNs / newNs);
+}
+
+static const String macs[4] = {"24:6F:28:0A:1B:2C", "aa:bb:cc:dd:ee:ff", "FF:EE:DD:CC:BB:AA", "00:11:22:33:44:55"};
+static const String ips[4] = {"192.168.4.1", "10.0.0.88", "255.255.255.0", "172.16.254.3"};
+static const String keys[4] = {"DEADBEEFDEADBEEFDEADBEEFDEADBEEF", "0x00112233445566778899aabbccddeeff",
+                               "01 23 45 67 89 AB CD EF 01 23 45 67 89 AB CD EF", "ffffffffffffffffffffffffffffffff"};
+
+static bool checks() {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) printf("FAILED: %s\n", what);
+        ok = ok && cond;
+    };
+
+    uint8_t mac[6];
+    char text[MAC_TEXT_LEN + 1];
+    expect(parseMac("aa-bb-cc-dd-ee-ff", 17, mac) && formatMac(mac, text) == 17 &&
+           strcmp(text, "AA:BB:CC:DD:EE:FF") == 0, "MAC dash form");
+    expect(parseMac("246F280A1B2C", 12, mac) && mac[0] == 0x24 && mac[5] == 0x2C, "bare MAC");
+    expect(!parseMac("AA:BB:CC:DD:EE:F", 16, mac), "short MAC");
+    expect(!parseMac("AA:BB-CC:DD:EE:FF", 17, mac), "mixed separators");
+    expect(!parseMac("AA:BB:CC:DD:EE:FG", 17, mac), "non-hex MAC");
+
+    uint8_t ip[4];
+    char ipText[IPV4_TEXT_MAX + 1];
+    expect(parseIPv4("192.168.004.1", 13, ip) && formatIPv4(ip, ipText) == 11 &&
+           strcmp(ipText, "192.168.4.1") == 0, "IPv4 canonical");
+    expect(!parseIPv4("256.1.1.1", 9, ip) && !parseIPv4("1.2.3", 5, ip) && !parseIPv4("1.2.3.4.", 8, ip) &&
+           !parseIPv4("1..3.4", 6, ip) && !parseIPv4("1.2.3.4.5", 9, ip), "IPv4 rejects");
+
+    uint8_t key[16];
+    for (const String& k : keys) {
+        uint8_t legacy[16];
+        bool a = legacyParseHex(k, legacy, 16);
+        bool b = parseHex(k.c_str(), k.length(), key, 16) == 16;
+        expect(!a || (b && memcmp(key, legacy, 16) == 0), k.c_str());
+    }
+    expect(parseHex("abc", 3, key, 16) == 0 && parseHex("0011", 4, key, 1) == 0, "hex rejects");
+    char hex[3 * 4];
+    const uint8_t bytes[4] = {0xDE, 0xAD, 0x00, 0x0F};
+    expect(formatHex(bytes, 4, hex, sizeof(hex), ' ') == 11 && strcmp(hex, "DE AD 00 0F") == 0, "hex format");
+    expect(formatHex(bytes, 4, hex, 8) == 0, "hex format overflow");
+
+    int32_t n;
+    char intText[INT_TEXT_MAX + 1];
+    expect(parseInt("-2147483648", 11, n) && n == INT32_MIN && formatInt(n, intText) == 11 &&
+           strcmp(intText, "-2147483648") == 0, "INT32_MIN");
+    expect(parseInt("2147483647", 10, n) && n == INT32_MAX, "INT32_MAX");
+    expect(!parseInt("2147483648", 10, n) && !parseInt("-", 1, n) && !parseInt("12ms", 4, n) &&
+           !parseInt("", 0, n), "int rejects");
+    expect(parseInt("007", 3, n) && formatInt(n, intText) == 1 && strcmp(intText, "7") == 0, "int canonical");
+
+    // Every byte value round-trips through MAC text
+    for (int v = 0; v < 256; ++v) {
+        uint8_t in[6] = {uint8_t(v), uint8_t(255 - v), 0, 0x7F, 0x80, uint8_t(v ^ 0x5A)};
+        uint8_t back[6];
+        formatMac(in, text);
+        if (!parseMac(text, MAC_TEXT_LEN, back) || memcmp(in, back, 6) != 0) {
+            expect(false, "MAC round trip");
+            break;
+        }
+    }
+    return ok;
+}
+
+int main() {
+    const int rounds = 1000000;
+    printf("%-28s %25s   %25s\n", "", "previous code", "textCodec");
+
+    compare("MAC canonicalise (schema)", rounds,
+            [](int i) { char t[18]; sink += legacyNormalizeMac(macs[i & 3].c_str(), macs[i & 3].length(), t) ? t[16] : 0; },
+            [](int i) { uint8_t m[6]; char t[MAC_TEXT_LEN + 1];
+                        sink += parseMac(macs[i & 3].c_str(), macs[i & 3].length(), m) && formatMac(m, t) ? t[16] : 0; });
+    compare("MAC format (flushPeers)", rounds,
+            [](int i) { uint8_t m[6] = {0x24, 0x6F, 0x28, 0, uint8_t(i >> 8), uint8_t(i)};
+                        String t = legacyFormatMac(m); sink += t.length() + t[i & 15]; },
+            [](int i) { uint8_t m[6] = {0x24, 0x6F, 0x28, 0, uint8_t(i >> 8), uint8_t(i)};
+                        char t[MAC_TEXT_LEN + 1]; sink += formatMac(m, t) + t[i & 15]; });
+    compare("IPv4 check (schema)", rounds,
+            [](int i) { sink += legacyValidateIPv4(ips[i & 3].c_str(), ips[i & 3].length()); },
+            [](int i) { uint8_t a[4]; sink += parseIPv4(ips[i & 3].c_str(), ips[i & 3].length(), a) ? a[3] : 0; });
+    compare("16-byte hex key (LMK)", rounds,
+            [](int i) { uint8_t k[16]; sink += legacyParseHex(keys[i & 3], k, 16) ? k[15] : 0; },
+            [](int i) { uint8_t k[16]; sink += parseHex(keys[i & 3].c_str(), keys[i & 3].length(), k, 16) ? k[15] : 0; });
+    compare("integer format + parse", rounds,
+            [](int i) { sink += String(i).toInt(); },
+            [](int i) { char t[INT_TEXT_MAX + 1]; int32_t n = 0; size_t len = formatInt(i, t);
+                        parseInt(t, len, n); sink += n; });
+    printf("\n");
+    bool ok = checks();
+    printf("edge cases and round trips: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
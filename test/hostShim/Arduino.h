@@ -0,0 +1,57 @@
+#pragma once
+// Minimal host stand-in for the Arduino core: String, Serial, ESP, millis/micros/delay.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <chrono>
+#include <thread>
+#include "WString.h"
+#include "Esp.h"
+
+#ifndef F
+#define F(s) (s)
+#endif
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+inline unsigned long micros() {
+    using namespace std::chrono;
+    static const auto start = steady_clock::now();
+    return static_cast<unsigned long>(duration_cast<microseconds>(steady_clock::now() - start).count());
+}
+
+// Benches can drive time by hand: set hostClock::manual and advance hostClock::nowMs
+struct hostClock {
+    static inline bool manual = false;
+    static inline unsigned long nowMs = 0;
+};
+
+inline unsigned long millis() { return hostClock::manual ? hostClock::nowMs : micros() / 1000; }
+inline void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+class hostSerial {
+public:
+    void begin(unsigned long) {}
+    int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        va_list ap;
+        va_start(ap, fmt);
+        int n = quiet ? 0 : vprintf(fmt, ap);
+        va_end(ap);
+        return n;
+    }
+    size_t print(const String& s) {
+        if (!quiet) fputs(s.c_str(), stdout);
+        return s.length();
+    }
+    size_t print(const char* s) { return print(String(s)); }
+    size_t print(long v) { return print(String(v)); }
+    size_t println() { return print("\n"); }
+    size_t println(const String& s) { return print(s) + println(); }
+    size_t println(const char* s) { return println(String(s)); }
+    size_t println(long v) { return println(String(v)); }
+
+    bool quiet = false;  // Benchmarks silence library logging
+};
+
+inline hostSerial Serial;
@@ -0,0 +1,24 @@
+#pragma once
+// Host stand-in for the ESP32 core's ESP object: fixed chip facts for the info
+// page. Benches may overwrite the fields.
+#include <stdint.h>
+
+class hostEsp {
+public:
+    const char* getChipModel() const { return chipModel; }
+    uint8_t getChipRevision() const { return chipRevision; }
+    uint32_t getCpuFreqMHz() const { return cpuFreqMHz; }
+    uint32_t getFlashChipSize() const { return flashChipSize; }
+    uint32_t getSketchSize() const { return sketchSize; }
+    uint32_t getFreeHeap() const { return freeHeap; }
+    void restart() {}
+
+    const char* chipModel = "host";
+    uint8_t chipRevision = 0;
+    uint32_t cpuFreqMHz = 240;
+    uint32_t flashChipSize = 4 * 1024 * 1024;
+    uint32_t sketchSize = 0;
+    uint32_t freeHeap = 320 * 1024;
+};
+
+inline hostEsp ESP;
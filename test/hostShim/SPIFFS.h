@@ -0,0 +1,190 @@
+#pragma once
+// Host stand-in for SPIFFS, backed by a directory (default "./spiffs", or
+// SPIFFS.setRoot()). Counts bytes and files written so benches can report
+// flash wear: bytes, write calls, and the 256-byte SPIFFS pages each write
+// touches (a page touched by two writes is programmed twice); hostFlash can
+// charge a program time per page. SPIFFS is flat, so open("/") lists the
+// regular files in the root.
+#include "Arduino.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <memory>
+#include <string>
+
+// Benches can make flash slow: each page a write touches costs this long, as
+// programming it would on the device (0: as fast as the host disk)
+struct hostFlash {
+    static inline unsigned pageWriteUs = 0;
+};
+
+struct hostFsStats {
+    static const size_t PAGE = 256; // CONFIG_SPIFFS_PAGE_SIZE
+    size_t bytesWritten = 0;
+    size_t writeCalls = 0;
+    size_t pagesProgrammed = 0;
+    size_t filesOpenedForWrite = 0;
+    size_t renames = 0;
+    size_t removes = 0;
+};
+
+class File {
+public:
+    File() = default;
+    File(FILE* f, hostFsStats* stats, bool writable, const std::string& name = "")
+        : fp(f, &fclose), stats(stats), writable(writable), fileName(name) {}
+    // Directory handle: openNextFile() walks the entries
+    File(DIR* d, const std::string& dirPath, hostFsStats* stats)
+        : dir(d, &closedir), stats(stats), dirPath(dirPath), fileName("/") {}
+
+    explicit operator bool() const { return fp != nullptr || dir != nullptr; }
+    bool isDirectory() const { return dir != nullptr; }
+    const char* name() const { return fileName.c_str(); } // Base name, as in the ESP32 core 2.x
+
+    File openNextFile(const char* mode = "r") {
+        while (dir) {
+            dirent* entry = readdir(dir.get());
+            if (!entry) return File();
+            std::string path = dirPath + "/" + entry->d_name;
+            struct stat st;
+            if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) continue;
+            FILE* f = fopen(path.c_str(), mode[0] == 'r' ? "rb" : "ab");
+            if (f) return File(f, stats, mode[0] != 'r', entry->d_name);
+        }
+        return File();
+    }
+
+    size_t write(const uint8_t* buf, size_t len) {
+        if (!fp || !writable) return 0;
+        size_t at = static_cast<size_t>(ftell(fp.get()));
+        size_t n = fwrite(buf, 1, len, fp.get());
+        size_t pages = n ? (at + n - 1) / hostFsStats::PAGE - at / hostFsStats::PAGE + 1 : 0;
+        if (stats && n) {
+            stats->bytesWritten += n;
+            ++stats->writeCalls;
+            stats->pagesProgrammed += pages;
+        }
+        if (hostFlash::pageWriteUs)
+            std::this_thread::sleep_for(std::chrono::microseconds(pages * hostFlash::pageWriteUs));
+        return n;
+    }
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t print(const String& s) { return write(reinterpret_cast<const uint8_t*>(s.c_str()), s.length()); }
+    size_t print(const char* s) { return print(String(s)); }
+
+    int read() {
+        if (!fp) return -1;
+        int c = fgetc(fp.get());
+        return c == EOF ? -1 : c;
+    }
+    size_t read(uint8_t* buf, size_t len) { return fp ? fread(buf, 1, len, fp.get()) : 0; }
+    String readString() {
+        std::string all;
+        char chunk[256];
+        size_t n;
+        while (fp && (n = fread(chunk, 1, sizeof(chunk), fp.get())) > 0) all.append(chunk, n);
+        return String(all);
+    }
+
+    int available() {
+        if (!fp) return 0;
+        long here = ftell(fp.get());
+        return static_cast<int>(size() - here);
+    }
+    size_t size() const {
+        if (!fp) return 0;
+        long here = ftell(fp.get());
+        fseek(fp.get(), 0, SEEK_END);
+        long end = ftell(fp.get());
+        fseek(fp.get(), here, SEEK_SET);
+        return static_cast<size_t>(end);
+    }
+    size_t position() const { return fp ? static_cast<size_t>(ftell(fp.get())) : 0; }
+    // Whole seconds, as SPIFFS stores it (CONFIG_SPIFFS_USE_MTIME)
+    time_t getLastWrite() const {
+        struct stat st;
+        return fp && fstat(fileno(fp.get()), &st) == 0 ? st.st_mtime : 0;
+    }
+    bool seek(size_t pos) { return fp && fseek(fp.get(), static_cast<long>(pos), SEEK_SET) == 0; }
+    void flush() { if (fp) fflush(fp.get()); }
+    void close() {
+        fp.reset();
+        dir.reset();
+    }
+
+private:
+    std::shared_ptr<FILE> fp;
+    std::shared_ptr<DIR> dir;
+    hostFsStats* stats = nullptr;
+    bool writable = false;
+    std::string dirPath;
+    std::string fileName;
+};
+
+class hostSpiffs {
+public:
+    void setRoot(const String& dir) { root = dir.str(); }
+    // Benches can make the Nth rename from now fail, as a full or worn flash might
+    unsigned failRenameIn = 0;
+    bool begin(bool formatOnFail = false) {
+        struct stat st;
+        if (stat(root.c_str(), &st) == 0) return S_ISDIR(st.st_mode);
+        return formatOnFail && mkdir(root.c_str(), 0755) == 0;
+    }
+    void end() {}
+
+    File open(const String& path, const char* mode = "r") {
+        bool writable = mode[0] == 'w' || mode[0] == 'a';
+        std::string where = full(path);
+        struct stat st;
+        if (!writable && stat(where.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+            DIR* d = opendir(where.c_str());
+            return d ? File(d, where, &stats) : File();
+        }
+        std::string m = std::string(mode) + "b";
+        FILE* f = fopen(where.c_str(), m.c_str());
+        if (!f) return File();
+        if (writable) ++stats.filesOpenedForWrite;
+        return File(f, &stats, writable, path.startsWith("/") ? path.substring(1).str() : path.str());
+    }
+    bool exists(const String& path) {
+        struct stat st;
+        return stat(full(path).c_str(), &st) == 0;
+    }
+    // SPIFFS refuses to rename over an existing file; mirror that
+    bool rename(const String& from, const String& to) {
+        if (exists(to)) return false;
+        if (failRenameIn && --failRenameIn == 0) return false;
+        ++stats.renames;
+        return ::rename(full(from).c_str(), full(to).c_str()) == 0;
+    }
+    bool remove(const String& path) {
+        ++stats.removes;
+        return ::remove(full(path).c_str()) == 0;
+    }
+
+    // Partition size is settable; used is what the files in the root hold
+    void setCapacity(size_t bytes) { capacity = bytes; }
+    size_t totalBytes() const { return capacity; }
+    size_t usedBytes() const {
+        size_t used = 0;
+        DIR* d = opendir(root.c_str());
+        for (dirent* entry; d && (entry = readdir(d));) {
+            struct stat st;
+            if (stat((root + "/" + entry->d_name).c_str(), &st) == 0 && S_ISREG(st.st_mode)) used += st.st_size;
+        }
+        if (d) closedir(d);
+        return used;
+    }
+
+    hostFsStats stats;
+
+private:
+    std::string root = "./spiffs";
+    size_t capacity = 0x160000; // spiffs partition of the default 4 MB partition table
+    std::string full(const String& path) const {
+        return root + (path.startsWith("/") ? "" : "/") + path.str();
+    }
+};
+
+inline hostSpiffs SPIFFS;
@@ -0,0 +1,100 @@
+#pragma once
+// Host stand-in for the Arduino String class, backed by std::string.
+// Covers the subset used under lib/; add members here as callers need them.
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <algorithm>
+
+class String {
+public:
+    String() = default;
+    String(const char* s) : s_(s ? s : "") {}
+    String(const std::string& s) : s_(s) {}
+    String(char c) : s_(1, c) {}
+    String(int v) : s_(std::to_string(v)) {}
+    String(unsigned int v) : s_(std::to_string(v)) {}
+    String(long v) : s_(std::to_string(v)) {}
+    String(unsigned long v) : s_(std::to_string(v)) {}
+    String(long long v) : s_(std::to_string(v)) {}
+    String(unsigned long long v) : s_(std::to_string(v)) {}
+    String(float v, unsigned decimals = 2) : String(static_cast<double>(v), decimals) {}
+    String(double v, unsigned decimals = 2) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", static_cast<int>(decimals), v);
+        s_ = buf;
+    }
+
+    const char* c_str() const { return s_.c_str(); }
+    unsigned int length() const { return static_cast<unsigned int>(s_.size()); }
+    bool isEmpty() const { return s_.empty(); }
+    bool reserve(unsigned int n) { s_.reserve(n); return true; }
+
+    char operator[](unsigned int i) const { return i < s_.size() ? s_[i] : '\0'; }
+    char& operator[](unsigned int i) { return s_[i]; }
+    char charAt(unsigned int i) const { return (*this)[i]; }
+
+    long toInt() const { return strtol(s_.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(s_.c_str(), nullptr); }
+
+    bool equals(const String& o) const { return s_ == o.s_; }
+    bool equalsIgnoreCase(const String& o) const {
+        return s_.size() == o.s_.size() &&
+               std::equal(s_.begin(), s_.end(), o.s_.begin(),
+                          [](char a, char b) { return tolower(a) == tolower(b); });
+    }
+    bool startsWith(const String& p) const { return s_.compare(0, p.s_.size(), p.s_) == 0; }
+    bool endsWith(const String& p) const {
+        return s_.size() >= p.s_.size() && s_.compare(s_.size() - p.s_.size(), p.s_.size(), p.s_) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return find(s_.find(c, from)); }
+    int indexOf(const String& p, unsigned int from = 0) const { return find(s_.find(p.s_, from)); }
+    int lastIndexOf(char c) const { return find(s_.rfind(c)); }
+
+    String substring(unsigned int from) const { return from < s_.size() ? String(s_.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) std::swap(from, to);
+        if (from >= s_.size()) return String();
+        return String(s_.substr(from, std::min<size_t>(to, s_.size()) - from));
+    }
+
+    void replace(const String& from, const String& to) {
+        if (from.s_.empty()) return;
+        for (size_t pos = 0; (pos = s_.find(from.s_, pos)) != std::string::npos; pos += to.s_.size())
+            s_.replace(pos, from.s_.size(), to.s_);
+    }
+    void remove(unsigned int index) { if (index < s_.size()) s_.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < s_.size()) s_.erase(index, count); }
+    void toUpperCase() { for (auto& c : s_) c = toupper(c); }
+    void toLowerCase() { for (auto& c : s_) c = tolower(c); }
+    void trim() {
+        size_t b = s_.find_first_not_of(" \t\r\n");
+        size_t e = s_.find_last_not_of(" \t\r\n");
+        s_ = (b == std::string::npos) ? std::string() : s_.substr(b, e - b + 1);
+    }
+
+    bool concat(const String& o) { s_ += o.s_; return true; }
+    bool concat(const char* p, unsigned int n) { s_.append(p, n); return true; }
+    String& operator+=(const String& o) { s_ += o.s_; return *this; }
+    String& operator+=(const char* o) { s_ += o; return *this; }
+    String& operator+=(char c) { s_ += c; return *this; }
+
+    friend String operator+(const String& a, const String& b) { return String(a.s_ + b.s_); }
+    friend String operator+(const String& a, const char* b) { return String(a.s_ + b); }
+    friend String operator+(const char* a, const String& b) { return String(a + b.s_); }
+
+    friend bool operator==(const String& a, const String& b) { return a.s_ == b.s_; }
+    friend bool operator==(const String& a, const char* b) { return a.s_ == b; }
+    friend bool operator!=(const String& a, const String& b) { return a.s_ != b.s_; }
+    friend bool operator!=(const String& a, const char* b) { return a.s_ != b; }
+    friend bool operator<(const String& a, const String& b) { return a.s_ < b.s_; }
+
+    const std::string& str() const { return s_; }
+
+private:
+    std::string s_;
+    static int find(size_t pos) { return pos == std::string::npos ? -1 : static_cast<int>(pos); }
+};
+
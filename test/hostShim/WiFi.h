@@ -0,0 +1,44 @@
+#pragma once
+// Host stand-in for WiFi.h: IPAddress and a WiFi object reporting a fixed
+// station. Only the read-only calls the web UI makes are covered.
+#include "Arduino.h"
+#include <string.h>
+
+class IPAddress {
+public:
+    IPAddress() = default;
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : octets{a, b, c, d} {}
+
+    uint8_t operator[](int i) const { return octets[i]; }
+    uint8_t& operator[](int i) { return octets[i]; }
+    String toString() const {
+        char text[16];
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+        return String(text);
+    }
+
+private:
+    uint8_t octets[4] = {0, 0, 0, 0};
+};
+
+class hostWiFi {
+public:
+    uint8_t* macAddress(uint8_t* out) const {
+        memcpy(out, mac, sizeof(mac));
+        return out;
+    }
+    IPAddress localIP() const { return ip; }
+    IPAddress softAPIP() const { return apIp; }
+    int32_t channel() const { return wifiChannel; }
+    String SSID() const { return ssid; }
+    int8_t RSSI() const { return rssi; }
+
+    uint8_t mac[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x01};
+    IPAddress ip{192, 168, 1, 50};
+    IPAddress apIp{192, 168, 4, 1};
+    int32_t wifiChannel = 1;
+    String ssid = "host";
+    int8_t rssi = -50;
+};
+
+inline hostWiFi WiFi;
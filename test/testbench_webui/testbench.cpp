@@ -1,45 +1,86 @@
-#include <iostream>
-#include <fstream>
+// Loads test_config.json through configManager2, edits a value and renders the
+// web UI pages on the host. SPIFFS is the directory-backed shim rooted here, so
+// the file pages list this directory. Pass a directory to also write the pages
+// out as .html files for a browser.
+//   g++ -std=c++17 -O2 -I../hostShim -I../../lib/configManager2 -I../../lib/globalConstants/src -I../../lib/textCodec -I../../lib/heapStats
+//       -I../../lib/htmlRenderer/src testbench.cpp ../../lib/configManager2/configManager2.cpp
+//       ../../lib/configManager2/configSchema.cpp ../../lib/htmlRenderer/src/htmlRenderer.cpp -o testbench
+#include <cstdio>
 #include <configManager2.h>
+#include <htmlRenderer.h>
 
-void loadTestConfig(configManager2& configManager, const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file) {
-        std::cerr << "❌ Error: Cannot open " << filename << std::endl;
-        return;
+static bool loadTestConfig(configManager2& configManager, const String& filename) {
+    if (!configManager.loadFromFile(filename, true)) {
+        Serial.printf("❌ Error: Cannot load %s\n", filename.c_str());
+        return false;
     }
+    Serial.println("✅ Config Loaded Successfully!");
+    configManager.printConfigToSerial();
+    return true;
+}
 
-    std::string jsonString((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    file.close();
+static bool modifyTestConfig(configManager2& configManager) {
+    String section = "Server";
+    String key = "ip";
+    String newValue = "192.168.1.10";
 
-    if (!configManager.jsonStringToMap(&jsonString, true)) {
-        std::cerr << "❌ JSON parsing failed!" << std::endl;
-    } else {
-        std::cout << "✅ Config Loaded Successfully!\n";
-        configManager.printConfigToSerial();
+    Serial.printf("\n🔧 Modifying config: %s.%s → %s\n", section.c_str(), key.c_str(), newValue.c_str());
+    if (!configManager.setValue(section, key, newValue) || configManager.getValue(section, key) != newValue) {
+        Serial.println("❌ setValue was not applied");
+        return false;
     }
+    Serial.println("📝 New Configuration:");
+    configManager.printConfigToSerial();
+    return true;
 }
 
-void modifyTestConfig(configManager2& configManager) {
-    std::string section = "Server";
-    std::string key = "ip";
-    std::string newValue = "192.168.1.10";
-
-    std::cout << "\n🔧 Modifying config: " << section << "." << key << " → " << newValue << std::endl;
-    configManager.setValue(section, key, newValue);
-
-    std::cout << "📝 New Configuration:\n";
-    configManager.printConfigToSerial();
+static bool renderPage(const char* name, const String& html, const char* outDir) {
+    bool ok = html.startsWith("<!DOCTYPE html>");
+    Serial.printf("%s %-12s %6u bytes\n", ok ? "✅" : "❌", name, html.length());
+    if (outDir) {
+        String path = String(outDir) + "/" + name + ".html";
+        FILE* f = fopen(path.c_str(), "wb");
+        if (f) {
+            fwrite(html.c_str(), 1, html.length(), f);
+            fclose(f);
+        }
+    }
+    return ok;
 }
 
-int main() {
+int main(int argc, char** argv) {
+    const char* outDir = argc > 1 ? argv[1] : nullptr;
+    SPIFFS.setRoot(".");
+    SPIFFS.begin();
     configManager2 configManager;
 
-    std::cout << "\n🔍 Loading Test Config...\n";
-    loadTestConfig(configManager, "test_config.json");
+    Serial.println("\n🔍 Loading Test Config...");
+    bool ok = loadTestConfig(configManager, "/test_config.json");
+
+    Serial.println("\n💾 Running Modifications...");
+    ok = ok && modifyTestConfig(configManager);
+
+    Serial.println("\n🖥 Rendering Pages...");
+    htmlRenderer renderer(&configManager.getConfig());
+    renderer.setSchema(&configManager.getSchema());
+    ok = renderPage("home", renderer.generateHomePage(), outDir) && ok;
+    ok = renderPage("sections", renderer.generateAllSectionsPage(), outDir) && ok;
+    ok = renderPage("config", renderer.generateConfigFormPage(configManager.getConfig()), outDir) && ok;
+    ok = renderPage("files", renderer.generateSPIFFSFileListPage(), outDir) && ok;
+    ok = renderPage("download", renderer.generateDownloadPage(), outDir) && ok;
+    ok = renderPage("info", renderer.generateInfoPage(), outDir) && ok;
 
-    std::cout << "\n💾 Running Modifications...\n";
-    modifyTestConfig(configManager);
+    String config = renderer.generateConfigFormPage(configManager.getConfig());
+    if (config.indexOf("192.168.1.10") < 0) {
+        Serial.println("❌ Config form does not show the edited value");
+        ok = false;
+    }
+    String files = renderer.generateSPIFFSFileListPage();
+    if (files.indexOf("test_config.json") < 0) {
+        Serial.println("❌ File list does not show test_config.json");
+        ok = false;
+    }
 
-    return 0;
-}
\ No newline at end of file
+    Serial.printf("\n%s\n", ok ? "✅ testbench passed" : "❌ testbench FAILED");
+    return ok ? 0 : 1;
+}